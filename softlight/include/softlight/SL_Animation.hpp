@@ -12,6 +12,7 @@
 
 #include "softlight/SL_AnimationProperty.hpp"
 #include "softlight/SL_AnimationChannel.hpp"
+#include "softlight/SL_AnimationClip.hpp"
 
 
 
@@ -108,6 +109,13 @@ class SL_Animation
      */
     std::vector<size_t> mTransformIds;
 
+    /**
+     * @brief mClip contains an optional, packed copy of every channel in
+     * *this. When valid, it is sampled instead of the channels in the scene
+     * graph. Adding or removing channels will discard the packed copy.
+     */
+    SL_AnimationClip mClip;
+
   public: // public member functions
     /**
      * @brief Destructor
@@ -386,6 +394,46 @@ class SL_Animation
      */
     void animate(SL_SceneGraph& graph, const SL_AnimPrecision percentDone, size_t baseTransformId) const noexcept;
 
+    /**
+     * @brief Animate a range of channels in a sceneGraph.
+     *
+     * Each channel only writes to its own transformation, allowing
+     * separate ranges of channels to be animated from different threads.
+     * Channels are applied from last to first, so if several channels in a
+     * range target the same transformation, the first one takes precedence.
+     *
+     * @param graph
+     * A reference to a sceneGraph object who's internal nodes will be
+     * transformed according to the keyframes in *this.
+     *
+     * @param percentDone
+     * The percent of the animation which has been played in total. An
+     * assertion will be raised if this value is less than 0.0.
+     *
+     * @param baseTransformId
+     * An index of a root transformation in the scene graph, or
+     * SL_SceneNodeProp::SCENE_NODE_ROOT_ID to use the transformations
+     * assigned to each channel.
+     *
+     * @param pCursors
+     * An array of keyframe cursors, one per channel in *this, which will be
+     * used to speed up keyframe lookups. This can be NULL.
+     *
+     * @param channelBegin
+     * The index of the first channel in *this to animate.
+     *
+     * @param channelEnd
+     * One past the index of the last channel in *this to animate.
+     */
+    void animate(
+        SL_SceneGraph& graph,
+        const SL_AnimPrecision percentDone,
+        size_t baseTransformId,
+        SL_AnimationCursor* pCursors,
+        size_t channelBegin,
+        size_t channelEnd
+    ) const noexcept;
+
     /**
      * Initialize the animation transformations for all nodes in a scene graph.
      * 
@@ -407,6 +455,37 @@ class SL_Animation
      * node transformations, FALSE if not.
      */
     bool have_monotonic_transforms() const noexcept;
+
+    /**
+     * @brief Resample all channels of *this into a packed animation clip,
+     * which will be used for all future calls to "animate()".
+     *
+     * @param graph
+     * The scene graph containing the keyframes of *this.
+     *
+     * @param samplesPerSec
+     * The number of keyframes to store for each second of animation.
+     *
+     * @param quantize
+     * Store each key component in 16 bits rather than 32.
+     *
+     * @return 0 if *this was packed, or a negative value from
+     * SL_AnimationClip::init() if not.
+     */
+    int pack(const SL_SceneGraph& graph, SL_AnimPrecision samplesPerSec = SL_ANIM_CLIP_SAMPLE_RATE, bool quantize = false) noexcept;
+
+    /**
+     * @brief Discard the packed animation clip of *this.
+     */
+    void unpack() noexcept;
+
+    /**
+     * @brief Retrieve the packed animation clip of *this.
+     *
+     * @return A reference to an animation clip, which is only valid if
+     * "pack()" has been called.
+     */
+    const SL_AnimationClip& clip() const noexcept;
 };
 
 
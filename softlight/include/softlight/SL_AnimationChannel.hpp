@@ -13,6 +13,20 @@
 
 
 
+/*-----------------------------------------------------------------------------
+ * Keyframes last used by an animation channel. Animation players keep one of
+ * these per channel so keyframes don't need to be searched for on every
+ * update.
+-----------------------------------------------------------------------------*/
+struct SL_AnimationCursor
+{
+    size_t mPosFrame;
+    size_t mScaleFrame;
+    size_t mOrientFrame;
+};
+
+
+
 /*-----------------------------------------------------------------------------
  * SL_Animation Keys (interpolations of animations).
 -----------------------------------------------------------------------------*/
@@ -215,6 +229,23 @@ struct SL_AnimationChannel
      */
     ls::math::vec3_t<float> position_frame(const SL_AnimPrecision percent) const noexcept;
 
+    /**
+     * @brief Retrieve the position that a node should be during a
+     * particular frame, starting the keyframe search from a cursor.
+     *
+     * @param percent
+     * The percent of the position reel, clamped between 0 and 1, which
+     * has been completed.
+     *
+     * @param ioCursor
+     * The keyframes last used by this channel. These will be updated with
+     * the keyframes used for the current percentage.
+     *
+     * @return A 3D vector, containing the node-relative position which
+     * will be stored in *this at a particular frame.
+     */
+    ls::math::vec3_t<float> position_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept;
+
     /**
      * @brief Set the scale of a frame.
      *
@@ -251,6 +282,23 @@ struct SL_AnimationChannel
      */
     ls::math::vec3_t<float> scale_frame(const SL_AnimPrecision percent) const noexcept;
 
+    /**
+     * @brief Retrieve the scale that a node should be during a particular
+     * frame, starting the keyframe search from a cursor.
+     *
+     * @param percent
+     * The percent of the scale reel, clamped between 0 and 1, which has
+     * been completed.
+     *
+     * @param ioCursor
+     * The keyframes last used by this channel. These will be updated with
+     * the keyframes used for the current percentage.
+     *
+     * @return A 3D vector, containing the node-relative scaling which will
+     * be stored in *this at a particular frame.
+     */
+    ls::math::vec3_t<float> scale_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept;
+
     /**
      * @brief Set the rotation of a frame.
      *
@@ -287,6 +335,23 @@ struct SL_AnimationChannel
      */
     ls::math::quat_t<float> rotation_frame(const SL_AnimPrecision percent) const noexcept;
 
+    /**
+     * @brief Retrieve the orientation that a node should be during a
+     * particular frame, starting the keyframe search from a cursor.
+     *
+     * @param percent
+     * The percent of the rotation reel, clamped between 0 and 1, which has
+     * been completed.
+     *
+     * @param ioCursor
+     * The keyframes last used by this channel. These will be updated with
+     * the keyframes used for the current percentage.
+     *
+     * @return A quaternion, containing the node-relative orientation which
+     * will be stored in *this at a particular frame.
+     */
+    ls::math::quat_t<float> rotation_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept;
+
     /**
      * @brief Retrieve the position, scale, and rotation of a node at a
      * percentage of its total frame index.
@@ -447,6 +512,16 @@ inline ls::math::vec3 SL_AnimationChannel::position_frame(const SL_AnimPrecision
 
 
 
+/*-------------------------------------
+ * Get a single position key (cached)
+-------------------------------------*/
+inline ls::math::vec3 SL_AnimationChannel::position_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept
+{
+    return mPosFrames.interpolated_data(percent, mAnimMode, ioCursor.mPosFrame);
+}
+
+
+
 /*-------------------------------------
  * Get a single scale key
 -------------------------------------*/
@@ -457,6 +532,16 @@ inline ls::math::vec3 SL_AnimationChannel::scale_frame(const SL_AnimPrecision pe
 
 
 
+/*-------------------------------------
+ * Get a single scale key (cached)
+-------------------------------------*/
+inline ls::math::vec3 SL_AnimationChannel::scale_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept
+{
+    return mScaleFrames.interpolated_data(percent, mAnimMode, ioCursor.mScaleFrame);
+}
+
+
+
 /*-------------------------------------
  * Get a single rotaion key
 -------------------------------------*/
@@ -467,6 +552,16 @@ inline ls::math::quat SL_AnimationChannel::rotation_frame(const SL_AnimPrecision
 
 
 
+/*-------------------------------------
+ * Get a single rotaion key (cached)
+-------------------------------------*/
+inline ls::math::quat SL_AnimationChannel::rotation_frame(const SL_AnimPrecision percent, SL_AnimationCursor& ioCursor) const noexcept
+{
+    return mOrientFrames.interpolated_data(percent, mAnimMode, ioCursor.mOrientFrame);
+}
+
+
+
 /*-------------------------------------
  * SL_Animation Key Interpolator
 -------------------------------------*/
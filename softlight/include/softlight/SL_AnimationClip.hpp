@@ -0,0 +1,260 @@
+
+#ifndef SL_ANIMATION_CLIP_HPP
+#define SL_ANIMATION_CLIP_HPP
+
+#include <cstdint>
+
+#include "softlight/SL_AnimationProperty.hpp"
+#include "softlight/SL_Config.hpp" // SL_ANIM_CLIP_SAMPLE_RATE
+#include "softlight/SL_Setup.hpp" // SL_AlignedVector
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward declarations
+-----------------------------------------------------------------------------*/
+class SL_Animation;
+class SL_SceneGraph;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Packed Animation Clip Properties
+-----------------------------------------------------------------------------*/
+enum SL_AnimationClipFlag : uint8_t
+{
+    SL_ANIM_CLIP_FLAG_NONE     = 0x00,
+    SL_ANIM_CLIP_FLAG_POSITION = 0x01, // the channel has position keys
+    SL_ANIM_CLIP_FLAG_SCALE    = 0x02, // the channel has scale keys
+    SL_ANIM_CLIP_FLAG_ROTATION = 0x04, // the channel has rotation keys
+    SL_ANIM_CLIP_FLAG_STEPPED  = 0x08, // the channel jumps between keys (SL_ANIM_FLAG_IMMEDIATE)
+};
+
+enum : unsigned
+{
+    // Number of channels sampled at once
+    SL_ANIM_CLIP_LANES = 4,
+
+    // Position XYZ, scale XYZ, then rotation XYZW
+    SL_ANIM_CLIP_COMPONENTS = 10,
+    SL_ANIM_CLIP_POSITION_OFFSET = 0,
+    SL_ANIM_CLIP_SCALE_OFFSET = 3,
+    SL_ANIM_CLIP_ROTATION_OFFSET = 6,
+
+    // Start & end times of the position, scale, then rotation keys
+    SL_ANIM_CLIP_CHANNEL_TIMES = 6,
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Sampled transformations of SL_ANIM_CLIP_LANES channels. Each row contains
+ * a single component of every channel.
+-----------------------------------------------------------------------------*/
+struct alignas(sizeof(float)*SL_ANIM_CLIP_LANES) SL_AnimationClipSample
+{
+    float mComponents[SL_ANIM_CLIP_COMPONENTS][SL_ANIM_CLIP_LANES];
+};
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief An Animation Clip is a packed copy of every channel in an animation.
+ *
+ * Keyframes of all channels are resampled at a fixed rate so they share the
+ * same key times. Groups of SL_ANIM_CLIP_LANES channels are stored together,
+ * one component per row, allowing each group to be interpolated with vector
+ * instructions. Keys can optionally be quantized to 16 bits per component.
+-----------------------------------------------------------------------------*/
+class SL_AnimationClip
+{
+  private:
+    size_t mNumChannels;
+
+    size_t mNumFrames;
+
+    // One set of SL_AnimationClipFlag bits per channel
+    SL_AlignedVector<uint8_t> mChannelFlags;
+
+    // Time range of each channel's original keys, ordered by
+    // [channel][position/scale/rotation][start/end]
+    SL_AlignedVector<SL_AnimPrecision> mChannelTimes;
+
+    // Keys are ordered by [group][frame][component][lane]
+    SL_AlignedVector<float> mKeys;
+
+    // Same layout as mKeys, only used by quantized clips
+    SL_AlignedVector<uint16_t> mQuantizedKeys;
+
+    // Minimum value and step size of each quantized group, ordered by
+    // [group][min/step][component][lane]
+    SL_AlignedVector<float> mKeyRanges;
+
+  public:
+    ~SL_AnimationClip() noexcept;
+
+    SL_AnimationClip() noexcept;
+
+    SL_AnimationClip(const SL_AnimationClip& c) noexcept;
+
+    SL_AnimationClip(SL_AnimationClip&& c) noexcept;
+
+    SL_AnimationClip& operator=(const SL_AnimationClip& c) noexcept;
+
+    SL_AnimationClip& operator=(SL_AnimationClip&& c) noexcept;
+
+    /**
+     * @brief Resample all channels of an animation into *this.
+     *
+     * @param graph
+     * The scene graph containing the animation's keyframes.
+     *
+     * @param anim
+     * The animation to pack.
+     *
+     * @param samplesPerSec
+     * The number of keyframes to store for each second of animation.
+     *
+     * @param quantize
+     * Store each key component in 16 bits rather than 32.
+     *
+     * @return 0 if the animation was packed, -1 if the animation has no
+     * channels, or -2 if the sample rate is invalid.
+     */
+    int init(const SL_SceneGraph& graph, const SL_Animation& anim, SL_AnimPrecision samplesPerSec, bool quantize) noexcept;
+
+    /**
+     * @brief Free all keyframes from *this.
+     */
+    void terminate() noexcept;
+
+    bool valid() const noexcept;
+
+    bool quantized() const noexcept;
+
+    size_t num_channels() const noexcept;
+
+    size_t num_groups() const noexcept;
+
+    size_t num_frames() const noexcept;
+
+    /**
+     * @brief Retrieve the SL_AnimationClipFlag bits of a channel.
+     */
+    uint8_t channel_flags(size_t channelId) const noexcept;
+
+    /**
+     * @brief Retrieve the SL_AnimationClipFlag bits of a channel which
+     * apply at a point in time.
+     *
+     * Position, scale, and rotation flags are only returned while the
+     * channel's original keys cover "percent", matching
+     * SL_AnimationChannel::has_position_frame() and friends.
+     */
+    uint8_t channel_flags(size_t channelId, SL_AnimPrecision percent) const noexcept;
+
+    /**
+     * @brief Interpolate the transformations of a group of channels.
+     *
+     * Positions and scales are linearly interpolated. Rotations use a
+     * normalized linear interpolation along the shortest path. Stepped
+     * channels are not interpolated; they switch keys on frame boundaries.
+     *
+     * @param groupId
+     * The index of the group to sample. Group N contains channels
+     * [N*SL_ANIM_CLIP_LANES, (N+1)*SL_ANIM_CLIP_LANES).
+     *
+     * @param percent
+     * The percent of the animation which has been played, clamped between
+     * 0 and 1.
+     *
+     * @param outSample
+     * The interpolated transformations of each channel in the group.
+     */
+    void sample(size_t groupId, SL_AnimPrecision percent, SL_AnimationClipSample& outSample) const noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Check if *this contains keyframes
+-------------------------------------*/
+inline bool SL_AnimationClip::valid() const noexcept
+{
+    return mNumFrames > 0;
+}
+
+
+
+/*-------------------------------------
+ * Check if keyframes are quantized
+-------------------------------------*/
+inline bool SL_AnimationClip::quantized() const noexcept
+{
+    return !mQuantizedKeys.empty();
+}
+
+
+
+/*-------------------------------------
+ * Get the number of channels
+-------------------------------------*/
+inline size_t SL_AnimationClip::num_channels() const noexcept
+{
+    return mNumChannels;
+}
+
+
+
+/*-------------------------------------
+ * Get the number of channel groups
+-------------------------------------*/
+inline size_t SL_AnimationClip::num_groups() const noexcept
+{
+    return (mNumChannels + SL_ANIM_CLIP_LANES - 1u) / SL_ANIM_CLIP_LANES;
+}
+
+
+
+/*-------------------------------------
+ * Get the number of keyframes
+-------------------------------------*/
+inline size_t SL_AnimationClip::num_frames() const noexcept
+{
+    return mNumFrames;
+}
+
+
+
+/*-------------------------------------
+ * Get a channel's flags
+-------------------------------------*/
+inline uint8_t SL_AnimationClip::channel_flags(size_t channelId) const noexcept
+{
+    return mChannelFlags[channelId];
+}
+
+
+
+/*-------------------------------------
+ * Get a channel's flags at a point in time
+-------------------------------------*/
+inline uint8_t SL_AnimationClip::channel_flags(size_t channelId, SL_AnimPrecision percent) const noexcept
+{
+    const SL_AnimPrecision* const pTimes = mChannelTimes.data() + channelId * SL_ANIM_CLIP_CHANNEL_TIMES;
+    uint8_t flags = mChannelFlags[channelId];
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        if (percent < pTimes[i*2u] || percent > pTimes[i*2u+1u])
+        {
+            flags &= (uint8_t)~(SL_ANIM_CLIP_FLAG_POSITION << i);
+        }
+    }
+
+    return flags;
+}
+
+
+
+#endif /* SL_ANIMATION_CLIP_HPP */
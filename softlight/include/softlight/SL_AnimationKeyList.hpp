@@ -285,6 +285,28 @@ class SL_AnimationKeyList
      */
     data_t interpolated_data(SL_AnimPrecision percent, const SL_AnimationFlag animFlags) const noexcept;
 
+    /**
+     * Retrieve the interpolation between two keyframes, using a cached
+     * keyframe index to avoid searching the entire key list.
+     *
+     * @param percent
+     * A floating-point value, representing the overall time that has
+     * elapsed in an animation.
+     *
+     * @param animFlags
+     * A set of flags which determines how the output data will be
+     * interpolated.
+     *
+     * @param ioCursor
+     * A reference to the keyframe index returned by a previous call. This
+     * will be updated with the index of the next keyframe used for
+     * interpolation. A value of 0 forces a full search.
+     *
+     * @return The interpolation between two animation frames at a given
+     * time of an animation.
+     */
+    data_t interpolated_data(SL_AnimPrecision percent, const SL_AnimationFlag animFlags, size_t& ioCursor) const noexcept;
+
     /**
      * Calculate the percent of interpolation which is required to mix the
      * data between two animation frames.
@@ -311,6 +333,39 @@ class SL_AnimationKeyList
         size_t& outCurrFrame,
         size_t& outNextFrame
     ) const noexcept;
+
+    /**
+     * Calculate the percent of interpolation which is required to mix the
+     * data between two animation frames.
+     *
+     * The next keyframe is looked up near 'frameHint' first. Animations
+     * which play forward will usually find their keyframes there, otherwise
+     * a binary search is performed.
+     *
+     * @param totalAnimPercent
+     * The overall percent of time elapsed in an animation.
+     *
+     * @param outCurrFrame
+     * A reference to an integer, which will contain the array index of the
+     * current frame in *this which should be used for interpolation.
+     *
+     * @param outNextFrame
+     * A reference to an integer, which will contain the array index of the
+     * next frame in *this which should be used for interpolation.
+     *
+     * @param frameHint
+     * The value of 'outNextFrame' from a previous call, or 0 if unknown.
+     *
+     * @return A percentage, which should be used to determine the amount
+     * of interpolation between the frames at 'outCurrFrane' and
+     * 'outNextFrame.'
+     */
+    SL_AnimPrecision calc_frame_interpolation(
+        const SL_AnimPrecision totalAnimPercent,
+        size_t& outCurrFrame,
+        size_t& outNextFrame,
+        const size_t frameHint
+    ) const noexcept;
 };
 
 
@@ -4,7 +4,9 @@
 
 #include <climits> // UINT_MAX
 #include <cstdint> // uint64_t
+#include <vector>
 
+#include "softlight/SL_AnimationChannel.hpp" // SL_AnimationCursor
 #include "softlight/SL_AnimationProperty.hpp"
 
 
@@ -12,6 +14,7 @@
 /*-----------------------------------------------------------------------------
  * Forward declarations
 -----------------------------------------------------------------------------*/
+class SL_Animation;
 class SL_SceneGraph;
 
 
@@ -85,6 +88,29 @@ class SL_AnimationPlayer
      */
     SL_AnimPrecision mDilation;
 
+    /**
+     * @brief The keyframes last used by each channel of the animation being
+     * played. Caching these avoids searching every channel's keyframes on
+     * each update.
+     */
+    std::vector<SL_AnimationCursor> mCursors;
+
+    /**
+     * @brief Progress the play count and time of *this.
+     *
+     * @param anim
+     * The animation being played.
+     *
+     * @param millis
+     * The number of milliseconds which have passed since the last update.
+     *
+     * @param outPercent
+     * The percent of the animation which should be sampled.
+     *
+     * @return TRUE if the animation should be sampled, FALSE if not.
+     */
+    bool advance(const SL_Animation& anim, int64_t millis, SL_AnimPrecision& outPercent) noexcept;
+
   public:
     /**
      * @brief Destructor
@@ -217,6 +243,47 @@ class SL_AnimationPlayer
      */
     void tick(SL_SceneGraph& graph, size_t animationIndex, int64_t millis, size_t baseTransformId) noexcept;
 
+    /**
+     * @brief Progress a set of animation players at once.
+     *
+     * The play state of each player is updated serially, then all channels
+     * of every playing animation are sampled in parallel using the threads
+     * of the scene graph's context. Players must not animate the same
+     * transformations, otherwise the results are undefined. Channels within
+     * one animation which share a transformation are applied in the same
+     * order as SL_Animation::animate() unless they are split across threads.
+     *
+     * @param graph
+     * A reference to a sceneGraph object which contains one or more
+     * Animation objects.
+     *
+     * @param pPlayers
+     * An array of animation players to update.
+     *
+     * @param pAnimIndices
+     * An array containing the index of the Animation object each player
+     * should use.
+     *
+     * @param pBaseTransformIds
+     * An array containing the root transformation each player should
+     * animate, or SL_SceneNodeProp::SCENE_NODE_ROOT_ID to animate the
+     * transformations referenced by each animation. This can be NULL.
+     *
+     * @param numPlayers
+     * The number of elements in each of the input arrays.
+     *
+     * @param millis
+     * The number of milliseconds which have passed since the last update.
+     */
+    static void tick_all(
+        SL_SceneGraph& graph,
+        SL_AnimationPlayer* pPlayers,
+        const size_t* pAnimIndices,
+        const size_t* pBaseTransformIds,
+        size_t numPlayers,
+        int64_t millis
+    ) noexcept;
+
     /**
      * @brief Animate a scene graph using the using the Animation object
      * referenced by a specific index. This function does not modify internal
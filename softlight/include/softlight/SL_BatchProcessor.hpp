@@ -0,0 +1,118 @@
+#ifndef SL_BATCH_PROCESSOR_HPP
+#define SL_BATCH_PROCESSOR_HPP
+
+#include <cstdint>
+
+#include "softlight/SL_Mesh.hpp" // SL_RenderMode
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward Declarations
+-----------------------------------------------------------------------------*/
+template <typename data_t>
+union SL_BinCounter;
+
+template <typename data_t>
+union SL_BinCounterAtomic;
+
+struct SL_BinTileMap;
+class SL_Context;
+struct SL_FragCoord;
+struct SL_FragmentBin;
+class SL_Framebuffer;
+struct SL_MeshletCull;
+struct SL_Shader;
+struct SL_ThreadStats;
+
+
+
+/*-----------------------------------------------------------------------------
+ * A run of meshes within a batch which share a shader, framebuffer, and
+ * render mode. Each run is processed the same way as a call to
+ * SL_Context::draw_multiple() (or draw_instanced()).
+-----------------------------------------------------------------------------*/
+struct SL_DrawRun
+{
+    const SL_Shader* pShader;
+    SL_Framebuffer* pFbo;
+
+    const SL_Mesh* pMeshes;
+    size_t numMeshes;
+    size_t numInstances;
+
+    // Meshlet culling data for each mesh, any of which may be NULL
+    const SL_MeshletCull* const* pCulls;
+
+    SL_RenderMode mode;
+
+    // When set, no thread may begin this run until the previous run has been
+    // fully rasterized by all threads.
+    uint32_t waitForPrevious;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Synchronization primitives & bin storage for a single run. Consecutive runs
+ * alternate between two bin sets so vertex processing of one run can begin
+ * while fragments from the previous run are still being rasterized.
+-----------------------------------------------------------------------------*/
+struct SL_BinSet
+{
+    SL_BinCounterAtomic<int_fast64_t>* pFragProcessors;
+    SL_BinCounterAtomic<uint_fast64_t>* pBusyProcessors;
+
+    SL_BinCounterAtomic<uint32_t>* pBinsUsed;
+    SL_BinCounter<uint32_t>* pBinIds;
+    SL_BinCounter<uint32_t>* pTempBinIds;
+
+    SL_FragmentBin* pFragBins;
+    SL_BinTileMap* pBinTiles;
+
+    SL_BinCounterAtomic<uint_fast64_t>* pVertChunks;
+
+    // Number of threads which have left the current run
+    SL_BinCounterAtomic<uint32_t>* pRunExits;
+
+    // Number of runs which have completed using this bin set
+    SL_BinCounterAtomic<uint32_t>* pRunsRetired;
+};
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Batch Processor executes a sequence of draw runs on a single
+ * thread without returning to the processor pool between draws.
+ *
+ * Each pixel is only ever written by the thread which owns its scanline, and
+ * every thread executes runs in submission order. A thread which finishes its
+ * share of fragments for run N can therefore start transforming the vertices
+ * of run N+1 without reordering writes to the framebuffer.
+-----------------------------------------------------------------------------*/
+struct SL_BatchProcessor
+{
+    // 32 bits
+    uint16_t mThreadId;
+    uint16_t mNumThreads;
+
+    // 64-128 bits
+    const SL_Context* mContext;
+
+    // 128-256 bits
+    const SL_DrawRun* mRuns;
+    size_t mNumRuns;
+
+    // 192-384 bits
+    const SL_BinSet* mBinSets; // 2 elements
+    SL_FragCoord* mFragQueues;
+    SL_ThreadStats* mStats;
+
+    // 416-864 bits total, 52-108 bytes
+
+    void execute() noexcept;
+};
+
+
+
+#endif /* SL_BATCH_PROCESSOR_HPP */
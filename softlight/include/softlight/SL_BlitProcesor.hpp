@@ -53,7 +53,12 @@ struct SL_BlitProcessor
     const SL_TextureView* mSrcTex;
     SL_TextureView* mDstTex;
 
-    // 224-288 bits total, 28-36 bytes
+    // 16 bits
+    // Set for framebuffer attachments, which are indexed with sl_fbo_index()
+    uint8_t mSrcTiled;
+    uint8_t mDstTiled;
+
+    // 240-304 bits total, 30-38 bytes
 
     // Blit a single R channel
     template<typename inColor_type>
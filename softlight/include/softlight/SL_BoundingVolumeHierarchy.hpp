@@ -0,0 +1,244 @@
+
+#ifndef SL_BOUNDING_VOLUME_HIERARCHY_HPP
+#define SL_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <cstdint>
+
+#include "lightsky/math/vec4.h"
+
+#include "softlight/SL_BoundingBox.hpp"
+#include "softlight/SL_Setup.hpp" // SL_AlignedVector
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward declarations
+-----------------------------------------------------------------------------*/
+class SL_Context;
+class SL_SceneGraph;
+
+
+
+/*-----------------------------------------------------------------------------
+ * BVH Properties
+-----------------------------------------------------------------------------*/
+enum : uint32_t
+{
+    // Number of child boxes stored in, and tested by, each BVH node
+    SL_BVH_LANES = 4,
+
+    // Used by lanes which reference a draw item rather than a child node,
+    // and by the root node's parent
+    SL_BVH_INVALID_NODE = ~0u
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * A single mesh of a mesh node
+-----------------------------------------------------------------------------*/
+struct SL_DrawItem
+{
+    // Index into SL_SceneGraph::mNodes and SL_SceneGraph::mModelMatrices
+    size_t nodeId;
+
+    // Index into SL_SceneGraph::mMeshes and SL_SceneGraph::mMeshBounds
+    size_t meshId;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Each BVH node contains the world-space bounds of SL_BVH_LANES children,
+ * stored as one component per row. Every lane covers a contiguous range of
+ * draw items, in BVH order. Lanes without a child node contain exactly one
+ * draw item. Unused lanes contain no items.
+-----------------------------------------------------------------------------*/
+struct alignas(sizeof(float)*SL_BVH_LANES) SL_BVHNode
+{
+    float mCenterX[SL_BVH_LANES];
+    float mCenterY[SL_BVH_LANES];
+    float mCenterZ[SL_BVH_LANES];
+
+    float mExtentX[SL_BVH_LANES];
+    float mExtentY[SL_BVH_LANES];
+    float mExtentZ[SL_BVH_LANES];
+
+    uint32_t mChildren[SL_BVH_LANES];
+    uint32_t mFirstItem[SL_BVH_LANES];
+    uint32_t mNumItems[SL_BVH_LANES];
+
+    uint32_t mParent;
+};
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Bounding Volume Hierarchy sorts the meshes of a scene graph by
+ * their world-space bounds, allowing large parts of a scene to be culled at
+ * once.
+ *
+ * Parent nodes are always stored before their children. The tree is built
+ * once, then refitted to match the nodes which moved during each call to
+ * SL_SceneGraph::update().
+-----------------------------------------------------------------------------*/
+class SL_BoundingVolumeHierarchy
+{
+  private:
+    // Number of nodes in the scene graph when *this was built
+    size_t mNumSceneNodes;
+
+    SL_AlignedVector<SL_BVHNode> mNodes;
+
+    // All draw items, sorted by node ID
+    SL_AlignedVector<SL_DrawItem> mItems;
+
+    // World-space bounds of each draw item
+    SL_AlignedVector<SL_BoundingBox> mItemBounds;
+
+    // Draw item indices, in BVH order
+    SL_AlignedVector<uint32_t> mItemOrder;
+
+    // BVH node referencing each draw item
+    SL_AlignedVector<uint32_t> mItemLeaves;
+
+    // Scratch data for refitting and culling
+    SL_AlignedVector<uint8_t> mDirtyNodes;
+    SL_AlignedVector<uint32_t> mCullRoots;
+    SL_AlignedVector<SL_AlignedVector<SL_DrawItem>> mThreadItems;
+
+    uint32_t build_node(uint32_t parentId, uint32_t first, uint32_t last) noexcept;
+
+    void update_lane(SL_BVHNode& node, unsigned lane) noexcept;
+
+  public:
+    ~SL_BoundingVolumeHierarchy() noexcept;
+
+    SL_BoundingVolumeHierarchy() noexcept;
+
+    SL_BoundingVolumeHierarchy(const SL_BoundingVolumeHierarchy& bvh) noexcept;
+
+    SL_BoundingVolumeHierarchy(SL_BoundingVolumeHierarchy&& bvh) noexcept;
+
+    SL_BoundingVolumeHierarchy& operator=(const SL_BoundingVolumeHierarchy& bvh) noexcept;
+
+    SL_BoundingVolumeHierarchy& operator=(SL_BoundingVolumeHierarchy&& bvh) noexcept;
+
+    /**
+     * @brief Build a hierarchy from all mesh nodes in a scene graph.
+     *
+     * The scene graph should be updated beforehand so its model matrices are
+     * current. This must be called again after nodes are inserted, deleted,
+     * or reparented.
+     *
+     * @param graph
+     * The scene graph containing the mesh nodes and bounding boxes to sort.
+     *
+     * @return 0 if the hierarchy was built, or -1 if the scene graph contains
+     * no meshes.
+     */
+    int init(const SL_SceneGraph& graph) noexcept;
+
+    /**
+     * @brief Free all nodes from *this.
+     */
+    void terminate() noexcept;
+
+    /**
+     * @brief Update the bounds of all draw items moved by the last call to
+     * SL_SceneGraph::update(), along with their ancestors in the hierarchy.
+     *
+     * The tree structure is kept, so its quality degrades as objects travel
+     * far from where they were when *this was built. The hierarchy is rebuilt
+     * if the number of nodes in the scene graph has changed.
+     *
+     * @param graph
+     * The scene graph used to build *this.
+     */
+    void refit(const SL_SceneGraph& graph) noexcept;
+
+    /**
+     * @brief Gather all draw items which intersect a view frustum.
+     *
+     * Subtrees are traversed in parallel using the context's threads. Within
+     * each node, the boxes of all lanes are tested against every plane at
+     * once.
+     *
+     * @param context
+     * The context whose threads will traverse the hierarchy.
+     *
+     * @param planes
+     * World-space frustum planes, extracted from a view-projection matrix
+     * using sl_extract_frustum_planes().
+     *
+     * @param outDrawList
+     * Replaced with the visible draw items, in BVH order.
+     *
+     * @return The number of visible draw items.
+     */
+    size_t cull(SL_Context& context, const ls::math::vec4 planes[6], SL_AlignedVector<SL_DrawItem>& outDrawList) noexcept;
+
+    bool valid() const noexcept;
+
+    size_t num_nodes() const noexcept;
+
+    size_t num_items() const noexcept;
+
+    const SL_DrawItem& item(size_t itemId) const noexcept;
+
+    const SL_BoundingBox& item_bounds(size_t itemId) const noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Check if *this contains nodes
+-------------------------------------*/
+inline bool SL_BoundingVolumeHierarchy::valid() const noexcept
+{
+    return !mNodes.empty();
+}
+
+
+
+/*-------------------------------------
+ * Get the number of BVH nodes
+-------------------------------------*/
+inline size_t SL_BoundingVolumeHierarchy::num_nodes() const noexcept
+{
+    return mNodes.size();
+}
+
+
+
+/*-------------------------------------
+ * Get the number of draw items
+-------------------------------------*/
+inline size_t SL_BoundingVolumeHierarchy::num_items() const noexcept
+{
+    return mItems.size();
+}
+
+
+
+/*-------------------------------------
+ * Get a draw item, sorted by node ID
+-------------------------------------*/
+inline const SL_DrawItem& SL_BoundingVolumeHierarchy::item(size_t itemId) const noexcept
+{
+    return mItems[itemId];
+}
+
+
+
+/*-------------------------------------
+ * Get the world-space bounds of a draw item
+-------------------------------------*/
+inline const SL_BoundingBox& SL_BoundingVolumeHierarchy::item_bounds(size_t itemId) const noexcept
+{
+    return mItemBounds[itemId];
+}
+
+
+
+#endif /* SL_BOUNDING_VOLUME_HIERARCHY_HPP */
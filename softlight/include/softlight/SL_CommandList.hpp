@@ -0,0 +1,292 @@
+#ifndef SL_COMMAND_LIST_HPP
+#define SL_COMMAND_LIST_HPP
+
+#include <cstdint> // uint16_t, uint32_t
+
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Setup.hpp" // SL_AlignedVector
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward declarations
+-----------------------------------------------------------------------------*/
+struct SL_MeshletCull;
+struct SL_TextureView;
+class SL_UniformBuffer;
+
+namespace ls
+{
+namespace math
+{
+    template <typename T>
+    union vec4_t;
+}
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Types of commands which can be recorded into a command list
+-----------------------------------------------------------------------------*/
+enum SL_CommandType : uint32_t
+{
+    SL_COMMAND_CLEAR_COLOR,
+    SL_COMMAND_CLEAR_DEPTH,
+    SL_COMMAND_CLEAR_FRAMEBUFFER,
+    SL_COMMAND_DRAW,
+    SL_COMMAND_DRAW_MULTIPLE,
+    SL_COMMAND_DRAW_INSTANCED,
+    SL_COMMAND_BLIT_TEXTURE,
+    SL_COMMAND_BLIT_BUFFER,
+    SL_COMMAND_UPDATE_UNIFORMS,
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Command Parameters
+-----------------------------------------------------------------------------*/
+struct SL_DrawCommand
+{
+    SL_Mesh mesh;
+    size_t numInstances;
+    size_t shaderId;
+    size_t fboId;
+
+    // Uniforms to draw with, in place of the shader's uniform buffer. When
+    // null, the shader's uniform buffer is read while the draw executes.
+    // Must remain valid until the command has executed.
+    const SL_UniformBuffer* pUniforms;
+
+    // Optional meshlet culling data for a triangle mesh, ignored for
+    // instanced draws. Must remain valid until the command has executed.
+    const SL_MeshletCull* pCull;
+};
+
+struct SL_DrawMultipleCommand
+{
+    // Must remain valid until the command has executed
+    const SL_Mesh* pMeshes;
+    size_t numMeshes;
+    size_t shaderId;
+    size_t fboId;
+
+    // Optional meshlet culling data for each mesh. The array or any of its
+    // elements may be null.
+    const SL_MeshletCull* const* pCulls;
+};
+
+struct SL_ClearCommand
+{
+    size_t fboId;
+    unsigned attachmentId;
+    double color[4];
+    double depth;
+};
+
+struct SL_BlitCommand
+{
+    size_t outTextureId;
+    size_t inTextureId;
+
+    // Must remain valid until the command has executed
+    SL_TextureView* pOutBuffer;
+
+    // Blit the entire input onto the entire output, ignoring the coordinates
+    // below.
+    bool fullRegion;
+
+    uint16_t srcX0;
+    uint16_t srcY0;
+    uint16_t srcX1;
+    uint16_t srcY1;
+    uint16_t dstX0;
+    uint16_t dstY0;
+    uint16_t dstX1;
+    uint16_t dstY1;
+};
+
+
+
+struct SL_UniformCommand
+{
+    size_t uboId;
+
+    // Location of the recorded bytes within the command list
+    size_t dataOffset;
+
+    // Destination range within the uniform buffer
+    uint32_t offset;
+    uint32_t numBytes;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Tagged union of all command parameters
+-----------------------------------------------------------------------------*/
+struct SL_Command
+{
+    SL_CommandType type;
+
+    union
+    {
+        SL_DrawCommand draw;
+        SL_DrawMultipleCommand drawMultiple;
+        SL_ClearCommand clear;
+        SL_BlitCommand blit;
+        SL_UniformCommand uniforms;
+    };
+};
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief A Command List records clear, draw, and blit operations so they can
+ * be executed by an SL_Context at a later time.
+ *
+ * Command lists only store the IDs of context resources. All resources (and
+ * any mesh arrays or texture views passed in by pointer) must remain valid
+ * and unmodified until the list has been executed.
+ *
+ * Uniform data is copied into the list when recorded. Each draw reads the
+ * uniforms recorded before it, even when batched with later draws.
+-----------------------------------------------------------------------------*/
+class SL_CommandList
+{
+  private:
+    SL_AlignedVector<SL_Command> mCommands;
+
+    SL_AlignedVector<unsigned char> mUniformData;
+
+  public:
+    ~SL_CommandList() noexcept = default;
+
+    SL_CommandList() noexcept;
+
+    SL_CommandList(const SL_CommandList& c) noexcept;
+
+    SL_CommandList(SL_CommandList&& c) noexcept;
+
+    SL_CommandList& operator=(const SL_CommandList& c) noexcept;
+
+    SL_CommandList& operator=(SL_CommandList&& c) noexcept;
+
+    const SL_AlignedVector<SL_Command>& commands() const noexcept;
+
+    const unsigned char* uniform_data(const SL_UniformCommand& cmd) const noexcept;
+
+    std::size_t size() const noexcept;
+
+    bool empty() const noexcept;
+
+    void reserve(std::size_t numCommands) noexcept;
+
+    void clear() noexcept;
+
+    /*
+     * Draw Commands
+     */
+    void draw(const SL_Mesh& m, size_t shaderId, size_t fboId) noexcept;
+
+    void draw_multiple(const SL_Mesh* meshes, size_t numMeshes, size_t shaderId, size_t fboId) noexcept;
+
+    void draw_instanced(const SL_Mesh& m, size_t numInstances, size_t shaderId, size_t fboId) noexcept;
+
+    void draw_clustered(const SL_Mesh& m, const SL_MeshletCull& cull, size_t shaderId, size_t fboId) noexcept;
+
+    void draw_clustered(const SL_Mesh* meshes, const SL_MeshletCull* const* culls, size_t numMeshes, size_t shaderId, size_t fboId) noexcept;
+
+    /*
+     * Uniform Commands
+     *
+     * Copy "numBytes" from "pData" into a uniform buffer, starting at
+     * "offset" bytes. The data is copied into *this immediately.
+     */
+    void update_uniforms(size_t uboId, const void* pData, size_t offset, size_t numBytes) noexcept;
+
+    /*
+     * Blit Commands
+     */
+    void blit(size_t outTextureId, size_t inTextureId) noexcept;
+
+    void blit(
+        size_t outTextureId,
+        size_t inTextureId,
+        uint16_t srcX0,
+        uint16_t srcY0,
+        uint16_t srcX1,
+        uint16_t srcY1,
+        uint16_t dstX0,
+        uint16_t dstY0,
+        uint16_t dstX1,
+        uint16_t dstY1) noexcept;
+
+    void blit(SL_TextureView& buffer, size_t textureId) noexcept;
+
+    void blit(
+        SL_TextureView& buffer,
+        size_t textureId,
+        uint16_t srcX0,
+        uint16_t srcY0,
+        uint16_t srcX1,
+        uint16_t srcY1,
+        uint16_t dstX0,
+        uint16_t dstY0,
+        uint16_t dstX1,
+        uint16_t dstY1) noexcept;
+
+    /*
+     * Clear Commands
+     */
+    void clear_color_buffer(size_t fboId, unsigned attachmentId, const ls::math::vec4_t<double>& color) noexcept;
+
+    void clear_depth_buffer(size_t fboId, double depth) noexcept;
+
+    void clear_framebuffer(size_t fboId, unsigned attachmentId, const ls::math::vec4_t<double>& color, double depth) noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Retrieve all recorded commands
+-------------------------------------*/
+inline const SL_AlignedVector<SL_Command>& SL_CommandList::commands() const noexcept
+{
+    return mCommands;
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the bytes recorded by a uniform update
+-------------------------------------*/
+inline const unsigned char* SL_CommandList::uniform_data(const SL_UniformCommand& cmd) const noexcept
+{
+    return mUniformData.data() + cmd.dataOffset;
+}
+
+
+
+/*-------------------------------------
+ * Number of recorded commands
+-------------------------------------*/
+inline std::size_t SL_CommandList::size() const noexcept
+{
+    return mCommands.size();
+}
+
+
+
+/*-------------------------------------
+ * Check if any commands have been recorded
+-------------------------------------*/
+inline bool SL_CommandList::empty() const noexcept
+{
+    return mCommands.empty();
+}
+
+
+
+#endif /* SL_COMMAND_LIST_HPP */
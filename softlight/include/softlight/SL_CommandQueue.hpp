@@ -0,0 +1,94 @@
+#ifndef SL_COMMAND_QUEUE_HPP
+#define SL_COMMAND_QUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint> // uint64_t
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "softlight/SL_CommandList.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward declarations
+-----------------------------------------------------------------------------*/
+class SL_Context;
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Command Queue executes submitted command lists on a dedicated
+ * submission thread.
+ *
+ * The submission thread drives the context's processor pool, taking the place
+ * of the main thread while rendering. This allows the thread which submitted
+ * a command list to continue working until it needs the results.
+ *
+ * Each submission returns a fence value. Fences complete in the order they
+ * were submitted.
+-----------------------------------------------------------------------------*/
+class SL_CommandQueue
+{
+  private:
+    SL_Context* mContext;
+
+    mutable std::mutex mLock;
+
+    // Signaled when a command list is submitted or the queue shuts down
+    std::condition_variable mSubmitCond;
+
+    // Signaled after each command list completes
+    mutable std::condition_variable mCompleteCond;
+
+    std::deque<SL_CommandList> mPending;
+
+    uint64_t mSubmitted;
+
+    std::atomic_uint_fast64_t mCompleted;
+
+    bool mRunning;
+
+    std::thread mThread;
+
+    void run() noexcept;
+
+  public:
+    ~SL_CommandQueue() noexcept;
+
+    SL_CommandQueue(SL_Context& context) noexcept;
+
+    SL_CommandQueue(const SL_CommandQueue&) = delete;
+
+    SL_CommandQueue(SL_CommandQueue&&) = delete;
+
+    SL_CommandQueue& operator=(const SL_CommandQueue&) = delete;
+
+    SL_CommandQueue& operator=(SL_CommandQueue&&) = delete;
+
+    uint64_t submit(SL_CommandList&& cmds) noexcept;
+
+    uint64_t last_submitted() const noexcept;
+
+    bool is_complete(uint64_t fence) const noexcept;
+
+    void wait(uint64_t fence) const noexcept;
+
+    void finish() const noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Check if a fence has been reached
+-------------------------------------*/
+inline bool SL_CommandQueue::is_complete(uint64_t fence) const noexcept
+{
+    return mCompleted.load(std::memory_order_acquire) >= fence;
+}
+
+
+
+#endif /* SL_COMMAND_QUEUE_HPP */
@@ -15,6 +15,25 @@
     #define SL_VERTEX_CACHE_SIZE 8
 #endif /* SL_VERTEX_CACHE_SIZE */
 
+// Shade each unique index of an indexed triangle chunk once, then assemble
+// triangles from the shaded vertices. Takes priority over
+// SL_VERTEX_CACHING_ENABLED for indexed triangle meshes.
+#ifndef SL_VERTEX_BATCHING_ENABLED
+    #define SL_VERTEX_BATCHING_ENABLED 1
+#endif /* SL_VERTEX_BATCHING_ENABLED */
+
+// Size of the FIFO vertex cache targeted (and measured) by the offline mesh
+// optimizer.
+#ifndef SL_MESH_OPTIMIZER_CACHE_SIZE
+    #define SL_MESH_OPTIMIZER_CACHE_SIZE 16
+#endif /* SL_MESH_OPTIMIZER_CACHE_SIZE */
+
+// Number of primitives each thread claims at a time from a mesh. Threads
+// which cull or clip most of their primitives simply claim more chunks.
+#ifndef SL_VERTEX_CHUNK_SIZE
+    #define SL_VERTEX_CHUNK_SIZE 64
+#endif /* SL_VERTEX_CHUNK_SIZE */
+
 
 
 /*-----------------------------------------------------------------------------
@@ -28,5 +47,82 @@
     #define SL_CONSERVE_MEMORY 0
 #endif /* SL_CONSERVE_MEMORY */
 
+// Track how long each rendering thread spends working versus waiting on other
+// threads. Results are available through SL_ProcessorPool::thread_stats().
+#ifndef SL_PROFILE_THREAD_BALANCE
+    #define SL_PROFILE_THREAD_BALANCE 0
+#endif /* SL_PROFILE_THREAD_BALANCE */
+
+
+
+/*-----------------------------------------------------------------------------
+ * Fragment Processing Configuration
+-----------------------------------------------------------------------------*/
+// Bin triangles into screen-space tiles so each rasterization thread only
+// visits primitives which overlap the tiles it has claimed.
+#ifndef SL_TILED_BINNING_ENABLED
+    #define SL_TILED_BINNING_ENABLED 0
+#endif /* SL_TILED_BINNING_ENABLED */
+
+// Width & height, in pixels, of a binning tile. Must be a power of 2.
+#ifndef SL_BIN_TILE_SIZE
+    #define SL_BIN_TILE_SIZE 64
+#endif /* SL_BIN_TILE_SIZE */
+
+// Maintain coarse min/max depth bounds for each framebuffer so occluded
+// triangles can be rejected before rasterizing individual pixels.
+#ifndef SL_HIZ_ENABLED
+    #define SL_HIZ_ENABLED 1
+#endif /* SL_HIZ_ENABLED */
+
+// Width & height, in pixels, of a coarse depth tile. Must be a power of 2 and
+// evenly divide SL_BIN_TILE_SIZE.
+#ifndef SL_HIZ_TILE_SIZE
+    #define SL_HIZ_TILE_SIZE 16
+#endif /* SL_HIZ_TILE_SIZE */
+
+// Number of fragments passed to a wide fragment shader in a single call.
+// Must be either 4 or 8.
+#ifndef SL_FRAG_BLOCK_SIZE
+    #define SL_FRAG_BLOCK_SIZE 8
+#endif /* SL_FRAG_BLOCK_SIZE */
+
+// Store framebuffer attachments as 4x4 tiles of texels, the same layout used
+// by SL_TexelOrder::SWIZZLED textures, rather than as rows. Attachment
+// dimensions must be a multiple of 4. Framebuffers are only de-tiled when
+// blitted to a window.
+#ifndef SL_FBO_TILED_ENABLED
+    #define SL_FBO_TILED_ENABLED 0
+#endif /* SL_FBO_TILED_ENABLED */
+
+// Largest width & height, in pixels, of a rendered point.
+#ifndef SL_MAX_POINT_SIZE
+    #define SL_MAX_POINT_SIZE 64
+#endif /* SL_MAX_POINT_SIZE */
+
+// Largest width, in pixels, of a rendered line.
+#ifndef SL_MAX_LINE_WIDTH
+    #define SL_MAX_LINE_WIDTH 64
+#endif /* SL_MAX_LINE_WIDTH */
+
+// Compile 16-wide AVX-512 rasterization kernels. These are only used when the
+// CPU supports AVX-512 at runtime.
+#ifndef SL_AVX512_ENABLED
+    #define SL_AVX512_ENABLED 1
+#endif /* SL_AVX512_ENABLED */
+
+// Compile x86 kernels for instruction sets newer than the build targets and
+// select between them at runtime. When disabled, only the kernels enabled by
+// the compiler's flags are available.
+#ifndef SL_CPU_DISPATCH_ENABLED
+    #define SL_CPU_DISPATCH_ENABLED 1
+#endif /* SL_CPU_DISPATCH_ENABLED */
+
+// Number of keyframes stored per second of animation when animations are
+// packed into an SL_AnimationClip.
+#ifndef SL_ANIM_CLIP_SAMPLE_RATE
+    #define SL_ANIM_CLIP_SAMPLE_RATE 30
+#endif /* SL_ANIM_CLIP_SAMPLE_RATE */
+
 
 #endif /* SL_CONFIG_HPP */
@@ -12,6 +12,7 @@
 #include "softlight/SL_PipelineState.hpp"
 #include "softlight/SL_ProcessorPool.hpp"
 #include "softlight/SL_Setup.hpp"
+#include "softlight/SL_Swizzle.hpp" // SL_TexelOrder
 #include "softlight/SL_ViewportState.hpp"
 
 
@@ -19,12 +20,19 @@
 /*-----------------------------------------------------------------------------
  * Forward declarations
 -----------------------------------------------------------------------------*/
+enum SL_ColorDataType : uint8_t;
+class SL_CommandList;
+class SL_CommandQueue;
+struct SL_DrawCommand;
 class SL_Framebuffer;
 struct SL_FragmentShader;
+class SL_ImgFile;
 class SL_IndexBuffer;
 struct SL_Mesh;
+struct SL_MeshletCull;
 struct SL_Shader;
 class SL_Texture;
+struct SL_ThreadStats;
 struct SL_TextureView;
 class SL_UniformBuffer;
 class SL_VertexArray;
@@ -63,6 +71,10 @@ class SL_Context
     friend class SL_ProcessorPool;
 
   private:
+    // Declared first so any in-flight commands of a copied or moved context
+    // can complete before its resources are transferred.
+    std::unique_ptr<SL_CommandQueue> mCommandQueue;
+
     SL_AlignedVector<SL_VertexArray> mVaos;
 
     SL_AlignedVector<SL_Texture*> mTextures;
@@ -224,6 +236,31 @@ class SL_Context
      */
     void draw_instanced(const SL_Mesh& meshes, size_t numInstances, size_t shaderId, size_t fboId) noexcept;
 
+    /*
+     * Draw a triangle mesh, skipping any meshlets which are outside the view
+     * frustum or facing away from the viewer. Meshlets must have been built
+     * from the same mesh using sl_build_meshlets().
+     */
+    void draw_clustered(const SL_Mesh& m, const SL_MeshletCull& cull, size_t shaderId, size_t fboId) noexcept;
+
+    /*
+     * Draw several triangle meshes with meshlet culling, the same as
+     * draw_multiple(). "culls" contains one entry per mesh, any of which may
+     * be NULL to draw that mesh without culling. Batched & recorded draws
+     * carry their culling data in SL_DrawCommand::pCull.
+     */
+    void draw_clustered(const SL_Mesh* meshes, const SL_MeshletCull* const* culls, size_t numMeshes, size_t shaderId, size_t fboId) noexcept;
+
+    /*
+     * Draw a sequence of meshes in order. Vertex processing of each draw may
+     * overlap with fragment processing of the draw before it. Consecutive
+     * draws which share a shader, framebuffer, & uniforms are merged.
+     *
+     * Draws without their own uniforms (SL_DrawCommand::pUniforms) all read
+     * the current contents of their shader's uniform buffer.
+     */
+    void draw_batch(const SL_DrawCommand* draws, size_t numDraws) noexcept;
+
     /*
      *
      */
@@ -294,6 +331,73 @@ class SL_Context
      */
     void clear_framebuffer(size_t fboId, const std::array<unsigned, 4>& bufferIndices, const std::array<ls::math::vec4_t<double>, 4>& colors, double depth) noexcept;
 
+    /*
+     * Allocate a full mip chain for a 2D texture and fill each level from the
+     * one above it using a box filter. The texel order must match the order
+     * used when the base level was written. Packed color types are not
+     * supported.
+     *
+     * Returns 0 on success, or a negative value on error.
+     */
+    int generate_mipmaps(size_t textureId, SL_TexelOrder order = SL_TexelOrder::ORDERED) noexcept;
+
+    /*
+     * Reallocate a texture to match an image file, then copy the image into
+     * it using all threads. Texels can be swizzled and converted to another
+     * color type along the way. Conversions may only add or remove channels
+     * of the same component type. New channels are set to 0, except for
+     * alpha which is fully opaque.
+     *
+     * Returns 0 on success, or a negative value on error.
+     */
+    int upload_texture(size_t textureId, const SL_ImgFile& imgFile, SL_ColorDataType type, SL_TexelOrder order = SL_TexelOrder::ORDERED) noexcept;
+
+    int upload_texture(size_t textureId, const SL_ImgFile& imgFile, SL_TexelOrder order = SL_TexelOrder::ORDERED) noexcept;
+
+    /*
+     * Execute all commands in a command list on the calling thread.
+     *
+     * Recorded uniform updates are copied into the context's uniform buffers
+     * once all commands have executed.
+     */
+    void execute(const SL_CommandList& cmds) noexcept;
+
+    /*
+     * Submit a command list for asynchronous execution. The returned fence
+     * can be used to wait for the commands to complete.
+     *
+     * Resources referenced by a submitted command list must not be modified
+     * (including uniform data) until its fence has completed. Creating or
+     * destroying resources will wait for all submitted commands to finish.
+     * Immediate-mode drawing, clearing, and blitting must not be used while
+     * commands are in flight.
+     */
+    uint64_t submit(const SL_CommandList& cmds) noexcept;
+
+    uint64_t submit(SL_CommandList&& cmds) noexcept;
+
+    /*
+     * Check if a submitted command list has completed.
+     */
+    bool is_complete(uint64_t fence) const noexcept;
+
+    /*
+     * Block until a submitted command list has completed.
+     */
+    void wait(uint64_t fence) const noexcept;
+
+    /*
+     * Block until all submitted command lists have completed.
+     */
+    void finish() const noexcept;
+
+    /*
+     * Run a function once on every thread of the processor pool, then wait
+     * for all threads to finish. Submitted command lists are completed
+     * first.
+     */
+    void run_tasks(SL_TaskFunc task, void* pUserData) noexcept;
+
     /*
      *
      */
@@ -303,6 +407,14 @@ class SL_Context
      *
      */
     unsigned num_threads(unsigned inNumThreads) noexcept;
+
+    /*
+     * Per-thread busy/idle statistics, one entry per thread. Only updated
+     * when SL_PROFILE_THREAD_BALANCE is enabled.
+     */
+    const SL_ThreadStats* thread_stats() const noexcept;
+
+    void reset_thread_stats() noexcept;
 };
 
 
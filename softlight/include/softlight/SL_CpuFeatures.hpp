@@ -0,0 +1,137 @@
+#ifndef SL_CPU_FEATURES_HPP
+#define SL_CPU_FEATURES_HPP
+
+#include <cstdint>
+
+#include "lightsky/setup/Arch.h"
+#include "lightsky/setup/Compiler.h"
+
+#include "softlight/SL_Config.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Function attributes for kernels which are compiled for a newer instruction
+ * set than the rest of the library. Callers must check sl_cpu_features()
+ * before invoking them.
+-----------------------------------------------------------------------------*/
+#if defined(LS_ARCH_X86)
+    #include <immintrin.h>
+#endif
+
+#if defined(LS_ARCH_X86) && !defined(LS_COMPILER_MSC)
+    #define SL_TARGET_SSE41  __attribute__((target("sse4.1,popcnt")))
+    #define SL_TARGET_AVX2   __attribute__((target("avx2,fma,f16c,popcnt")))
+    #define SL_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma,f16c,popcnt")))
+#else
+    #define SL_TARGET_SSE41
+    #define SL_TARGET_AVX2
+    #define SL_TARGET_AVX512
+#endif
+
+
+
+/*-----------------------------------------------------------------------------
+ * Kernels available in this build. Kernels for instruction sets the build
+ * already targets are always compiled. Newer ones are only compiled when
+ * runtime dispatch is enabled.
+-----------------------------------------------------------------------------*/
+#if SL_CPU_DISPATCH_ENABLED && defined(LS_ARCH_X86)
+    #define SL_CPU_DISPATCH_X86 1
+#else
+    #define SL_CPU_DISPATCH_X86 0
+#endif
+
+// Kernels which only exist to be selected at runtime
+#if SL_CPU_DISPATCH_X86 && !defined(LS_X86_SSE4_1)
+    #define SL_SSE41_DISPATCH_ENABLED 1
+#else
+    #define SL_SSE41_DISPATCH_ENABLED 0
+#endif
+
+#if SL_CPU_DISPATCH_X86 && !defined(LS_X86_AVX2)
+    #define SL_AVX2_DISPATCH_ENABLED 1
+#else
+    #define SL_AVX2_DISPATCH_ENABLED 0
+#endif
+
+// Kernels which are compiled for either the build's targets or for dispatch
+#if SL_CPU_DISPATCH_X86 || defined(LS_X86_SSE4_1)
+    #define SL_SSE41_KERNELS_ENABLED 1
+#else
+    #define SL_SSE41_KERNELS_ENABLED 0
+#endif
+
+#if SL_CPU_DISPATCH_X86 || defined(LS_X86_AVX2)
+    #define SL_AVX2_KERNELS_ENABLED 1
+#else
+    #define SL_AVX2_KERNELS_ENABLED 0
+#endif
+
+#if SL_AVX2_KERNELS_ENABLED && SL_AVX512_ENABLED
+    #define SL_AVX512_KERNELS_ENABLED 1
+#else
+    #define SL_AVX512_KERNELS_ENABLED 0
+#endif
+
+
+
+/*-----------------------------------------------------------------------------
+ * Instruction set extensions which can be selected at runtime
+-----------------------------------------------------------------------------*/
+enum SL_CpuFeatureFlags : uint32_t
+{
+    SL_CPU_FEATURE_NONE   = 0x00000000,
+
+    SL_CPU_FEATURE_SSE2   = 0x00000001,
+    SL_CPU_FEATURE_SSE4_1 = 0x00000002,
+
+    // AVX2, FMA3, and F16C
+    SL_CPU_FEATURE_AVX2   = 0x00000004,
+
+    // AVX-512 F, BW, DQ, and VL
+    SL_CPU_FEATURE_AVX512 = 0x00000008,
+
+    SL_CPU_FEATURE_ALL    = 0x0000000F
+};
+
+
+
+/*-------------------------------------
+ * Query the current CPU & operating system for supported features
+-------------------------------------*/
+uint32_t sl_cpu_detect_features() noexcept;
+
+
+
+/*-------------------------------------
+ * Detect CPU features and apply any override from the environment variable
+ * "SL_CPU_FEATURES". Only the first call has any effect; SL_Context calls
+ * this on construction.
+ *
+ * The variable names the newest instruction set which may be used:
+ * "none", "sse2", "sse4.1", "avx2", or "avx512". Unknown values are ignored.
+-------------------------------------*/
+uint32_t sl_cpu_init_features() noexcept;
+
+
+
+/*-------------------------------------
+ * Retrieve the set of features which rendering kernels may use. This is the
+ * detected feature set unless it has been restricted through
+ * sl_cpu_set_features().
+-------------------------------------*/
+uint32_t sl_cpu_features() noexcept;
+
+
+
+/*-------------------------------------
+ * Restrict the features available to rendering kernels (i.e. for
+ * benchmarking or testing fallback paths). Features which the CPU does not
+ * support are ignored. Returns the resulting feature set.
+-------------------------------------*/
+uint32_t sl_cpu_set_features(uint32_t features) noexcept;
+
+
+
+#endif /* SL_CPU_FEATURES_HPP */
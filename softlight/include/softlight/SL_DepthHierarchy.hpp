@@ -0,0 +1,210 @@
+#ifndef SL_DEPTH_HIERARCHY_HPP
+#define SL_DEPTH_HIERARCHY_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "lightsky/utils/Pointer.h" // UniqueAlignedArray
+
+#include "softlight/SL_Config.hpp"
+#include "softlight/SL_PipelineState.hpp" // SL_DepthTest
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward Declarations
+-----------------------------------------------------------------------------*/
+namespace ls
+{
+namespace math
+{
+struct half;
+}
+}
+
+struct SL_TextureView;
+
+
+
+static_assert((SL_HIZ_TILE_SIZE & (SL_HIZ_TILE_SIZE-1)) == 0, "SL_HIZ_TILE_SIZE must be a power of 2.");
+static_assert((SL_BIN_TILE_SIZE % SL_HIZ_TILE_SIZE) == 0, "SL_HIZ_TILE_SIZE must evenly divide SL_BIN_TILE_SIZE.");
+
+
+
+/*-----------------------------------------------------------------------------
+ * Minimum & maximum depth values within a region of a depth buffer
+-----------------------------------------------------------------------------*/
+struct SL_DepthBounds
+{
+    float minDepth;
+    float maxDepth;
+};
+
+
+
+/*-------------------------------------
+ * Determine if a depth test can reject fragments using only the range of
+ * depth values in a region.
+-------------------------------------*/
+constexpr bool sl_depth_test_is_ordered(SL_DepthTest depthTest) noexcept
+{
+    return depthTest >= SL_DEPTH_TEST_LESS_THAN && depthTest <= SL_DEPTH_TEST_GREATER_EQUAL;
+}
+
+
+
+/*-------------------------------------
+ * Determine if every fragment with a depth in the range [zMin, zMax] would
+ * fail a depth test against a region of the depth buffer. Only the ordered
+ * depth tests can be answered conservatively.
+-------------------------------------*/
+constexpr bool sl_depth_bounds_occluded(SL_DepthTest depthTest, float zMin, float zMax, const SL_DepthBounds& bounds) noexcept
+{
+    return (depthTest == SL_DEPTH_TEST_LESS_THAN)     ? (zMin >= bounds.maxDepth)
+        :  (depthTest == SL_DEPTH_TEST_LESS_EQUAL)    ? (zMin >  bounds.maxDepth)
+        :  (depthTest == SL_DEPTH_TEST_GREATER_THAN)  ? (zMax <= bounds.minDepth)
+        :  (depthTest == SL_DEPTH_TEST_GREATER_EQUAL) ? (zMax <  bounds.minDepth)
+        :  false;
+}
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief Coarse min/max depth structure maintained alongside a framebuffer's
+ * depth attachment.
+ *
+ * The hierarchy contains two levels:
+ *
+ * "Spans" cover SL_HIZ_TILE_SIZE pixels of a single row. Spans are only
+ * read & written by the thread which owns their row during rasterization,
+ * so they can be tested per-scanline without synchronization. Depth writes
+ * mark a span as dirty. Dirty spans are never used for culling and are
+ * recalculated by their owning thread once it finishes a rasterization pass.
+ *
+ * "Tiles" cover SL_HIZ_TILE_SIZE x SL_HIZ_TILE_SIZE pixels and are tested
+ * when a primitive is binned. Tiles are rebuilt from their spans at the start
+ * of a draw, before any thread can rasterize. A tile is only trusted while
+ * its dirty flag is clear.
+-----------------------------------------------------------------------------*/
+class SL_DepthHierarchy
+{
+  private:
+    uint16_t mWidth;
+
+    uint16_t mHeight;
+
+    uint16_t mSpansX;
+
+    uint16_t mTilesX;
+
+    uint16_t mTilesY;
+
+    ls::utils::UniqueAlignedArray<SL_DepthBounds> mSpans;
+
+    ls::utils::UniqueAlignedArray<uint8_t> mSpanDirty;
+
+    ls::utils::UniqueAlignedArray<SL_DepthBounds> mTiles;
+
+    ls::utils::UniqueAlignedArray<std::atomic_uint_fast8_t> mTileDirty;
+
+  public:
+    ~SL_DepthHierarchy() noexcept;
+
+    SL_DepthHierarchy() noexcept;
+
+    SL_DepthHierarchy(const SL_DepthHierarchy& h) noexcept;
+
+    SL_DepthHierarchy(SL_DepthHierarchy&& h) noexcept;
+
+    SL_DepthHierarchy& operator=(const SL_DepthHierarchy& h) noexcept;
+
+    SL_DepthHierarchy& operator=(SL_DepthHierarchy&& h) noexcept;
+
+    int init(uint16_t width, uint16_t height) noexcept;
+
+    void terminate() noexcept;
+
+    bool valid() const noexcept;
+
+    void clear(float depth) noexcept;
+
+    void invalidate() noexcept;
+
+    void mark_dirty(uint16_t x, uint16_t y) noexcept;
+
+    bool is_span_occluded(SL_DepthTest depthTest, int32_t y, int32_t x0, int32_t x1, float zMin, float zMax) const noexcept;
+
+    bool is_rect_occluded(SL_DepthTest depthTest, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float zMin, float zMax) const noexcept;
+
+    template <typename depth_type>
+    void update_spans(const SL_TextureView& depthBuf, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t yStep) noexcept;
+
+    void update_tiles(uint16_t threadId, uint16_t numThreads) noexcept;
+};
+
+
+
+extern template void SL_DepthHierarchy::update_spans<ls::math::half>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+extern template void SL_DepthHierarchy::update_spans<float>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+extern template void SL_DepthHierarchy::update_spans<double>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+
+
+
+/*-------------------------------------
+ * Check if the hierarchy can be used
+-------------------------------------*/
+inline bool SL_DepthHierarchy::valid() const noexcept
+{
+    return mSpans != nullptr;
+}
+
+
+
+/*-------------------------------------
+ * Flag the span & tile containing a pixel as modified. Only the thread which
+ * owns the pixel's row may call this.
+-------------------------------------*/
+inline void SL_DepthHierarchy::mark_dirty(uint16_t x, uint16_t y) noexcept
+{
+    const uint32_t spanX  = (uint32_t)x / SL_HIZ_TILE_SIZE;
+    const uint32_t spanId = (uint32_t)y * mSpansX + spanX;
+
+    if (!mSpanDirty[spanId])
+    {
+        mSpanDirty[spanId] = 1;
+        mTileDirty[((uint32_t)y / SL_HIZ_TILE_SIZE) * mTilesX + spanX].store(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Test the pixels [x0, x1) of a single row. Only the thread which owns the
+ * row may call this.
+-------------------------------------*/
+inline bool SL_DepthHierarchy::is_span_occluded(SL_DepthTest depthTest, int32_t y, int32_t x0, int32_t x1, float zMin, float zMax) const noexcept
+{
+    if ((uint32_t)y >= mHeight || x0 < 0 || x0 >= x1 || x1 > (int32_t)mWidth)
+    {
+        return false;
+    }
+
+    const uint32_t        rowOffset = (uint32_t)y * mSpansX;
+    const SL_DepthBounds* pSpans    = mSpans.get() + rowOffset;
+    const uint8_t*        pDirty    = mSpanDirty.get() + rowOffset;
+    const uint32_t        spanEnd   = (uint32_t)(x1 - 1) / SL_HIZ_TILE_SIZE;
+
+    for (uint32_t s = (uint32_t)x0 / SL_HIZ_TILE_SIZE; s <= spanEnd; ++s)
+    {
+        if (pDirty[s] || !sl_depth_bounds_occluded(depthTest, zMin, zMax, pSpans[s]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+#endif /* SL_DEPTH_HIERARCHY_HPP */
@@ -4,6 +4,7 @@
 
 #include "lightsky/math/vec4.h"
 
+#include "softlight/SL_Framebuffer.hpp" // SL_PixelWriter
 #include "softlight/SL_Mesh.hpp" // SL_RenderMode
 
 
@@ -22,6 +23,7 @@ namespace ls
 template <typename data_t>
 union SL_BinCounter;
 
+struct SL_BinTileMap; // SL_ShaderUtil.hpp
 struct SL_FragCoord; // SL_ShaderProcessor.hpp
 struct SL_FragmentBin; // SL_ShaderProcessor.hpp
 class SL_Framebuffer;
@@ -50,6 +52,11 @@ struct SL_FragmentProcessor
     SL_BinCounter<uint32_t>* mBinIds;
     const SL_FragmentBin* mBins;
     SL_FragCoord* mQueues;
+    SL_BinTileMap* mBinTiles;
+
+    // Resolved once per draw from the shader's blend mode and the
+    // framebuffer's color formats.
+    SL_PixelWriter mPixelWriter;
 
     virtual ~SL_FragmentProcessor() noexcept {}
 
@@ -9,6 +9,8 @@
 #include "lightsky/utils/Assertions.h"
 #include "lightsky/utils/Copy.h" // utils::fast_memset, fast_fill
 
+#include "softlight/SL_Config.hpp" // SL_FRAG_BLOCK_SIZE
+#include "softlight/SL_DepthHierarchy.hpp"
 #include "softlight/SL_Texture.hpp"
 
 
@@ -65,6 +67,103 @@ constexpr SL_FboOutputMask sl_calc_fbo_out_mask(unsigned numOutputs, bool blendE
 
 
 
+/*-----------------------------------------------------------------------------
+ * Framebuffer Memory Layout
+ *
+ * Rasterizers walk each scanline in runs of 4 texels. In a tiled layout, a
+ * run must start on a multiple of 4 so it stays within a single row of one
+ * tile.
+-----------------------------------------------------------------------------*/
+constexpr SL_TexelOrder SL_FBO_TEXEL_ORDER = SL_FBO_TILED_ENABLED ? SL_TexelOrder::SWIZZLED : SL_TexelOrder::ORDERED;
+
+static_assert(!SL_FBO_TILED_ENABLED || SL_TEXELS_PER_CHUNK == 4, "Tiled framebuffers require 4-texel runs to fill a row of a tile.");
+
+enum SL_FboSpanInfo : int32_t
+{
+    SL_FBO_SPAN_TEXELS = 4,
+
+    // Offset between consecutive runs of a scanline
+    SL_FBO_SPAN_STEP = SL_FBO_TILED_ENABLED ? (SL_TEXELS_PER_CHUNK * SL_TEXELS_PER_CHUNK) : SL_FBO_SPAN_TEXELS
+};
+
+
+
+/*-------------------------------------
+ * Index of a texel within a framebuffer attachment
+-------------------------------------*/
+inline LS_INLINE ptrdiff_t sl_fbo_index(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y) noexcept
+{
+    return sl_texture_view_index<SL_FBO_TEXEL_ORDER>(view, x, y);
+}
+
+
+
+/*-------------------------------------
+ * Offset from texel (x-1, y) to texel (x, y)
+-------------------------------------*/
+constexpr ptrdiff_t sl_fbo_step_x(int32_t x) noexcept
+{
+    return (SL_FBO_TILED_ENABLED && !(x & (SL_TEXELS_PER_CHUNK-1))) ? (ptrdiff_t)(SL_TEXELS_PER_CHUNK*SL_TEXELS_PER_CHUNK - (SL_TEXELS_PER_CHUNK-1)) : (ptrdiff_t)1;
+}
+
+
+
+/*-------------------------------------
+ * First x-coordinate of the 4-texel run which contains "x"
+-------------------------------------*/
+constexpr int32_t sl_fbo_span_begin(int32_t x) noexcept
+{
+    return SL_FBO_TILED_ENABLED ? (x & ~(int32_t)(SL_FBO_SPAN_TEXELS-1)) : x;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Specialized Pixel Writers
+ *
+ * Writing through SL_Framebuffer::put_pixel() selects a color format and
+ * blend mode for every fragment. A pixel writer makes those decisions once
+ * per draw so fragment processors can call a single function which has been
+ * specialized for each attachment's format and the shader's blend mode.
+-----------------------------------------------------------------------------*/
+struct SL_PixelWriter;
+
+typedef void (*SL_AttachmentWriterFunc)(SL_TextureView&, uint16_t, uint16_t, const ls::math::vec4_t<float>&);
+
+typedef void (*SL_PixelWriterFunc)(const SL_PixelWriter&, const SL_FragmentParam&);
+
+typedef void (*SL_BlockWriterFunc)(
+    const SL_PixelWriter&,
+    const uint16_t* pX,
+    const uint16_t* pY,
+    const float (*pRgba)[SL_FRAG_BLOCK_SIZE],
+    uint32_t outMask);
+
+struct SL_PixelWriter
+{
+    // Writes all outputs of a fragment
+    SL_PixelWriterFunc pWrite;
+
+    // Blends & writes up to SL_FRAG_BLOCK_SIZE fragments to the first
+    // attachment. Colors are stored as arrays of R, G, B, and A. Only
+    // fragments with their bit set in the output mask are written, and no
+    // two fragments in a block may share a pixel. Only available for single
+    // RGBA8 attachments and NULL otherwise.
+    SL_BlockWriterFunc pWriteBlock;
+
+    SL_AttachmentWriterFunc pWriters[SL_FBO_MAX_COLOR_ATTACHMENTS];
+    SL_TextureView* pTargets[SL_FBO_MAX_COLOR_ATTACHMENTS];
+};
+
+
+
+inline void sl_write_pixel(const SL_PixelWriter& writer, const SL_FragmentParam& fragParam) noexcept
+{
+    writer.pWrite(writer, fragParam);
+}
+
+
+
 /*-----------------------------------------------------------------------------
  * Framebuffer Abstraction
 -----------------------------------------------------------------------------*/
@@ -77,6 +176,8 @@ class SL_Framebuffer
 
     SL_TextureView mDepth;
 
+    SL_DepthHierarchy mDepthHierarchy;
+
   public:
     ~SL_Framebuffer() noexcept;
 
@@ -120,6 +221,10 @@ class SL_Framebuffer
 
     void clear_depth_buffer() noexcept;
 
+    const SL_DepthHierarchy& depth_hierarchy() const noexcept;
+
+    SL_DepthHierarchy& depth_hierarchy() noexcept;
+
     int valid() const noexcept;
 
     void terminate() noexcept;
@@ -132,6 +237,8 @@ class SL_Framebuffer
 
     void put_pixel(SL_FboOutputMask outMask, SL_BlendMode blendMode, const SL_FragmentParam& fragParam) noexcept;
 
+    SL_PixelWriter pixel_writer(SL_FboOutputMask outMask, SL_BlendMode blendMode) noexcept;
+
     void put_alpha_pixel(
         uint64_t targetId,
         uint16_t x,
@@ -252,6 +359,8 @@ void SL_Framebuffer::clear_depth_buffer(const float_type depthVal) noexcept
     {
         ls::utils::fast_fill<float_type>(reinterpret_cast<float_type*>(mDepth.pTexels), depthVal, mDepth.width*mDepth.height);
     }
+
+    mDepthHierarchy.clear((float)depthVal);
 }
 
 
@@ -265,6 +374,7 @@ inline void SL_Framebuffer::clear_depth_buffer() noexcept
     {
         const uint64_t numBytes = mDepth.bytesPerTexel * mDepth.width * mDepth.height * mDepth.depth;
         ls::utils::fast_memset(mDepth.pTexels, 0, numBytes);
+        mDepthHierarchy.clear(0.f);
     }
 }
 
@@ -290,13 +400,38 @@ inline SL_TextureView& SL_Framebuffer::get_depth_buffer() noexcept
 
 
 
+/*-------------------------------------
+ * Retrieve the coarse depth bounds of the depth buffer
+-------------------------------------*/
+inline const SL_DepthHierarchy& SL_Framebuffer::depth_hierarchy() const noexcept
+{
+    return mDepthHierarchy;
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the coarse depth bounds of the depth buffer
+-------------------------------------*/
+inline SL_DepthHierarchy& SL_Framebuffer::depth_hierarchy() noexcept
+{
+    return mDepthHierarchy;
+}
+
+
+
 /*-------------------------------------
  * Place a single pixel onto the depth buffer
 -------------------------------------*/
 template <>
 inline void SL_Framebuffer::put_depth_pixel<ls::math::half>(uint16_t x, uint16_t y, ls::math::half depth) noexcept
 {
-    ((ls::math::half*)mDepth.pTexels)[x + mDepth.width * y] = depth;
+    ((ls::math::half*)mDepth.pTexels)[sl_fbo_index(mDepth, x, y)] = depth;
+
+    if (mDepthHierarchy.valid())
+    {
+        mDepthHierarchy.mark_dirty(x, y);
+    }
 }
 
 
@@ -304,7 +439,12 @@ inline void SL_Framebuffer::put_depth_pixel<ls::math::half>(uint16_t x, uint16_t
 template <>
 inline void SL_Framebuffer::put_depth_pixel<float>(uint16_t x, uint16_t y, float depth) noexcept
 {
-    ((float*)mDepth.pTexels)[x + mDepth.width * y] = depth;
+    ((float*)mDepth.pTexels)[sl_fbo_index(mDepth, x, y)] = depth;
+
+    if (mDepthHierarchy.valid())
+    {
+        mDepthHierarchy.mark_dirty(x, y);
+    }
 }
 
 
@@ -312,7 +452,12 @@ inline void SL_Framebuffer::put_depth_pixel<float>(uint16_t x, uint16_t y, float
 template <>
 inline void SL_Framebuffer::put_depth_pixel<double>(uint16_t x, uint16_t y, double depth) noexcept
 {
-    ((double*)mDepth.pTexels)[x + mDepth.width * y] = depth;
+    ((double*)mDepth.pTexels)[sl_fbo_index(mDepth, x, y)] = depth;
+
+    if (mDepthHierarchy.valid())
+    {
+        mDepthHierarchy.mark_dirty(x, y);
+    }
 }
 
 
@@ -367,6 +367,90 @@ void sl_draw_line_bresenham(sl_lowp_t x1, sl_lowp_t y1, sl_lowp_t x2, sl_lowp_t
 
 
 
+/*-------------------------------------
+ * Bresenham template, restricted to the scanlines where
+ * (y % rowStep) == rowOffset.
+ *
+ * This produces the same pixels as sl_draw_line_bresenham() on those
+ * scanlines, but each row's pixels are located directly rather than stepping
+ * through the entire line. Multiple threads can rasterize one line with each
+ * only doing work proportional to the number of rows it owns.
+-------------------------------------*/
+template <typename PerPixelCallback>
+void sl_draw_line_bresenham_rows(sl_lowp_t x1, sl_lowp_t y1, sl_lowp_t x2, sl_lowp_t y2, sl_highp_t rowOffset, sl_highp_t rowStep, PerPixelCallback&& lineCallback) noexcept
+{
+    const bool steep = ls::math::abs(x1 - x2) < ls::math::abs(y1 - y2);
+    if (steep)
+    {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+
+    if (x1 > x2)
+    {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+
+    // After "k" steps along the major axis, Bresenham's algorithm has moved
+    // (k*dErr + dx - 1) / (2*dx) steps along the minor axis. 64-bit math
+    // keeps the products from overflowing on large framebuffers.
+    const int64_t    dx   = (int64_t)x2 - (int64_t)x1;
+    const int64_t    dErr = ((y2 > y1) ? ((int64_t)y2 - (int64_t)y1) : ((int64_t)y1 - (int64_t)y2)) * 2;
+    const sl_highp_t yErr = (y2 > y1) ? 1 : -1;
+
+    if (steep)
+    {
+        // Every step along the major axis lands on a new scanline. Start at
+        // the first row owned by the caller then skip "rowStep" rows at a
+        // time.
+        const sl_highp_t rowMod = ((rowOffset - (sl_highp_t)x1) % rowStep + rowStep) % rowStep;
+        const int64_t    jump   = (int64_t)rowStep * dErr;
+        const int64_t    jumpY  = jump / (2 * dx);
+        const int64_t    jumpE  = jump - jumpY * 2 * dx;
+
+        int64_t    k   = rowMod;
+        int64_t    c   = (k * dErr + dx - 1) / (2 * dx);
+        int64_t    err = k * dErr - c * 2 * dx;
+        sl_highp_t y   = y1 + yErr * (sl_highp_t)c;
+
+        for (sl_highp_t x = x1 + rowMod; x <= x2; x += rowStep)
+        {
+            lineCallback((sl_lowp_t)y, (sl_lowp_t)x);
+
+            y   += yErr * (sl_highp_t)jumpY;
+            err += jumpE;
+
+            if (err > dx)
+            {
+                y   += yErr;
+                err -= 2 * dx;
+            }
+        }
+    }
+    else
+    {
+        // Each scanline contains a horizontal run of pixels. The run for row
+        // "c" begins at the first step which has moved "c" rows.
+        const int64_t    numRows = dErr / 2;
+        const sl_highp_t rowMod  = ((yErr * (rowOffset - (sl_highp_t)y1)) % rowStep + rowStep) % rowStep;
+
+        for (int64_t c = rowMod; c <= numRows; c += rowStep)
+        {
+            const int64_t    kBegin = c ? ((2 * dx * c - dx + dErr) / dErr) : 0;
+            const int64_t    kEnd   = (c < numRows) ? ((2 * dx * (c+1) - dx + dErr) / dErr) : (dx + 1);
+            const sl_highp_t y      = y1 + yErr * (sl_highp_t)c;
+
+            for (int64_t k = kBegin; k < kEnd; ++k)
+            {
+                lineCallback((sl_lowp_t)(x1 + k), (sl_lowp_t)y);
+            }
+        }
+    }
+}
+
+
+
 /*-------------------------------------
  * Line Drawing: Bresenham Base Case
 -------------------------------------*/
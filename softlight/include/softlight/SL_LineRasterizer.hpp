@@ -41,6 +41,9 @@ struct SL_DepthFuncOFF;
 -----------------------------------------------------------------------------*/
 struct SL_LineRasterizer final : public SL_FragmentProcessor
 {
+    template <class DepthCmpFunc, typename depth_type>
+    void render_wide_line(const SL_FragmentBin& bin, SL_Framebuffer* const fbo) noexcept;
+
     template <class DepthCmpFunc, typename depth_type>
     void render_line(const SL_FragmentBin& bin, SL_Framebuffer* const fbo) noexcept;
 
@@ -0,0 +1,125 @@
+
+#ifndef SL_MESH_OPTIMIZER_HPP
+#define SL_MESH_OPTIMIZER_HPP
+
+#include <cstddef> // size_t
+#include <cstdint>
+#include <vector>
+
+#include "softlight/SL_Config.hpp" // SL_MESH_OPTIMIZER_CACHE_SIZE
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward Declarations
+-----------------------------------------------------------------------------*/
+class SL_IndexBuffer;
+struct SL_Mesh;
+class SL_VertexBuffer;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Mesh optimization statistics
+-----------------------------------------------------------------------------*/
+struct SL_MeshOptimizerStats
+{
+    // Average Cache Miss Ratio: the number of vertex shader invocations per
+    // triangle, using a FIFO cache of SL_MESH_OPTIMIZER_CACHE_SIZE entries.
+    // Ranges from 0.5 (ideal) to 3.0 (no vertex reuse).
+    float acmrBefore;
+    float acmrAfter;
+};
+
+
+
+/*-------------------------------------
+ * Calculate the Average Cache Miss Ratio of an indexed triangle list by
+ * simulating a FIFO post-transform vertex cache.
+ *
+ * Returns 0.f if there are no triangles to process.
+-------------------------------------*/
+float sl_calc_acmr(
+    const uint32_t* pIndices,
+    size_t numIndices,
+    size_t numVerts,
+    unsigned cacheSize = SL_MESH_OPTIMIZER_CACHE_SIZE
+) noexcept;
+
+
+
+/*-------------------------------------
+ * Reorder the triangles of an indexed triangle list for vertex cache
+ * locality (Sander, Nehab, and Barczak's "Tipsify").
+ *
+ * If "pClusters" is not null, it will be filled with the first index of each
+ * contiguous cluster of triangles, as determined by where the reordering had
+ * to jump to a distant part of the mesh.
+-------------------------------------*/
+void sl_optimize_vertex_cache(
+    uint32_t* pIndices,
+    size_t numIndices,
+    size_t numVerts,
+    unsigned cacheSize = SL_MESH_OPTIMIZER_CACHE_SIZE,
+    std::vector<size_t>* pClusters = nullptr
+) noexcept;
+
+
+
+/*-------------------------------------
+ * Reorder clusters of triangles so those facing away from the center of a
+ * mesh are drawn first, increasing the chance later clusters fail the depth
+ * test. The triangle order within each cluster is preserved.
+ *
+ * Vertex positions are read as three floats at the beginning of each vertex.
+-------------------------------------*/
+void sl_optimize_overdraw(
+    uint32_t* pIndices,
+    size_t numIndices,
+    const std::vector<size_t>& clusters,
+    const char* pVertices,
+    size_t numVerts,
+    size_t vertStride
+) noexcept;
+
+
+
+/*-------------------------------------
+ * Reorder vertices to match the order in which they are first referenced by
+ * an index buffer, then update the indices to match.
+-------------------------------------*/
+void sl_optimize_vertex_fetch(
+    uint32_t* pIndices,
+    size_t numIndices,
+    char* pVertices,
+    size_t numVerts,
+    size_t vertStride
+) noexcept;
+
+
+
+/*-------------------------------------
+ * Run all optimizations on a triangle mesh which has been uploaded to an
+ * index buffer and vertex buffer.
+ *
+ * The vertices of a mesh must be contiguous, interleaved, and start at
+ * "vboOffset" bytes into the vertex buffer. "baseVert" is the index of the
+ * first vertex, which has been added to each index in the IBO.
+ *
+ * Returns 0 on success, or a negative value if the mesh could not be
+ * optimized.
+-------------------------------------*/
+int sl_optimize_mesh(
+    const SL_Mesh& mesh,
+    SL_IndexBuffer& ibo,
+    SL_VertexBuffer& vbo,
+    size_t vboOffset,
+    size_t baseVert,
+    size_t numVerts,
+    size_t vertStride,
+    SL_MeshOptimizerStats* pStats = nullptr
+) noexcept;
+
+
+
+#endif /* SL_MESH_OPTIMIZER_HPP */
@@ -0,0 +1,111 @@
+
+#ifndef SL_MESHLET_HPP
+#define SL_MESHLET_HPP
+
+#include <cstddef> // size_t
+
+#include "lightsky/math/vec4.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Config.hpp" // SL_VERTEX_CHUNK_SIZE
+#include "softlight/SL_Setup.hpp" // SL_AlignedVector
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward Declarations
+-----------------------------------------------------------------------------*/
+class SL_Context;
+struct SL_Mesh;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Meshlets (clusters of triangles)
+ *
+ * A meshlet covers the same range of triangles as a single vertex processing
+ * chunk (SL_VERTEX_CHUNK_SIZE triangles), so the vertex processors can reject
+ * an entire chunk before running any vertex shaders on it.
+-----------------------------------------------------------------------------*/
+struct SL_Meshlet
+{
+    // Object-space bounding sphere. XYZ contains the center, W the radius.
+    ls::math::vec4 bounds;
+
+    // Normal cone. XYZ contains the average facing direction of all
+    // triangles, W contains the cosine of the cone's spread. A W value
+    // greater than 1 means the meshlet can never be back-face culled.
+    ls::math::vec4 cone;
+
+    // Point from which the normal cone is projected. W is always 1.
+    ls::math::vec4 coneApex;
+};
+
+
+
+/*-------------------------------------
+ * Per-draw culling state. Planes and view position must be in the same
+ * (object) space as the meshlet bounds. Planes can be generated with
+ * sl_extract_frustum_planes() using a model-view-projection matrix. The W
+ * component of the view position must be 1.
+-------------------------------------*/
+struct SL_MeshletCull
+{
+    const SL_Meshlet* pMeshlets;
+    size_t numMeshlets;
+
+    ls::math::vec4 planes[6];
+    ls::math::vec4 viewPos;
+};
+
+
+
+/*-------------------------------------
+ * Determine if a meshlet is potentially visible.
+ *
+ * Back-facing meshlets are only rejected when "cullBackFaces" is true.
+ * Triangles are assumed to use a counter-clockwise winding order.
+-------------------------------------*/
+inline bool sl_meshlet_visible(const SL_Meshlet& meshlet, const SL_MeshletCull& cull, bool cullBackFaces) noexcept
+{
+    const ls::math::vec4 center{meshlet.bounds[0], meshlet.bounds[1], meshlet.bounds[2], 1.f};
+    const float radius = meshlet.bounds[3];
+
+    for (unsigned i = 6; i--;)
+    {
+        if (ls::math::dot(cull.planes[i], center) < -radius)
+        {
+            return false;
+        }
+    }
+
+    if (cullBackFaces && meshlet.cone[3] <= 1.f)
+    {
+        const ls::math::vec4&& viewDir = ls::math::normalize(meshlet.coneApex - cull.viewPos);
+        const ls::math::vec4   axis{meshlet.cone[0], meshlet.cone[1], meshlet.cone[2], 0.f};
+
+        if (ls::math::dot(viewDir, axis) >= meshlet.cone[3])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-------------------------------------
+ * Build a list of meshlets for an indexed or non-indexed triangle mesh.
+ *
+ * Vertex positions are read from the first binding of the mesh's VAO and
+ * must contain at least 3 floats.
+ *
+ * Returns the number of meshlets generated, or a negative value if the mesh
+ * is not a triangle mesh or does not have float positions.
+-------------------------------------*/
+int sl_build_meshlets(const SL_Context& context, const SL_Mesh& mesh, SL_AlignedVector<SL_Meshlet>& outMeshlets) noexcept;
+
+
+
+#endif /* SL_MESHLET_HPP */
@@ -0,0 +1,49 @@
+
+#ifndef SL_MIPMAP_PROCESSOR_HPP
+#define SL_MIPMAP_PROCESSOR_HPP
+
+#include <cstdint>
+
+#include "softlight/SL_Swizzle.hpp" // SL_TexelOrder
+
+
+
+struct SL_TextureView;
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Mipmap Processor generates a single mip level of a texture from
+ * the level above it, using a 2x2 box filter. Rows of the output level are
+ * interleaved between threads.
+ *
+ * Only uncompressed color types are supported.
+-----------------------------------------------------------------------------*/
+struct SL_MipmapProcessor
+{
+    // 32 bits
+    uint16_t mThreadId;
+    uint16_t mNumThreads;
+
+    // 32 bits
+    SL_TexelOrder mTexelOrder;
+
+    // 64-128 bits
+    const SL_TextureView* mSrcTex;
+    SL_TextureView* mDstTex;
+
+    // 128-192 bits total, 16-24 bytes
+
+    // Average each 2x2 block of texels from the source level
+    template<typename color_type, typename value_type, SL_TexelOrder order>
+    void downsample() noexcept;
+
+    template<typename color_type, typename value_type>
+    void downsample_texels() noexcept;
+
+    void execute() noexcept;
+};
+
+
+
+#endif /* SL_MIPMAP_PROCESSOR_HPP */
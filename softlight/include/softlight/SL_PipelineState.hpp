@@ -91,6 +91,17 @@ enum SL_RenderTargetCount : uint8_t
 
 
 
+/*-------------------------------------
+ * Screen-Space Derivatives of Fragment Varyings
+-------------------------------------*/
+enum SL_DerivativeMode : uint8_t
+{
+    SL_DERIVATIVES_OFF,
+    SL_DERIVATIVES_ON
+}; // 2 states = 1 bit
+
+
+
 /*-------------------------------------
  * Helper structures to ensure compile-time validation of bit masks
 -------------------------------------*/
@@ -101,7 +112,7 @@ namespace sl_detail
     template <typename enum_type>
     struct PipelineEnumBits;
 
-    // Currently 15/16 bits are used. "value_type" can be updated to uint32_t
+    // Currently 16/16 bits are used. "value_type" can be updated to uint32_t
     // if more bits are needed in the future, along with the class's alignment.
     template <> struct PipelineEnumBits<SL_CullMode>          { enum : sl_detail::value_type {mask = 0x0003, shifts = 0}; };
     template <> struct PipelineEnumBits<SL_DepthTest>         { enum : sl_detail::value_type {mask = 0x001C, shifts = 2}; };
@@ -109,6 +120,7 @@ namespace sl_detail
     template <> struct PipelineEnumBits<SL_BlendMode>         { enum : sl_detail::value_type {mask = 0x01C0, shifts = 6}; };
     template <> struct PipelineEnumBits<SL_VaryingCount>      { enum : sl_detail::value_type {mask = 0x0E00, shifts = 9}; };
     template <> struct PipelineEnumBits<SL_RenderTargetCount> { enum : sl_detail::value_type {mask = 0x7000, shifts = 12}; };
+    template <> struct PipelineEnumBits<SL_DerivativeMode>    { enum : sl_detail::value_type {mask = 0x8000, shifts = 15}; };
 
 } // end SL_PipelineBitDetail namespace
 
@@ -179,6 +191,10 @@ class alignas(alignof(sl_detail::value_type)) SL_PipelineState
     void num_render_targets(SL_RenderTargetCount rt) noexcept;
 
     constexpr SL_RenderTargetCount num_render_targets() const noexcept;
+
+    void derivative_mode(SL_DerivativeMode dm) noexcept;
+
+    constexpr SL_DerivativeMode derivative_mode() const noexcept;
 };
 
 
@@ -226,7 +242,8 @@ constexpr SL_PipelineState::SL_PipelineState() noexcept :
         SL_PipelineState::enum_value_to_bits<SL_DepthMask>(SL_DepthMask::SL_DEPTH_MASK_ON) |
         SL_PipelineState::enum_value_to_bits<SL_BlendMode>(SL_BlendMode::SL_BLEND_OFF) |
         SL_PipelineState::enum_value_to_bits<SL_VaryingCount>(SL_VaryingCount::SL_VARYING_COUNT_0) |
-        SL_PipelineState::enum_value_to_bits<SL_RenderTargetCount>(SL_RenderTargetCount::SL_RENDER_TARGET_COUNT_1)
+        SL_PipelineState::enum_value_to_bits<SL_RenderTargetCount>(SL_RenderTargetCount::SL_RENDER_TARGET_COUNT_1) |
+        SL_PipelineState::enum_value_to_bits<SL_DerivativeMode>(SL_DerivativeMode::SL_DERIVATIVES_OFF)
     )}
 {}
 
@@ -398,4 +415,24 @@ constexpr SL_RenderTargetCount SL_PipelineState::num_render_targets() const noex
 
 
 
+/*-------------------------------------
+ * derivative mode setter
+-------------------------------------*/
+inline void SL_PipelineState::derivative_mode(SL_DerivativeMode dm) noexcept
+{
+    mStates = SL_PipelineState::set_enum_bits<SL_DerivativeMode>(mStates, dm);
+}
+
+
+
+/*-------------------------------------
+ * derivative mode getter
+-------------------------------------*/
+constexpr SL_DerivativeMode SL_PipelineState::derivative_mode() const noexcept
+{
+    return SL_PipelineState::enum_value_from_bits<SL_DerivativeMode>(mStates);
+}
+
+
+
 #endif /* SL_PIPELINE_STATE_HPP */
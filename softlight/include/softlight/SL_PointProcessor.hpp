@@ -12,13 +12,14 @@
 class SL_PointProcessor final : public SL_VertexProcessor
 {
   private:
-    void push_bin(size_t primIndex, const ls::math::vec4_t<float>& viewportDims, const SL_TransformedVert& v) const noexcept;
+    void push_bin(size_t primIndex, const ls::math::vec4_t<float>& viewportDims, int32_t pointSize, const SL_TransformedVert& v) const noexcept;
 
     void process_verts(
         const SL_Mesh& m,
         size_t instanceId,
         const ls::math::mat4_t<float>& scissorMat,
-        const ls::math::vec4_t<float>& viewportDims
+        const ls::math::vec4_t<float>& viewportDims,
+        int32_t pointSize
     ) noexcept;
 
   public:
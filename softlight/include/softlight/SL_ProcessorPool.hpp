@@ -7,7 +7,13 @@
 
 #include "lightsky/utils/Pointer.h" // Pointer, AlignedPointerDeleter
 
+#include "softlight/SL_BatchProcessor.hpp" // SL_DrawRun
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Setup.hpp" // SL_AlignedVector
+#include "softlight/SL_Shader.hpp"
 #include "softlight/SL_ShaderUtil.hpp"
+#include "softlight/SL_TaskProcessor.hpp" // SL_TaskFunc
+#include "softlight/SL_ThreadStats.hpp"
 
 
 
@@ -29,13 +35,17 @@ union vec4_t;
 } // math namespace
 } // ls namespace
 
+struct SL_BinTileMap;
 class SL_Context;
 struct SL_FragCoord;
 struct SL_FragmentBin;
+struct SL_DrawCommand;
 class SL_Framebuffer;
-struct SL_Mesh;
-struct SL_Shader;
+struct SL_MeshletCull;
 struct SL_ShaderProcessor;
+enum SL_ColorDataType : uint8_t;
+enum class SL_TexelOrder;
+class SL_Texture;
 struct SL_TextureView;
 
 
@@ -64,10 +74,50 @@ class SL_ProcessorPool
 
     ls::utils::UniqueAlignedArray<SL_FragCoord> mFragQueues;
 
+    ls::utils::UniqueAlignedPointer<SL_BinTileMap> mBinTiles;
+
+    ls::utils::UniqueAlignedPointer<SL_BinCounterAtomic<uint_fast64_t>> mVertChunks;
+
+    ls::utils::UniqueAlignedArray<SL_ThreadStats> mThreadStats;
+
+    // Secondary bins used by every other run of a batched draw. These are
+    // only allocated once a batch has been submitted.
+    ls::utils::UniqueAlignedPointer<SL_BinCounterAtomic<int_fast64_t>> mBatchFragSemaphore;
+
+    ls::utils::UniqueAlignedPointer<SL_BinCounterAtomic<uint_fast64_t>> mBatchShadingSemaphore;
+
+    ls::utils::UniqueAlignedArray<SL_BinCounter<uint32_t>> mBatchBinIds;
+
+    ls::utils::UniqueAlignedArray<SL_BinCounter<uint32_t>> mBatchTempBinIds;
+
+    ls::utils::UniqueAlignedPointer<SL_BinCounterAtomic<uint32_t>> mBatchBinsUsed;
+
+    ls::utils::UniqueAlignedArray<SL_FragmentBin> mBatchFragBins;
+
+    ls::utils::UniqueAlignedPointer<SL_BinTileMap> mBatchBinTiles;
+
+    ls::utils::UniqueAlignedPointer<SL_BinCounterAtomic<uint_fast64_t>> mBatchVertChunks;
+
+    ls::utils::UniqueAlignedArray<SL_BinCounterAtomic<uint32_t>> mRunExits;
+
+    ls::utils::UniqueAlignedArray<SL_BinCounterAtomic<uint32_t>> mRunsRetired;
+
+    SL_AlignedVector<SL_Mesh> mBatchMeshes;
+
+    // Meshlet culling data for each element of "mBatchMeshes"
+    SL_AlignedVector<const SL_MeshletCull*> mBatchCulls;
+
+    SL_AlignedVector<SL_DrawRun> mBatchRuns;
+
+    // Copies of shaders used with a draw's own uniform buffer
+    SL_AlignedVector<SL_Shader> mBatchShaders;
+
     ls::utils::UniqueAlignedArray<ThreadedWorker> mWorkers;
 
     unsigned mNumThreads;
 
+    void allocate_batch_bins() noexcept;
+
   public:
     ~SL_ProcessorPool() noexcept;
 
@@ -93,12 +143,18 @@ class SL_ProcessorPool
 
     void execute() noexcept;
 
-    void run_shader_processors(const SL_Context& c, const SL_Mesh& m, size_t numInstances, const SL_Shader& s, SL_Framebuffer& fbo) noexcept;
+    void run_shader_processors(const SL_Context& c, const SL_Mesh& m, size_t numInstances, const SL_Shader& s, SL_Framebuffer& fbo, const SL_MeshletCull* pCull = nullptr) noexcept;
 
-    void run_shader_processors(const SL_Context& c, const SL_Mesh* meshes, size_t numMeshes, const SL_Shader& s, SL_Framebuffer& fbo) noexcept;
+    void run_shader_processors(const SL_Context& c, const SL_Mesh* meshes, size_t numMeshes, const SL_Shader& s, SL_Framebuffer& fbo, const SL_MeshletCull* const* pCulls = nullptr) noexcept;
+
+    void run_shader_batch(const SL_Context& c, const SL_DrawCommand* draws, size_t numDraws, const SL_Shader* shaders, SL_Framebuffer* fbos) noexcept;
 
     void clear_fragment_bins() noexcept;
 
+    const SL_ThreadStats* thread_stats() const noexcept;
+
+    void reset_thread_stats() noexcept;
+
     void run_blit_processors(
         const SL_TextureView* inTex,
         SL_TextureView* outTex,
@@ -109,7 +165,9 @@ class SL_ProcessorPool
         uint16_t dstX0,
         uint16_t dstY0,
         uint16_t dstX1,
-        uint16_t dstY1
+        uint16_t dstY1,
+        bool srcIsAttachment,
+        bool dstIsAttachment
     ) noexcept;
 
     void run_blit_compressed_processors(
@@ -122,7 +180,9 @@ class SL_ProcessorPool
         uint16_t dstX0,
         uint16_t dstY0,
         uint16_t dstX1,
-        uint16_t dstY1
+        uint16_t dstY1,
+        bool srcIsAttachment,
+        bool dstIsAttachment
     ) noexcept;
 
     void run_clear_processors(const void* inColor, SL_TextureView* outTex) noexcept;
@@ -134,6 +194,12 @@ class SL_ProcessorPool
     void run_clear_processors(const std::array<const void*, 3>& inColors, const void* depth, const std::array<SL_TextureView*, 3>& colorBufs, SL_TextureView* depthBuf) noexcept;
 
     void run_clear_processors(const std::array<const void*, 4>& inColors, const void* depth, const std::array<SL_TextureView*, 4>& colorBufs, SL_TextureView* depthBuf) noexcept;
+
+    void run_mipmap_processors(SL_Texture& tex, SL_TexelOrder order) noexcept;
+
+    void run_texture_upload_processors(const void* pTexels, SL_ColorDataType srcType, SL_TextureView& outTex, SL_TexelOrder order) noexcept;
+
+    void run_task_processors(SL_TaskFunc task, void* pUserData) noexcept;
 };
 
 
@@ -148,6 +214,16 @@ inline unsigned SL_ProcessorPool::concurrency() const noexcept
 
 
 
+/*--------------------------------------
+ * Retrieve the per-thread load-balancing statistics
+--------------------------------------*/
+inline const SL_ThreadStats* SL_ProcessorPool::thread_stats() const noexcept
+{
+    return mThreadStats.get();
+}
+
+
+
 /*-------------------------------------
  * Run the processor threads
 -------------------------------------*/
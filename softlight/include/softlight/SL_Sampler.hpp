@@ -2,10 +2,13 @@
 #ifndef SL_SAMPLER_HPP
 #define SL_SAMPLER_HPP
 
+#include <cmath> // std::log2
+
 #include "lightsky/setup/Types.h"
 
 #include "lightsky/math/scalar_utils.h"
 #include "lightsky/math/fixed.h"
+#include "lightsky/math/vec2.h"
 
 #include "softlight/SL_Texture.hpp"
 
@@ -373,4 +376,140 @@ inline LS_INLINE color_type sl_sample_trilinear(const SL_Texture& tex, float x,
 
 
 
+/*-----------------------------------------------------------------------------
+ * Mipmapped filtering
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Calculate a texture's level-of-detail from the screen-space derivatives of
+ * its texture coordinates (see sl_dfdx() and sl_dfdy()).
+-------------------------------------*/
+inline LS_INLINE float sl_texture_lod(const SL_Texture& tex, const ls::math::vec2& dUVdx, const ls::math::vec2& dUVdy) noexcept
+{
+    const ls::math::vec2&& texSize = ls::math::vec2{(float)tex.width(), (float)tex.height()};
+    const ls::math::vec2&& dx      = dUVdx * texSize;
+    const ls::math::vec2&& dy      = dUVdy * texSize;
+    const float            rho2    = ls::math::max(ls::math::dot(dx, dx), ls::math::dot(dy, dy));
+
+    // log2(sqrt(rho2)) == 0.5*log2(rho2)
+    return 0.5f * std::log2(rho2);
+}
+
+
+
+/*-------------------------------------
+ * Nearest-neighbor sampling of a single mip level
+-------------------------------------*/
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_level_nearest(const SL_TextureView& view, float x, float y) noexcept
+{
+    if (SL_WrapMode::SL_IsWrapModeBorder<WrapMode>::value && (x < 0.f || x >= 1.f || y < 0.f || y >= 1.f))
+    {
+        return color_type{0};
+    }
+
+    constexpr WrapMode wrapMode;
+
+    const uint_fast32_t xi = ls::math::min<uint_fast32_t>((uint_fast32_t)((float)view.width  * wrapMode(x)), view.width-1u);
+    const uint_fast32_t yi = ls::math::min<uint_fast32_t>((uint_fast32_t)((float)view.height * wrapMode(y)), view.height-1u);
+
+    return reinterpret_cast<const color_type*>(view.pTexels)[sl_texture_view_index<order>(view, xi, yi)];
+}
+
+
+
+/*-------------------------------------
+ * Bilinear sampling of a single mip level
+-------------------------------------*/
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_level_bilinear(const SL_TextureView& view, float x, float y) noexcept
+{
+    if (SL_WrapMode::SL_IsWrapModeBorder<WrapMode>::value && (x < 0.f || x >= 1.f || y < 0.f || y >= 1.f))
+    {
+        return color_type{0};
+    }
+
+    constexpr WrapMode wrapMode;
+
+    const color_type* pTexels = reinterpret_cast<const color_type*>(view.pTexels);
+    const float         xf      = wrapMode(x) * (float)view.width;
+    const float         yf      = wrapMode(y) * (float)view.height;
+    const uint_fast32_t xi0     = ls::math::min<uint_fast32_t>((uint_fast32_t)xf, view.width-1u);
+    const uint_fast32_t yi0     = ls::math::min<uint_fast32_t>((uint_fast32_t)yf, view.height-1u);
+    const uint_fast32_t xi1     = ls::math::min<uint_fast32_t>(xi0+1u, view.width-1u);
+    const uint_fast32_t yi1     = ls::math::min<uint_fast32_t>(yi0+1u, view.height-1u);
+    const float         dx      = xf - (float)xi0;
+    const float         dy      = yf - (float)yi0;
+    const float         omdx    = 1.f - dx;
+    const float         omdy    = 1.f - dy;
+    const auto&&        pixel0  = color_cast<float, typename color_type::value_type>(pTexels[sl_texture_view_index<order>(view, xi0, yi0)]);
+    const auto&&        pixel1  = color_cast<float, typename color_type::value_type>(pTexels[sl_texture_view_index<order>(view, xi0, yi1)]);
+    const auto&&        pixel2  = color_cast<float, typename color_type::value_type>(pTexels[sl_texture_view_index<order>(view, xi1, yi0)]);
+    const auto&&        pixel3  = color_cast<float, typename color_type::value_type>(pTexels[sl_texture_view_index<order>(view, xi1, yi1)]);
+    const auto&&        weight0 = pixel0 * omdx * omdy;
+    const auto&&        weight1 = pixel1 * omdx * dy;
+    const auto&&        weight2 = pixel2 * dx * omdy;
+    const auto&&        weight3 = pixel3 * dx * dy;
+
+    const auto&& ret = ls::math::sum(weight0, weight1, weight2, weight3);
+
+    return color_cast<typename color_type::value_type, float>(ret);
+}
+
+
+
+/*-------------------------------------
+ * Bilinear sampling of the nearest mip level
+-------------------------------------*/
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_nearest_mip(const SL_Texture& tex, float x, float y, float lod) noexcept
+{
+    const float    maxLevel = (float)(tex.num_levels() - 1u);
+    const uint32_t level    = (uint32_t)ls::math::clamp(lod + 0.5f, 0.f, maxLevel);
+
+    return sl_sample_level_bilinear<color_type, WrapMode, order>(tex.level_view(level), x, y);
+}
+
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_nearest_mip(const SL_Texture& tex, float x, float y, const ls::math::vec2& dUVdx, const ls::math::vec2& dUVdy) noexcept
+{
+    return sl_sample_nearest_mip<color_type, WrapMode, order>(tex, x, y, sl_texture_lod(tex, dUVdx, dUVdy));
+}
+
+
+
+/*-------------------------------------
+ * Bilinear sampling of the two nearest mip levels, blended by the fractional
+ * level-of-detail
+-------------------------------------*/
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_linear_mip(const SL_Texture& tex, float x, float y, float lod) noexcept
+{
+    const uint32_t maxLevel = tex.num_levels() - 1u;
+    const float    lodf     = ls::math::clamp(lod, 0.f, (float)maxLevel);
+    const uint32_t level0   = (uint32_t)lodf;
+    const uint32_t level1   = ls::math::min<uint32_t>(level0 + 1u, maxLevel);
+    const float    t        = lodf - (float)level0;
+
+    const color_type&& c0 = sl_sample_level_bilinear<color_type, WrapMode, order>(tex.level_view(level0), x, y);
+    if (level0 == level1 || t <= 0.f)
+    {
+        return c0;
+    }
+
+    const color_type&& c1 = sl_sample_level_bilinear<color_type, WrapMode, order>(tex.level_view(level1), x, y);
+
+    const auto&& weight0 = color_cast<float, typename color_type::value_type>(c0) * (1.f - t);
+    const auto&& weight1 = color_cast<float, typename color_type::value_type>(c1) * t;
+
+    return color_cast<typename color_type::value_type, float>(weight0 + weight1);
+}
+
+template <typename color_type, class WrapMode, SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE color_type sl_sample_linear_mip(const SL_Texture& tex, float x, float y, const ls::math::vec2& dUVdx, const ls::math::vec2& dUVdy) noexcept
+{
+    return sl_sample_linear_mip<color_type, WrapMode, order>(tex, x, y, sl_texture_lod(tex, dUVdx, dUVdy));
+}
+
+
+
 #endif /* SL_SAMPLER_HPP */
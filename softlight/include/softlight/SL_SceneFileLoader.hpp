@@ -125,6 +125,20 @@ struct SL_SceneLoadOpts
     // transformed UV mapping is in the CPU cache (will increase CPU cycles
     // spent calculating UVs while potentially decreasing memory bandwidth).
     bool swizzleTexels;
+
+    // Reorder the triangles and vertices of each indexed triangle mesh to
+    // improve vertex cache hit rates and reduce overdraw. The average cache
+    // miss ratio (ACMR) before and after optimization is logged.
+    bool optimizeMeshes;
+
+    // Resample every animation into a packed SL_AnimationClip, storing
+    // SL_ANIM_CLIP_SAMPLE_RATE keyframes per second, so all channels of an
+    // animation can be interpolated together.
+    bool packAnimations;
+
+    // Store the keyframes of packed animations in 16 bits per component.
+    // This option does nothing unless packAnimations is set.
+    bool quantizeAnimations;
 };
 
 
@@ -141,6 +155,9 @@ struct SL_SceneLoadOpts
  *     genSmoothNormals: TRUE
  *     genTangents:      FALSE
  *     swizzleTexels:    FALSE
+ *     optimizeMeshes:   FALSE
+ *     packAnimations:   FALSE
+ *     quantizeAnimations: FALSE
  *
  * @return A SL_SceneLoadOpts structure, containing standard data-modification
  * options which will affect a scene being loaded.
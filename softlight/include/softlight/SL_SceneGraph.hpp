@@ -2,6 +2,7 @@
 #ifndef SL_SCENE_GRAPH_HPP
 #define SL_SCENE_GRAPH_HPP
 
+#include <utility> // std::pair
 #include <vector>
 
 #include "lightsky/utils/AlignedAllocator.hpp"
@@ -372,6 +373,29 @@ class SL_SceneGraph
      */
     SL_AlignedVector<SL_AlignedVector<SL_AnimationChannel>> mNodeAnims;
 
+  private: // member objects
+    /**
+     * Ranges of nodes updated by the last call to update(). Each range
+     * contains a dirty node, followed by all of its children.
+     */
+    SL_AlignedVector<std::pair<size_t, size_t>> mDirtyRanges;
+
+    /**
+     * Depth of each node relative to the start of its dirty range.
+     */
+    SL_AlignedVector<size_t> mNodeDepths;
+
+    /**
+     * Dirty node IDs, sorted by their depth. Nodes at the same depth can be
+     * updated in parallel.
+     */
+    SL_AlignedVector<size_t> mUpdateNodes;
+
+    /**
+     * Offset of the first node of each depth within mUpdateNodes.
+     */
+    SL_AlignedVector<size_t> mUpdateLevels;
+
   private: // member functions
     /**
      * Update the transformation of a single node in the transformation
@@ -382,6 +406,21 @@ class SL_SceneGraph
      */
     void update_node_transform(const size_t transformId) noexcept;
 
+    /**
+     * Update a subset of the nodes at a single depth. Used as a task by
+     * the context's threads.
+     *
+     * @param pUserData
+     * A pointer to the list of nodes being updated.
+     *
+     * @param threadId
+     * The ID of the calling thread.
+     *
+     * @param numThreads
+     * The number of threads sharing the list of nodes.
+     */
+    static void update_transforms_task(void* pUserData, uint32_t threadId, uint32_t numThreads) noexcept;
+
     /**
      * Remove all data specific to mesh nodes.
      *
@@ -509,6 +548,17 @@ class SL_SceneGraph
      */
     void update() noexcept;
 
+    /**
+     * Retrieve the ranges of nodes updated by the last call to update().
+     *
+     * Each range contains a dirty node, followed by all of its children. This
+     * allows other structures, such as a bounding volume hierarchy, to only
+     * refresh the nodes which have moved.
+     *
+     * @return A list of [first, last) node ranges, sorted by node ID.
+     */
+    const SL_AlignedVector<std::pair<size_t, size_t>>& dirty_ranges() const noexcept;
+
     /**
      * Remove a node from the scene graph.
      *
@@ -741,4 +791,14 @@ class SL_SceneGraph
 
 
 
+/*-------------------------------------
+ * Get the nodes updated by the last call to update()
+-------------------------------------*/
+inline const SL_AlignedVector<std::pair<size_t, size_t>>& SL_SceneGraph::dirty_ranges() const noexcept
+{
+    return mDirtyRanges;
+}
+
+
+
 #endif    /* SL_SCENE_GRAPH_HPP */
@@ -79,6 +79,80 @@ struct SL_FragmentParam
     alignas(sizeof(ls::math::vec4)*2) ls::math::vec4 pVaryings[SL_SHADER_MAX_VARYING_VECTORS];
 
     alignas(sizeof(ls::math::vec4)) ls::math::vec4 pOutputs[SL_SHADER_MAX_FRAG_OUTPUTS];
+
+    // Screen-space derivatives of each varying across the 2x2 pixel quad
+    // containing this fragment. Only available for triangles when the
+    // shader enables SL_DERIVATIVES_ON.
+    alignas(sizeof(ls::math::vec4)*2) ls::math::vec4 pDdx[SL_SHADER_MAX_VARYING_VECTORS];
+    alignas(sizeof(ls::math::vec4)*2) ls::math::vec4 pDdy[SL_SHADER_MAX_VARYING_VECTORS];
+};
+
+
+
+/*-------------------------------------
+ * Varying derivatives in the horizontal screen direction
+-------------------------------------*/
+inline const ls::math::vec4& sl_dfdx(const SL_FragmentParam& fragParams, unsigned varyingId) noexcept
+{
+    return fragParams.pDdx[varyingId];
+}
+
+
+
+/*-------------------------------------
+ * Varying derivatives in the vertical screen direction
+-------------------------------------*/
+inline const ls::math::vec4& sl_dfdy(const SL_FragmentParam& fragParams, unsigned varyingId) noexcept
+{
+    return fragParams.pDdy[varyingId];
+}
+
+
+
+/*-------------------------------------
+ * Sum of the absolute horizontal & vertical derivatives of a varying
+-------------------------------------*/
+inline ls::math::vec4 sl_fwidth(const SL_FragmentParam& fragParams, unsigned varyingId) noexcept
+{
+    const ls::math::vec4& dx = fragParams.pDdx[varyingId];
+    const ls::math::vec4& dy = fragParams.pDdy[varyingId];
+
+    return ls::math::vec4{
+        ls::math::abs(dx[0]) + ls::math::abs(dy[0]),
+        ls::math::abs(dx[1]) + ls::math::abs(dy[1]),
+        ls::math::abs(dx[2]) + ls::math::abs(dy[2]),
+        ls::math::abs(dx[3]) + ls::math::abs(dy[3])
+    };
+}
+
+
+
+/*-------------------------------------
+ * Parameters which go into a wide frag shader.
+ *
+ * Data is stored as a structure-of-arrays, where each array contains one
+ * element per fragment in the block. For example, the Y-component of the
+ * second varying for fragment "n" is "pVaryings[1][1][n]".
+-------------------------------------*/
+struct SL_FragmentBlockParam
+{
+    const SL_UniformBuffer* pUniforms;
+
+    // Bit "n" is set if fragment "n" of the block needs to be shaded.
+    uint32_t activeMask;
+
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) uint16_t x[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) uint16_t y[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float depth[SL_SHADER_FRAG_BLOCK_SIZE];
+
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float pVaryings[SL_SHADER_MAX_VARYING_VECTORS][4][SL_SHADER_FRAG_BLOCK_SIZE];
+
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float pOutputs[SL_SHADER_MAX_FRAG_OUTPUTS][4][SL_SHADER_FRAG_BLOCK_SIZE];
+
+    // Varying derivatives, laid out the same as "pVaryings." Only available
+    // when the shader enables SL_DERIVATIVES_ON.
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float pDdx[SL_SHADER_MAX_VARYING_VECTORS][4][SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float pDdy[SL_SHADER_MAX_VARYING_VECTORS][4][SL_SHADER_FRAG_BLOCK_SIZE];
 };
 
 
@@ -95,6 +169,15 @@ struct SL_FragmentShader
     SL_DepthMask depthMask;
 
     bool (*shader)(SL_FragmentParam& perFragParams);
+
+    // Optional wide entry point, used for triangles when available. This
+    // returns a mask of the fragments in "activeMask" which should be written
+    // to the framebuffer. "shader" is still used for points & lines.
+    uint32_t (*blockShader)(SL_FragmentBlockParam& blockParams) = nullptr;
+
+    // Calculate screen-space derivatives of the varyings for each triangle
+    // fragment. Needed for texture LOD selection.
+    SL_DerivativeMode derivatives = SL_DERIVATIVES_OFF;
 };
 
 
@@ -110,6 +193,8 @@ struct SL_Shader
 
     bool (*pFragShader)(SL_FragmentParam& perFragParams);
 
+    uint32_t (*pFragBlockShader)(SL_FragmentBlockParam& blockParams);
+
     // Shared pointers are only changed in the move and copy operators
     SL_UniformBuffer* pUniforms;
 };
@@ -4,11 +4,15 @@
 
 #include <cstdint>
 
+#include "softlight/SL_BatchProcessor.hpp"
 #include "softlight/SL_BlitProcesor.hpp"
 #include "softlight/SL_BlitCompressedProcesor.hpp"
 #include "softlight/SL_ClearProcesor.hpp"
 #include "softlight/SL_LineProcessor.hpp"
+#include "softlight/SL_MipmapProcessor.hpp"
 #include "softlight/SL_PointProcessor.hpp"
+#include "softlight/SL_TaskProcessor.hpp"
+#include "softlight/SL_TextureUploadProcessor.hpp"
 #include "softlight/SL_TriProcessor.hpp"
 
 
@@ -27,7 +31,11 @@ enum SL_ShaderType : uint8_t
     SL_POINT_PROCESSOR,
     SL_BLIT_PROCESSOR,
     SL_BLIT_COMPRESSED_PROCESSOR,
-    SL_CLEAR_PROCESSOR
+    SL_CLEAR_PROCESSOR,
+    SL_MIPMAP_PROCESSOR,
+    SL_TEXTURE_UPLOAD_PROCESSOR,
+    SL_TASK_PROCESSOR,
+    SL_BATCH_PROCESSOR
 };
 
 SL_ShaderType sl_processor_type_for_draw_mode(SL_RenderMode drawMode) noexcept;
@@ -50,6 +58,10 @@ struct SL_ShaderProcessor
         SL_BlitProcessor mBlitter;
         SL_BlitCompressedProcessor mBlitterCompressed;
         SL_ClearProcessor mClear;
+        SL_MipmapProcessor mMipmap;
+        SL_TextureUploadProcessor mTexUpload;
+        SL_TaskProcessor mTask;
+        SL_BatchProcessor mBatch;
     };
 
     // 2144 bits (268 bytes), padding not included
@@ -103,6 +115,22 @@ inline void SL_ShaderProcessor::operator()() noexcept
         case SL_CLEAR_PROCESSOR:
             mClear.execute();
             break;
+
+        case SL_MIPMAP_PROCESSOR:
+            mMipmap.execute();
+            break;
+
+        case SL_TEXTURE_UPLOAD_PROCESSOR:
+            mTexUpload.execute();
+            break;
+
+        case SL_TASK_PROCESSOR:
+            mTask.execute();
+            break;
+
+        case SL_BATCH_PROCESSOR:
+            mBatch.execute();
+            break;
     }
 }
 
@@ -13,9 +13,11 @@
 #include "lightsky/setup/Types.h"
 
 #include "lightsky/math/scalar_utils.h"
+#include "lightsky/math/vec2.h"
 #include "lightsky/math/vec4.h"
 
 #include "softlight/SL_Config.hpp"
+#include "softlight/SL_CpuFeatures.hpp" // SL_TARGET_AVX2, SL_TARGET_AVX512
 
 
 
@@ -262,6 +264,20 @@ struct SL_DepthFuncOFF
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256, __m256) const noexcept
+        {
+            return _mm256_castsi256_ps(_mm256_set1_epi32(0xFFFFFFFF));
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512, __m512) const noexcept
+        {
+            return (__mmask16)0xFFFF;
+        }
+    #endif
 };
 
 
@@ -304,6 +320,20 @@ struct SL_DepthFuncLT
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+        }
+    #endif
 };
 
 /*-------------------------------------
@@ -344,6 +374,20 @@ struct SL_DepthFuncLE
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ);
+        }
+    #endif
 };
 
 /*-------------------------------------
@@ -384,6 +428,20 @@ struct SL_DepthFuncGT
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+        }
+    #endif
 };
 
 /*-------------------------------------
@@ -424,6 +482,20 @@ struct SL_DepthFuncGE
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ);
+        }
+    #endif
 };
 
 /*-------------------------------------
@@ -464,6 +536,20 @@ struct SL_DepthFuncEQ
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+        }
+    #endif
 };
 
 /*-------------------------------------
@@ -504,6 +590,20 @@ struct SL_DepthFuncNE
         }
 
     #endif
+
+    #if SL_AVX2_KERNELS_ENABLED
+        SL_TARGET_AVX2 inline LS_INLINE __m256 operator()(__m256 a, __m256 b) const noexcept
+        {
+            return _mm256_cmp_ps(a, b, _CMP_NEQ_OQ);
+        }
+    #endif
+
+    #if SL_AVX512_KERNELS_ENABLED
+        SL_TARGET_AVX512 inline LS_INLINE __mmask16 operator()(__m512 a, __m512 b) const noexcept
+        {
+            return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_OQ);
+        }
+    #endif
 };
 
 
@@ -518,6 +618,9 @@ enum SL_ShaderLimits
     SL_SHADER_MAX_VARYING_VECTORS = 4,
     SL_SHADER_MAX_FRAG_OUTPUTS    = 4,
 
+    // Number of fragments shaded by each call to a wide fragment shader.
+    SL_SHADER_FRAG_BLOCK_SIZE     = SL_FRAG_BLOCK_SIZE,
+
     // Maximum number of fragments that get queued before being placed on a
     // framebuffer.
     #if !SL_CONSERVE_MEMORY
@@ -529,8 +632,18 @@ enum SL_ShaderLimits
     // Maximum number of vertex groups which get binned before being sent to a
     // fragment processor.
     SL_SHADER_MAX_BINNED_PRIMS    = 8192,
+
+    // Maximum number of screen-space tiles which can be binned (enough for a
+    // 4096x4096 framebuffer with 64x64 tiles). Framebuffers with more tiles
+    // fall back to scanline-interleaved rasterization.
+    SL_SHADER_MAX_BIN_TILES       = 4096,
+
+    // Maximum number of tile-to-primitive references per batch of bins.
+    SL_SHADER_MAX_TILE_REFS       = SL_SHADER_MAX_BINNED_PRIMS * 4,
 };
 
+static_assert(SL_SHADER_FRAG_BLOCK_SIZE == 4 || SL_SHADER_FRAG_BLOCK_SIZE == 8, "SL_FRAG_BLOCK_SIZE must be either 4 or 8.");
+
 
 
 /*-----------------------------------------------------------------------------
@@ -655,8 +768,11 @@ struct alignas(sizeof(ls::math::vec4)*2) SL_FragmentBin
     // 8 bytes
     uint_fast64_t primIndex;
 
-    // 8 bytes
-    uint_fast64_t pad0;
+    // 2-byte integers * 4 elements = 8 bytes
+    // Inclusive range of screen-space tiles overlapped by a primitive, stored
+    // as {minX, minY, maxX, maxY}. Used by points, and by triangles with
+    // SL_TILED_BINNING_ENABLED.
+    uint16_t mTileBounds[4];
 
     // 16 bytes of padding to reduce false-sharing
     ls::math::vec4 pad1;
@@ -668,6 +784,34 @@ static_assert(sizeof(SL_FragmentBin) == sizeof(ls::math::vec4)*20, "Unexpected s
 
 
 
+/*-----------------------------------------------------------------------------
+ * Screen-space tile lists
+ *
+ * Generated from the sorted list of bin IDs before rasterization. Each tile
+ * references a contiguous range of "binIds," preserving the sorting order of
+ * its primitives. Rasterizers claim whole tiles through "nextTile," with the
+ * most expensive tiles handed out first.
+-----------------------------------------------------------------------------*/
+struct alignas(64) SL_BinTileMap
+{
+    // Index of the next entry in "activeTiles" to be rasterized
+    alignas(64) std::atomic_uint_fast32_t nextTile;
+
+    alignas(64) uint32_t numTilesX;
+    uint32_t numTilesY;
+
+    // Set to 0 if the current bins could not be tiled
+    uint32_t numActiveTiles;
+
+    uint32_t tileOffsets[SL_SHADER_MAX_BIN_TILES];
+    uint32_t tileCounts[SL_SHADER_MAX_BIN_TILES];
+    uint32_t activeTiles[SL_SHADER_MAX_BIN_TILES];
+    uint32_t tempTiles[SL_SHADER_MAX_BIN_TILES]; // scratch space for sorting
+    uint32_t binIds[SL_SHADER_MAX_TILE_REFS];
+};
+
+
+
 /*-----------------------------------------------------------------------------
  * Helper structure to put a pixel on the screen
 -----------------------------------------------------------------------------*/
@@ -687,7 +831,10 @@ struct SL_FragCoord
     union
     {
         ls::math::vec4 bc[SL_SHADER_MAX_QUEUED_FRAGS]; // 32*4
-        float lineInterp[SL_SHADER_MAX_QUEUED_FRAGS]; // 32*4
+
+        // Lines store the interpolation between their vertices in X and the
+        // fraction of a pixel they cover in Y.
+        ls::math::vec2 lineInterp[SL_SHADER_MAX_QUEUED_FRAGS]; // 32*2*4
     };
 
     SL_FragCoordXYZ coord[SL_SHADER_MAX_QUEUED_FRAGS];
@@ -0,0 +1,142 @@
+
+#ifndef SL_SKINNING_HPP
+#define SL_SKINNING_HPP
+
+#include <cstddef> // size_t
+
+#include "lightsky/math/mat4.h"
+
+#include "softlight/SL_Mesh.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Forward Declarations
+-----------------------------------------------------------------------------*/
+class SL_Context;
+
+
+
+/*-----------------------------------------------------------------------------
+ * CPU Skinning
+ *
+ * Skinned meshes are normally transformed inside a vertex shader, which
+ * repeats the same bone blending for every draw and every triangle sharing a
+ * vertex. Pre-skinning a mesh once per frame writes the transformed vertices
+ * into a separate vertex buffer so all later passes can use a regular,
+ * non-skinned vertex shader.
+-----------------------------------------------------------------------------*/
+enum SL_SkinningMode
+{
+    // Blend the bone matrices of each vertex (linear blend skinning)
+    SL_SKINNING_LINEAR,
+
+    // Blend bones as dual quaternions. This preserves volume around twisting
+    // joints but requires bone matrices to be rigid (no scaling).
+    SL_SKINNING_DUAL_QUATERNION,
+
+    SL_SKINNING_DEFAULT = SL_SKINNING_LINEAR
+};
+
+
+
+enum : unsigned
+{
+    // Use for meshes without normals
+    SL_SKINNING_NO_BINDING = ~0u
+};
+
+
+
+/*-------------------------------------
+ * A skinned copy of a mesh.
+ *
+ * The copy's VAO has the same bindings as the original, but references a
+ * separate vertex buffer which receives the skinned positions and normals.
+ * This buffer only holds the range of vertices used by the mesh. Bindings are
+ * rebased so the original vertex IDs and index buffer can still be used. All
+ * other vertex attributes are copied once, during initialization.
+-------------------------------------*/
+struct SL_SkinnedMesh
+{
+    // Mesh to draw after skinning, uses the skinned VAO
+    SL_Mesh mesh;
+
+    // Original (bind-pose) vertices
+    size_t srcVaoId;
+
+    // Skinned vertices
+    size_t vboId;
+
+    // Range of vertices referenced by the mesh
+    size_t vertBegin;
+    size_t vertEnd;
+
+    // VAO bindings used for skinning
+    unsigned positionBinding;
+    unsigned normalBinding;
+    unsigned boneIdBinding;
+    unsigned boneWeightBinding;
+};
+
+
+
+/*-------------------------------------
+ * Create a skinned copy of a mesh.
+ *
+ * Positions must contain at least 3 floats. Normals can contain either 3
+ * floats or a packed 2_10_10_10 integer. Bone IDs must contain 4 16-bit or
+ * 32-bit integers and bone weights must contain 4 half-floats or floats.
+ * These match the attributes generated by the scene loader.
+ *
+ * The skinned VAO and VBO are created within, and owned by, the context.
+ *
+ * Returns 0 on success, -1 if the mesh is not a triangle mesh or contains no
+ * vertices, -2 if a binding is missing or has an unsupported format, or -3
+ * if the skinned vertex buffer could not be allocated. Nothing is added to
+ * the context on failure.
+-------------------------------------*/
+int sl_init_skinned_mesh(
+    SL_Context& context,
+    const SL_Mesh& srcMesh,
+    unsigned positionBinding,
+    unsigned normalBinding,
+    unsigned boneIdBinding,
+    unsigned boneWeightBinding,
+    SL_SkinnedMesh& outMesh
+) noexcept;
+
+
+
+/*-------------------------------------
+ * Release the skinned VAO and VBO of a mesh.
+ *
+ * Objects at the end of the context's lists are destroyed. Any others are
+ * only emptied, so the IDs of unrelated VAOs and VBOs remain valid.
+-------------------------------------*/
+void sl_terminate_skinned_mesh(SL_Context& context, SL_SkinnedMesh& mesh) noexcept;
+
+
+
+/*-------------------------------------
+ * Skin the positions and normals of a mesh using the context's threads.
+ *
+ * "pBones" contains the skeleton of the mesh, indexed by the mesh's bone IDs.
+ * When skinning a mesh loaded into a scene graph, this is
+ * "graph.mModelMatrices.data() + graph.mMeshSkeletons[meshId].index", after
+ * the scene graph has been updated.
+ *
+ * Skinned vertices remain in the mesh's model space. This waits for all
+ * submitted draws to finish before overwriting the skinned vertex buffer.
+-------------------------------------*/
+void sl_skin_mesh(
+    SL_Context& context,
+    const SL_SkinnedMesh& mesh,
+    const ls::math::mat4* pBones,
+    size_t numBones,
+    SL_SkinningMode mode = SL_SKINNING_DEFAULT
+) noexcept;
+
+
+
+#endif /* SL_SKINNING_HPP */
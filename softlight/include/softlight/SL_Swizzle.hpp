@@ -39,6 +39,9 @@ enum class SL_TexelOrder
 
 /*-----------------------------------------------------------------------------
  * Swizzle a 2D lookup
+ *
+ * Images are stored as if padded to a whole number of chunks, so rows of
+ * chunks never overlap when a dimension isn't a multiple of the chunk size.
 -----------------------------------------------------------------------------*/
 template <uint_fast32_t texels_per_chunk, uint_fast32_t shifts_per_chunk = sl_swizzle_ctz(texels_per_chunk)>
 inline uint_fast32_t LS_INLINE sl_swizzle_2d_index(uint_fast32_t x, uint_fast32_t y, uint_fast32_t imgWidth) noexcept
@@ -49,7 +52,8 @@ inline uint_fast32_t LS_INLINE sl_swizzle_2d_index(uint_fast32_t x, uint_fast32_
     constexpr uint_fast32_t idsPerBlock = texels_per_chunk*texels_per_chunk;
     const uint_fast32_t     tileX       = x >> shifts_per_chunk;
     const uint_fast32_t     tileY       = y >> shifts_per_chunk;
-    const uint_fast32_t     tileId      = (tileX + (imgWidth >> shifts_per_chunk) * tileY);
+    const uint_fast32_t     tilesX      = (imgWidth + (texels_per_chunk-1u)) >> shifts_per_chunk;
+    const uint_fast32_t     tileId      = (tileX + tilesX * tileY);
 
     // We're only getting the remainder of a power of 2. Use bit operations
     // instead of a modulo.
@@ -63,7 +67,7 @@ inline uint_fast32_t LS_INLINE sl_swizzle_2d_index(uint_fast32_t x, uint_fast32_
 
 
 /*-----------------------------------------------------------------------------
- * Swizzle a 3D lookup
+ * Swizzle a 3D lookup, padded the same as a 2D lookup
 -----------------------------------------------------------------------------*/
 template <uint_fast32_t texels_per_chunk, uint_fast32_t shifts_per_chunk = sl_swizzle_ctz(texels_per_chunk)>
 inline uint_fast32_t LS_INLINE sl_swizzle_3d_index(uint_fast32_t x, uint_fast32_t y, uint_fast32_t z, uint_fast32_t imgWidth, uint_fast32_t imgHeight) noexcept
@@ -77,7 +81,9 @@ inline uint_fast32_t LS_INLINE sl_swizzle_3d_index(uint_fast32_t x, uint_fast32_
     const uint_fast32_t tileX       = x >> shifts_per_chunk;
     const uint_fast32_t tileY       = y >> shifts_per_chunk;
     const uint_fast32_t tileZ       = z >> shifts_per_chunk;
-    const uint_fast32_t tileId      = tileX + ((imgWidth >> shifts_per_chunk) * (tileY + ((imgHeight >> shifts_per_chunk) * tileZ)));
+    const uint_fast32_t tilesX      = (imgWidth + (texels_per_chunk-1u)) >> shifts_per_chunk;
+    const uint_fast32_t tilesY      = (imgHeight + (texels_per_chunk-1u)) >> shifts_per_chunk;
+    const uint_fast32_t tileId      = tileX + (tilesX * (tileY + (tilesY * tileZ)));
 
     const uint_fast32_t innerX      = x & (texels_per_chunk-1u);
     const uint_fast32_t innerY      = y & (texels_per_chunk-1u);
@@ -0,0 +1,49 @@
+
+#ifndef SL_TASK_PROCESSOR_HPP
+#define SL_TASK_PROCESSOR_HPP
+
+#include <cstdint>
+
+
+
+/*-----------------------------------------------------------------------------
+ * Function run by each thread of a task. The thread ID and number of threads
+ * can be used to partition work between threads.
+-----------------------------------------------------------------------------*/
+typedef void (*SL_TaskFunc)(void* pUserData, uint32_t threadId, uint32_t numThreads);
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Task Processor runs a user-provided function on a worker
+ * thread. This allows work outside of the rendering pipeline (such as scene
+ * or animation updates) to reuse the threads of a processor pool.
+-----------------------------------------------------------------------------*/
+struct SL_TaskProcessor
+{
+    // 32 bits
+    uint16_t mThreadId;
+    uint16_t mNumThreads;
+
+    // 64-128 bits
+    SL_TaskFunc mTask;
+    void* mUserData;
+
+    // 160-288 bits total, 20-36 bytes
+
+    void execute() noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Run the task
+-------------------------------------*/
+inline void SL_TaskProcessor::execute() noexcept
+{
+    mTask(mUserData, mThreadId, mNumThreads);
+}
+
+
+
+#endif /* SL_TASK_PROCESSOR_HPP */
@@ -52,6 +52,62 @@ void sl_reset(SL_TextureView& view) noexcept;
 
 
 
+/*-------------------------------------
+ * Map a coordinate to a texel index within a texture view
+ *
+ * This is the only mapping used to read or write texels. Swizzled views
+ * whose dimensions are not a multiple of SL_TEXELS_PER_CHUNK (such as most
+ * mip levels) are indexed as if they were padded to whole chunks. Views
+ * with a depth of 1 always use the 2D layout.
+-------------------------------------*/
+template <SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE ptrdiff_t sl_texture_view_index(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y) noexcept;
+
+template <SL_TexelOrder order = SL_TexelOrder::ORDERED>
+inline LS_INLINE ptrdiff_t sl_texture_view_index(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y, uint_fast32_t z) noexcept;
+
+template <>
+inline LS_INLINE ptrdiff_t sl_texture_view_index<SL_TexelOrder::ORDERED>(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y) noexcept
+{
+    return (ptrdiff_t)(x + (uint_fast32_t)view.width * y);
+}
+
+template <>
+inline LS_INLINE ptrdiff_t sl_texture_view_index<SL_TexelOrder::SWIZZLED>(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y) noexcept
+{
+    return (ptrdiff_t)sl_swizzle_2d_index<SL_TEXELS_PER_CHUNK, SL_TEXEL_SHIFTS_PER_CHUNK>(x, y, view.width);
+}
+
+template <>
+inline LS_INLINE ptrdiff_t sl_texture_view_index<SL_TexelOrder::ORDERED>(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y, uint_fast32_t z) noexcept
+{
+    return (ptrdiff_t)(x + (uint_fast32_t)view.width * (y + (uint_fast32_t)view.height * z));
+}
+
+template <>
+inline LS_INLINE ptrdiff_t sl_texture_view_index<SL_TexelOrder::SWIZZLED>(const SL_TextureView& view, uint_fast32_t x, uint_fast32_t y, uint_fast32_t z) noexcept
+{
+    if (view.depth <= 1)
+    {
+        return (ptrdiff_t)sl_swizzle_2d_index<SL_TEXELS_PER_CHUNK, SL_TEXEL_SHIFTS_PER_CHUNK>(x, y, view.width);
+    }
+
+    return (ptrdiff_t)sl_swizzle_3d_index<SL_TEXELS_PER_CHUNK, SL_TEXEL_SHIFTS_PER_CHUNK>(x, y, z, view.width, view.height);
+}
+
+
+
+/*-------------------------------------
+ * Maximum number of mip levels in a texture, including the base level
+ * (enough for 65535x65535 textures).
+-------------------------------------*/
+enum SL_TextureLimits : uint32_t
+{
+    SL_TEXTURE_MAX_LEVELS = 16
+};
+
+
+
 /*-------------------------------------
  * Create a Texture view from pre-supplied data
 -------------------------------------*/
@@ -79,6 +135,14 @@ class alignas(sizeof(uint64_t)) SL_Texture
   private:
     SL_TextureView mView;
 
+    // Number of levels available, including the base level
+    uint32_t mNumLevels;
+
+    // Storage for mip levels 1 through (mNumLevels-1)
+    SL_TextureView mMips[SL_TEXTURE_MAX_LEVELS-1];
+
+    void terminate_levels() noexcept;
+
   public:
     ~SL_Texture() noexcept;
 
@@ -124,6 +188,14 @@ class alignas(sizeof(uint64_t)) SL_Texture
 
     void terminate() noexcept;
 
+    int init_levels(uint32_t numLevels = SL_TEXTURE_MAX_LEVELS) noexcept;
+
+    uint32_t num_levels() const noexcept;
+
+    const SL_TextureView& level_view(uint32_t level) const noexcept;
+
+    SL_TextureView& level_view(uint32_t level) noexcept;
+
     SL_ColorDataType type() const noexcept;
 
     const void* data() const noexcept;
@@ -189,7 +261,7 @@ class alignas(sizeof(uint64_t)) SL_Texture
 template <>
 inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::ORDERED>(uint_fast32_t x, uint_fast32_t y) const noexcept
 {
-    return (ptrdiff_t)(x + (uint_fast32_t)mView.width * y);
+    return sl_texture_view_index<SL_TexelOrder::ORDERED>(mView, x, y);
 }
 
 
@@ -197,7 +269,7 @@ inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::ORDERED>(ui
 template <>
 inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::SWIZZLED>(uint_fast32_t x, uint_fast32_t y) const noexcept
 {
-    return (ptrdiff_t)sl_swizzle_2d_index<SL_TEXELS_PER_CHUNK, SL_TEXEL_SHIFTS_PER_CHUNK>(x, y, mView.width);
+    return sl_texture_view_index<SL_TexelOrder::SWIZZLED>(mView, x, y);
 }
 
 
@@ -219,7 +291,7 @@ inline LS_INLINE ls::math::vec4_t<ptrdiff_t> SL_Texture::map_coordinates(uint_fa
 template <>
 inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::ORDERED>(uint_fast32_t x, uint_fast32_t y, uint_fast32_t z) const noexcept
 {
-    return (ptrdiff_t)(x + mView.width * (y + mView.height * z));
+    return sl_texture_view_index<SL_TexelOrder::ORDERED>(mView, x, y, z);
 }
 
 
@@ -227,7 +299,7 @@ inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::ORDERED>(ui
 template <>
 inline LS_INLINE ptrdiff_t SL_Texture::map_coordinate<SL_TexelOrder::SWIZZLED>(uint_fast32_t x, uint_fast32_t y, uint_fast32_t z) const noexcept
 {
-    return (ptrdiff_t)sl_swizzle_3d_index<SL_TEXELS_PER_CHUNK, SL_TEXEL_SHIFTS_PER_CHUNK>(x, y, z, mView.width, mView.height);
+    return sl_texture_view_index<SL_TexelOrder::SWIZZLED>(mView, x, y, z);
 }
 
 
@@ -258,7 +330,9 @@ inline LS_INLINE ls::math::vec4_t<ptrdiff_t> SL_Texture::map_coordinates<SL_Texe
     const uint_fast32_t tileX3      = x3 >> SL_TEXEL_SHIFTS_PER_CHUNK;
     const uint_fast32_t tileY       = y >> SL_TEXEL_SHIFTS_PER_CHUNK;
     const uint_fast32_t tileZ       = z >> SL_TEXEL_SHIFTS_PER_CHUNK;
-    const uint_fast32_t tileShift   = (mView.width >> SL_TEXEL_SHIFTS_PER_CHUNK) * (tileY + ((mView.height >> SL_TEXEL_SHIFTS_PER_CHUNK) * tileZ));
+    const uint_fast32_t tilesX      = (mView.width + (SL_TEXELS_PER_CHUNK-1u)) >> SL_TEXEL_SHIFTS_PER_CHUNK;
+    const uint_fast32_t tilesY      = (mView.height + (SL_TEXELS_PER_CHUNK-1u)) >> SL_TEXEL_SHIFTS_PER_CHUNK;
+    const uint_fast32_t tileShift   = tilesX * (tileY + (tilesY * tileZ));
     const uint_fast32_t tileId0     = tileX0 + tileShift;
     const uint_fast32_t tileId1     = tileX1 + tileShift;
     const uint_fast32_t tileId2     = tileX2 + tileShift;
@@ -353,6 +427,36 @@ inline LS_INLINE uint32_t SL_Texture::channels() const noexcept
 
 
 
+/*-------------------------------------
+ * Get the number of mip levels, including the base level
+-------------------------------------*/
+inline LS_INLINE uint32_t SL_Texture::num_levels() const noexcept
+{
+    return mNumLevels;
+}
+
+
+
+/*-------------------------------------
+ * Get the data of a single mip level (const)
+-------------------------------------*/
+inline LS_INLINE const SL_TextureView& SL_Texture::level_view(uint32_t level) const noexcept
+{
+    return level ? mMips[level-1u] : mView;
+}
+
+
+
+/*-------------------------------------
+ * Get the data of a single mip level
+-------------------------------------*/
+inline LS_INLINE SL_TextureView& SL_Texture::level_view(uint32_t level) noexcept
+{
+    return level ? mMips[level-1u] : mView;
+}
+
+
+
 /*-------------------------------------
  * Get the texture mView.type
 -------------------------------------*/
@@ -0,0 +1,75 @@
+
+#ifndef SL_TEXTURE_UPLOAD_PROCESSOR_HPP
+#define SL_TEXTURE_UPLOAD_PROCESSOR_HPP
+
+#include <cstdint>
+
+#include "softlight/SL_Color.hpp" // SL_ColorDataType
+#include "softlight/SL_Swizzle.hpp" // SL_TexelOrder
+
+
+
+struct SL_TextureView;
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief The Texture Upload Processor copies tightly-packed, row-ordered
+ * texels into a texture, converting their color type and texel order along
+ * the way. Bands of SL_TEXELS_PER_CHUNK rows are interleaved between threads
+ * so each swizzled chunk is only written by one thread.
+ *
+ * Color types can only be converted by adding or removing channels of the
+ * same component type. Packed color types must match exactly.
+-----------------------------------------------------------------------------*/
+struct SL_TextureUploadProcessor
+{
+    // 32 bits
+    uint16_t mThreadId;
+    uint16_t mNumThreads;
+
+    // 32 bits
+    SL_TexelOrder mTexelOrder;
+
+    // 8 bits
+    SL_ColorDataType mSrcType;
+
+    // 64-128 bits
+    const char* mSrcTexels;
+    SL_TextureView* mDstTex;
+
+    // 136-200 bits total, 17-25 bytes
+
+    // Copy runs of SL_TEXELS_PER_CHUNK texels into the destination texture
+    template<typename src_type, typename dst_type, typename value_type, SL_TexelOrder order>
+    void upload() noexcept;
+
+    template<typename src_type, typename dst_type, typename value_type>
+    void upload_texels() noexcept;
+
+    template<typename dst_type, typename value_type>
+    void upload_from() noexcept;
+
+    void execute() noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Determine if texels of one color type can be uploaded to a texture of
+ * another.
+-------------------------------------*/
+constexpr bool sl_texture_upload_supported(SL_ColorDataType srcType, SL_ColorDataType dstType) noexcept
+{
+    // Uncompressed types are grouped by channel count, with their component
+    // types always listed in the same order.
+    return (srcType == dstType) || (
+        !sl_is_compressed_color(srcType) &&
+        !sl_is_compressed_color(dstType) &&
+        (srcType % SL_COLOR_RG_8U) == (dstType % SL_COLOR_RG_8U)
+    );
+}
+
+
+
+#endif /* SL_TEXTURE_UPLOAD_PROCESSOR_HPP */
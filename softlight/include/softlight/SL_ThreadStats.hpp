@@ -0,0 +1,139 @@
+#ifndef SL_THREAD_STATS_HPP
+#define SL_THREAD_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "softlight/SL_Config.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Constants
+-----------------------------------------------------------------------------*/
+enum SL_ThreadStatsLimits : uint32_t
+{
+    // Idle-time histogram buckets, 10% each
+    SL_THREAD_STATS_BUCKETS = 10
+};
+
+
+
+/**----------------------------------------------------------------------------
+ * @brief Per-thread busy/idle counters used to measure how evenly rendering
+ * work is distributed across the processor pool.
+ *
+ * Counters are only updated when SL_PROFILE_THREAD_BALANCE is enabled.
+-----------------------------------------------------------------------------*/
+struct alignas(64) SL_ThreadStats
+{
+    uint64_t numDraws;
+    uint64_t busyNanos;
+    uint64_t idleNanos;
+
+    // Number of draws, bucketed by the percentage of time this thread spent
+    // waiting on other threads (0-9%, 10-19%, ..., 90-100%).
+    uint64_t idleHistogram[SL_THREAD_STATS_BUCKETS];
+
+    // Intermediate values for the current draw
+    uint64_t drawStart;
+    uint64_t drawIdle;
+};
+
+
+
+/*-------------------------------------
+ * Retrieve a timestamp for profiling (0 when profiling is disabled)
+-------------------------------------*/
+inline uint64_t sl_thread_stats_timestamp() noexcept
+{
+    #if SL_PROFILE_THREAD_BALANCE
+        const auto&& now = std::chrono::steady_clock::now().time_since_epoch();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    #else
+        return 0;
+    #endif
+}
+
+
+
+/*-------------------------------------
+ * Reset all counters
+-------------------------------------*/
+inline void sl_thread_stats_reset(SL_ThreadStats& stats) noexcept
+{
+    stats.numDraws  = 0;
+    stats.busyNanos = 0;
+    stats.idleNanos = 0;
+    stats.drawStart = 0;
+    stats.drawIdle  = 0;
+
+    for (uint64_t& bucket : stats.idleHistogram)
+    {
+        bucket = 0;
+    }
+}
+
+
+
+/*-------------------------------------
+ * Start timing a draw
+-------------------------------------*/
+inline void sl_thread_stats_begin_draw(SL_ThreadStats* pStats) noexcept
+{
+    #if SL_PROFILE_THREAD_BALANCE
+        if (pStats)
+        {
+            pStats->drawStart = sl_thread_stats_timestamp();
+            pStats->drawIdle  = 0;
+        }
+    #else
+        (void)pStats;
+    #endif
+}
+
+
+
+/*-------------------------------------
+ * Accumulate time spent waiting since "idleStart"
+-------------------------------------*/
+inline void sl_thread_stats_add_idle(SL_ThreadStats* pStats, uint64_t idleStart) noexcept
+{
+    #if SL_PROFILE_THREAD_BALANCE
+        if (pStats)
+        {
+            pStats->drawIdle += sl_thread_stats_timestamp() - idleStart;
+        }
+    #else
+        (void)pStats;
+        (void)idleStart;
+    #endif
+}
+
+
+
+/*-------------------------------------
+ * Finish timing a draw
+-------------------------------------*/
+inline void sl_thread_stats_end_draw(SL_ThreadStats* pStats) noexcept
+{
+    #if SL_PROFILE_THREAD_BALANCE
+        if (pStats)
+        {
+            const uint64_t total  = sl_thread_stats_timestamp() - pStats->drawStart;
+            const uint64_t idle   = pStats->drawIdle < total ? pStats->drawIdle : total;
+            const uint64_t bucket = total ? ((idle * SL_THREAD_STATS_BUCKETS) / total) : 0;
+
+            pStats->numDraws  += 1;
+            pStats->busyNanos += total - idle;
+            pStats->idleNanos += idle;
+            pStats->idleHistogram[bucket < SL_THREAD_STATS_BUCKETS ? bucket : (SL_THREAD_STATS_BUCKETS-1)] += 1;
+        }
+    #else
+        (void)pStats;
+    #endif
+}
+
+
+
+#endif /* SL_THREAD_STATS_HPP */
@@ -2,6 +2,7 @@
 #ifndef SL_TRI_PROCESSOR_HPP
 #define SL_TRI_PROCESSOR_HPP
 
+#include "softlight/SL_CpuFeatures.hpp" // SL_TARGET_SSE41
 #include "softlight/SL_VertexProcessor.hpp"
 
 
@@ -22,6 +23,14 @@ class SL_TriProcessor final : public SL_VertexProcessor
         const SL_TransformedVert& c
     ) noexcept;
 
+    template <bool usingIndices, class TriSetup>
+    void process_verts_impl(
+        const SL_Mesh& m,
+        size_t instanceId,
+        const ls::math::mat4_t<float>& scissorMat,
+        const ls::math::vec4_t<float>& viewportDims
+    ) noexcept;
+
     template <bool usingIndices>
     void process_verts(
         const SL_Mesh& m,
@@ -30,6 +39,17 @@ class SL_TriProcessor final : public SL_VertexProcessor
         const ls::math::vec4_t<float>& viewportDims
     ) noexcept;
 
+    #if SL_SSE41_DISPATCH_ENABLED
+    // Requires a CPU with SL_CPU_FEATURE_SSE4_1
+    template <bool usingIndices>
+    SL_TARGET_SSE41 void process_verts_sse41(
+        const SL_Mesh& m,
+        size_t instanceId,
+        const ls::math::mat4_t<float>& scissorMat,
+        const ls::math::vec4_t<float>& viewportDims
+    ) noexcept;
+    #endif /* SL_SSE41_DISPATCH_ENABLED */
+
   public:
     virtual ~SL_TriProcessor() noexcept override {}
 
@@ -56,4 +76,24 @@ extern template void SL_TriProcessor::process_verts<false>(
 
 
 
+#if SL_SSE41_DISPATCH_ENABLED
+extern template void SL_TriProcessor::process_verts_sse41<true>(
+    const SL_Mesh&,
+    size_t,
+    const ls::math::mat4_t<float>&,
+    const ls::math::vec4_t<float>&
+) noexcept;
+
+
+
+extern template void SL_TriProcessor::process_verts_sse41<false>(
+    const SL_Mesh&,
+    size_t,
+    const ls::math::mat4_t<float>&,
+    const ls::math::vec4_t<float>&
+) noexcept;
+#endif /* SL_SSE41_DISPATCH_ENABLED */
+
+
+
 #endif /* SL_TRI_PROCESSOR_HPP */
@@ -3,6 +3,7 @@
 #define SL_TRI_RASTERIZER_HPP
 
 #include "softlight/SL_Config.hpp"
+#include "softlight/SL_CpuFeatures.hpp" // SL_TARGET_AVX512
 #include "softlight/SL_FragmentProcessor.hpp"
 
 
@@ -56,6 +57,21 @@ struct SL_TriRasterizer final : public SL_FragmentProcessor
     template <class DepthCmpFunc, typename depth_type>
     void render_triangle_simd(const SL_TextureView& depthBuffer) const noexcept;
 
+    #if SL_AVX2_KERNELS_ENABLED
+        // Requires a CPU with SL_CPU_FEATURE_AVX2
+        template <class DepthCmpFunc, typename depth_type>
+        SL_TARGET_AVX2 void render_triangle_simd8(const SL_TextureView& depthBuffer) const noexcept;
+
+        #if SL_AVX512_KERNELS_ENABLED
+            // Requires a CPU with SL_CPU_FEATURE_AVX512
+            template <class DepthCmpFunc, typename depth_type>
+            SL_TARGET_AVX512 void render_triangle_simd16(const SL_TextureView& depthBuffer) const noexcept;
+        #endif
+    #endif
+
+    template <class DepthCmpFunc, typename depth_type>
+    void render_triangle_tiled(const SL_TextureView& depthBuffer) const noexcept;
+
     template <class DepthCmpFunc>
     void dispatch_bins() noexcept;
 
@@ -154,6 +170,100 @@ extern template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncOFF, dou
 
 
 
+#if SL_AVX2_KERNELS_ENABLED
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+
+
+
+#if SL_AVX512_KERNELS_ENABLED
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+#endif /* SL_AVX512_KERNELS_ENABLED */
+#endif /* SL_AVX2_KERNELS_ENABLED */
+
+
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+extern template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+
+
+
 extern template void SL_TriRasterizer::dispatch_bins<SL_DepthFuncLT>() noexcept;
 extern template void SL_TriRasterizer::dispatch_bins<SL_DepthFuncLE>() noexcept;
 extern template void SL_TriRasterizer::dispatch_bins<SL_DepthFuncGT>() noexcept;
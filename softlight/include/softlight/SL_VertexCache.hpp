@@ -2,6 +2,7 @@
 #ifndef SL_VERTEX_CACHE_HPP
 #define SL_VERTEX_CACHE_HPP
 
+#include "lightsky/utils/Assertions.h" // LS_DEBUG_ASSERT
 #include "lightsky/utils/IndexedCache.hpp"
 #include "lightsky/utils/LRUCache.hpp"
 #include "lightsky/utils/LRU8WayCache.hpp"
@@ -61,4 +62,144 @@ inline LS_INLINE void sl_cache_query_or_update(SL_PTVCache& cache, size_t key, S
 
 
 
+/*-----------------------------------------------------------------------------
+ * Post-Transform Vertex Batch
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Smallest power of two which is >= n
+-------------------------------------*/
+constexpr size_t sl_vertex_batch_pow2(size_t n, size_t p = 1) noexcept
+{
+    return (p >= n) ? p : sl_vertex_batch_pow2(n, p << 1u);
+}
+
+
+
+enum SL_PTVBatchLimits : uint32_t
+{
+    // Largest number of indices a triangle chunk can reference
+    SL_VERTEX_BATCH_MAX_INDICES = SL_VERTEX_CHUNK_SIZE * 3,
+
+    // Keep the hash table at most half full
+    SL_VERTEX_BATCH_HASH_SIZE = (uint32_t)sl_vertex_batch_pow2(SL_VERTEX_BATCH_MAX_INDICES * 2u),
+
+    SL_VERTEX_BATCH_EMPTY_SLOT = 0xFFFF
+};
+
+static_assert(SL_VERTEX_BATCH_MAX_INDICES < SL_VERTEX_BATCH_EMPTY_SLOT, "Vertex batch slots must fit in 16 bits.");
+
+
+
+/**
+ * @brief Post-Transform Vertex Batch
+ *
+ * Maps the vertex indices of a single primitive chunk onto a compact list of
+ * unique vertices so each one only passes through the vertex shader once.
+ * Lookups use an open-addressed hash table with linear probing.
+ */
+class SL_PTVBatch
+{
+  private:
+    uint_fast32_t mNumUnique;
+
+    uint16_t mHashSlots[SL_VERTEX_BATCH_HASH_SIZE];
+
+    // Hash table position of each slot, used to clear the table quickly
+    uint16_t mHashPositions[SL_VERTEX_BATCH_MAX_INDICES];
+
+    size_t mUniqueIds[SL_VERTEX_BATCH_MAX_INDICES];
+
+  public:
+    SL_PTVBatch() noexcept;
+
+    void reset() noexcept;
+
+    uint_fast32_t insert(size_t vertId) noexcept;
+
+    uint_fast32_t size() const noexcept;
+
+    size_t vertex_id(uint_fast32_t slot) const noexcept;
+};
+
+
+
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+inline SL_PTVBatch::SL_PTVBatch() noexcept :
+    mNumUnique{0}
+{
+    for (uint_fast32_t i = 0; i < SL_VERTEX_BATCH_HASH_SIZE; ++i)
+    {
+        mHashSlots[i] = SL_VERTEX_BATCH_EMPTY_SLOT;
+    }
+}
+
+
+
+/*-------------------------------------
+ * Begin a new batch
+-------------------------------------*/
+inline LS_INLINE void SL_PTVBatch::reset() noexcept
+{
+    for (uint_fast32_t i = 0; i < mNumUnique; ++i)
+    {
+        mHashSlots[mHashPositions[i]] = SL_VERTEX_BATCH_EMPTY_SLOT;
+    }
+
+    mNumUnique = 0;
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the slot of a vertex index, adding it if it hasn't been seen yet
+-------------------------------------*/
+inline LS_INLINE uint_fast32_t SL_PTVBatch::insert(size_t vertId) noexcept
+{
+    LS_DEBUG_ASSERT(mNumUnique < SL_VERTEX_BATCH_MAX_INDICES);
+
+    uint_fast32_t h = (((uint_fast32_t)vertId * 0x9E3779B1u) >> 16u) & (SL_VERTEX_BATCH_HASH_SIZE-1u);
+
+    while (mHashSlots[h] != SL_VERTEX_BATCH_EMPTY_SLOT)
+    {
+        const uint_fast32_t slot = mHashSlots[h];
+        if (mUniqueIds[slot] == vertId)
+        {
+            return slot;
+        }
+
+        h = (h + 1u) & (SL_VERTEX_BATCH_HASH_SIZE-1u);
+    }
+
+    const uint_fast32_t slot = mNumUnique++;
+    mHashSlots[h]        = (uint16_t)slot;
+    mHashPositions[slot] = (uint16_t)h;
+    mUniqueIds[slot]     = vertId;
+
+    return slot;
+}
+
+
+
+/*-------------------------------------
+ * Number of unique vertices in the current batch
+-------------------------------------*/
+inline LS_INLINE uint_fast32_t SL_PTVBatch::size() const noexcept
+{
+    return mNumUnique;
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the vertex index stored in a slot
+-------------------------------------*/
+inline LS_INLINE size_t SL_PTVBatch::vertex_id(uint_fast32_t slot) const noexcept
+{
+    return mUniqueIds[slot];
+}
+
+
+
 #endif /* SL_VERTEX_CACHE_HPP */
@@ -31,10 +31,13 @@ union SL_BinCounter;
 template <typename data_t>
 union SL_BinCounterAtomic;
 
+struct SL_BinTileMap; // SL_ShaderUtil.hpp
 class SL_Context; // SL_Context.hpp
 struct SL_FragmentBin; // SL_ShaderProcessor.hpp
 struct SL_FragCoord;
+struct SL_MeshletCull; // SL_Meshlet.hpp
 class SL_Framebuffer; // SL_Framebuffer.hpp
+struct SL_ThreadStats; // SL_ThreadStats.hpp
 struct SL_PointRasterizer;
 struct SL_LineRasterizer;
 struct SL_Shader; // SL_Shader.hpp
@@ -84,6 +87,27 @@ class SL_VertexProcessor
 
     SL_FragmentBin* mFragBins;
     SL_FragCoord* mFragQueues;
+    SL_BinTileMap* mBinTiles;
+
+    // Shared counter used by all threads to claim chunks of primitives
+    SL_BinCounterAtomic<uint_fast64_t>* mVertChunks;
+
+    // Array of per-thread statistics, indexed by thread ID. May be NULL.
+    SL_ThreadStats* mThreadStats;
+
+    // Index of the first chunk in the current mesh, and the next chunk this
+    // thread will process.
+    size_t mChunkBase;
+    size_t mChunkId;
+
+    // Set when no other draw is in-flight, allowing the framebuffer's coarse
+    // depth tiles to be rebuilt before binning.
+    uint32_t mRebuildDepthTiles;
+
+    // Optional per-chunk culling data for triangle meshes, one entry per
+    // element of "mMeshes". Either the array or any of its entries may be
+    // NULL. Ignored for instanced draws.
+    const SL_MeshletCull* const* mMeshletCulls;
 
     virtual ~SL_VertexProcessor() noexcept = default;
     SL_VertexProcessor() noexcept = default;
@@ -95,6 +119,10 @@ class SL_VertexProcessor
     virtual void execute() noexcept = 0;
 
   protected:
+    void begin_draw() noexcept;
+
+    bool next_chunk(size_t elementBegin, size_t elementEnd, size_t vertsPerPrim, size_t& outBegin, size_t& outEnd) noexcept;
+
     template <typename RasterizerType>
     void flush_rasterizer() const noexcept;
 
@@ -7,6 +7,8 @@
 #include "lightsky/math/scalar_utils.h"
 #include "lightsky/math/vec4.h"
 
+#include "softlight/SL_Config.hpp" // SL_MAX_POINT_SIZE, SL_MAX_LINE_WIDTH
+
 
 
 /*-----------------------------------------------------------------------------
@@ -62,10 +64,28 @@ class SL_ViewportState
 
     ls::math::mat4_t<float> scissor_matrix(const float fboW, const float fboH) const noexcept;
 
+    void point_size(float size) noexcept;
+
+    constexpr float point_size() const noexcept;
+
+    void line_width(float width) noexcept;
+
+    constexpr float line_width() const noexcept;
+
+    void line_smoothing(bool smooth) noexcept;
+
+    constexpr bool line_smoothing() const noexcept;
+
   private:
     ls::math::vec4_t<int32_t> mViewport;
 
     ls::math::vec4_t<int32_t> mScissor;
+
+    float mPointSize;
+
+    float mLineWidth;
+
+    bool mLineSmoothing;
 };
 
 
@@ -78,7 +98,10 @@ class SL_ViewportState
 -------------------------------------*/
 constexpr SL_ViewportState::SL_ViewportState() noexcept :
     mViewport{0, 0, 65535, 65535},
-    mScissor{0, 0, 65535, 65535}
+    mScissor{0, 0, 65535, 65535},
+    mPointSize{1.f},
+    mLineWidth{1.f},
+    mLineSmoothing{false}
 {}
 
 
@@ -88,7 +111,10 @@ constexpr SL_ViewportState::SL_ViewportState() noexcept :
 -------------------------------------*/
 constexpr SL_ViewportState::SL_ViewportState(const SL_ViewportState& rs) noexcept :
     mViewport{rs.mViewport},
-    mScissor{rs.mScissor}
+    mScissor{rs.mScissor},
+    mPointSize{rs.mPointSize},
+    mLineWidth{rs.mLineWidth},
+    mLineSmoothing{rs.mLineSmoothing}
 {}
 
 
@@ -98,7 +124,10 @@ constexpr SL_ViewportState::SL_ViewportState(const SL_ViewportState& rs) noexcep
 -------------------------------------*/
 constexpr SL_ViewportState::SL_ViewportState(SL_ViewportState&& rs) noexcept :
     mViewport{rs.mViewport},
-    mScissor{rs.mScissor}
+    mScissor{rs.mScissor},
+    mPointSize{rs.mPointSize},
+    mLineWidth{rs.mLineWidth},
+    mLineSmoothing{rs.mLineSmoothing}
 {}
 
 
@@ -110,6 +139,9 @@ inline SL_ViewportState& SL_ViewportState::operator=(const SL_ViewportState& rs)
 {
     mViewport = rs.mViewport;
     mScissor = rs.mScissor;
+    mPointSize = rs.mPointSize;
+    mLineWidth = rs.mLineWidth;
+    mLineSmoothing = rs.mLineSmoothing;
 
     return *this;
 }
@@ -123,6 +155,9 @@ inline SL_ViewportState& SL_ViewportState::operator=(SL_ViewportState&& rs) noex
 {
     mViewport = rs.mViewport;
     mScissor = rs.mScissor;
+    mPointSize = rs.mPointSize;
+    mLineWidth = rs.mLineWidth;
+    mLineSmoothing = rs.mLineSmoothing;
 
     rs.reset();
 
@@ -138,6 +173,9 @@ inline void SL_ViewportState::reset() noexcept
 {
     mViewport = ls::math::vec4_t<int32_t>{0, 0, 65535, 65535};
     mScissor = ls::math::vec4_t<int32_t>{0, 0, 65535, 65535};
+    mPointSize = 1.f;
+    mLineWidth = 1.f;
+    mLineSmoothing = false;
 }
 
 
@@ -192,4 +230,74 @@ constexpr ls::math::vec4_t<int32_t> SL_ViewportState::scissor() const noexcept
 
 
 
+/*-------------------------------------
+ * point size setter
+ *
+ * Points larger than 1 pixel are rendered as screen-aligned squares, with
+ * their sizes rounded to the nearest pixel.
+-------------------------------------*/
+inline void SL_ViewportState::point_size(float size) noexcept
+{
+    mPointSize = ls::math::clamp<float>(size, 1.f, (float)SL_MAX_POINT_SIZE);
+}
+
+
+
+/*-------------------------------------
+ * point size getter
+-------------------------------------*/
+constexpr float SL_ViewportState::point_size() const noexcept
+{
+    return mPointSize;
+}
+
+
+
+/*-------------------------------------
+ * line width setter
+ *
+ * Lines wider than 1 pixel are expanded into screen-space rectangles by the
+ * line rasterizer.
+-------------------------------------*/
+inline void SL_ViewportState::line_width(float width) noexcept
+{
+    mLineWidth = ls::math::clamp<float>(width, 1.f, (float)SL_MAX_LINE_WIDTH);
+}
+
+
+
+/*-------------------------------------
+ * line width getter
+-------------------------------------*/
+constexpr float SL_ViewportState::line_width() const noexcept
+{
+    return mLineWidth;
+}
+
+
+
+/*-------------------------------------
+ * line anti-aliasing setter
+ *
+ * Smoothed lines multiply the alpha of each fragment's outputs by the
+ * fraction of the pixel covered by the line. A blend mode must be enabled
+ * for the coverage to be visible.
+-------------------------------------*/
+inline void SL_ViewportState::line_smoothing(bool smooth) noexcept
+{
+    mLineSmoothing = smooth;
+}
+
+
+
+/*-------------------------------------
+ * line anti-aliasing getter
+-------------------------------------*/
+constexpr bool SL_ViewportState::line_smoothing() const noexcept
+{
+    return mLineSmoothing;
+}
+
+
+
 #endif /* SL_RASTER_STATE_HPP */
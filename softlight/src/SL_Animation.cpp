@@ -39,7 +39,8 @@ SL_Animation::SL_Animation() noexcept :
     mName {""},
     mChannelIds {},
     mTrackIds {},
-    mTransformIds {}
+    mTransformIds {},
+    mClip {}
 {}
 
 
@@ -55,7 +56,8 @@ SL_Animation::SL_Animation(const SL_Animation& a) noexcept :
     mName {a.mName},
     mChannelIds {a.mChannelIds},
     mTrackIds {a.mTrackIds},
-    mTransformIds {a.mTransformIds}
+    mTransformIds {a.mTransformIds},
+    mClip {a.mClip}
 {}
 
 
@@ -71,7 +73,8 @@ SL_Animation::SL_Animation(SL_Animation&& a) noexcept :
     mName {std::move(a.mName)},
     mChannelIds {std::move(a.mChannelIds)},
     mTrackIds {std::move(a.mTrackIds)},
-    mTransformIds {std::move(a.mTransformIds)}
+    mTransformIds {std::move(a.mTransformIds)},
+    mClip {std::move(a.mClip)}
 {
     a.mPlayMode = SL_AnimPlayMode::SL_ANIM_PLAY_DEFAULT;
     a.mAnimId = 0;
@@ -94,6 +97,7 @@ SL_Animation& SL_Animation::operator =(const SL_Animation& a) noexcept
     mChannelIds = a.mChannelIds;
     mTrackIds = a.mTrackIds;
     mTransformIds = a.mTransformIds;
+    mClip = a.mClip;
 
     return *this;
 }
@@ -121,6 +125,7 @@ SL_Animation& SL_Animation::operator =(SL_Animation&& a) noexcept
     mChannelIds = std::move(a.mChannelIds);
     mTrackIds = std::move(a.mTrackIds);
     mTransformIds = std::move(a.mTransformIds);
+    mClip = std::move(a.mClip);
 
     return *this;
 }
@@ -267,6 +272,7 @@ void SL_Animation::add_channel(const size_t sceneChannelId, const size_t nodeTra
     mChannelIds.push_back(sceneChannelId);
     mTrackIds.push_back(nodeTrackId);
     mTransformIds.push_back(nodeId);
+    mClip.terminate();
 }
 
 
@@ -284,6 +290,7 @@ void SL_Animation::erase(const size_t trackId) noexcept
     mChannelIds.erase(mChannelIds.begin() + trackId);
     mTrackIds.erase(mTrackIds.begin() + trackId);
     mTransformIds.erase(mTransformIds.begin() + trackId);
+    mClip.terminate();
 }
 
 
@@ -296,6 +303,7 @@ void SL_Animation::clear() noexcept
     mChannelIds.clear();
     mTrackIds.clear();
     mTransformIds.clear();
+    mClip.terminate();
 }
 
 
@@ -317,86 +325,117 @@ void SL_Animation::reserve(const size_t reserveSize) noexcept
 -------------------------------------*/
 void SL_Animation::animate(SL_SceneGraph& graph, const SL_AnimPrecision percentDone) const noexcept
 {
-    LS_DEBUG_ASSERT(percentDone >= 0.0);
-    LS_DEBUG_ASSERT(mTransformIds.size() == mChannelIds.size());
-    LS_DEBUG_ASSERT(mTransformIds.size() == mTrackIds.size());
+    animate(graph, percentDone, SL_SceneNodeProp::SCENE_NODE_ROOT_ID, nullptr, 0, mTransformIds.size());
+}
 
-    // prefetch
-    const SL_AlignedVector<SL_AnimationChannel>* pNodeAnims = graph.mNodeAnims.data();
-    SL_Transform* const pTransforms = graph.mCurrentTransforms.data();
 
-    for (size_t i = mTransformIds.size(); i --> 0;)
-    {
-        const size_t animChannelId       = mChannelIds[i];   // maps to SL_SceneGraph.mNodeAnims[i]
-        const size_t nodeTrackId         = mTrackIds[i];     // maps to SL_SceneGraph.mNodeAnims[i][nodeTrackId]
-        const size_t transformId         = mTransformIds[i]; // maps to SL_SceneGraph.mCurrentTransforms[i]
-        const SL_AnimationChannel& track = pNodeAnims[animChannelId][nodeTrackId];
-        SL_Transform& nodeTransform      = pTransforms[transformId];
 
-        LS_DEBUG_ASSERT(transformId != SL_SceneNodeProp::SCENE_NODE_ROOT_ID);
-
-        if (track.has_position_frame(percentDone))
-        {
-            const math::vec3&& pos = track.position_frame(percentDone);
-            nodeTransform.position(pos);
-        }
-
-        if (track.has_scale_frame(percentDone))
-        {
-            const math::vec3&& scl = track.scale_frame(percentDone);
-            nodeTransform.scaling(scl);
-        }
-
-        if (track.has_rotation_frame(percentDone))
-        {
-            math::quat&& rot = track.rotation_frame(percentDone);
-            nodeTransform.orientation(rot);
-        }
-    }
+/*-------------------------------------
+ * Animate a scene graph using all tracks.
+-------------------------------------*/
+void SL_Animation::animate(SL_SceneGraph& graph, const SL_AnimPrecision percentDone, size_t baseTransformId) const noexcept
+{
+    animate(graph, percentDone, baseTransformId, nullptr, 0, mTransformIds.size());
 }
 
 
 
 /*-------------------------------------
- * Animate a scene graph using all tracks.
+ * Animate a scene graph using a range of tracks.
 -------------------------------------*/
-void SL_Animation::animate(SL_SceneGraph& graph, const SL_AnimPrecision percentDone, size_t baseTransformId) const noexcept
+void SL_Animation::animate(
+    SL_SceneGraph& graph,
+    const SL_AnimPrecision percentDone,
+    size_t baseTransformId,
+    SL_AnimationCursor* pCursors,
+    size_t channelBegin,
+    size_t channelEnd
+) const noexcept
 {
     LS_DEBUG_ASSERT(percentDone >= 0.0);
     LS_DEBUG_ASSERT(mTransformIds.size() == mChannelIds.size());
     LS_DEBUG_ASSERT(mTransformIds.size() == mTrackIds.size());
+    LS_DEBUG_ASSERT(channelEnd <= mTransformIds.size());
 
     // prefetch
     const SL_AlignedVector<SL_AnimationChannel>* pNodeAnims = graph.mNodeAnims.data();
     SL_Transform* const pTransforms = graph.mCurrentTransforms.data();
 
-    size_t rootIndex = !mTransformIds.empty() ? mTransformIds[0] : 0;
+    const bool useBaseId = baseTransformId != SL_SceneNodeProp::SCENE_NODE_ROOT_ID;
+    const size_t rootIndex = !mTransformIds.empty() ? mTransformIds[0] : 0;
 
-    for (size_t i = mTransformIds.size(); i--;)
+    // Channels are applied from last to first, so the first channel which
+    // targets a transformation takes precedence.
+    if (mClip.valid())
+    {
+        SL_AnimationClipSample sample;
+
+        for (size_t i = channelEnd; i > channelBegin;)
+        {
+            const size_t groupId    = (i-1u) / SL_ANIM_CLIP_LANES;
+            const size_t groupBegin = math::max<size_t>(groupId * SL_ANIM_CLIP_LANES, channelBegin);
+
+            mClip.sample(groupId, percentDone, sample);
+
+            for (size_t n = i; n --> groupBegin;)
+            {
+                const size_t   transformId = useBaseId ? (baseTransformId + (mTransformIds[n] - rootIndex)) : mTransformIds[n];
+                const unsigned lane        = (unsigned)(n % SL_ANIM_CLIP_LANES);
+                const uint8_t  flags       = mClip.channel_flags(n, percentDone);
+                const float  (&c)[SL_ANIM_CLIP_COMPONENTS][SL_ANIM_CLIP_LANES] = sample.mComponents;
+                SL_Transform&  nodeTransform = pTransforms[transformId];
+
+                if (flags & SL_ANIM_CLIP_FLAG_POSITION)
+                {
+                    nodeTransform.position(math::vec3{c[SL_ANIM_CLIP_POSITION_OFFSET][lane], c[SL_ANIM_CLIP_POSITION_OFFSET+1][lane], c[SL_ANIM_CLIP_POSITION_OFFSET+2][lane]});
+                }
+
+                if (flags & SL_ANIM_CLIP_FLAG_SCALE)
+                {
+                    nodeTransform.scaling(math::vec3{c[SL_ANIM_CLIP_SCALE_OFFSET][lane], c[SL_ANIM_CLIP_SCALE_OFFSET+1][lane], c[SL_ANIM_CLIP_SCALE_OFFSET+2][lane]});
+                }
+
+                if (flags & SL_ANIM_CLIP_FLAG_ROTATION)
+                {
+                    nodeTransform.orientation(math::quat{c[SL_ANIM_CLIP_ROTATION_OFFSET][lane], c[SL_ANIM_CLIP_ROTATION_OFFSET+1][lane], c[SL_ANIM_CLIP_ROTATION_OFFSET+2][lane], c[SL_ANIM_CLIP_ROTATION_OFFSET+3][lane]});
+                }
+            }
+
+            i = groupBegin;
+        }
+
+        return;
+    }
+
+    for (size_t i = channelEnd; i --> channelBegin;)
     {
         const size_t animChannelId       = mChannelIds[i];   // maps to SL_SceneGraph.mNodeAnims[i]
         const size_t nodeTrackId         = mTrackIds[i];     // maps to SL_SceneGraph.mNodeAnims[i][nodeTrackId]
-        const size_t transformId         = baseTransformId + (mTransformIds[i] - rootIndex); // maps to SL_SceneGraph.mCurrentTransforms[i]
+        const size_t transformId         = useBaseId ? (baseTransformId + (mTransformIds[i] - rootIndex)) : mTransformIds[i]; // maps to SL_SceneGraph.mCurrentTransforms[i]
         const SL_AnimationChannel& track = pNodeAnims[animChannelId][nodeTrackId];
         SL_Transform& nodeTransform      = pTransforms[transformId];
 
+        // A cursor of 0 forces each key list to search for its keyframes
+        SL_AnimationCursor tempCursor{0, 0, 0};
+        SL_AnimationCursor& cursor = pCursors ? pCursors[i] : tempCursor;
+
         LS_DEBUG_ASSERT(transformId != SL_SceneNodeProp::SCENE_NODE_ROOT_ID);
 
         if (track.has_position_frame(percentDone))
         {
-            const math::vec3&& pos = track.position_frame(percentDone);
+            const math::vec3&& pos = track.position_frame(percentDone, cursor);
             nodeTransform.position(pos);
         }
 
         if (track.has_scale_frame(percentDone))
         {
-            const math::vec3&& scl = track.scale_frame(percentDone);
+            const math::vec3&& scl = track.scale_frame(percentDone, cursor);
             nodeTransform.scaling(scl);
         }
 
         if (track.has_rotation_frame(percentDone))
         {
-            math::quat&& rot = track.rotation_frame(percentDone);
+            math::quat&& rot = track.rotation_frame(percentDone, cursor);
             nodeTransform.orientation(rot);
         }
     }
@@ -460,3 +499,33 @@ bool SL_Animation::have_monotonic_transforms() const noexcept
 
     return true;
 }
+
+
+
+/*-------------------------------------
+ * Pack all channels into a single clip
+-------------------------------------*/
+int SL_Animation::pack(const SL_SceneGraph& graph, SL_AnimPrecision samplesPerSec, bool quantize) noexcept
+{
+    return mClip.init(graph, *this, samplesPerSec, quantize);
+}
+
+
+
+/*-------------------------------------
+ * Discard the packed clip
+-------------------------------------*/
+void SL_Animation::unpack() noexcept
+{
+    mClip.terminate();
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the packed clip
+-------------------------------------*/
+const SL_AnimationClip& SL_Animation::clip() const noexcept
+{
+    return mClip;
+}
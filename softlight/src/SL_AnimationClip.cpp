@@ -0,0 +1,521 @@
+
+#include <cmath> // std::ceil, std::sqrt
+#include <utility> // std::move
+
+#include "lightsky/setup/Api.h" // LS_INLINE
+
+#include "lightsky/math/scalar_utils.h" // min, max, clamp
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/quat.h"
+
+#include "lightsky/utils/Assertions.h"
+
+#include "softlight/SL_Animation.hpp"
+#include "softlight/SL_AnimationChannel.hpp"
+#include "softlight/SL_AnimationClip.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Number of floats in a single keyframe of a channel group
+-------------------------------------*/
+constexpr size_t SL_ANIM_CLIP_KEY_SIZE = (size_t)SL_ANIM_CLIP_COMPONENTS * (size_t)SL_ANIM_CLIP_LANES;
+
+
+
+/*-------------------------------------
+ * 4-wide vector helpers
+-------------------------------------*/
+#if defined(LS_X86_SSE2)
+    typedef __m128 _sl_float4;
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return _mm_load_ps(p); }
+    inline LS_INLINE void _sl_store4(float* p, _sl_float4 a) noexcept { _mm_store_ps(p, a); }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return _mm_set1_ps(a); }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { return _mm_add_ps(a, b); }
+    inline LS_INLINE _sl_float4 _sl_sub4(_sl_float4 a, _sl_float4 b) noexcept { return _mm_sub_ps(a, b); }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { return _mm_mul_ps(a, b); }
+
+    // a*b + c
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    // Negate each element of "a" where the same element of "b" is negative
+    inline LS_INLINE _sl_float4 _sl_xorsign4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        return _mm_xor_ps(a, _mm_and_ps(b, _mm_set1_ps(-0.f)));
+    }
+
+    // Reciprocal square root, refined with a single Newton-Raphson step
+    inline LS_INLINE _sl_float4 _sl_rsqrt4(_sl_float4 a) noexcept
+    {
+        const __m128 y = _mm_rsqrt_ps(a);
+        const __m128 halfA = _mm_mul_ps(a, _mm_set1_ps(0.5f));
+        return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfA, _mm_mul_ps(y, y))));
+    }
+
+    inline LS_INLINE _sl_float4 _sl_load4_u16(const uint16_t* p) noexcept
+    {
+        const __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, _mm_setzero_si128()));
+    }
+
+#elif defined(LS_ARM_NEON)
+    typedef float32x4_t _sl_float4;
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return vld1q_f32(p); }
+    inline LS_INLINE void _sl_store4(float* p, _sl_float4 a) noexcept { vst1q_f32(p, a); }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return vdupq_n_f32(a); }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { return vaddq_f32(a, b); }
+    inline LS_INLINE _sl_float4 _sl_sub4(_sl_float4 a, _sl_float4 b) noexcept { return vsubq_f32(a, b); }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { return vmulq_f32(a, b); }
+
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        return vmlaq_f32(c, a, b);
+    }
+
+    inline LS_INLINE _sl_float4 _sl_xorsign4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(b), vdupq_n_u32(0x80000000u));
+        return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), sign));
+    }
+
+    inline LS_INLINE _sl_float4 _sl_rsqrt4(_sl_float4 a) noexcept
+    {
+        const float32x4_t y = vrsqrteq_f32(a);
+        return vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(a, y), y));
+    }
+
+    inline LS_INLINE _sl_float4 _sl_load4_u16(const uint16_t* p) noexcept
+    {
+        return vcvtq_f32_u32(vmovl_u16(vld1_u16(p)));
+    }
+
+#else
+    struct _sl_float4
+    {
+        float v[SL_ANIM_CLIP_LANES];
+    };
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return _sl_float4{{p[0], p[1], p[2], p[3]}}; }
+    inline LS_INLINE void _sl_store4(float* p, _sl_float4 a) noexcept { for (unsigned i = 0; i < 4; ++i) p[i] = a.v[i]; }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return _sl_float4{{a, a, a, a}}; }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { for (unsigned i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    inline LS_INLINE _sl_float4 _sl_sub4(_sl_float4 a, _sl_float4 b) noexcept { for (unsigned i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { for (unsigned i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        for (unsigned i = 0; i < 4; ++i) a.v[i] = a.v[i] * b.v[i] + c.v[i];
+        return a;
+    }
+
+    inline LS_INLINE _sl_float4 _sl_xorsign4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        for (unsigned i = 0; i < 4; ++i) a.v[i] = (b.v[i] < 0.f) ? -a.v[i] : a.v[i];
+        return a;
+    }
+
+    inline LS_INLINE _sl_float4 _sl_rsqrt4(_sl_float4 a) noexcept
+    {
+        for (unsigned i = 0; i < 4; ++i) a.v[i] = 1.f / std::sqrt(a.v[i]);
+        return a;
+    }
+
+    inline LS_INLINE _sl_float4 _sl_load4_u16(const uint16_t* p) noexcept
+    {
+        return _sl_float4{{(float)p[0], (float)p[1], (float)p[2], (float)p[3]}};
+    }
+
+#endif
+
+
+
+/*-------------------------------------
+ * Write the transformation of a single channel at a point in time
+-------------------------------------*/
+void _sl_pack_channel_key(const SL_AnimationChannel* pTrack, SL_AnimPrecision percent, float* pKey, unsigned lane) noexcept
+{
+    // Untouched lanes hold an identity transform so every lane can be
+    // interpolated safely.
+    math::vec3 pos{0.f};
+    math::vec3 scl{1.f};
+    math::quat rot{0.f, 0.f, 0.f, 1.f};
+
+    if (pTrack)
+    {
+        if (pTrack->mPosFrames.valid())
+        {
+            pos = pTrack->position_frame(percent);
+        }
+
+        if (pTrack->mScaleFrames.valid())
+        {
+            scl = pTrack->scale_frame(percent);
+        }
+
+        if (pTrack->mOrientFrames.valid())
+        {
+            rot = pTrack->rotation_frame(percent);
+        }
+    }
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        pKey[(SL_ANIM_CLIP_POSITION_OFFSET+i) * SL_ANIM_CLIP_LANES + lane] = pos[i];
+        pKey[(SL_ANIM_CLIP_SCALE_OFFSET+i) * SL_ANIM_CLIP_LANES + lane] = scl[i];
+    }
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        pKey[(SL_ANIM_CLIP_ROTATION_OFFSET+i) * SL_ANIM_CLIP_LANES + lane] = rot[i];
+    }
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_AnimationClip Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Destructor
+-------------------------------------*/
+SL_AnimationClip::~SL_AnimationClip() noexcept
+{
+}
+
+
+
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+SL_AnimationClip::SL_AnimationClip() noexcept :
+    mNumChannels{0},
+    mNumFrames{0},
+    mChannelFlags{},
+    mChannelTimes{},
+    mKeys{},
+    mQuantizedKeys{},
+    mKeyRanges{}
+{}
+
+
+
+/*-------------------------------------
+ * Copy Constructor
+-------------------------------------*/
+SL_AnimationClip::SL_AnimationClip(const SL_AnimationClip& c) noexcept :
+    mNumChannels{c.mNumChannels},
+    mNumFrames{c.mNumFrames},
+    mChannelFlags{c.mChannelFlags},
+    mChannelTimes{c.mChannelTimes},
+    mKeys{c.mKeys},
+    mQuantizedKeys{c.mQuantizedKeys},
+    mKeyRanges{c.mKeyRanges}
+{}
+
+
+
+/*-------------------------------------
+ * Move Constructor
+-------------------------------------*/
+SL_AnimationClip::SL_AnimationClip(SL_AnimationClip&& c) noexcept :
+    mNumChannels{c.mNumChannels},
+    mNumFrames{c.mNumFrames},
+    mChannelFlags{std::move(c.mChannelFlags)},
+    mChannelTimes{std::move(c.mChannelTimes)},
+    mKeys{std::move(c.mKeys)},
+    mQuantizedKeys{std::move(c.mQuantizedKeys)},
+    mKeyRanges{std::move(c.mKeyRanges)}
+{
+    c.mNumChannels = 0;
+    c.mNumFrames = 0;
+}
+
+
+
+/*-------------------------------------
+ * Copy Operator
+-------------------------------------*/
+SL_AnimationClip& SL_AnimationClip::operator=(const SL_AnimationClip& c) noexcept
+{
+    if (this != &c)
+    {
+        mNumChannels = c.mNumChannels;
+        mNumFrames = c.mNumFrames;
+        mChannelFlags = c.mChannelFlags;
+        mChannelTimes = c.mChannelTimes;
+        mKeys = c.mKeys;
+        mQuantizedKeys = c.mQuantizedKeys;
+        mKeyRanges = c.mKeyRanges;
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Move Operator
+-------------------------------------*/
+SL_AnimationClip& SL_AnimationClip::operator=(SL_AnimationClip&& c) noexcept
+{
+    if (this != &c)
+    {
+        mNumChannels = c.mNumChannels;
+        c.mNumChannels = 0;
+
+        mNumFrames = c.mNumFrames;
+        c.mNumFrames = 0;
+
+        mChannelFlags = std::move(c.mChannelFlags);
+        mChannelTimes = std::move(c.mChannelTimes);
+        mKeys = std::move(c.mKeys);
+        mQuantizedKeys = std::move(c.mQuantizedKeys);
+        mKeyRanges = std::move(c.mKeyRanges);
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Resample an animation
+-------------------------------------*/
+int SL_AnimationClip::init(const SL_SceneGraph& graph, const SL_Animation& anim, SL_AnimPrecision samplesPerSec, bool quantize) noexcept
+{
+    terminate();
+
+    if (!anim.size())
+    {
+        return -1;
+    }
+
+    if (!(samplesPerSec > SL_AnimPrecision{0}))
+    {
+        return -2;
+    }
+
+    const SL_AnimPrecision ticksPerSec = anim.ticks_per_sec();
+    const SL_AnimPrecision seconds     = (ticksPerSec > SL_AnimPrecision{0}) ? (anim.duration() / ticksPerSec) : anim.duration();
+
+    mNumChannels = anim.size();
+    mNumFrames   = math::max<size_t>(2, (size_t)std::ceil(seconds * samplesPerSec) + 1u);
+
+    const size_t numGroups = num_groups();
+    const std::vector<size_t>& channelIds = anim.animations();
+    const std::vector<size_t>& trackIds = anim.tracks();
+
+    mChannelFlags.resize(mNumChannels, SL_ANIM_CLIP_FLAG_NONE);
+    mChannelTimes.resize(mNumChannels * SL_ANIM_CLIP_CHANNEL_TIMES);
+    mKeys.resize(numGroups * mNumFrames * SL_ANIM_CLIP_KEY_SIZE);
+
+    for (size_t c = 0; c < mNumChannels; ++c)
+    {
+        const SL_AnimationChannel& track = graph.mNodeAnims[channelIds[c]][trackIds[c]];
+
+        mChannelFlags[c] = (uint8_t)(
+            (track.mPosFrames.valid() ? SL_ANIM_CLIP_FLAG_POSITION : 0) |
+            (track.mScaleFrames.valid() ? SL_ANIM_CLIP_FLAG_SCALE : 0) |
+            (track.mOrientFrames.valid() ? SL_ANIM_CLIP_FLAG_ROTATION : 0) |
+            ((track.flags() & SL_ANIM_FLAG_IMMEDIATE) ? SL_ANIM_CLIP_FLAG_STEPPED : 0)
+        );
+
+        SL_AnimPrecision* const pTimes = mChannelTimes.data() + c * SL_ANIM_CLIP_CHANNEL_TIMES;
+        pTimes[0] = track.mPosFrames.start_time();
+        pTimes[1] = track.mPosFrames.end_time();
+        pTimes[2] = track.mScaleFrames.start_time();
+        pTimes[3] = track.mScaleFrames.end_time();
+        pTimes[4] = track.mOrientFrames.start_time();
+        pTimes[5] = track.mOrientFrames.end_time();
+    }
+
+    const SL_AnimPrecision frameStep = SL_AnimPrecision{1} / (SL_AnimPrecision)(mNumFrames - 1u);
+
+    for (size_t g = 0; g < numGroups; ++g)
+    {
+        for (size_t f = 0; f < mNumFrames; ++f)
+        {
+            const SL_AnimPrecision percent = math::min(SL_AnimPrecision{1}, frameStep * (SL_AnimPrecision)f);
+            float* const pKey = mKeys.data() + (g * mNumFrames + f) * SL_ANIM_CLIP_KEY_SIZE;
+
+            for (unsigned lane = 0; lane < SL_ANIM_CLIP_LANES; ++lane)
+            {
+                const size_t c = g * SL_ANIM_CLIP_LANES + lane;
+                const SL_AnimationChannel* const pTrack = (c < mNumChannels) ? &graph.mNodeAnims[channelIds[c]][trackIds[c]] : nullptr;
+                _sl_pack_channel_key(pTrack, percent, pKey, lane);
+            }
+        }
+    }
+
+    if (!quantize)
+    {
+        return 0;
+    }
+
+    // Each component of each channel is quantized within its own range
+    mQuantizedKeys.resize(mKeys.size());
+    mKeyRanges.resize(numGroups * 2u * SL_ANIM_CLIP_KEY_SIZE);
+
+    for (size_t g = 0; g < numGroups; ++g)
+    {
+        const float* const pGroupKeys = mKeys.data() + g * mNumFrames * SL_ANIM_CLIP_KEY_SIZE;
+        uint16_t* const pQuantKeys = mQuantizedKeys.data() + g * mNumFrames * SL_ANIM_CLIP_KEY_SIZE;
+        float* const pMins = mKeyRanges.data() + g * 2u * SL_ANIM_CLIP_KEY_SIZE;
+        float* const pSteps = pMins + SL_ANIM_CLIP_KEY_SIZE;
+
+        for (size_t k = 0; k < SL_ANIM_CLIP_KEY_SIZE; ++k)
+        {
+            float minVal = pGroupKeys[k];
+            float maxVal = pGroupKeys[k];
+
+            for (size_t f = 1; f < mNumFrames; ++f)
+            {
+                minVal = math::min(minVal, pGroupKeys[f * SL_ANIM_CLIP_KEY_SIZE + k]);
+                maxVal = math::max(maxVal, pGroupKeys[f * SL_ANIM_CLIP_KEY_SIZE + k]);
+            }
+
+            const float step = (maxVal - minVal) / 65535.f;
+            const float invStep = (step > 0.f) ? (1.f / step) : 0.f;
+
+            pMins[k] = minVal;
+            pSteps[k] = step;
+
+            for (size_t f = 0; f < mNumFrames; ++f)
+            {
+                const float q = (pGroupKeys[f * SL_ANIM_CLIP_KEY_SIZE + k] - minVal) * invStep + 0.5f;
+                pQuantKeys[f * SL_ANIM_CLIP_KEY_SIZE + k] = (uint16_t)math::clamp(q, 0.f, 65535.f);
+            }
+        }
+    }
+
+    mKeys.clear();
+    mKeys.shrink_to_fit();
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Free all keys
+-------------------------------------*/
+void SL_AnimationClip::terminate() noexcept
+{
+    mNumChannels = 0;
+    mNumFrames = 0;
+    mChannelFlags.clear();
+    mChannelTimes.clear();
+    mKeys.clear();
+    mQuantizedKeys.clear();
+    mKeyRanges.clear();
+}
+
+
+
+/*-------------------------------------
+ * Interpolate a group of channels
+-------------------------------------*/
+void SL_AnimationClip::sample(size_t groupId, SL_AnimPrecision percent, SL_AnimationClipSample& outSample) const noexcept
+{
+    LS_DEBUG_ASSERT(valid());
+    LS_DEBUG_ASSERT(groupId < num_groups());
+
+    const SL_AnimPrecision framePos = math::clamp(percent, SL_AnimPrecision{0}, SL_AnimPrecision{1}) * (SL_AnimPrecision)(mNumFrames - 1u);
+    const size_t frameId = math::min<size_t>((size_t)framePos, mNumFrames - 2u);
+    const float frameDelta = (float)(framePos - (SL_AnimPrecision)frameId);
+
+    // Stepped channels jump straight to the key at the end of the current
+    // frame, since SL_AnimationKeyList holds each key until the time of the
+    // following one.
+    alignas(sizeof(_sl_float4)) float laneDeltas[SL_ANIM_CLIP_LANES];
+    for (unsigned lane = 0; lane < SL_ANIM_CLIP_LANES; ++lane)
+    {
+        const size_t c = groupId * SL_ANIM_CLIP_LANES + lane;
+        const bool stepped = c < mNumChannels && (mChannelFlags[c] & SL_ANIM_CLIP_FLAG_STEPPED);
+        laneDeltas[lane] = stepped ? ((frameDelta > 0.f) ? 1.f : 0.f) : frameDelta;
+    }
+
+    const _sl_float4 t = _sl_load4(laneDeltas);
+
+    const size_t keyOffset = (groupId * mNumFrames + frameId) * SL_ANIM_CLIP_KEY_SIZE;
+    _sl_float4 a[SL_ANIM_CLIP_COMPONENTS];
+    _sl_float4 b[SL_ANIM_CLIP_COMPONENTS];
+
+    if (quantized())
+    {
+        const uint16_t* const pKeys = mQuantizedKeys.data() + keyOffset;
+        const float* const pMins = mKeyRanges.data() + groupId * 2u * SL_ANIM_CLIP_KEY_SIZE;
+        const float* const pSteps = pMins + SL_ANIM_CLIP_KEY_SIZE;
+
+        for (unsigned i = 0; i < SL_ANIM_CLIP_COMPONENTS; ++i)
+        {
+            const _sl_float4 minVal = _sl_load4(pMins + i*SL_ANIM_CLIP_LANES);
+            const _sl_float4 step = _sl_load4(pSteps + i*SL_ANIM_CLIP_LANES);
+            a[i] = _sl_fmadd4(_sl_load4_u16(pKeys + i*SL_ANIM_CLIP_LANES), step, minVal);
+            b[i] = _sl_fmadd4(_sl_load4_u16(pKeys + SL_ANIM_CLIP_KEY_SIZE + i*SL_ANIM_CLIP_LANES), step, minVal);
+        }
+    }
+    else
+    {
+        const float* const pKeys = mKeys.data() + keyOffset;
+
+        for (unsigned i = 0; i < SL_ANIM_CLIP_COMPONENTS; ++i)
+        {
+            a[i] = _sl_load4(pKeys + i*SL_ANIM_CLIP_LANES);
+            b[i] = _sl_load4(pKeys + SL_ANIM_CLIP_KEY_SIZE + i*SL_ANIM_CLIP_LANES);
+        }
+    }
+
+    // Position & scale
+    for (unsigned i = 0; i < SL_ANIM_CLIP_ROTATION_OFFSET; ++i)
+    {
+        _sl_store4(outSample.mComponents[i], _sl_fmadd4(_sl_sub4(b[i], a[i]), t, a[i]));
+    }
+
+    // Rotations take the shortest path between keys
+    _sl_float4* const qa = a + SL_ANIM_CLIP_ROTATION_OFFSET;
+    _sl_float4* const qb = b + SL_ANIM_CLIP_ROTATION_OFFSET;
+
+    _sl_float4 cosTheta = _sl_mul4(qa[0], qb[0]);
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        cosTheta = _sl_fmadd4(qa[i], qb[i], cosTheta);
+    }
+
+    _sl_float4 q[4];
+    _sl_float4 lenSquared = _sl_set4(0.f);
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const _sl_float4 target = _sl_xorsign4(qb[i], cosTheta);
+        q[i] = _sl_fmadd4(_sl_sub4(target, qa[i]), t, qa[i]);
+        lenSquared = _sl_fmadd4(q[i], q[i], lenSquared);
+    }
+
+    const _sl_float4 invLen = _sl_rsqrt4(lenSquared);
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        _sl_store4(outSample.mComponents[SL_ANIM_CLIP_ROTATION_OFFSET+i], _sl_mul4(q[i], invLen));
+    }
+}
@@ -1,4 +1,6 @@
 
+#include <algorithm> // std::lower_bound
+
 #include "lightsky/math/vec_utils.h"
 #include "lightsky/math/quat_utils.h"
 
@@ -45,6 +47,38 @@ struct _SL_AnimInterpolator
 
 
 
+/*-------------------------------------
+ * Locate the first keyframe, after the initial one, which is not earlier
+ * than a point in time.
+-------------------------------------*/
+inline size_t _sl_find_next_key(
+    const SL_AnimPrecision* pTimes,
+    const size_t numFrames,
+    const SL_AnimPrecision percent,
+    const size_t hint) noexcept
+{
+    if (hint > 0 && hint < numFrames && !(pTimes[hint] < percent))
+    {
+        if (hint == 1 || pTimes[hint-1] < percent)
+        {
+            return hint;
+        }
+    }
+    else if (hint > 0 && hint+1 < numFrames && !(pTimes[hint+1] < percent))
+    {
+        // Forward playback rarely skips more than one keyframe per update
+        return hint+1;
+    }
+
+    const SL_AnimPrecision* const pNext = std::lower_bound(pTimes+1, pTimes+numFrames, percent);
+    const size_t nextFrame = (size_t)(pNext - pTimes);
+
+    // Clamp to the last frame when time runs past a repeating animation
+    return nextFrame < numFrames ? nextFrame : (numFrames-1);
+}
+
+
+
 } // end anonymous namespace
 
 
@@ -384,18 +418,25 @@ SL_AnimPrecision SL_AnimationKeyList<data_t>::calc_frame_interpolation(
     size_t& outNextFrame
 ) const noexcept
 {
-    LS_DEBUG_ASSERT(mNumFrames > 0);
+    return calc_frame_interpolation(totalAnimPercent, outCurrFrame, outNextFrame, 0);
+}
 
-    outCurrFrame = 0;
-    outNextFrame = 1;
 
-    // If there's one thing I hate more in hot code paths than branches, it's
-    // loops. One day I'll find out how to get rid of this. The more key frames
-    // that are in an animation channel, the longer this will take to run.
-    while (mKeyTimes[outNextFrame] < totalAnimPercent)
-    {
-        outNextFrame++;
-    }
+
+/*-------------------------------------
+ * Frame difference interpolator (cached)
+-------------------------------------*/
+template<typename data_t>
+SL_AnimPrecision SL_AnimationKeyList<data_t>::calc_frame_interpolation(
+    const SL_AnimPrecision totalAnimPercent,
+    size_t& outCurrFrame,
+    size_t& outNextFrame,
+    const size_t frameHint
+) const noexcept
+{
+    LS_DEBUG_ASSERT(mNumFrames > 0);
+
+    outNextFrame = _sl_find_next_key(mKeyTimes.get(), mNumFrames, totalAnimPercent, frameHint);
 
     const size_t prevFrame = outNextFrame-1;
     outCurrFrame = (outNextFrame != 0) ? prevFrame : outNextFrame;
@@ -415,6 +456,18 @@ SL_AnimPrecision SL_AnimationKeyList<data_t>::calc_frame_interpolation(
 -------------------------------------*/
 template<typename data_t>
 data_t SL_AnimationKeyList<data_t>::interpolated_data(SL_AnimPrecision percent, const SL_AnimationFlag animFlags) const noexcept
+{
+    size_t cursor = 0;
+    return interpolated_data(percent, animFlags, cursor);
+}
+
+
+
+/*-------------------------------------
+ * Interpolate a set of keyframe (cached)
+-------------------------------------*/
+template<typename data_t>
+data_t SL_AnimationKeyList<data_t>::interpolated_data(SL_AnimPrecision percent, const SL_AnimationFlag animFlags, size_t& ioCursor) const noexcept
 {
     if (percent <= start_time())
     {
@@ -427,7 +480,8 @@ data_t SL_AnimationKeyList<data_t>::interpolated_data(SL_AnimPrecision percent,
     }
 
     size_t currFrame, nextFrame;
-    SL_AnimPrecision interpAmount = calc_frame_interpolation(percent, currFrame, nextFrame);
+    SL_AnimPrecision interpAmount = calc_frame_interpolation(percent, currFrame, nextFrame, ioCursor);
+    ioCursor = nextFrame;
 
     if ((animFlags & SL_AnimationFlag::SL_ANIM_FLAG_IMMEDIATE) != 0)
     {
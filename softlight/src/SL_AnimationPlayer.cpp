@@ -1,4 +1,7 @@
 
+#include <algorithm> // std::upper_bound
+#include <utility> // std::move
+
 #include "lightsky/utils/Assertions.h"
 
 #include "lightsky/math/scalar_utils.h" // fmod
@@ -6,6 +9,85 @@
 #include "softlight/SL_Animation.hpp"
 #include "softlight/SL_AnimationPlayer.hpp"
 #include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp" // SL_SceneNodeProp
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Batches with fewer channels are cheaper to animate on a single thread
+-------------------------------------*/
+constexpr size_t SL_ANIMATION_MIN_PARALLEL_CHANNELS = 64;
+
+
+
+/*-------------------------------------
+ * A single animation which should be sampled
+-------------------------------------*/
+struct _SL_AnimationBatchItem
+{
+    const SL_Animation* pAnim;
+    SL_AnimationCursor* pCursors;
+    size_t baseTransformId;
+    SL_AnimPrecision percent;
+};
+
+
+
+/*-------------------------------------
+ * Animations shared between threads
+-------------------------------------*/
+struct _SL_AnimationBatchTask
+{
+    SL_SceneGraph* pGraph;
+    const _SL_AnimationBatchItem* pItems;
+    const size_t* pChannelOffsets; // numItems+1 elements
+    size_t numItems;
+};
+
+
+
+/*-------------------------------------
+ * Sample a contiguous range of channels from all animations in a batch
+-------------------------------------*/
+void _sl_animate_batch(void* pUserData, uint32_t threadId, uint32_t numThreads) noexcept
+{
+    const _SL_AnimationBatchTask* const pTask = reinterpret_cast<const _SL_AnimationBatchTask*>(pUserData);
+    const size_t* const pOffsets = pTask->pChannelOffsets;
+    const size_t numChannels = pOffsets[pTask->numItems];
+
+    const size_t begin = (numChannels * threadId) / numThreads;
+    const size_t end   = (numChannels * (threadId+1u)) / numThreads;
+
+    if (begin >= end)
+    {
+        return;
+    }
+
+    // Locate the animation containing this thread's first channel
+    size_t item = (size_t)(std::upper_bound(pOffsets, pOffsets + pTask->numItems + 1u, begin) - pOffsets) - 1u;
+
+    for (size_t i = begin; i < end; ++item)
+    {
+        const _SL_AnimationBatchItem& anim = pTask->pItems[item];
+        const size_t channelBegin = i - pOffsets[item];
+        const size_t channelEnd   = ((end < pOffsets[item+1u]) ? end : pOffsets[item+1u]) - pOffsets[item];
+
+        anim.pAnim->animate(*pTask->pGraph, anim.percent, anim.baseTransformId, anim.pCursors, channelBegin, channelEnd);
+        i = pOffsets[item] + channelEnd;
+    }
+}
+
+
+
+} // end anonymous namespace
 
 
 
@@ -25,7 +107,8 @@ SL_AnimationPlayer::SL_AnimationPlayer() noexcept :
     mCurrentState {SL_ANIM_STATE_STOPPED},
     mNumPlays {PLAY_AUTO},
     mCurrentPercent {0.0},
-    mDilation {1.0}
+    mDilation {1.0},
+    mCursors {}
 {}
 
 
@@ -37,7 +120,8 @@ SL_AnimationPlayer::SL_AnimationPlayer(const SL_AnimationPlayer& a) noexcept :
     mCurrentState {a.mCurrentState},
     mNumPlays {a.mNumPlays},
     mCurrentPercent {a.mCurrentPercent},
-    mDilation {a.mDilation}
+    mDilation {a.mDilation},
+    mCursors {a.mCursors}
 {}
 
 
@@ -49,7 +133,8 @@ SL_AnimationPlayer::SL_AnimationPlayer(SL_AnimationPlayer&& a) noexcept :
     mCurrentState {a.mCurrentState},
     mNumPlays {a.mNumPlays},
     mCurrentPercent {a.mCurrentPercent},
-    mDilation {a.mDilation}
+    mDilation {a.mDilation},
+    mCursors {std::move(a.mCursors)}
 {
     a.mCurrentState = SL_ANIM_STATE_STOPPED;
     a.mNumPlays = PLAY_AUTO;
@@ -68,6 +153,7 @@ SL_AnimationPlayer& SL_AnimationPlayer::operator =(const SL_AnimationPlayer& a)
     mNumPlays = a.mNumPlays;
     mCurrentPercent = a.mCurrentPercent;
     mDilation = a.mDilation;
+    mCursors = a.mCursors;
 
     return *this;
 }
@@ -91,6 +177,8 @@ SL_AnimationPlayer& SL_AnimationPlayer::operator =(SL_AnimationPlayer&& a) noexc
     mDilation = a.mDilation;
     a.mDilation = 1.0;
 
+    mCursors = std::move(a.mCursors);
+
     return *this;
 }
 
@@ -127,18 +215,15 @@ SL_AnimPrecision SL_AnimationPlayer::get_current_ticks() const noexcept
 
 
 /*-------------------------------------
- * Progress an animation
+ * Progress the play count and time
 -------------------------------------*/
-void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64_t millis) noexcept
+bool SL_AnimationPlayer::advance(const SL_Animation& anim, int64_t millis, SL_AnimPrecision& outPercent) noexcept
 {
     if (mCurrentState != SL_ANIM_STATE_PLAYING)
     {
-        return;
+        return false;
     }
 
-    const SL_AlignedVector<SL_Animation>& animations = graph.mAnimations;
-    const SL_Animation& anim = animations[animationIndex];
-
     if (mNumPlays == PLAY_AUTO)
     {
         mNumPlays = (anim.play_mode() == SL_AnimPlayMode::SL_ANIM_PLAY_REPEAT)
@@ -149,7 +234,7 @@ void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64
     if (!mNumPlays)
     {
         stop_anim();
-        return;
+        return false;
     }
 
     const SL_AnimPrecision secondsDelta  = SL_AnimPrecision{0.001} * (SL_AnimPrecision)millis;
@@ -158,8 +243,6 @@ void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64
     const SL_AnimPrecision percentDone   = mCurrentPercent + percentDelta;
     const SL_AnimPrecision nextPercent   = percentDone >= SL_AnimPrecision{0.0} ? percentDone : (SL_AnimPrecision{1}+percentDone);
 
-    anim.animate(graph, nextPercent);
-
     // check for a looped SL_Animation even when time is going backwards.
     if (percentDone >= SL_AnimPrecision{1}
         || (mCurrentPercent > SL_AnimPrecision{0} && percentDone < SL_AnimPrecision{0}))
@@ -176,6 +259,12 @@ void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64
     {
         stop_anim();
     }
+
+    // Cursors are only hints, stale ones from another animation are fine
+    mCursors.resize(anim.size(), SL_AnimationCursor{0, 0, 0});
+    outPercent = nextPercent;
+
+    return true;
 }
 
 
@@ -183,52 +272,78 @@ void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64
 /*-------------------------------------
  * Progress an animation
 -------------------------------------*/
-void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64_t millis, size_t baseTransformId) noexcept
+void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64_t millis) noexcept
 {
-    if (mCurrentState != SL_ANIM_STATE_PLAYING)
+    const SL_Animation& anim = graph.mAnimations[animationIndex];
+    SL_AnimPrecision percent;
+
+    if (advance(anim, millis, percent))
     {
-        return;
+        anim.animate(graph, percent, SL_SceneNodeProp::SCENE_NODE_ROOT_ID, mCursors.data(), 0, anim.size());
     }
+}
 
-    const SL_AlignedVector<SL_Animation>& animations = graph.mAnimations;
-    const SL_Animation& anim = animations[animationIndex];
 
-    if (mNumPlays == PLAY_AUTO)
-    {
-        mNumPlays = (anim.play_mode() == SL_AnimPlayMode::SL_ANIM_PLAY_REPEAT)
-            ? PLAY_REPEAT
-            : PLAY_ONCE;
-    }
 
-    if (!mNumPlays)
+/*-------------------------------------
+ * Progress an animation
+-------------------------------------*/
+void SL_AnimationPlayer::tick(SL_SceneGraph& graph, size_t animationIndex, int64_t millis, size_t baseTransformId) noexcept
+{
+    const SL_Animation& anim = graph.mAnimations[animationIndex];
+    SL_AnimPrecision percent;
+
+    if (advance(anim, millis, percent))
     {
-        stop_anim();
-        return;
+        anim.animate(graph, percent, baseTransformId, mCursors.data(), 0, anim.size());
     }
+}
 
-    const SL_AnimPrecision secondsDelta  = SL_AnimPrecision{0.001} * (SL_AnimPrecision)millis;
-    const SL_AnimPrecision ticksDelta    = secondsDelta * anim.ticks_per_sec();
-    const SL_AnimPrecision percentDelta  = (ticksDelta * mDilation) / anim.duration();
-    const SL_AnimPrecision percentDone   = mCurrentPercent + percentDelta;
-    const SL_AnimPrecision nextPercent   = percentDone >= SL_AnimPrecision{0.0} ? percentDone : (SL_AnimPrecision{1}+percentDone);
 
-    anim.animate(graph, nextPercent, baseTransformId);
 
-    // check for a looped SL_Animation even when time is going backwards.
-    if (percentDone >= SL_AnimPrecision{1}
-    || (mCurrentPercent > SL_AnimPrecision{0} && percentDone < SL_AnimPrecision{0}))
+/*-------------------------------------
+ * Progress multiple animations
+-------------------------------------*/
+void SL_AnimationPlayer::tick_all(
+    SL_SceneGraph& graph,
+    SL_AnimationPlayer* pPlayers,
+    const size_t* pAnimIndices,
+    const size_t* pBaseTransformIds,
+    size_t numPlayers,
+    int64_t millis) noexcept
+{
+    std::vector<_SL_AnimationBatchItem> items;
+    std::vector<size_t> channelOffsets;
+
+    items.reserve(numPlayers);
+    channelOffsets.reserve(numPlayers+1u);
+    channelOffsets.push_back(0);
+
+    for (size_t i = 0; i < numPlayers; ++i)
     {
-        if (mNumPlays != PLAY_REPEAT)
+        const SL_Animation& anim = graph.mAnimations[pAnimIndices[i]];
+        SL_AnimationPlayer& player = pPlayers[i];
+        SL_AnimPrecision percent;
+
+        if (!player.advance(anim, millis, percent) || !anim.size())
         {
-            --mNumPlays;
+            continue;
         }
+
+        const size_t baseId = pBaseTransformIds ? pBaseTransformIds[i] : SL_SceneNodeProp::SCENE_NODE_ROOT_ID;
+        items.push_back(_SL_AnimationBatchItem{&anim, player.mCursors.data(), baseId, percent});
+        channelOffsets.push_back(channelOffsets.back() + anim.size());
     }
 
-    mCurrentPercent = ls::math::fmod(nextPercent, SL_AnimPrecision{1});
+    _SL_AnimationBatchTask task{&graph, items.data(), channelOffsets.data(), items.size()};
 
-    if (!mNumPlays)
+    if (graph.mContext.num_threads() > 1 && channelOffsets.back() >= SL_ANIMATION_MIN_PARALLEL_CHANNELS)
     {
-        stop_anim();
+        graph.mContext.run_tasks(&_sl_animate_batch, &task);
+    }
+    else
+    {
+        _sl_animate_batch(&task, 0, 1);
     }
 }
 
@@ -356,4 +471,5 @@ void SL_AnimationPlayer::reset() noexcept
     mNumPlays = PLAY_AUTO;
     mCurrentPercent = 0.0;
     mDilation = 1.0;
+    mCursors.clear();
 }
@@ -0,0 +1,107 @@
+#include "lightsky/setup/CPU.h" // ls::setup::cpu_yield()
+
+#include "softlight/SL_BatchProcessor.hpp"
+#include "softlight/SL_ShaderProcessor.hpp"
+#include "softlight/SL_ShaderUtil.hpp" // SL_BinCounterAtomic
+#include "softlight/SL_ThreadStats.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Wait until a bin set has retired a number of runs
+-------------------------------------*/
+inline void _sl_wait_for_retirement(const SL_BinCounterAtomic<uint32_t>& runsRetired, uint32_t numRuns, SL_ThreadStats* pStats) noexcept
+{
+    const uint64_t idleStart = sl_thread_stats_timestamp();
+
+    while (runsRetired.count.load(std::memory_order_acquire) < numRuns)
+    {
+        ls::setup::cpu_yield();
+    }
+
+    sl_thread_stats_add_idle(pStats, idleStart);
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_BatchProcessor Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Execute all draw runs in order
+-------------------------------------*/
+void SL_BatchProcessor::execute() noexcept
+{
+    SL_ShaderProcessor task;
+    SL_ThreadStats* pStats = mStats ? (mStats + mThreadId) : nullptr;
+
+    for (size_t runId = 0; runId < mNumRuns; ++runId)
+    {
+        const SL_DrawRun& run  = mRuns[runId];
+        const SL_BinSet&  bins = mBinSets[runId & 1u];
+
+        // Bins are double-buffered. The run which last used this bin set must
+        // be fully rasterized before its bins can be overwritten.
+        _sl_wait_for_retirement(*bins.pRunsRetired, (uint32_t)(runId >> 1u), pStats);
+
+        // Runs which may read the results of a previous run (render-to-texture
+        // or differing pixel ownership) cannot overlap with it.
+        if (run.waitForPrevious && runId)
+        {
+            const SL_BinSet& prevBins = mBinSets[(runId-1u) & 1u];
+            _sl_wait_for_retirement(*prevBins.pRunsRetired, (uint32_t)(((runId-1u) >> 1u) + 1u), pStats);
+        }
+
+        task.mType = sl_processor_type_for_draw_mode(run.mode);
+
+        SL_VertexProcessor* vertTask = task.processor_for_draw_mode(run.mode);
+        vertTask->mThreadId       = mThreadId;
+        vertTask->mNumThreads     = mNumThreads;
+        vertTask->mFragProcessors = bins.pFragProcessors;
+        vertTask->mBusyProcessors = bins.pBusyProcessors;
+        vertTask->mShader         = run.pShader;
+        vertTask->mContext        = mContext;
+        vertTask->mFbo            = run.pFbo;
+        vertTask->mRenderMode     = run.mode;
+        vertTask->mNumMeshes      = run.numMeshes;
+        vertTask->mNumInstances   = run.numInstances;
+        vertTask->mMeshes         = run.pMeshes;
+        vertTask->mBinsUsed       = bins.pBinsUsed;
+        vertTask->mBinIds         = bins.pBinIds;
+        vertTask->mTempBinIds     = bins.pTempBinIds;
+        vertTask->mFragBins       = bins.pFragBins;
+        vertTask->mFragQueues     = mFragQueues;
+        vertTask->mBinTiles       = bins.pBinTiles;
+        vertTask->mVertChunks     = bins.pVertChunks;
+        vertTask->mThreadStats    = mStats;
+
+        // Coarse depth tiles can only be rebuilt while no other run is
+        // writing to the framebuffer.
+        vertTask->mRebuildDepthTiles = (runId == 0 || run.waitForPrevious) ? 1u : 0u;
+        vertTask->mMeshletCulls      = run.pCulls;
+
+        task();
+
+        // The last thread to leave a run resets its synchronization state so
+        // the bin set can be reused two runs from now.
+        if (bins.pRunExits->count.fetch_add(1u, std::memory_order_acq_rel) == (uint32_t)mNumThreads-1u)
+        {
+            bins.pRunExits->count.store(0u, std::memory_order_relaxed);
+            bins.pBusyProcessors->count.store(mNumThreads, std::memory_order_relaxed);
+            bins.pVertChunks->count.store(0, std::memory_order_relaxed);
+            bins.pRunsRetired->count.fetch_add(1u, std::memory_order_release);
+        }
+    }
+}
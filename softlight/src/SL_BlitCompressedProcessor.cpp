@@ -6,6 +6,8 @@
 
 #include "softlight/SL_BlitCompressedProcesor.hpp"
 #include "softlight/SL_ColorCompressed.hpp"
+#include "softlight/SL_Config.hpp" // SL_FBO_TILED_ENABLED
+#include "softlight/SL_Framebuffer.hpp" // sl_fbo_index()
 #include "softlight/SL_Texture.hpp"
 
 
@@ -34,12 +36,11 @@ struct SL_Blit_Compressed_to_R
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcIndex];
         reinterpret_cast<SL_ColorRType<outColor_type>*>(pOutBuf + outIndex)->r = rgb_cast<outColor_type, compressed_type>(inColor)[0];
     }
 };
@@ -59,12 +60,11 @@ struct SL_Blit_Compressed_to_RG
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGType<outColor_type>*>(pOutBuf + outIndex) = ls::math::vec2_cast(rgba_cast<outColor_type, compressed_type>(inColor));
     }
 };
@@ -84,12 +84,11 @@ struct SL_Blit_Compressed_to_RGB
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGBType<outColor_type>*>(pOutBuf + outIndex) = rgb_cast<outColor_type, compressed_type>(inColor);
     }
 };
@@ -109,12 +108,11 @@ struct SL_Blit_Compressed_to_RGBA
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const compressed_type inColor = ((compressed_type*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGBAType<outColor_type>*>(pOutBuf + outIndex) = rgba_cast<outColor_type, compressed_type>(inColor);
     }
 };
@@ -134,12 +132,11 @@ struct SL_Blit_R_to_Compressed
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRType<inColor_type> inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRType<inColor_type> inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type> inColor   = ls::math::vec3_t<inColor_type>(inColorR.r, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r);
 
         *reinterpret_cast<compressed_type*>(pOutBuf + outIndex) = rgb_cast<compressed_type, inColor_type>(inColor);
@@ -162,12 +159,11 @@ struct SL_Blit_RG_to_Compressed
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGType<inColor_type> inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGType<inColor_type> inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type> inColor   = ls::math::vec3_cast(inColorRG, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r);
 
         *reinterpret_cast<compressed_type*>(pOutBuf + outIndex) = rgb_cast<compressed_type, inColor_type>(inColor);
@@ -189,12 +185,11 @@ struct SL_Blit_RGB_to_Compressed
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<compressed_type*>(pOutBuf + outIndex) = rgb_cast<compressed_type, inColor_type>(inColor);
     }
 };
@@ -214,12 +209,11 @@ struct SL_Blit_RGBA_to_Compressed
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type>  inColor     = ls::math::vec3_cast(inColorRGBA);
 
         *reinterpret_cast<compressed_type*>(pOutBuf + outIndex) = rgb_cast<compressed_type, inColor_type>(inColor);
@@ -241,12 +235,11 @@ struct SL_Blit_Compressed_to_Compressed<inCompressed_type, inCompressed_type>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const inCompressed_type inColor = ((inCompressed_type*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const inCompressed_type inColor = ((inCompressed_type*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<inCompressed_type*>(pOutBuf + outIndex) = inColor;
     }
 };
@@ -266,12 +259,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB565, SL_ColorRGB332>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB565>(inColor);
         *reinterpret_cast<SL_ColorRGB332*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB332, uint8_t>(outColor);
     }
@@ -289,12 +281,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB5551, SL_ColorRGB332>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB5551>(inColor);
         *reinterpret_cast<SL_ColorRGB332*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB332, uint8_t>(outColor);
     }
@@ -312,12 +303,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB4444, SL_ColorRGB332>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB4444>(inColor);
         *reinterpret_cast<SL_ColorRGB332*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB332, uint8_t>(outColor);
     }
@@ -335,12 +325,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB1010102, SL_ColorRGB332>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB1010102>(inColor);
         *reinterpret_cast<SL_ColorRGB332*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB332, uint8_t>(outColor);
     }
@@ -361,12 +350,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB332, SL_ColorRGB565>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB332>(inColor);
         *reinterpret_cast<SL_ColorRGB565*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB565, uint8_t>(outColor);
     }
@@ -384,12 +372,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB5551, SL_ColorRGB565>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB5551>(inColor);
         *reinterpret_cast<SL_ColorRGB565*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB565, uint8_t>(outColor);
     }
@@ -407,12 +394,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB4444, SL_ColorRGB565>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB4444>(inColor);
         *reinterpret_cast<SL_ColorRGB565*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB565, uint8_t>(outColor);
     }
@@ -430,12 +416,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB1010102, SL_ColorRGB565>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcIndex];
         const ls::math::vec3_t<uint8_t> outColor = rgb_cast<uint8_t, SL_ColorRGB1010102>(inColor);
         *reinterpret_cast<SL_ColorRGB565*>(pOutBuf + outIndex) = rgb_cast<SL_ColorRGB565, uint8_t>(outColor);
     }
@@ -456,12 +441,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB332, SL_ColorRGB5551>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outRGBA = rgba_cast<uint8_t, SL_ColorRGB332>(inColor);
         *reinterpret_cast<SL_ColorRGB5551*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB5551, uint8_t>(outRGBA);
     }
@@ -479,12 +463,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB565, SL_ColorRGB5551>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outRGBA = rgba_cast<uint8_t, SL_ColorRGB565>(inColor);
         *reinterpret_cast<SL_ColorRGB5551*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB5551, uint8_t>(outRGBA);
     }
@@ -502,12 +485,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB4444, SL_ColorRGB5551>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outColor = rgba_cast<uint8_t, SL_ColorRGB4444>(inColor);
         *reinterpret_cast<SL_ColorRGB5551*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB5551, uint8_t>(outColor);
     }
@@ -525,12 +507,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB1010102, SL_ColorRGB5551>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outColor = rgba_cast<uint8_t, SL_ColorRGB1010102>(inColor);
         *reinterpret_cast<SL_ColorRGB5551*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB5551, uint8_t>(outColor);
     }
@@ -551,12 +532,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB332, SL_ColorRGB4444>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outRGBA = rgba_cast<uint8_t, SL_ColorRGB332>(inColor);
         *reinterpret_cast<SL_ColorRGB4444*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB4444, uint8_t>(outRGBA);
     }
@@ -574,12 +554,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB565, SL_ColorRGB4444>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outRGBA = rgba_cast<uint8_t, SL_ColorRGB565>(inColor);
         *reinterpret_cast<SL_ColorRGB4444*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB4444, uint8_t>(outRGBA);
     }
@@ -597,12 +576,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB5551, SL_ColorRGB4444>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outColor = rgba_cast<uint8_t, SL_ColorRGB5551>(inColor);
         *reinterpret_cast<SL_ColorRGB4444*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB4444, uint8_t>(outColor);
     }
@@ -620,12 +598,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB1010102, SL_ColorRGB4444>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB1010102 inColor = ((SL_ColorRGB1010102*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint8_t> outColor = rgba_cast<uint8_t, SL_ColorRGB1010102>(inColor);
         *reinterpret_cast<SL_ColorRGB4444*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB4444, uint8_t>(outColor);
     }
@@ -646,12 +623,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB332, SL_ColorRGB1010102>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB332 inColor = ((SL_ColorRGB332*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint16_t> outRGBA = rgba_cast<uint16_t, SL_ColorRGB332>(inColor);
         *reinterpret_cast<SL_ColorRGB1010102*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB1010102, uint16_t>(outRGBA);
     }
@@ -669,12 +645,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB565, SL_ColorRGB1010102>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB565 inColor = ((SL_ColorRGB565*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint16_t> outRGBA = rgba_cast<uint16_t, SL_ColorRGB565>(inColor);
         *reinterpret_cast<SL_ColorRGB1010102*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB1010102, uint16_t>(outRGBA);
     }
@@ -692,12 +667,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB5551, SL_ColorRGB1010102>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB5551 inColor = ((SL_ColorRGB5551*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint16_t> outColor = rgba_cast<uint16_t, SL_ColorRGB5551>(inColor);
         *reinterpret_cast<SL_ColorRGB1010102*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB1010102, uint16_t>(outColor);
     }
@@ -715,12 +689,11 @@ struct SL_Blit_Compressed_to_Compressed<SL_ColorRGB4444, SL_ColorRGB1010102>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGB4444 inColor = ((SL_ColorRGB4444*)pTexture->pTexels)[srcIndex];
         const ls::math::vec4_t<uint16_t> outColor = rgba_cast<uint16_t, SL_ColorRGB4444>(inColor);
         *reinterpret_cast<SL_ColorRGB1010102*>(pOutBuf + outIndex) = rgba_cast<SL_ColorRGB1010102, uint16_t>(outColor);
     }
@@ -897,6 +870,11 @@ void SL_BlitCompressedProcessor::blit_nearest() noexcept
     const uint_fast32_t foutW = (finW / totalOutW) + 1u; // account for rounding errors
     const uint_fast32_t foutH = (finH / totalOutH) + 1u;
 
+    // Framebuffer attachments may be stored in tiles. Other textures, and
+    // window buffers, are always row-major.
+    const bool srcTiled = SL_FBO_TILED_ENABLED && mSrcTiled;
+    const bool dstTiled = SL_FBO_TILED_ENABLED && mDstTiled;
+
     uint_fast32_t y = y0;
 
     while (LS_LIKELY(y < y1))
@@ -912,7 +890,15 @@ void SL_BlitCompressedProcessor::blit_nearest() noexcept
             const uint_fast32_t xf   = x * foutW;
             const uint_fast32_t srcX = xf >> NUM_FIXED_BITS;
 
-            blitOp(mSrcTex, srcX, srcY, pOutBuf, outIndex);
+            const ptrdiff_t srcIndex = srcTiled
+                ? sl_fbo_index(*mSrcTex, srcX, srcY)
+                : sl_texture_view_index<SL_TexelOrder::ORDERED>(*mSrcTex, srcX, srcY);
+
+            const uint_fast32_t dstIndex = dstTiled
+                ? (uint_fast32_t)sl_fbo_index(*mDstTex, x, y) * BlitOp::stride
+                : outIndex;
+
+            blitOp(mSrcTex, srcIndex, pOutBuf, dstIndex);
             ++x;
             outIndex += BlitOp::stride;
         }
@@ -6,6 +6,8 @@
 
 #include "softlight/SL_BlitProcesor.hpp"
 #include "softlight/SL_Color.hpp"
+#include "softlight/SL_Config.hpp" // SL_FBO_TILED_ENABLED
+#include "softlight/SL_Framebuffer.hpp" // sl_fbo_index()
 #include "softlight/SL_Texture.hpp"
 
 
@@ -28,12 +30,11 @@ struct SL_Blit_R_to_R
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRType<inColor_type> inColor = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRType<inColor_type> inColor = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
     }
 };
@@ -48,12 +49,11 @@ struct SL_Blit_RG_to_R
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGType<inColor_type> inColor = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGType<inColor_type> inColor = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor)[0];
     }
 };
@@ -68,12 +68,11 @@ struct SL_Blit_RGB_to_R
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor)[0];
     }
 };
@@ -88,12 +87,11 @@ struct SL_Blit_RGBA_to_R
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<inColor_type> inColor = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<inColor_type> inColor = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor)[0];
     }
 };
@@ -113,12 +111,11 @@ struct SL_Blit_R_to_RG
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRType<inColor_type>  inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRType<inColor_type>  inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGType<inColor_type> inColor  = SL_ColorRGType<inColor_type>{inColorR[0], SL_ColorLimits<inColor_type, SL_ColorRType>::min().r};
 
         *reinterpret_cast<SL_ColorRGType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -135,12 +132,11 @@ struct SL_Blit_RG_to_RG
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGType<inColor_type> inColor = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGType<inColor_type> inColor = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
     }
 };
@@ -155,12 +151,11 @@ struct SL_Blit_RGB_to_RG
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBType<inColor_type> inColorRGB = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBType<inColor_type> inColorRGB = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGType<inColor_type>  inColor    = ls::math::vec2_cast(inColorRGB);
 
         *reinterpret_cast<SL_ColorRGType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -177,12 +172,11 @@ struct SL_Blit_RGBA_to_RG
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGType<inColor_type>   inColor     = ls::math::vec2_cast(inColorRGBA);
 
         *reinterpret_cast<SL_ColorRGType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -204,12 +198,11 @@ struct SL_Blit_R_to_RGB
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRType<inColor_type>   inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRType<inColor_type>   inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type> inColor  = SL_ColorRGBType<inColor_type>{SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, inColorR[0]};
 
         *reinterpret_cast<SL_ColorRGBType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -226,12 +219,11 @@ struct SL_Blit_RG_to_RGB
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGType<inColor_type>  inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGType<inColor_type>  inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type> inColor   = ls::math::vec3_cast(inColorRG, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r);
 
         *reinterpret_cast<SL_ColorRGBType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -248,12 +240,11 @@ struct SL_Blit_RGB_to_RGB
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBType<inColor_type> inColor = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGBType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
     }
 };
@@ -268,12 +259,11 @@ struct SL_Blit_RGBA_to_RGB
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<inColor_type> inColorRGBA = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBType<inColor_type>  inColor     = ls::math::vec3_cast(inColorRGBA);
 
         *reinterpret_cast<SL_ColorRGBType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -295,12 +285,11 @@ struct SL_Blit_R_to_RGBA
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRType<inColor_type>    inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRType<inColor_type>    inColorR = ((SL_ColorRType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBAType<inColor_type> inColor  = SL_ColorRGBAType<inColor_type>{SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, inColorR[0], SL_ColorLimits<inColor_type, SL_ColorRGBAType>::max()[3]};
 
         *reinterpret_cast<SL_ColorRGBAType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -317,12 +306,11 @@ struct SL_Blit_RG_to_RGBA
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGType<inColor_type>   inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGType<inColor_type>   inColorRG = ((SL_ColorRGType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBAType<inColor_type> inColor   = ls::math::vec4_cast(SL_ColorLimits<inColor_type, SL_ColorRType>::min().r, inColorRG, SL_ColorLimits<inColor_type, SL_ColorRGBAType>::max()[3]);
 
         *reinterpret_cast<SL_ColorRGBAType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -339,12 +327,11 @@ struct SL_Blit_RGB_to_RGBA
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBType<inColor_type>  inColorRGB = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBType<inColor_type>  inColorRGB = ((SL_ColorRGBType<inColor_type>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBAType<inColor_type> inColor    = ls::math::vec4_cast(inColorRGB, SL_ColorLimits<inColor_type, SL_ColorRGBAType>::max()[3]);
 
         *reinterpret_cast<SL_ColorRGBAType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
@@ -362,12 +349,11 @@ struct SL_Blit_RGBA_to_RGBA
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<inColor_type> inColor = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<inColor_type> inColor = ((SL_ColorRGBAType<inColor_type>*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<SL_ColorRGBAType<outColor_type>*>(pOutBuf + outIndex) = color_cast<outColor_type, inColor_type>(inColor);
     }
 };
@@ -384,12 +370,11 @@ struct SL_Blit_RGBA_to_RGBA<uint8_t, uint8_t>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const int32_t inColor = ((int32_t*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const int32_t inColor = ((int32_t*)pTexture->pTexels)[srcIndex];
         *reinterpret_cast<int32_t*>(pOutBuf + outIndex) = inColor;
     }
 };
@@ -406,12 +391,11 @@ struct SL_Blit_RGBA_to_RGBA<float, uint8_t>
 
     inline LS_INLINE void operator()(
         const SL_TextureView* pTexture,
-        const uint_fast32_t srcX,
-        const uint_fast32_t srcY,
+        const ptrdiff_t srcIndex,
         unsigned char* const pOutBuf,
         uint_fast32_t outIndex) const noexcept
     {
-        const SL_ColorRGBAType<float>   inColor = ((SL_ColorRGBAType<float>*)pTexture->pTexels)[srcX + (uint_fast32_t)pTexture->width * srcY];
+        const SL_ColorRGBAType<float>   inColor = ((SL_ColorRGBAType<float>*)pTexture->pTexels)[srcIndex];
         const SL_ColorRGBAType<uint8_t> in = color_cast<uint8_t, float>(inColor);
         *reinterpret_cast<int32_t*>(pOutBuf + outIndex) = reinterpret_cast<const int32_t&>(in);
     }
@@ -625,6 +609,11 @@ void SL_BlitProcessor::blit_nearest() noexcept
     const uint_fast32_t foutW = (finW / totalOutW) + 1u; // account for rounding errors
     const uint_fast32_t foutH = (finH / totalOutH) + 1u;
 
+    // Framebuffer attachments may be stored in tiles. Other textures, and
+    // window buffers, are always row-major.
+    const bool srcTiled = SL_FBO_TILED_ENABLED && mSrcTiled;
+    const bool dstTiled = SL_FBO_TILED_ENABLED && mDstTiled;
+
     uint_fast32_t y = y0;
 
     while (LS_LIKELY(y < y1))
@@ -640,7 +629,15 @@ void SL_BlitProcessor::blit_nearest() noexcept
             const uint_fast32_t xf   = x * foutW;
             const uint_fast32_t srcX = xf >> NUM_FIXED_BITS;
 
-            blitOp(mSrcTex, srcX, srcY, pOutBuf, outIndex);
+            const ptrdiff_t srcIndex = srcTiled
+                ? sl_fbo_index(*mSrcTex, srcX, srcY)
+                : sl_texture_view_index<SL_TexelOrder::ORDERED>(*mSrcTex, srcX, srcY);
+
+            const uint_fast32_t dstIndex = dstTiled
+                ? (uint_fast32_t)sl_fbo_index(*mDstTex, x, y) * BlipOp::stride
+                : outIndex;
+
+            blitOp(mSrcTex, srcIndex, pOutBuf, dstIndex);
             ++x;
             outIndex += BlipOp::stride;
         }
@@ -0,0 +1,807 @@
+
+#include <algorithm> // std::lower_bound, std::nth_element
+#include <utility> // std::move
+
+#include "lightsky/setup/Api.h" // LS_INLINE
+
+#include "lightsky/math/scalar_utils.h" // abs
+#include "lightsky/math/vec_utils.h" // min, max
+
+#include "lightsky/utils/Assertions.h"
+
+#include "softlight/SL_BoundingVolumeHierarchy.hpp"
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Number of subtrees to give each thread while culling. Extra subtrees help
+ * balance the work when parts of the scene are off-screen.
+-------------------------------------*/
+constexpr size_t SL_BVH_ROOTS_PER_THREAD = 4;
+
+
+
+/*-------------------------------------
+ * Each node can add (SL_BVH_LANES-1) entries to the traversal stack. Median
+ * splits keep the tree balanced, so this covers far more items than can be
+ * indexed by a BVH node.
+-------------------------------------*/
+constexpr size_t SL_BVH_STACK_SIZE = 128;
+
+
+
+/*-------------------------------------
+ * 4-wide vector helpers
+-------------------------------------*/
+#if defined(LS_X86_SSE2)
+    typedef __m128 _sl_float4;
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return _mm_load_ps(p); }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return _mm_set1_ps(a); }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { return _mm_add_ps(a, b); }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { return _mm_mul_ps(a, b); }
+
+    // a*b + c
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    // One bit per lane, set where a < b
+    inline LS_INLINE unsigned _sl_lt_mask4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        return (unsigned)_mm_movemask_ps(_mm_cmplt_ps(a, b));
+    }
+
+#elif defined(LS_ARM_NEON)
+    typedef float32x4_t _sl_float4;
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return vld1q_f32(p); }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return vdupq_n_f32(a); }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { return vaddq_f32(a, b); }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { return vmulq_f32(a, b); }
+
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        return vmlaq_f32(c, a, b);
+    }
+
+    inline LS_INLINE unsigned _sl_lt_mask4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        const uint32_t laneBits[4] = {1u, 2u, 4u, 8u};
+        const uint32x4_t bits = vandq_u32(vcltq_f32(a, b), vld1q_u32(laneBits));
+        const uint32x2_t half = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+        return (unsigned)(vget_lane_u32(half, 0) | vget_lane_u32(half, 1));
+    }
+
+#else
+    struct _sl_float4
+    {
+        float v[SL_BVH_LANES];
+    };
+
+    inline LS_INLINE _sl_float4 _sl_load4(const float* p) noexcept { return _sl_float4{{p[0], p[1], p[2], p[3]}}; }
+    inline LS_INLINE _sl_float4 _sl_set4(float a) noexcept { return _sl_float4{{a, a, a, a}}; }
+    inline LS_INLINE _sl_float4 _sl_add4(_sl_float4 a, _sl_float4 b) noexcept { for (unsigned i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    inline LS_INLINE _sl_float4 _sl_mul4(_sl_float4 a, _sl_float4 b) noexcept { for (unsigned i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+
+    inline LS_INLINE _sl_float4 _sl_fmadd4(_sl_float4 a, _sl_float4 b, _sl_float4 c) noexcept
+    {
+        for (unsigned i = 0; i < 4; ++i) a.v[i] = a.v[i] * b.v[i] + c.v[i];
+        return a;
+    }
+
+    inline LS_INLINE unsigned _sl_lt_mask4(_sl_float4 a, _sl_float4 b) noexcept
+    {
+        unsigned mask = 0;
+        for (unsigned i = 0; i < 4; ++i) mask |= (a.v[i] < b.v[i] ? 1u : 0u) << i;
+        return mask;
+    }
+
+#endif
+
+
+
+/*-------------------------------------
+ * Frustum planes, splatted across all lanes
+-------------------------------------*/
+struct _SL_BVHPlanes
+{
+    _sl_float4 nx[6];
+    _sl_float4 ny[6];
+    _sl_float4 nz[6];
+    _sl_float4 d[6];
+
+    // Absolute value of each plane normal, used to project a box's extents
+    _sl_float4 ax[6];
+    _sl_float4 ay[6];
+    _sl_float4 az[6];
+};
+
+
+
+/*-------------------------------------
+ * Hierarchy data shared between threads while culling
+-------------------------------------*/
+struct _SL_BVHCullTask
+{
+    const SL_BVHNode* pNodes;
+    const uint32_t* pItemOrder;
+    const SL_DrawItem* pItems;
+    const _SL_BVHPlanes* pPlanes;
+    const uint32_t* pRoots;
+    size_t numRoots;
+    SL_AlignedVector<SL_DrawItem>* pThreadItems;
+};
+
+
+
+/*-------------------------------------
+ * Transform a mesh's bounding box into world space (Arvo's method)
+-------------------------------------*/
+inline SL_BoundingBox _sl_world_bounds(const SL_BoundingBox& localBounds, const math::mat4& modelMat) noexcept
+{
+    const math::vec4& localMin = localBounds.min_point();
+    const math::vec4& localMax = localBounds.max_point();
+    const math::vec4&& center  = (localMax + localMin) * 0.5f;
+    const math::vec4&& extent  = (localMax - localMin) * 0.5f;
+
+    const math::vec4&& worldCenter = modelMat * math::vec4{center[0], center[1], center[2], 1.f};
+    math::vec4 worldExtent{0.f};
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        worldExtent[i] =
+            math::abs(modelMat[0][i]) * extent[0] +
+            math::abs(modelMat[1][i]) * extent[1] +
+            math::abs(modelMat[2][i]) * extent[2];
+    }
+
+    SL_BoundingBox worldBounds;
+    worldBounds.min_point(worldCenter - worldExtent);
+    worldBounds.max_point(worldCenter + worldExtent);
+    return worldBounds;
+}
+
+
+
+/*-------------------------------------
+ * Test all lanes of a node against each frustum plane. Returns one bit for
+ * each visible lane. Lanes which are entirely within the frustum are also
+ * flagged in "outInside".
+-------------------------------------*/
+inline unsigned _sl_cull_node(const SL_BVHNode& node, const _SL_BVHPlanes& planes, unsigned& outInside) noexcept
+{
+    const _sl_float4 cx = _sl_load4(node.mCenterX);
+    const _sl_float4 cy = _sl_load4(node.mCenterY);
+    const _sl_float4 cz = _sl_load4(node.mCenterZ);
+    const _sl_float4 ex = _sl_load4(node.mExtentX);
+    const _sl_float4 ey = _sl_load4(node.mExtentY);
+    const _sl_float4 ez = _sl_load4(node.mExtentZ);
+    const _sl_float4 zero = _sl_set4(0.f);
+
+    unsigned outside = 0;
+    unsigned partial = 0;
+
+    for (unsigned p = 0; p < 6; ++p)
+    {
+        const _sl_float4 dist = _sl_fmadd4(planes.nx[p], cx, _sl_fmadd4(planes.ny[p], cy, _sl_fmadd4(planes.nz[p], cz, planes.d[p])));
+        const _sl_float4 radius = _sl_fmadd4(planes.ax[p], ex, _sl_fmadd4(planes.ay[p], ey, _sl_mul4(planes.az[p], ez)));
+
+        outside |= _sl_lt_mask4(_sl_add4(dist, radius), zero);
+        partial |= _sl_lt_mask4(dist, radius);
+    }
+
+    unsigned used = 0;
+    for (unsigned lane = 0; lane < SL_BVH_LANES; ++lane)
+    {
+        used |= (node.mNumItems[lane] ? 1u : 0u) << lane;
+    }
+
+    const unsigned visible = used & ~outside;
+    outInside = visible & ~partial;
+
+    return visible;
+}
+
+
+
+/*-------------------------------------
+ * Append every draw item covered by a lane
+-------------------------------------*/
+inline void _sl_append_lane(
+    const _SL_BVHCullTask& task,
+    const SL_BVHNode& node,
+    unsigned lane,
+    SL_AlignedVector<SL_DrawItem>& outItems) noexcept
+{
+    const uint32_t first = node.mFirstItem[lane];
+    const uint32_t last = first + node.mNumItems[lane];
+
+    for (uint32_t i = first; i < last; ++i)
+    {
+        outItems.push_back(task.pItems[task.pItemOrder[i]]);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Cull a single node, queueing visible children which are partially outside
+ * the frustum. Returns the new size of the queue.
+-------------------------------------*/
+inline size_t _sl_cull_lanes(
+    const _SL_BVHCullTask& task,
+    uint32_t nodeId,
+    uint32_t* pQueue,
+    size_t queueSize,
+    SL_AlignedVector<SL_DrawItem>& outItems) noexcept
+{
+    const SL_BVHNode& node = task.pNodes[nodeId];
+    unsigned inside;
+    const unsigned visible = _sl_cull_node(node, *task.pPlanes, inside);
+
+    for (unsigned lane = 0; lane < SL_BVH_LANES; ++lane)
+    {
+        const unsigned laneBit = 1u << lane;
+
+        if (!(visible & laneBit))
+        {
+            continue;
+        }
+
+        if ((inside & laneBit) || node.mChildren[lane] == SL_BVH_INVALID_NODE)
+        {
+            _sl_append_lane(task, node, lane, outItems);
+        }
+        else
+        {
+            pQueue[queueSize++] = node.mChildren[lane];
+        }
+    }
+
+    return queueSize;
+}
+
+
+
+/*-------------------------------------
+ * Cull a contiguous range of subtrees on each thread
+-------------------------------------*/
+void _sl_cull_subtrees(void* pUserData, uint32_t threadId, uint32_t numThreads) noexcept
+{
+    const _SL_BVHCullTask* const pTask = reinterpret_cast<const _SL_BVHCullTask*>(pUserData);
+    SL_AlignedVector<SL_DrawItem>& outItems = pTask->pThreadItems[threadId];
+
+    const size_t begin = (pTask->numRoots * threadId) / numThreads;
+    const size_t end   = (pTask->numRoots * (threadId+1u)) / numThreads;
+
+    uint32_t stack[SL_BVH_STACK_SIZE];
+
+    for (size_t r = begin; r < end; ++r)
+    {
+        size_t stackSize = 0;
+        stack[stackSize++] = pTask->pRoots[r];
+
+        while (stackSize)
+        {
+            LS_DEBUG_ASSERT(stackSize + SL_BVH_LANES <= SL_BVH_STACK_SIZE);
+            const uint32_t nodeId = stack[--stackSize];
+            stackSize = _sl_cull_lanes(*pTask, nodeId, stack, stackSize, outItems);
+        }
+    }
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * Bounding Volume Hierarchy
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Destructor
+-------------------------------------*/
+SL_BoundingVolumeHierarchy::~SL_BoundingVolumeHierarchy() noexcept
+{
+    terminate();
+}
+
+
+
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+SL_BoundingVolumeHierarchy::SL_BoundingVolumeHierarchy() noexcept :
+    mNumSceneNodes{0},
+    mNodes{},
+    mItems{},
+    mItemBounds{},
+    mItemOrder{},
+    mItemLeaves{},
+    mDirtyNodes{},
+    mCullRoots{},
+    mThreadItems{}
+{}
+
+
+
+/*-------------------------------------
+ * Copy Constructor
+-------------------------------------*/
+SL_BoundingVolumeHierarchy::SL_BoundingVolumeHierarchy(const SL_BoundingVolumeHierarchy& bvh) noexcept :
+    mNumSceneNodes{bvh.mNumSceneNodes},
+    mNodes{bvh.mNodes},
+    mItems{bvh.mItems},
+    mItemBounds{bvh.mItemBounds},
+    mItemOrder{bvh.mItemOrder},
+    mItemLeaves{bvh.mItemLeaves},
+    mDirtyNodes{bvh.mDirtyNodes},
+    mCullRoots{},
+    mThreadItems{}
+{}
+
+
+
+/*-------------------------------------
+ * Move Constructor
+-------------------------------------*/
+SL_BoundingVolumeHierarchy::SL_BoundingVolumeHierarchy(SL_BoundingVolumeHierarchy&& bvh) noexcept :
+    mNumSceneNodes{bvh.mNumSceneNodes},
+    mNodes{std::move(bvh.mNodes)},
+    mItems{std::move(bvh.mItems)},
+    mItemBounds{std::move(bvh.mItemBounds)},
+    mItemOrder{std::move(bvh.mItemOrder)},
+    mItemLeaves{std::move(bvh.mItemLeaves)},
+    mDirtyNodes{std::move(bvh.mDirtyNodes)},
+    mCullRoots{std::move(bvh.mCullRoots)},
+    mThreadItems{std::move(bvh.mThreadItems)}
+{
+    bvh.mNumSceneNodes = 0;
+}
+
+
+
+/*-------------------------------------
+ * Copy Operator
+-------------------------------------*/
+SL_BoundingVolumeHierarchy& SL_BoundingVolumeHierarchy::operator=(const SL_BoundingVolumeHierarchy& bvh) noexcept
+{
+    if (this != &bvh)
+    {
+        mNumSceneNodes = bvh.mNumSceneNodes;
+        mNodes = bvh.mNodes;
+        mItems = bvh.mItems;
+        mItemBounds = bvh.mItemBounds;
+        mItemOrder = bvh.mItemOrder;
+        mItemLeaves = bvh.mItemLeaves;
+        mDirtyNodes = bvh.mDirtyNodes;
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Move Operator
+-------------------------------------*/
+SL_BoundingVolumeHierarchy& SL_BoundingVolumeHierarchy::operator=(SL_BoundingVolumeHierarchy&& bvh) noexcept
+{
+    if (this != &bvh)
+    {
+        mNumSceneNodes = bvh.mNumSceneNodes;
+        bvh.mNumSceneNodes = 0;
+
+        mNodes = std::move(bvh.mNodes);
+        mItems = std::move(bvh.mItems);
+        mItemBounds = std::move(bvh.mItemBounds);
+        mItemOrder = std::move(bvh.mItemOrder);
+        mItemLeaves = std::move(bvh.mItemLeaves);
+        mDirtyNodes = std::move(bvh.mDirtyNodes);
+        mCullRoots = std::move(bvh.mCullRoots);
+        mThreadItems = std::move(bvh.mThreadItems);
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Recalculate the bounds of a single lane
+-------------------------------------*/
+void SL_BoundingVolumeHierarchy::update_lane(SL_BVHNode& node, unsigned lane) noexcept
+{
+    if (!node.mNumItems[lane])
+    {
+        return;
+    }
+
+    math::vec4 boxMin;
+    math::vec4 boxMax;
+    const uint32_t childId = node.mChildren[lane];
+
+    if (childId == SL_BVH_INVALID_NODE)
+    {
+        const SL_BoundingBox& bounds = mItemBounds[mItemOrder[node.mFirstItem[lane]]];
+        boxMin = bounds.min_point();
+        boxMax = bounds.max_point();
+    }
+    else
+    {
+        const SL_BVHNode& child = mNodes[childId];
+        bool first = true;
+
+        for (unsigned i = 0; i < SL_BVH_LANES; ++i)
+        {
+            if (!child.mNumItems[i])
+            {
+                continue;
+            }
+
+            const math::vec4 c{child.mCenterX[i], child.mCenterY[i], child.mCenterZ[i], 0.f};
+            const math::vec4 e{child.mExtentX[i], child.mExtentY[i], child.mExtentZ[i], 0.f};
+
+            boxMin = first ? (c - e) : math::min(boxMin, c - e);
+            boxMax = first ? (c + e) : math::max(boxMax, c + e);
+            first = false;
+        }
+    }
+
+    const math::vec4&& center = (boxMax + boxMin) * 0.5f;
+    const math::vec4&& extent = (boxMax - boxMin) * 0.5f;
+
+    node.mCenterX[lane] = center[0];
+    node.mCenterY[lane] = center[1];
+    node.mCenterZ[lane] = center[2];
+    node.mExtentX[lane] = extent[0];
+    node.mExtentY[lane] = extent[1];
+    node.mExtentZ[lane] = extent[2];
+}
+
+
+
+/*-------------------------------------
+ * Recursively build a node from a range of draw items
+-------------------------------------*/
+uint32_t SL_BoundingVolumeHierarchy::build_node(uint32_t parentId, uint32_t first, uint32_t last) noexcept
+{
+    const uint32_t nodeId = (uint32_t)mNodes.size();
+
+    mNodes.push_back(SL_BVHNode{});
+    mNodes[nodeId].mParent = parentId;
+
+    for (unsigned lane = 0; lane < SL_BVH_LANES; ++lane)
+    {
+        mNodes[nodeId].mChildren[lane] = SL_BVH_INVALID_NODE;
+    }
+
+    // Repeatedly split the largest range of items at its median until each
+    // lane has been assigned a range.
+    uint32_t splits[SL_BVH_LANES+1] = {first, last};
+    unsigned numRanges = 1;
+
+    while (numRanges < SL_BVH_LANES)
+    {
+        unsigned largest = 0;
+        for (unsigned r = 1; r < numRanges; ++r)
+        {
+            if ((splits[r+1] - splits[r]) > (splits[largest+1] - splits[largest]))
+            {
+                largest = r;
+            }
+        }
+
+        const uint32_t rangeBegin = splits[largest];
+        const uint32_t rangeEnd = splits[largest+1];
+
+        if (rangeEnd - rangeBegin < 2u)
+        {
+            break;
+        }
+
+        // Sort along the longest axis of the item centers
+        math::vec4 centerMin = mItemBounds[mItemOrder[rangeBegin]].min_point() + mItemBounds[mItemOrder[rangeBegin]].max_point();
+        math::vec4 centerMax = centerMin;
+
+        for (uint32_t i = rangeBegin+1u; i < rangeEnd; ++i)
+        {
+            const SL_BoundingBox& bounds = mItemBounds[mItemOrder[i]];
+            const math::vec4&& center = bounds.min_point() + bounds.max_point();
+            centerMin = math::min(centerMin, center);
+            centerMax = math::max(centerMax, center);
+        }
+
+        const math::vec4&& centerRange = centerMax - centerMin;
+        const unsigned axis = (centerRange[0] >= centerRange[1] && centerRange[0] >= centerRange[2]) ? 0u : (centerRange[1] >= centerRange[2] ? 1u : 2u);
+        const uint32_t mid = rangeBegin + (rangeEnd - rangeBegin) / 2u;
+        const SL_BoundingBox* const pBounds = mItemBounds.data();
+
+        std::nth_element(
+            mItemOrder.begin() + rangeBegin,
+            mItemOrder.begin() + mid,
+            mItemOrder.begin() + rangeEnd,
+            [pBounds, axis](uint32_t a, uint32_t b) noexcept->bool
+            {
+                return (pBounds[a].min_point()[axis] + pBounds[a].max_point()[axis]) < (pBounds[b].min_point()[axis] + pBounds[b].max_point()[axis]);
+            });
+
+        for (unsigned r = numRanges+1u; r > largest+1u; --r)
+        {
+            splits[r] = splits[r-1u];
+        }
+
+        splits[largest+1u] = mid;
+        ++numRanges;
+    }
+
+    for (unsigned lane = 0; lane < numRanges; ++lane)
+    {
+        const uint32_t laneBegin = splits[lane];
+        const uint32_t laneEnd = splits[lane+1u];
+
+        mNodes[nodeId].mFirstItem[lane] = laneBegin;
+        mNodes[nodeId].mNumItems[lane] = laneEnd - laneBegin;
+
+        if (laneEnd - laneBegin > 1u)
+        {
+            // The node array may be reallocated while building children
+            const uint32_t childId = build_node(nodeId, laneBegin, laneEnd);
+            mNodes[nodeId].mChildren[lane] = childId;
+        }
+        else
+        {
+            mItemLeaves[mItemOrder[laneBegin]] = nodeId;
+        }
+
+        update_lane(mNodes[nodeId], lane);
+    }
+
+    return nodeId;
+}
+
+
+
+/*-------------------------------------
+ * Build the hierarchy
+-------------------------------------*/
+int SL_BoundingVolumeHierarchy::init(const SL_SceneGraph& graph) noexcept
+{
+    terminate();
+
+    mNumSceneNodes = graph.mNodes.size();
+
+    for (size_t nodeId = 0; nodeId < graph.mNodes.size(); ++nodeId)
+    {
+        const SL_SceneNode& node = graph.mNodes[nodeId];
+        if (node.type != NODE_TYPE_MESH)
+        {
+            continue;
+        }
+
+        const size_t numMeshes = graph.mNumNodeMeshes[node.dataId];
+        const ls::utils::Pointer<size_t[]>& meshIds = graph.mNodeMeshes[node.dataId];
+
+        for (size_t m = 0; m < numMeshes; ++m)
+        {
+            const size_t meshId = meshIds[m];
+            mItems.push_back(SL_DrawItem{nodeId, meshId});
+            mItemBounds.push_back(_sl_world_bounds(graph.mMeshBounds[meshId], graph.mModelMatrices[nodeId]));
+        }
+    }
+
+    if (mItems.empty())
+    {
+        return -1;
+    }
+
+    const uint32_t numItems = (uint32_t)mItems.size();
+    mItemOrder.resize(numItems);
+    mItemLeaves.resize(numItems);
+
+    for (uint32_t i = 0; i < numItems; ++i)
+    {
+        mItemOrder[i] = i;
+    }
+
+    mNodes.reserve(numItems);
+    build_node(SL_BVH_INVALID_NODE, 0, numItems);
+
+    mDirtyNodes.resize(mNodes.size(), 0);
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Free all nodes
+-------------------------------------*/
+void SL_BoundingVolumeHierarchy::terminate() noexcept
+{
+    mNumSceneNodes = 0;
+    mNodes.clear();
+    mItems.clear();
+    mItemBounds.clear();
+    mItemOrder.clear();
+    mItemLeaves.clear();
+    mDirtyNodes.clear();
+    mCullRoots.clear();
+    mThreadItems.clear();
+}
+
+
+
+/*-------------------------------------
+ * Refit the nodes moved by a scene graph update
+-------------------------------------*/
+void SL_BoundingVolumeHierarchy::refit(const SL_SceneGraph& graph) noexcept
+{
+    if (graph.mNodes.size() != mNumSceneNodes)
+    {
+        init(graph);
+        return;
+    }
+
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    size_t lastDirty = 0;
+    bool haveDirty = false;
+
+    for (const std::pair<size_t, size_t>& range : graph.dirty_ranges())
+    {
+        // Draw items are sorted by node ID, the same as the dirty ranges
+        const SL_AlignedVector<SL_DrawItem>::const_iterator iter = std::lower_bound(
+            mItems.cbegin(),
+            mItems.cend(),
+            range.first,
+            [](const SL_DrawItem& item, size_t nodeId) noexcept->bool
+            {
+                return item.nodeId < nodeId;
+            });
+
+        for (size_t i = (size_t)(iter - mItems.cbegin()); i < mItems.size() && mItems[i].nodeId < range.second; ++i)
+        {
+            const SL_DrawItem& item = mItems[i];
+            mItemBounds[i] = _sl_world_bounds(graph.mMeshBounds[item.meshId], graph.mModelMatrices[item.nodeId]);
+
+            const uint32_t leafId = mItemLeaves[i];
+            mDirtyNodes[leafId] = 1;
+            lastDirty = leafId > lastDirty ? leafId : lastDirty;
+            haveDirty = true;
+        }
+    }
+
+    if (!haveDirty)
+    {
+        return;
+    }
+
+    // Children are stored after their parents. Walking backwards refits every
+    // child before the parent which contains it.
+    for (size_t nodeId = lastDirty+1u; nodeId--;)
+    {
+        if (!mDirtyNodes[nodeId])
+        {
+            continue;
+        }
+
+        mDirtyNodes[nodeId] = 0;
+        SL_BVHNode& node = mNodes[nodeId];
+
+        for (unsigned lane = 0; lane < SL_BVH_LANES; ++lane)
+        {
+            update_lane(node, lane);
+        }
+
+        if (node.mParent != SL_BVH_INVALID_NODE)
+        {
+            mDirtyNodes[node.mParent] = 1;
+        }
+    }
+}
+
+
+
+/*-------------------------------------
+ * Gather all visible draw items
+-------------------------------------*/
+size_t SL_BoundingVolumeHierarchy::cull(
+    SL_Context& context,
+    const math::vec4 planes[6],
+    SL_AlignedVector<SL_DrawItem>& outDrawList) noexcept
+{
+    outDrawList.clear();
+
+    if (mNodes.empty())
+    {
+        return 0;
+    }
+
+    _SL_BVHPlanes splatPlanes;
+    for (unsigned p = 0; p < 6; ++p)
+    {
+        splatPlanes.nx[p] = _sl_set4(planes[p][0]);
+        splatPlanes.ny[p] = _sl_set4(planes[p][1]);
+        splatPlanes.nz[p] = _sl_set4(planes[p][2]);
+        splatPlanes.d[p]  = _sl_set4(planes[p][3]);
+        splatPlanes.ax[p] = _sl_set4(math::abs(planes[p][0]));
+        splatPlanes.ay[p] = _sl_set4(math::abs(planes[p][1]));
+        splatPlanes.az[p] = _sl_set4(math::abs(planes[p][2]));
+    }
+
+    const unsigned numThreads = context.num_threads() ? context.num_threads() : 1u;
+    const size_t maxRoots = numThreads * SL_BVH_ROOTS_PER_THREAD;
+
+    _SL_BVHCullTask task;
+    task.pNodes       = mNodes.data();
+    task.pItemOrder   = mItemOrder.data();
+    task.pItems       = mItems.data();
+    task.pPlanes      = &splatPlanes;
+    task.pRoots       = nullptr;
+    task.numRoots     = 0;
+    task.pThreadItems = nullptr;
+
+    // Expand the top of the tree breadth-first until there are enough
+    // subtrees to share between threads.
+    mCullRoots.resize(SL_BVH_LANES);
+    mCullRoots[0] = 0;
+    size_t rootsBegin = 0;
+    size_t rootsEnd = 1;
+
+    while (numThreads > 1u && rootsBegin < rootsEnd && (rootsEnd - rootsBegin) < maxRoots)
+    {
+        mCullRoots.resize(rootsEnd + SL_BVH_LANES);
+        rootsEnd = _sl_cull_lanes(task, mCullRoots[rootsBegin++], mCullRoots.data(), rootsEnd, outDrawList);
+    }
+
+    if (rootsBegin == rootsEnd)
+    {
+        return outDrawList.size();
+    }
+
+    mThreadItems.resize(numThreads);
+    for (SL_AlignedVector<SL_DrawItem>& threadItems : mThreadItems)
+    {
+        threadItems.clear();
+    }
+
+    task.pRoots       = mCullRoots.data() + rootsBegin;
+    task.numRoots     = rootsEnd - rootsBegin;
+    task.pThreadItems = mThreadItems.data();
+
+    if (numThreads > 1u && task.numRoots > 1u)
+    {
+        context.run_tasks(&_sl_cull_subtrees, &task);
+    }
+    else
+    {
+        _sl_cull_subtrees(&task, 0, 1);
+    }
+
+    for (const SL_AlignedVector<SL_DrawItem>& threadItems : mThreadItems)
+    {
+        outDrawList.insert(outDrawList.end(), threadItems.begin(), threadItems.end());
+    }
+
+    return outDrawList.size();
+}
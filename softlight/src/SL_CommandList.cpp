@@ -0,0 +1,335 @@
+
+#include <utility> // std::move
+
+#include "lightsky/utils/Assertions.h" // LS_DEBUG_ASSERT
+
+#include "lightsky/math/vec4.h"
+
+#include "softlight/SL_CommandList.hpp"
+#include "softlight/SL_UniformBuffer.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_CommandList Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+SL_CommandList::SL_CommandList() noexcept :
+    mCommands{},
+    mUniformData{}
+{}
+
+
+
+/*-------------------------------------
+ * Copy Constructor
+-------------------------------------*/
+SL_CommandList::SL_CommandList(const SL_CommandList& c) noexcept :
+    mCommands{c.mCommands},
+    mUniformData{c.mUniformData}
+{}
+
+
+
+/*-------------------------------------
+ * Move Constructor
+-------------------------------------*/
+SL_CommandList::SL_CommandList(SL_CommandList&& c) noexcept :
+    mCommands{std::move(c.mCommands)},
+    mUniformData{std::move(c.mUniformData)}
+{}
+
+
+
+/*-------------------------------------
+ * Copy Operator
+-------------------------------------*/
+SL_CommandList& SL_CommandList::operator=(const SL_CommandList& c) noexcept
+{
+    if (this != &c)
+    {
+        mCommands = c.mCommands;
+        mUniformData = c.mUniformData;
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Move Operator
+-------------------------------------*/
+SL_CommandList& SL_CommandList::operator=(SL_CommandList&& c) noexcept
+{
+    if (this != &c)
+    {
+        mCommands = std::move(c.mCommands);
+        mUniformData = std::move(c.mUniformData);
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Pre-allocate command storage
+-------------------------------------*/
+void SL_CommandList::reserve(std::size_t numCommands) noexcept
+{
+    mCommands.reserve(numCommands);
+}
+
+
+
+/*-------------------------------------
+ * Remove all recorded commands
+-------------------------------------*/
+void SL_CommandList::clear() noexcept
+{
+    mCommands.clear();
+    mUniformData.clear();
+}
+
+
+
+/*-------------------------------------
+ * Record a mesh draw
+-------------------------------------*/
+void SL_CommandList::draw(const SL_Mesh& m, size_t shaderId, size_t fboId) noexcept
+{
+    this->draw_instanced(m, 1, shaderId, fboId);
+}
+
+
+
+/*-------------------------------------
+ * Record a draw of multiple meshes
+-------------------------------------*/
+void SL_CommandList::draw_multiple(const SL_Mesh* meshes, size_t numMeshes, size_t shaderId, size_t fboId) noexcept
+{
+    if (meshes == nullptr || numMeshes == 0)
+    {
+        return;
+    }
+
+    SL_Command cmd;
+    cmd.type = SL_COMMAND_DRAW_MULTIPLE;
+    cmd.drawMultiple.pMeshes   = meshes;
+    cmd.drawMultiple.numMeshes = numMeshes;
+    cmd.drawMultiple.shaderId  = shaderId;
+    cmd.drawMultiple.fboId     = fboId;
+    cmd.drawMultiple.pCulls    = nullptr;
+
+    mCommands.push_back(cmd);
+}
+
+
+
+/*-------------------------------------
+ * Record an instanced mesh draw
+-------------------------------------*/
+void SL_CommandList::draw_instanced(const SL_Mesh& m, size_t numInstances, size_t shaderId, size_t fboId) noexcept
+{
+    SL_Command cmd;
+    cmd.type = numInstances == 1 ? SL_COMMAND_DRAW : SL_COMMAND_DRAW_INSTANCED;
+    cmd.draw.mesh         = m;
+    cmd.draw.numInstances = numInstances;
+    cmd.draw.shaderId     = shaderId;
+    cmd.draw.fboId        = fboId;
+    cmd.draw.pUniforms    = nullptr;
+    cmd.draw.pCull        = nullptr;
+
+    mCommands.push_back(cmd);
+}
+
+
+
+/*-------------------------------------
+ * Record a mesh draw with meshlet culling
+-------------------------------------*/
+void SL_CommandList::draw_clustered(const SL_Mesh& m, const SL_MeshletCull& cull, size_t shaderId, size_t fboId) noexcept
+{
+    this->draw_instanced(m, 1, shaderId, fboId);
+    mCommands.back().draw.pCull = &cull;
+}
+
+
+
+/*-------------------------------------
+ * Record a draw of multiple meshes with meshlet culling
+-------------------------------------*/
+void SL_CommandList::draw_clustered(const SL_Mesh* meshes, const SL_MeshletCull* const* culls, size_t numMeshes, size_t shaderId, size_t fboId) noexcept
+{
+    if (meshes == nullptr || numMeshes == 0)
+    {
+        return;
+    }
+
+    this->draw_multiple(meshes, numMeshes, shaderId, fboId);
+    mCommands.back().drawMultiple.pCulls = culls;
+}
+
+
+
+/*-------------------------------------
+ * Record a uniform buffer update
+-------------------------------------*/
+void SL_CommandList::update_uniforms(size_t uboId, const void* pData, size_t offset, size_t numBytes) noexcept
+{
+    LS_DEBUG_ASSERT(offset + numBytes <= SL_MAX_UNIFORM_BUFFER_SIZE);
+
+    if (pData == nullptr || numBytes == 0)
+    {
+        return;
+    }
+
+    const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pData);
+
+    SL_Command cmd;
+    cmd.type = SL_COMMAND_UPDATE_UNIFORMS;
+    cmd.uniforms.uboId      = uboId;
+    cmd.uniforms.dataOffset = mUniformData.size();
+    cmd.uniforms.offset     = (uint32_t)offset;
+    cmd.uniforms.numBytes   = (uint32_t)numBytes;
+
+    mUniformData.insert(mUniformData.end(), pBytes, pBytes + numBytes);
+    mCommands.push_back(cmd);
+}
+
+
+
+/*-------------------------------------
+ * Record a full texture blit
+-------------------------------------*/
+void SL_CommandList::blit(size_t outTextureId, size_t inTextureId) noexcept
+{
+    this->blit(outTextureId, inTextureId, 0, 0, 0, 0, 0, 0, 0, 0);
+    mCommands.back().blit.fullRegion = true;
+}
+
+
+
+/*-------------------------------------
+ * Record a texture blit
+-------------------------------------*/
+void SL_CommandList::blit(
+    size_t outTextureId,
+    size_t inTextureId,
+    uint16_t srcX0,
+    uint16_t srcY0,
+    uint16_t srcX1,
+    uint16_t srcY1,
+    uint16_t dstX0,
+    uint16_t dstY0,
+    uint16_t dstX1,
+    uint16_t dstY1) noexcept
+{
+    SL_Command cmd;
+    cmd.type = SL_COMMAND_BLIT_TEXTURE;
+    cmd.blit.outTextureId = outTextureId;
+    cmd.blit.inTextureId  = inTextureId;
+    cmd.blit.pOutBuffer   = nullptr;
+    cmd.blit.fullRegion   = false;
+    cmd.blit.srcX0        = srcX0;
+    cmd.blit.srcY0        = srcY0;
+    cmd.blit.srcX1        = srcX1;
+    cmd.blit.srcY1        = srcY1;
+    cmd.blit.dstX0        = dstX0;
+    cmd.blit.dstY0        = dstY0;
+    cmd.blit.dstX1        = dstX1;
+    cmd.blit.dstY1        = dstY1;
+
+    mCommands.push_back(cmd);
+}
+
+
+
+/*-------------------------------------
+ * Record a full blit to a buffer
+-------------------------------------*/
+void SL_CommandList::blit(SL_TextureView& buffer, size_t textureId) noexcept
+{
+    this->blit(buffer, textureId, 0, 0, 0, 0, 0, 0, 0, 0);
+    mCommands.back().blit.fullRegion = true;
+}
+
+
+
+/*-------------------------------------
+ * Record a blit to a buffer
+-------------------------------------*/
+void SL_CommandList::blit(
+    SL_TextureView& buffer,
+    size_t textureId,
+    uint16_t srcX0,
+    uint16_t srcY0,
+    uint16_t srcX1,
+    uint16_t srcY1,
+    uint16_t dstX0,
+    uint16_t dstY0,
+    uint16_t dstX1,
+    uint16_t dstY1) noexcept
+{
+    SL_Command cmd;
+    cmd.type = SL_COMMAND_BLIT_BUFFER;
+    cmd.blit.outTextureId = 0;
+    cmd.blit.inTextureId  = textureId;
+    cmd.blit.pOutBuffer   = &buffer;
+    cmd.blit.fullRegion   = false;
+    cmd.blit.srcX0        = srcX0;
+    cmd.blit.srcY0        = srcY0;
+    cmd.blit.srcX1        = srcX1;
+    cmd.blit.srcY1        = srcY1;
+    cmd.blit.dstX0        = dstX0;
+    cmd.blit.dstY0        = dstY0;
+    cmd.blit.dstX1        = dstX1;
+    cmd.blit.dstY1        = dstY1;
+
+    mCommands.push_back(cmd);
+}
+
+
+
+/*-------------------------------------
+ * Record a color buffer clear
+-------------------------------------*/
+void SL_CommandList::clear_color_buffer(size_t fboId, unsigned attachmentId, const ls::math::vec4_t<double>& color) noexcept
+{
+    this->clear_framebuffer(fboId, attachmentId, color, 0.0);
+    mCommands.back().type = SL_COMMAND_CLEAR_COLOR;
+}
+
+
+
+/*-------------------------------------
+ * Record a depth buffer clear
+-------------------------------------*/
+void SL_CommandList::clear_depth_buffer(size_t fboId, double depth) noexcept
+{
+    this->clear_framebuffer(fboId, 0, ls::math::vec4_t<double>{0.0}, depth);
+    mCommands.back().type = SL_COMMAND_CLEAR_DEPTH;
+}
+
+
+
+/*-------------------------------------
+ * Record a color & depth buffer clear
+-------------------------------------*/
+void SL_CommandList::clear_framebuffer(size_t fboId, unsigned attachmentId, const ls::math::vec4_t<double>& color, double depth) noexcept
+{
+    SL_Command cmd;
+    cmd.type = SL_COMMAND_CLEAR_FRAMEBUFFER;
+    cmd.clear.fboId        = fboId;
+    cmd.clear.attachmentId = attachmentId;
+    cmd.clear.color[0]     = color[0];
+    cmd.clear.color[1]     = color[1];
+    cmd.clear.color[2]     = color[2];
+    cmd.clear.color[3]     = color[3];
+    cmd.clear.depth        = depth;
+
+    mCommands.push_back(cmd);
+}
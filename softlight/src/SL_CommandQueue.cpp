@@ -0,0 +1,135 @@
+
+#include <utility> // std::move
+
+#include "softlight/SL_CommandQueue.hpp"
+#include "softlight/SL_Context.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_CommandQueue Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Destructor
+-------------------------------------*/
+SL_CommandQueue::~SL_CommandQueue() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mLock};
+        mRunning = false;
+    }
+
+    // The submission thread drains all pending lists before exiting
+    mSubmitCond.notify_one();
+    mThread.join();
+}
+
+
+
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+SL_CommandQueue::SL_CommandQueue(SL_Context& context) noexcept :
+    mContext{&context},
+    mLock{},
+    mSubmitCond{},
+    mCompleteCond{},
+    mPending{},
+    mSubmitted{0},
+    mCompleted{0},
+    mRunning{true},
+    mThread{}
+{
+    mThread = std::thread{&SL_CommandQueue::run, this};
+}
+
+
+
+/*-------------------------------------
+ * Submission thread
+-------------------------------------*/
+void SL_CommandQueue::run() noexcept
+{
+    std::unique_lock<std::mutex> lock{mLock};
+
+    while (true)
+    {
+        mSubmitCond.wait(lock, [this]()->bool {
+            return !mPending.empty() || !mRunning;
+        });
+
+        if (mPending.empty())
+        {
+            break;
+        }
+
+        SL_CommandList cmds{std::move(mPending.front())};
+        mPending.pop_front();
+
+        lock.unlock();
+        mContext->execute(cmds);
+        lock.lock();
+
+        mCompleted.fetch_add(1, std::memory_order_acq_rel);
+        mCompleteCond.notify_all();
+    }
+}
+
+
+
+/*-------------------------------------
+ * Submit a command list for execution
+-------------------------------------*/
+uint64_t SL_CommandQueue::submit(SL_CommandList&& cmds) noexcept
+{
+    uint64_t fence;
+
+    {
+        std::lock_guard<std::mutex> lock{mLock};
+        mPending.emplace_back(std::move(cmds));
+        fence = ++mSubmitted;
+    }
+
+    mSubmitCond.notify_one();
+
+    return fence;
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the most recent fence
+-------------------------------------*/
+uint64_t SL_CommandQueue::last_submitted() const noexcept
+{
+    std::lock_guard<std::mutex> lock{mLock};
+    return mSubmitted;
+}
+
+
+
+/*-------------------------------------
+ * Wait for a fence
+-------------------------------------*/
+void SL_CommandQueue::wait(uint64_t fence) const noexcept
+{
+    if (is_complete(fence))
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{mLock};
+    mCompleteCond.wait(lock, [this, fence]()->bool {
+        return is_complete(fence);
+    });
+}
+
+
+
+/*-------------------------------------
+ * Wait for all submitted commands
+-------------------------------------*/
+void SL_CommandQueue::finish() const noexcept
+{
+    wait(last_submitted());
+}
@@ -1,25 +1,119 @@
 
 #include <algorithm> // std::move (overload)
 #include <iterator> // std::back_inserter
+#include <limits> // std::numeric_limits
 #include <utility> // std::move
 
+#include "lightsky/utils/Assertions.h" // LS_DEBUG_ASSERT
+
+#include "softlight/SL_CommandList.hpp"
+#include "softlight/SL_CommandQueue.hpp"
 #include "softlight/SL_Context.hpp"
+#include "softlight/SL_CpuFeatures.hpp" // sl_cpu_init_features()
 #include "softlight/SL_FragmentProcessor.hpp"
 #include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_ImgFile.hpp"
 #include "softlight/SL_IndexBuffer.hpp"
 #include "softlight/SL_Shader.hpp"
 #include "softlight/SL_Texture.hpp"
+#include "softlight/SL_TextureUploadProcessor.hpp" // sl_texture_upload_supported()
 #include "softlight/SL_UniformBuffer.hpp"
 #include "softlight/SL_VertexArray.hpp"
 #include "softlight/SL_VertexBuffer.hpp"
 
 
 
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Reset a framebuffer's coarse depth bounds after its depth buffer has been
+ * cleared. Bounds must match the stored (possibly rounded) depth value.
+-------------------------------------*/
+inline void _sl_clear_depth_bounds(SL_Framebuffer& fbo, uint8_t bytesPerTexel, double depth) noexcept
+{
+    #if SL_HIZ_ENABLED
+        const float boundsVal = (bytesPerTexel == sizeof(ls::math::half)) ? (float)(ls::math::half)(float)depth : (float)depth;
+        fbo.depth_hierarchy().clear(boundsVal);
+    #else
+        (void)fbo;
+        (void)bytesPerTexel;
+        (void)depth;
+    #endif
+}
+
+
+
+/*-------------------------------------
+ * Mark the depth bounds of any framebuffer using a texture as its depth
+ * attachment as out-of-date after the texture was written externally.
+-------------------------------------*/
+inline void _sl_invalidate_depth_bounds(SL_AlignedVector<SL_Framebuffer>& fbos, const SL_TextureView& tex) noexcept
+{
+    #if SL_HIZ_ENABLED
+        for (SL_Framebuffer& fbo : fbos)
+        {
+            if (fbo.get_depth_buffer().pTexels == tex.pTexels && tex.pTexels)
+            {
+                fbo.depth_hierarchy().invalidate();
+            }
+        }
+    #else
+        (void)fbos;
+        (void)tex;
+    #endif
+}
+
+
+
+/*-------------------------------------
+ * Check if a texture is attached to any framebuffer
+-------------------------------------*/
+inline bool _sl_is_fbo_attachment(const SL_AlignedVector<SL_Framebuffer>& fbos, const SL_TextureView& tex) noexcept
+{
+    if (!tex.pTexels)
+    {
+        return false;
+    }
+
+    for (const SL_Framebuffer& fbo : fbos)
+    {
+        if (fbo.get_depth_buffer().pTexels == tex.pTexels)
+        {
+            return true;
+        }
+
+        for (unsigned i = 0; i < fbo.num_color_buffers(); ++i)
+        {
+            if (fbo.get_color_buffer(i).pTexels == tex.pTexels)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+
+} // end anonymous namespace
+
+
+
 /*-------------------------------------
  *
 -------------------------------------*/
 SL_Context::~SL_Context() noexcept
 {
+    // Complete all pending commands before releasing any resources
+    mCommandQueue.reset();
+
     for (SL_Texture* pTex : mTextures)
     {
         delete pTex;
@@ -32,6 +126,7 @@ SL_Context::~SL_Context() noexcept
  *
 -------------------------------------*/
 SL_Context::SL_Context() noexcept :
+    mCommandQueue{},
     mVaos{},
     mTextures{},
     mFbos{},
@@ -41,7 +136,10 @@ SL_Context::SL_Context() noexcept :
     mShaders{},
     mViewState{},
     mProcessors{}
-{}
+{
+    // Rendering kernels are selected from the features detected here.
+    sl_cpu_init_features();
+}
 
 
 
@@ -49,6 +147,7 @@ SL_Context::SL_Context() noexcept :
  *
 -------------------------------------*/
 SL_Context::SL_Context(const SL_Context& c) noexcept :
+    mCommandQueue{(c.finish(), nullptr)},
     mVaos{c.mVaos},
     mTextures{},
     mFbos{c.mFbos},
@@ -73,6 +172,7 @@ SL_Context::SL_Context(const SL_Context& c) noexcept :
  *
 -------------------------------------*/
 SL_Context::SL_Context(SL_Context&& c) noexcept :
+    mCommandQueue{(c.finish(), nullptr)},
     mVaos{std::move(c.mVaos)},
     mTextures{std::move(c.mTextures)},
     mFbos{std::move(c.mFbos)},
@@ -93,6 +193,9 @@ SL_Context& SL_Context::operator=(const SL_Context& c) noexcept
 {
     if (this != &c)
     {
+        finish();
+        c.finish();
+
         mVaos       = c.mVaos;
         mFbos       = c.mFbos;
         mVbos       = c.mVbos;
@@ -129,6 +232,9 @@ SL_Context& SL_Context::operator=(SL_Context&& c) noexcept
 {
     if (this != &c)
     {
+        finish();
+        c.finish();
+
         mVaos       = std::move(c.mVaos);
         mTextures   = std::move(c.mTextures);
         mFbos       = std::move(c.mFbos);
@@ -180,6 +286,8 @@ SL_VertexArray& SL_Context::vao(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_vao()
 {
+    finish();
+
     mVaos.push_back(SL_VertexArray{});
     return mVaos.size() - 1;
 }
@@ -191,6 +299,8 @@ std::size_t SL_Context::create_vao()
 -------------------------------------*/
 void SL_Context::destroy_vao(std::size_t index)
 {
+    finish();
+
     mVaos.erase(mVaos.begin() + index);
 }
 
@@ -231,6 +341,8 @@ SL_Texture& SL_Context::texture(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_texture()
 {
+    finish();
+
     mTextures.push_back(new SL_Texture{});
     return mTextures.size() - 1;
 }
@@ -242,6 +354,8 @@ std::size_t SL_Context::create_texture()
 -------------------------------------*/
 void SL_Context::destroy_texture(std::size_t index)
 {
+    finish();
+
     delete mTextures[index];
     mTextures.erase(mTextures.begin() + index);
 }
@@ -283,6 +397,8 @@ SL_Framebuffer& SL_Context::framebuffer(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_framebuffer()
 {
+    finish();
+
     mFbos.push_back(SL_Framebuffer{});
     return mFbos.size() - 1;
 }
@@ -294,6 +410,8 @@ std::size_t SL_Context::create_framebuffer()
 -------------------------------------*/
 void SL_Context::destroy_framebuffer(std::size_t index)
 {
+    finish();
+
     mFbos.erase(mFbos.begin() + index);
 }
 
@@ -334,6 +452,8 @@ SL_VertexBuffer& SL_Context::vbo(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_vbo()
 {
+    finish();
+
     mVbos.push_back(SL_VertexBuffer{});
     return mVbos.size() - 1;
 }
@@ -345,6 +465,8 @@ std::size_t SL_Context::create_vbo()
 -------------------------------------*/
 void SL_Context::destroy_vbo(std::size_t index)
 {
+    finish();
+
     mVbos.erase(mVbos.begin() + index);
 }
 
@@ -385,6 +507,8 @@ SL_IndexBuffer& SL_Context::ibo(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_ibo()
 {
+    finish();
+
     mIbos.push_back(SL_IndexBuffer{});
     return mIbos.size() - 1;
 }
@@ -396,6 +520,8 @@ std::size_t SL_Context::create_ibo()
 -------------------------------------*/
 void SL_Context::destroy_ibo(std::size_t index)
 {
+    finish();
+
     mIbos.erase(mIbos.begin() + index);
 }
 
@@ -436,6 +562,8 @@ SL_UniformBuffer& SL_Context::ubo(std::size_t index)
 -------------------------------------*/
 std::size_t SL_Context::create_ubo()
 {
+    finish();
+
     mUniforms.push_back(SL_UniformBuffer{});
     return mUniforms.size() - 1;
 }
@@ -447,6 +575,8 @@ std::size_t SL_Context::create_ubo()
 -------------------------------------*/
 void SL_Context::destroy_ubo(std::size_t index)
 {
+    finish();
+
     mUniforms.erase(mUniforms.begin() + index);
 }
 
@@ -489,6 +619,8 @@ std::size_t SL_Context::create_shader(
     const SL_VertexShader& vertShader,
     const SL_FragmentShader& fragShader)
 {
+    finish();
+
     if (vertShader.numVaryings < fragShader.numVaryings)
     {
         return (std::size_t)-1;
@@ -510,6 +642,7 @@ std::size_t SL_Context::create_shader(
     pipeline.depth_test(fragShader.depthTest);
     pipeline.depth_mask(fragShader.depthMask);
     pipeline.blend_mode(fragShader.blend);
+    pipeline.derivative_mode(fragShader.derivatives);
 
     switch (fragShader.numVaryings)
     {
@@ -533,6 +666,7 @@ std::size_t SL_Context::create_shader(
     shader.pipelineState = pipeline;
     shader.pVertShader = vertShader.shader;
     shader.pFragShader = fragShader.shader;
+    shader.pFragBlockShader = fragShader.blockShader;
     shader.pUniforms = nullptr;
 
     mShaders.push_back(shader);
@@ -549,6 +683,8 @@ std::size_t SL_Context::create_shader(
     const SL_FragmentShader& fragShader,
     std::size_t uniformIndex)
 {
+    finish();
+
     if (uniformIndex >= mUniforms.size())
     {
         return (std::size_t)-1;
@@ -575,6 +711,7 @@ std::size_t SL_Context::create_shader(
     pipeline.depth_test(fragShader.depthTest);
     pipeline.depth_mask(fragShader.depthMask);
     pipeline.blend_mode(fragShader.blend);
+    pipeline.derivative_mode(fragShader.derivatives);
 
     switch (fragShader.numVaryings)
     {
@@ -598,6 +735,7 @@ std::size_t SL_Context::create_shader(
     shader.pipelineState = pipeline;
     shader.pVertShader = vertShader.shader;
     shader.pFragShader = fragShader.shader;
+    shader.pFragBlockShader = fragShader.blockShader;
     shader.pUniforms = &mUniforms[uniformIndex];
 
     mShaders.push_back(shader);
@@ -611,6 +749,8 @@ std::size_t SL_Context::create_shader(
 -------------------------------------*/
 void SL_Context::destroy_shader(std::size_t index)
 {
+    finish();
+
     mShaders.erase(mShaders.begin() + index);
 }
 
@@ -621,6 +761,8 @@ void SL_Context::destroy_shader(std::size_t index)
 -------------------------------------*/
 void SL_Context::terminate()
 {
+    finish();
+
     mVaos.clear();
     mVaos.shrink_to_fit();
 
@@ -660,6 +802,9 @@ void SL_Context::terminate()
 -------------------------------------*/
 void SL_Context::import(SL_Context&& inContext) noexcept
 {
+    finish();
+    inContext.finish();
+
     SL_AlignedVector<SL_VertexArray>&   inVaos     = inContext.mVaos;
     SL_AlignedVector<SL_Texture*>&      inTextures = inContext.mTextures;
     SL_AlignedVector<SL_Framebuffer>&   inFbos     = inContext.mFbos;
@@ -741,6 +886,42 @@ void SL_Context::draw_instanced(const SL_Mesh& m, size_t numInstances, size_t sh
 
 
 
+/*-------------------------------------
+ * Draw a mesh with meshlet culling
+-------------------------------------*/
+void SL_Context::draw_clustered(const SL_Mesh& m, const SL_MeshletCull& cull, size_t shaderId, size_t fboId) noexcept
+{
+    mProcessors.run_shader_processors(*this, m, 1, mShaders[shaderId], mFbos[fboId], &cull);
+}
+
+
+
+/*-------------------------------------
+ * Draw multiple meshes with meshlet culling
+-------------------------------------*/
+void SL_Context::draw_clustered(const SL_Mesh* meshes, const SL_MeshletCull* const* culls, size_t numMeshes, size_t shaderId, size_t fboId) noexcept
+{
+    if (meshes != nullptr && numMeshes > 0)
+    {
+        mProcessors.run_shader_processors(*this, meshes, numMeshes, mShaders[shaderId], mFbos[fboId], culls);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Draw a batch of meshes
+-------------------------------------*/
+void SL_Context::draw_batch(const SL_DrawCommand* draws, size_t numDraws) noexcept
+{
+    if (draws != nullptr && numDraws > 0)
+    {
+        mProcessors.run_shader_batch(*this, draws, numDraws, mShaders.data(), mFbos.data());
+    }
+}
+
+
+
 /*-------------------------------------
  * Blit to a window
 -------------------------------------*/
@@ -786,6 +967,10 @@ void SL_Context::blit(
     SL_TextureView& i = mTextures[inTextureId]->view();
     SL_TextureView& o = mTextures[outTextureId]->view();
 
+    // Framebuffer attachments use the framebuffer's texel layout
+    const bool inIsAttachment = _sl_is_fbo_attachment(mFbos, i);
+    const bool outIsAttachment = _sl_is_fbo_attachment(mFbos, o);
+
     if (sl_is_compressed_color(mTextures[outTextureId]->type()) || sl_is_compressed_color(mTextures[inTextureId]->type()))
     {
         mProcessors.run_blit_compressed_processors(
@@ -794,7 +979,9 @@ void SL_Context::blit(
             srcX0, srcY0,
             srcX1, srcY1,
             dstX0, dstY0,
-            dstX1, dstY1);
+            dstX1, dstY1,
+            inIsAttachment,
+            outIsAttachment);
     }
     else
     {
@@ -804,8 +991,11 @@ void SL_Context::blit(
             srcX0, srcY0,
             srcX1, srcY1,
             dstX0, dstY0,
-            dstX1, dstY1);
+            dstX1, dstY1,
+            inIsAttachment,
+            outIsAttachment);
     }
+    _sl_invalidate_depth_bounds(mFbos, o);
 }
 
 
@@ -853,6 +1043,9 @@ void SL_Context::blit(
 {
     SL_TextureView& t = mTextures[textureId]->view();
 
+    // Window buffers are always row-major
+    const bool inIsAttachment = _sl_is_fbo_attachment(mFbos, t);
+
     if (sl_is_compressed_color(mTextures[textureId]->type()) || sl_is_compressed_color(buffer.type))
     {
         mProcessors.run_blit_compressed_processors(
@@ -860,7 +1053,9 @@ void SL_Context::blit(
             srcX0, srcY0,
             srcX1, srcY1,
             dstX0, dstY0,
-            dstX1, dstY1);
+            dstX1, dstY1,
+            inIsAttachment,
+            false);
     }
     else
     {
@@ -869,8 +1064,11 @@ void SL_Context::blit(
             srcX0, srcY0,
             srcX1, srcY1,
             dstX0, dstY0,
-            dstX1, dstY1);
+            dstX1, dstY1,
+            inIsAttachment,
+            false);
     }
+    _sl_invalidate_depth_bounds(mFbos, buffer);
 }
 
 
@@ -920,7 +1118,7 @@ void SL_Context::clear_depth_buffer(size_t fboId, double depth) noexcept
     }
 
     mProcessors.run_clear_processors(&depthVal, &pTex);
-
+    _sl_clear_depth_bounds(mFbos[fboId], pTex.bytesPerTexel, depth);
 }
 
 
@@ -960,6 +1158,7 @@ void SL_Context::clear_framebuffer(size_t fboId, unsigned attachmentId, const ls
     }
 
     mProcessors.run_clear_processors(&outColor.color, &depthVal, &pColorBuf, &pDepth);
+    _sl_clear_depth_bounds(mFbos[fboId], pDepth.bytesPerTexel, depth);
 }
 
 
@@ -1012,6 +1211,7 @@ void SL_Context::clear_framebuffer(size_t fboId, const std::array<unsigned, 2>&
     }
 
     mProcessors.run_clear_processors(outColors, &depthVal, buffers, &pDepth);
+    _sl_clear_depth_bounds(mFbos[fboId], pDepth.bytesPerTexel, depth);
 }
 
 
@@ -1067,6 +1267,7 @@ void SL_Context::clear_framebuffer(size_t fboId, const std::array<unsigned, 3>&
     }
 
     mProcessors.run_clear_processors(outColors, &depthVal, buffers, &pDepth);
+    _sl_clear_depth_bounds(mFbos[fboId], pDepth.bytesPerTexel, depth);
 }
 
 
@@ -1125,6 +1326,347 @@ void SL_Context::clear_framebuffer(size_t fboId, const std::array<unsigned, 4>&
     }
 
     mProcessors.run_clear_processors(outColors, &depthVal, buffers, &pDepth);
+    _sl_clear_depth_bounds(mFbos[fboId], pDepth.bytesPerTexel, depth);
+}
+
+
+
+/*-------------------------------------
+ * Generate a texture's mip chain
+-------------------------------------*/
+int SL_Context::generate_mipmaps(size_t textureId, SL_TexelOrder order) noexcept
+{
+    SL_Texture& tex = *mTextures[textureId];
+
+    if (sl_is_compressed_color(tex.type()))
+    {
+        return -1;
+    }
+
+    // Reallocating mip levels may release memory still in use by
+    // asynchronous commands.
+    finish();
+
+    const int ret = tex.init_levels();
+    if (ret < 0)
+    {
+        return ret - 1;
+    }
+
+    mProcessors.run_mipmap_processors(tex, order);
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Convert and copy an image into a texture
+-------------------------------------*/
+int SL_Context::upload_texture(size_t textureId, const SL_ImgFile& imgFile, SL_ColorDataType type, SL_TexelOrder order) noexcept
+{
+    if (!imgFile.data())
+    {
+        return -1;
+    }
+
+    if (!sl_texture_upload_supported(imgFile.format(), type))
+    {
+        return -2;
+    }
+
+    const size_t* const dimens = imgFile.size();
+
+    if (dimens[0] > std::numeric_limits<uint16_t>::max()
+    || dimens[1] > std::numeric_limits<uint16_t>::max()
+    || dimens[2] > std::numeric_limits<uint16_t>::max())
+    {
+        return -3;
+    }
+
+    // Reallocating the texture may release memory still in use by
+    // asynchronous commands.
+    finish();
+
+    SL_Texture& tex = *mTextures[textureId];
+    if (tex.init(type, (uint16_t)dimens[0], (uint16_t)dimens[1], (uint16_t)dimens[2]) != 0)
+    {
+        return -4;
+    }
+
+    mProcessors.run_texture_upload_processors(imgFile.data(), imgFile.format(), tex.view(), order);
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Copy an image into a texture
+-------------------------------------*/
+int SL_Context::upload_texture(size_t textureId, const SL_ImgFile& imgFile, SL_TexelOrder order) noexcept
+{
+    return upload_texture(textureId, imgFile, imgFile.format(), order);
+}
+
+
+
+/*-------------------------------------
+ * Execute a command list on the current thread
+-------------------------------------*/
+void SL_Context::execute(const SL_CommandList& cmds) noexcept
+{
+    // Consecutive draws are gathered so they can be pipelined through the
+    // processor pool as a single batch.
+    SL_AlignedVector<SL_DrawCommand> draws;
+
+    // Uniform updates are applied to copies of each uniform buffer, allowing
+    // draws on either side of an update to remain in the same batch. Storage
+    // is reserved up-front so draws can safely point into it.
+    SL_AlignedVector<SL_UniformBuffer> uniformSnapshots;
+    SL_AlignedVector<size_t> snapshotUboIds;
+
+    size_t numUniformUpdates = 0;
+    for (const SL_Command& cmd : cmds.commands())
+    {
+        numUniformUpdates += cmd.type == SL_COMMAND_UPDATE_UNIFORMS ? 1u : 0u;
+    }
+
+    uniformSnapshots.reserve(numUniformUpdates);
+    snapshotUboIds.reserve(numUniformUpdates);
+
+    const auto latest_snapshot = [&](size_t uboId) noexcept->SL_UniformBuffer*
+    {
+        for (size_t i = snapshotUboIds.size(); i--;)
+        {
+            if (snapshotUboIds[i] == uboId)
+            {
+                return &uniformSnapshots[i];
+            }
+        }
+
+        return nullptr;
+    };
+
+    const auto draw_uniforms = [&](size_t shaderId) noexcept->const SL_UniformBuffer*
+    {
+        const SL_UniformBuffer* pUniforms = mShaders[shaderId].pUniforms;
+
+        if (snapshotUboIds.empty() || pUniforms < mUniforms.data() || pUniforms >= mUniforms.data() + mUniforms.size())
+        {
+            return nullptr;
+        }
+
+        return latest_snapshot((size_t)(pUniforms - mUniforms.data()));
+    };
+
+    const auto flush_draws = [&]() noexcept->void
+    {
+        this->draw_batch(draws.data(), draws.size());
+        draws.clear();
+    };
+
+    for (const SL_Command& cmd : cmds.commands())
+    {
+        // Uniform updates don't interrupt a batch
+        const bool isBatched = cmd.type == SL_COMMAND_DRAW
+            || cmd.type == SL_COMMAND_DRAW_MULTIPLE
+            || cmd.type == SL_COMMAND_DRAW_INSTANCED
+            || cmd.type == SL_COMMAND_UPDATE_UNIFORMS;
+
+        if (!isBatched && !draws.empty())
+        {
+            flush_draws();
+        }
+
+        switch (cmd.type)
+        {
+            case SL_COMMAND_DRAW:
+            case SL_COMMAND_DRAW_INSTANCED:
+                draws.push_back(cmd.draw);
+
+                if (!cmd.draw.pUniforms)
+                {
+                    draws.back().pUniforms = draw_uniforms(cmd.draw.shaderId);
+                }
+                break;
+
+            case SL_COMMAND_DRAW_MULTIPLE:
+                for (size_t i = 0; i < cmd.drawMultiple.numMeshes; ++i)
+                {
+                    const SL_MeshletCull* pCull = cmd.drawMultiple.pCulls ? cmd.drawMultiple.pCulls[i] : nullptr;
+                    draws.push_back(SL_DrawCommand{cmd.drawMultiple.pMeshes[i], 1, cmd.drawMultiple.shaderId, cmd.drawMultiple.fboId, draw_uniforms(cmd.drawMultiple.shaderId), pCull});
+                }
+                break;
+
+            case SL_COMMAND_UPDATE_UNIFORMS:
+            {
+                const SL_UniformBuffer* pPrev = latest_snapshot(cmd.uniforms.uboId);
+                uniformSnapshots.push_back(pPrev ? *pPrev : mUniforms[cmd.uniforms.uboId]);
+                uniformSnapshots.back().assign(cmds.uniform_data(cmd.uniforms), cmd.uniforms.offset, cmd.uniforms.numBytes);
+                snapshotUboIds.push_back(cmd.uniforms.uboId);
+                break;
+            }
+
+            case SL_COMMAND_CLEAR_COLOR:
+                this->clear_color_buffer(
+                    cmd.clear.fboId,
+                    cmd.clear.attachmentId,
+                    ls::math::vec4_t<double>{cmd.clear.color[0], cmd.clear.color[1], cmd.clear.color[2], cmd.clear.color[3]});
+                break;
+
+            case SL_COMMAND_CLEAR_DEPTH:
+                this->clear_depth_buffer(cmd.clear.fboId, cmd.clear.depth);
+                break;
+
+            case SL_COMMAND_CLEAR_FRAMEBUFFER:
+                this->clear_framebuffer(
+                    cmd.clear.fboId,
+                    cmd.clear.attachmentId,
+                    ls::math::vec4_t<double>{cmd.clear.color[0], cmd.clear.color[1], cmd.clear.color[2], cmd.clear.color[3]},
+                    cmd.clear.depth);
+                break;
+
+            case SL_COMMAND_BLIT_TEXTURE:
+                if (cmd.blit.fullRegion)
+                {
+                    this->blit(cmd.blit.outTextureId, cmd.blit.inTextureId);
+                }
+                else
+                {
+                    this->blit(
+                        cmd.blit.outTextureId, cmd.blit.inTextureId,
+                        cmd.blit.srcX0, cmd.blit.srcY0,
+                        cmd.blit.srcX1, cmd.blit.srcY1,
+                        cmd.blit.dstX0, cmd.blit.dstY0,
+                        cmd.blit.dstX1, cmd.blit.dstY1);
+                }
+                break;
+
+            case SL_COMMAND_BLIT_BUFFER:
+                if (cmd.blit.fullRegion)
+                {
+                    this->blit(*cmd.blit.pOutBuffer, cmd.blit.inTextureId);
+                }
+                else
+                {
+                    this->blit(
+                        *cmd.blit.pOutBuffer, cmd.blit.inTextureId,
+                        cmd.blit.srcX0, cmd.blit.srcY0,
+                        cmd.blit.srcX1, cmd.blit.srcY1,
+                        cmd.blit.dstX0, cmd.blit.dstY0,
+                        cmd.blit.dstX1, cmd.blit.dstY1);
+                }
+                break;
+
+            default:
+                LS_DEBUG_ASSERT(false);
+                LS_UNREACHABLE();
+        }
+    }
+
+    flush_draws();
+
+    // Keep the final value of every updated uniform buffer
+    for (size_t i = 0; i < snapshotUboIds.size(); ++i)
+    {
+        mUniforms[snapshotUboIds[i]] = uniformSnapshots[i];
+    }
+}
+
+
+
+/*-------------------------------------
+ * Asynchronously execute a command list
+-------------------------------------*/
+uint64_t SL_Context::submit(const SL_CommandList& cmds) noexcept
+{
+    return this->submit(SL_CommandList{cmds});
+}
+
+
+
+/*-------------------------------------
+ * Asynchronously execute a command list
+-------------------------------------*/
+uint64_t SL_Context::submit(SL_CommandList&& cmds) noexcept
+{
+    // The submission thread is only started once it's needed.
+    if (!mCommandQueue)
+    {
+        mCommandQueue.reset(new SL_CommandQueue{*this});
+    }
+
+    return mCommandQueue->submit(std::move(cmds));
+}
+
+
+
+/*-------------------------------------
+ * Check if a command list has completed
+-------------------------------------*/
+bool SL_Context::is_complete(uint64_t fence) const noexcept
+{
+    return !mCommandQueue || mCommandQueue->is_complete(fence);
+}
+
+
+
+/*-------------------------------------
+ * Wait for a command list to complete
+-------------------------------------*/
+void SL_Context::wait(uint64_t fence) const noexcept
+{
+    if (mCommandQueue)
+    {
+        mCommandQueue->wait(fence);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Wait for all command lists to complete
+-------------------------------------*/
+void SL_Context::finish() const noexcept
+{
+    if (mCommandQueue)
+    {
+        mCommandQueue->finish();
+    }
+}
+
+
+
+/*--------------------------------------
+ * Run a user-defined task on all threads
+--------------------------------------*/
+void SL_Context::run_tasks(SL_TaskFunc task, void* pUserData) noexcept
+{
+    finish();
+    mProcessors.run_task_processors(task, pUserData);
+}
+
+
+
+/*--------------------------------------
+ * Retrieve the per-thread load-balancing statistics
+--------------------------------------*/
+const SL_ThreadStats* SL_Context::thread_stats() const noexcept
+{
+    finish();
+    return mProcessors.thread_stats();
+}
+
+
+
+/*--------------------------------------
+ * Reset the per-thread load-balancing statistics
+--------------------------------------*/
+void SL_Context::reset_thread_stats() noexcept
+{
+    finish();
+    mProcessors.reset_thread_stats();
 }
 
 
@@ -1144,5 +1686,7 @@ unsigned SL_Context::num_threads() const noexcept
 --------------------------------------*/
 unsigned SL_Context::num_threads(unsigned inNumThreads) noexcept
 {
+    finish();
+
     return mProcessors.concurrency(inNumThreads);
 }
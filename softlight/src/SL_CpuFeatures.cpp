@@ -0,0 +1,239 @@
+#include <atomic>
+#include <cctype> // std::tolower()
+#include <cstdlib> // std::getenv
+
+#include "lightsky/setup/Arch.h"
+#include "lightsky/setup/Compiler.h"
+
+#if defined(LS_ARCH_X86) && defined(LS_COMPILER_MSC)
+    #include <intrin.h> // __cpuid(), __cpuidex(), _xgetbv()
+#endif
+
+#include "softlight/SL_CpuFeatures.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Query CPUID directly
+-------------------------------------*/
+#if defined(LS_ARCH_X86) && defined(LS_COMPILER_MSC)
+inline uint32_t _sl_query_cpu_features() noexcept
+{
+    int regs[4];
+    __cpuid(regs, 0);
+
+    const int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+    {
+        return SL_CPU_FEATURE_NONE;
+    }
+
+    __cpuid(regs, 1);
+    const bool haveSse2    = ((regs[3] >> 26) & 1) != 0;
+    const bool haveSse41   = ((regs[2] >> 19) & 1) != 0;
+    const bool haveFma     = ((regs[2] >> 12) & 1) != 0;
+    const bool haveOsXsave = ((regs[2] >> 27) & 1) != 0;
+    const bool haveF16c    = ((regs[2] >> 29) & 1) != 0;
+
+    // The OS must preserve the YMM (bits 1-2) and ZMM/opmask (bits 5-7)
+    // registers across context switches.
+    const unsigned long long xcr0 = haveOsXsave ? _xgetbv(0) : 0ull;
+    const bool haveYmmState = (xcr0 & 0x06ull) == 0x06ull;
+    const bool haveZmmState = (xcr0 & 0xE6ull) == 0xE6ull;
+
+    bool haveAvx2   = false;
+    bool haveAvx512 = false;
+
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(regs, 7, 0);
+        haveAvx2   = ((regs[1] >> 5) & 1) != 0;
+        haveAvx512 = ((regs[1] >> 16) & 1) != 0  // F
+                  && ((regs[1] >> 17) & 1) != 0  // DQ
+                  && ((regs[1] >> 30) & 1) != 0  // BW
+                  && ((regs[1] >> 31) & 1) != 0; // VL
+    }
+
+    uint32_t features = SL_CPU_FEATURE_NONE;
+    features |= haveSse2 ? SL_CPU_FEATURE_SSE2 : 0u;
+    features |= haveSse41 ? SL_CPU_FEATURE_SSE4_1 : 0u;
+    features |= (haveAvx2 && haveFma && haveF16c && haveYmmState) ? SL_CPU_FEATURE_AVX2 : 0u;
+    features |= (haveAvx512 && (features & SL_CPU_FEATURE_AVX2) && haveZmmState) ? SL_CPU_FEATURE_AVX512 : 0u;
+
+    return features;
+}
+
+#elif defined(LS_ARCH_X86)
+inline uint32_t _sl_query_cpu_features() noexcept
+{
+    // The compiler's builtins also verify that the OS saves extended register
+    // state. F16C is not queried since every AVX2 processor supports it.
+    __builtin_cpu_init();
+
+    const bool haveAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    const bool haveAvx512 = haveAvx2
+        && __builtin_cpu_supports("avx512f")
+        && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("avx512dq")
+        && __builtin_cpu_supports("avx512vl");
+
+    uint32_t features = SL_CPU_FEATURE_NONE;
+    features |= __builtin_cpu_supports("sse2") ? SL_CPU_FEATURE_SSE2 : 0u;
+    features |= __builtin_cpu_supports("sse4.1") ? SL_CPU_FEATURE_SSE4_1 : 0u;
+    features |= haveAvx2 ? SL_CPU_FEATURE_AVX2 : 0u;
+    features |= haveAvx512 ? SL_CPU_FEATURE_AVX512 : 0u;
+
+    return features;
+}
+
+#else
+inline uint32_t _sl_query_cpu_features() noexcept
+{
+    return SL_CPU_FEATURE_NONE;
+}
+
+#endif
+
+
+
+/*-------------------------------------
+ * Convert the name of an instruction set into the features it allows
+-------------------------------------*/
+inline bool _sl_parse_cpu_features(const char* pName, uint32_t& outFeatures) noexcept
+{
+    constexpr unsigned maxNameLen = 16;
+    char name[maxNameLen];
+    unsigned i = 0;
+
+    while (pName[i] && i < maxNameLen-1)
+    {
+        name[i] = (char)std::tolower((unsigned char)pName[i]);
+        ++i;
+    }
+
+    if (pName[i])
+    {
+        return false;
+    }
+
+    name[i] = '\0';
+
+    struct SL_CpuFeatureName
+    {
+        const char* pName;
+        uint32_t features;
+    };
+
+    constexpr SL_CpuFeatureName featureNames[] = {
+        {"none",    SL_CPU_FEATURE_NONE},
+        {"generic", SL_CPU_FEATURE_NONE},
+        {"sse2",    SL_CPU_FEATURE_SSE2},
+        {"sse4.1",  SL_CPU_FEATURE_SSE2|SL_CPU_FEATURE_SSE4_1},
+        {"sse41",   SL_CPU_FEATURE_SSE2|SL_CPU_FEATURE_SSE4_1},
+        {"avx2",    SL_CPU_FEATURE_SSE2|SL_CPU_FEATURE_SSE4_1|SL_CPU_FEATURE_AVX2},
+        {"avx512",  SL_CPU_FEATURE_ALL},
+    };
+
+    for (const SL_CpuFeatureName& featureName : featureNames)
+    {
+        const char* a = name;
+        const char* b = featureName.pName;
+
+        while (*a && *a == *b)
+        {
+            ++a;
+            ++b;
+        }
+
+        if (*a == *b)
+        {
+            outFeatures = featureName.features;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/*-------------------------------------
+ * Storage for the features currently in use
+-------------------------------------*/
+inline std::atomic<uint32_t>& _sl_active_cpu_features() noexcept
+{
+    static std::atomic<uint32_t> activeFeatures{sl_cpu_detect_features()};
+    return activeFeatures;
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * CPU Feature Detection
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Query the current CPU & operating system for supported features
+-------------------------------------*/
+uint32_t sl_cpu_detect_features() noexcept
+{
+    static const uint32_t detectedFeatures = _sl_query_cpu_features();
+    return detectedFeatures;
+}
+
+
+
+/*-------------------------------------
+ * Detect features once & apply the environment override
+-------------------------------------*/
+uint32_t sl_cpu_init_features() noexcept
+{
+    static const bool initialized = []() noexcept->bool
+    {
+        const char* const pOverride = std::getenv("SL_CPU_FEATURES");
+        uint32_t allowedFeatures = SL_CPU_FEATURE_ALL;
+
+        if (pOverride && _sl_parse_cpu_features(pOverride, allowedFeatures))
+        {
+            _sl_active_cpu_features().fetch_and(allowedFeatures, std::memory_order_relaxed);
+        }
+
+        return true;
+    }();
+
+    (void)initialized;
+    return sl_cpu_features();
+}
+
+
+
+/*-------------------------------------
+ * Retrieve the features available to rendering kernels
+-------------------------------------*/
+uint32_t sl_cpu_features() noexcept
+{
+    return _sl_active_cpu_features().load(std::memory_order_relaxed);
+}
+
+
+
+/*-------------------------------------
+ * Restrict the features available to rendering kernels
+-------------------------------------*/
+uint32_t sl_cpu_set_features(uint32_t features) noexcept
+{
+    features &= sl_cpu_detect_features();
+    _sl_active_cpu_features().store(features, std::memory_order_relaxed);
+    return features;
+}
@@ -0,0 +1,415 @@
+#include <new> // placement new
+#include <utility> // std::move()
+
+#include "lightsky/math/half.h"
+#include "lightsky/math/scalar_utils.h" // math::min(), math::max()
+
+#include "lightsky/utils/Copy.h" // utils::fast_memset()
+
+#include "softlight/SL_DepthHierarchy.hpp"
+#include "softlight/SL_Framebuffer.hpp" // sl_fbo_index()
+#include "softlight/SL_Texture.hpp" // SL_TextureView
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_DepthHierarchy Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Destructor
+-------------------------------------*/
+SL_DepthHierarchy::~SL_DepthHierarchy() noexcept
+{
+    terminate();
+}
+
+
+
+/*-------------------------------------
+ * Constructor
+-------------------------------------*/
+SL_DepthHierarchy::SL_DepthHierarchy() noexcept :
+    mWidth{0},
+    mHeight{0},
+    mSpansX{0},
+    mTilesX{0},
+    mTilesY{0},
+    mSpans{nullptr},
+    mSpanDirty{nullptr},
+    mTiles{nullptr},
+    mTileDirty{nullptr}
+{}
+
+
+
+/*-------------------------------------
+ * Copy Constructor
+ *
+ * Copies share a depth buffer with the original, but not its history of
+ * depth writes. The copy must be rebuilt before it can be used for culling.
+-------------------------------------*/
+SL_DepthHierarchy::SL_DepthHierarchy(const SL_DepthHierarchy& h) noexcept :
+    SL_DepthHierarchy{}
+{
+    if (h.valid())
+    {
+        init(h.mWidth, h.mHeight);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Move Constructor
+-------------------------------------*/
+SL_DepthHierarchy::SL_DepthHierarchy(SL_DepthHierarchy&& h) noexcept :
+    mWidth{h.mWidth},
+    mHeight{h.mHeight},
+    mSpansX{h.mSpansX},
+    mTilesX{h.mTilesX},
+    mTilesY{h.mTilesY},
+    mSpans{std::move(h.mSpans)},
+    mSpanDirty{std::move(h.mSpanDirty)},
+    mTiles{std::move(h.mTiles)},
+    mTileDirty{std::move(h.mTileDirty)}
+{
+    h.mWidth = 0;
+    h.mHeight = 0;
+    h.mSpansX = 0;
+    h.mTilesX = 0;
+    h.mTilesY = 0;
+}
+
+
+
+/*-------------------------------------
+ * Copy Operator
+-------------------------------------*/
+SL_DepthHierarchy& SL_DepthHierarchy::operator=(const SL_DepthHierarchy& h) noexcept
+{
+    if (this == &h)
+    {
+        return *this;
+    }
+
+    terminate();
+
+    if (h.valid())
+    {
+        init(h.mWidth, h.mHeight);
+    }
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Move Operator
+-------------------------------------*/
+SL_DepthHierarchy& SL_DepthHierarchy::operator=(SL_DepthHierarchy&& h) noexcept
+{
+    if (this == &h)
+    {
+        return *this;
+    }
+
+    mWidth = h.mWidth;
+    h.mWidth = 0;
+
+    mHeight = h.mHeight;
+    h.mHeight = 0;
+
+    mSpansX = h.mSpansX;
+    h.mSpansX = 0;
+
+    mTilesX = h.mTilesX;
+    h.mTilesX = 0;
+
+    mTilesY = h.mTilesY;
+    h.mTilesY = 0;
+
+    mSpans = std::move(h.mSpans);
+    mSpanDirty = std::move(h.mSpanDirty);
+    mTiles = std::move(h.mTiles);
+    mTileDirty = std::move(h.mTileDirty);
+
+    return *this;
+}
+
+
+
+/*-------------------------------------
+ * Allocate storage for a depth buffer of a specific size
+-------------------------------------*/
+int SL_DepthHierarchy::init(uint16_t width, uint16_t height) noexcept
+{
+    terminate();
+
+    if (!width || !height)
+    {
+        return -1;
+    }
+
+    const uint16_t spansX   = (uint16_t)((width + SL_HIZ_TILE_SIZE - 1u) / SL_HIZ_TILE_SIZE);
+    const uint16_t tilesY   = (uint16_t)((height + SL_HIZ_TILE_SIZE - 1u) / SL_HIZ_TILE_SIZE);
+    const size_t   numSpans = (size_t)spansX * (size_t)height;
+    const size_t   numTiles = (size_t)spansX * (size_t)tilesY;
+
+    mSpans     = ls::utils::make_unique_aligned_array<SL_DepthBounds>(numSpans);
+    mSpanDirty = ls::utils::make_unique_aligned_array<uint8_t>(numSpans);
+    mTiles     = ls::utils::make_unique_aligned_array<SL_DepthBounds>(numTiles);
+    mTileDirty = ls::utils::make_unique_aligned_array<std::atomic_uint_fast8_t>(numTiles);
+
+    if (!mSpans || !mSpanDirty || !mTiles || !mTileDirty)
+    {
+        terminate();
+        return -2;
+    }
+
+    for (size_t i = 0; i < numTiles; ++i)
+    {
+        new (&mTileDirty[i]) std::atomic_uint_fast8_t{1};
+    }
+
+    mWidth  = width;
+    mHeight = height;
+    mSpansX = spansX;
+    mTilesX = spansX;
+    mTilesY = tilesY;
+
+    // Contents of the depth buffer are unknown until it's cleared
+    invalidate();
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Release all resources
+-------------------------------------*/
+void SL_DepthHierarchy::terminate() noexcept
+{
+    mWidth = 0;
+    mHeight = 0;
+    mSpansX = 0;
+    mTilesX = 0;
+    mTilesY = 0;
+
+    mSpans.reset();
+    mSpanDirty.reset();
+    mTiles.reset();
+    mTileDirty.reset();
+}
+
+
+
+/*-------------------------------------
+ * Reset all bounds to match a cleared depth buffer
+-------------------------------------*/
+void SL_DepthHierarchy::clear(float depth) noexcept
+{
+    if (!valid())
+    {
+        return;
+    }
+
+    const size_t         numSpans = (size_t)mSpansX * (size_t)mHeight;
+    const size_t         numTiles = (size_t)mTilesX * (size_t)mTilesY;
+    const SL_DepthBounds bounds{depth, depth};
+
+    for (size_t i = 0; i < numSpans; ++i)
+    {
+        mSpans[i] = bounds;
+    }
+
+    ls::utils::fast_memset(mSpanDirty.get(), 0, numSpans);
+
+    for (size_t i = 0; i < numTiles; ++i)
+    {
+        mTiles[i] = bounds;
+        mTileDirty[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Prevent all bounds from being used until they're rebuilt
+-------------------------------------*/
+void SL_DepthHierarchy::invalidate() noexcept
+{
+    if (!valid())
+    {
+        return;
+    }
+
+    const size_t numSpans = (size_t)mSpansX * (size_t)mHeight;
+    const size_t numTiles = (size_t)mTilesX * (size_t)mTilesY;
+
+    ls::utils::fast_memset(mSpanDirty.get(), 1, numSpans);
+
+    for (size_t i = 0; i < numTiles; ++i)
+    {
+        mTileDirty[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Test a rectangle of pixels, [x0, x1) & [y0, y1), against the tile bounds.
+-------------------------------------*/
+bool SL_DepthHierarchy::is_rect_occluded(SL_DepthTest depthTest, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float zMin, float zMax) const noexcept
+{
+    x0 = math::max<int32_t>(x0, 0);
+    y0 = math::max<int32_t>(y0, 0);
+    x1 = math::min<int32_t>(x1, (int32_t)mWidth);
+    y1 = math::min<int32_t>(y1, (int32_t)mHeight);
+
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return false;
+    }
+
+    const uint32_t tx0 = (uint32_t)x0 / SL_HIZ_TILE_SIZE;
+    const uint32_t ty0 = (uint32_t)y0 / SL_HIZ_TILE_SIZE;
+    const uint32_t tx1 = (uint32_t)(x1 - 1) / SL_HIZ_TILE_SIZE;
+    const uint32_t ty1 = (uint32_t)(y1 - 1) / SL_HIZ_TILE_SIZE;
+
+    // Visible primitives will usually exit on their first few tiles.
+    for (uint32_t ty = ty0; ty <= ty1; ++ty)
+    {
+        for (uint32_t tx = tx0; tx <= tx1; ++tx)
+        {
+            const uint32_t tileId = ty * mTilesX + tx;
+
+            if (mTileDirty[tileId].load(std::memory_order_acquire) || !sl_depth_bounds_occluded(depthTest, zMin, zMax, mTiles[tileId]))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-------------------------------------
+ * Recalculate the dirty spans within every "yStep" rows of a region. Only the
+ * thread which owns the rows may call this.
+-------------------------------------*/
+template <typename depth_type>
+void SL_DepthHierarchy::update_spans(const SL_TextureView& depthBuf, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t yStep) noexcept
+{
+    if (!valid() || depthBuf.width != mWidth || depthBuf.height != mHeight)
+    {
+        return;
+    }
+
+    x0 = math::max<int32_t>(x0, 0);
+    x1 = math::min<int32_t>(x1, (int32_t)mWidth);
+    y1 = math::min<int32_t>(y1, (int32_t)mHeight);
+
+    if (x0 >= x1)
+    {
+        return;
+    }
+
+    const uint32_t spanBegin = (uint32_t)x0 / SL_HIZ_TILE_SIZE;
+    const uint32_t spanEnd   = (uint32_t)(x1 - 1) / SL_HIZ_TILE_SIZE;
+
+    for (int32_t y = math::max<int32_t>(y0, 0); y < y1; y += yStep)
+    {
+        const uint32_t    rowOffset = (uint32_t)y * mSpansX;
+        const depth_type* pTexels   = reinterpret_cast<const depth_type*>(depthBuf.pTexels);
+
+        for (uint32_t s = spanBegin; s <= spanEnd; ++s)
+        {
+            if (!mSpanDirty[rowOffset + s])
+            {
+                continue;
+            }
+
+            // Spans are always rebuilt in their entirety, even if the region
+            // only partially overlaps them.
+            const uint32_t px0  = s * SL_HIZ_TILE_SIZE;
+            const uint32_t px1  = math::min<uint32_t>(px0 + SL_HIZ_TILE_SIZE, mWidth);
+            float          dMin = (float)pTexels[sl_fbo_index(depthBuf, px0, (uint32_t)y)];
+            float          dMax = dMin;
+
+            for (uint32_t x = px0+1u; x < px1; ++x)
+            {
+                const float d = (float)pTexels[sl_fbo_index(depthBuf, x, (uint32_t)y)];
+                dMin = math::min(dMin, d);
+                dMax = math::max(dMax, d);
+            }
+
+            mSpans[rowOffset + s] = SL_DepthBounds{dMin, dMax};
+            mSpanDirty[rowOffset + s] = 0;
+        }
+    }
+}
+
+template void SL_DepthHierarchy::update_spans<ls::math::half>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+template void SL_DepthHierarchy::update_spans<float>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+template void SL_DepthHierarchy::update_spans<double>(const SL_TextureView&, int32_t, int32_t, int32_t, int32_t, int32_t) noexcept;
+
+
+
+/*-------------------------------------
+ * Rebuild dirty tiles from their spans. Each thread updates an interleaved
+ * set of tile rows. No thread may be rasterizing while this is running.
+-------------------------------------*/
+void SL_DepthHierarchy::update_tiles(uint16_t threadId, uint16_t numThreads) noexcept
+{
+    if (!valid())
+    {
+        return;
+    }
+
+    for (uint32_t ty = threadId; ty < mTilesY; ty += numThreads)
+    {
+        const uint32_t y0 = ty * SL_HIZ_TILE_SIZE;
+        const uint32_t y1 = math::min<uint32_t>(y0 + SL_HIZ_TILE_SIZE, mHeight);
+
+        for (uint32_t tx = 0; tx < mTilesX; ++tx)
+        {
+            const uint32_t tileId = ty * mTilesX + tx;
+
+            if (!mTileDirty[tileId].load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+
+            SL_DepthBounds bounds = mSpans[y0 * mSpansX + tx];
+            bool isValid = true;
+
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                const uint32_t spanId = y * mSpansX + tx;
+
+                // Tiles with spans which haven't been recalculated stay dirty
+                // until the next draw.
+                if (mSpanDirty[spanId])
+                {
+                    isValid = false;
+                    break;
+                }
+
+                bounds.minDepth = math::min(bounds.minDepth, mSpans[spanId].minDepth);
+                bounds.maxDepth = math::max(bounds.maxDepth, mSpans[spanId].maxDepth);
+            }
+
+            if (isValid)
+            {
+                mTiles[tileId] = bounds;
+                mTileDirty[tileId].store(0, std::memory_order_release);
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 
 #include "lightsky/setup/Api.h" // LS_IMPERATIVE
 
+#include "softlight/SL_CpuFeatures.hpp" // sl_cpu_features()
 #include "softlight/SL_FragmentProcessor.hpp"
 #include "softlight/SL_Framebuffer.hpp" // SL_Framebuffer
 #include "softlight/SL_PipelineState.hpp"
@@ -16,6 +17,10 @@ namespace utils = ls::utils;
 
 
 
+static_assert(SL_SHADER_MAX_QUEUED_FRAGS % SL_SHADER_FRAG_BLOCK_SIZE == 0, "Fragment queues must hold a whole number of shader blocks.");
+
+
+
 namespace
 {
 
@@ -149,48 +154,97 @@ inline void LS_IMPERATIVE interpolate_line_varyings(
 
 
 
+#if SL_AVX2_KERNELS_ENABLED
 /*--------------------------------------
- * Interpolate varying variables across a triangle
+ * Interpolate varying variables across a triangle (AVX2)
 --------------------------------------*/
-inline void LS_IMPERATIVE interpolate_tri_varyings(
+SL_TARGET_AVX2 inline void _sl_interpolate_tri_varyings_avx2(
     const float*      LS_RESTRICT_PTR baryCoords,
-    uint_fast32_t     numVaryings,
     const math::vec4* inVaryings0,
     math::vec4*       outVaryings) noexcept
 {
-    static_assert(SL_SHADER_MAX_VARYING_VECTORS == 4, "Please update the varying interpolator.");
+    const float* LS_RESTRICT_PTR i0 = reinterpret_cast<const float*>(inVaryings0);
+    const float* LS_RESTRICT_PTR i1 = reinterpret_cast<const float*>(inVaryings0 + SL_SHADER_MAX_VARYING_VECTORS);
+    const float* LS_RESTRICT_PTR i2 = reinterpret_cast<const float*>(inVaryings0 + SL_SHADER_MAX_VARYING_VECTORS * 2);
+    float* const LS_RESTRICT_PTR o = reinterpret_cast<float*>(outVaryings);
+
+    __m256 a, c, v0, v2;
+
+    a = _mm256_load_ps(i0 + 0);
+    c = _mm256_load_ps(i0 + 8);
+    const __m256 bc0 = _mm256_broadcast_ss(baryCoords+0);
+    v0 = _mm256_mul_ps(bc0, a);
+    v2 = _mm256_mul_ps(bc0, c);
+
+    a = _mm256_load_ps(i1 + 0);
+    c = _mm256_load_ps(i1 + 8);
+    const __m256 bc1 = _mm256_broadcast_ss(baryCoords+1);
+    v0 = _mm256_fmadd_ps(bc1, a, v0);
+    v2 = _mm256_fmadd_ps(bc1, c, v2);
+
+    a = _mm256_load_ps(i2 + 0);
+    c = _mm256_load_ps(i2 + 8);
+    const __m256 bc2 = _mm256_broadcast_ss(baryCoords+2);
+    v0 = _mm256_fmadd_ps(bc2, a, v0);
+    v2 = _mm256_fmadd_ps(bc2, c, v2);
+
+    _mm256_store_ps(o + 0,  v0);
+    _mm256_store_ps(o + 8,  v2);
+    _mm256_zeroupper();
+}
 
-    #if defined(LS_X86_AVX2)
-        (void)numVaryings;
 
-        const float* LS_RESTRICT_PTR i0 = reinterpret_cast<const float*>(inVaryings0);
-        const float* LS_RESTRICT_PTR i1 = reinterpret_cast<const float*>(inVaryings0 + SL_SHADER_MAX_VARYING_VECTORS);
-        const float* LS_RESTRICT_PTR i2 = reinterpret_cast<const float*>(inVaryings0 + SL_SHADER_MAX_VARYING_VECTORS * 2);
-        float* const LS_RESTRICT_PTR o = reinterpret_cast<float*>(outVaryings);
 
-        __m256 a, c, v0, v2;
+/*--------------------------------------
+ * Apply perspective correction to queued barycentric coordinates (AVX2)
+--------------------------------------*/
+SL_TARGET_AVX2 inline void _sl_perspective_correct_avx2(
+    const math::vec4*   pPoints,
+    uint_fast32_t       numQueuedFrags,
+    SL_FragCoord* const outCoords) noexcept
+{
+    const __m256  mask       = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+    const __m256i idx        = _mm256_set_epi32(-1, 11, 7, 3, -1, 11, 7, 3);
+    const __m256  homogenous = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), reinterpret_cast<const float*>(pPoints), idx, mask, sizeof(float));
 
-        a = _mm256_load_ps(i0 + 0);
-        c = _mm256_load_ps(i0 + 8);
-        const __m256 bc0 = _mm256_broadcast_ss(baryCoords+0);
-        v0 = _mm256_mul_ps(bc0, a);
-        v2 = _mm256_mul_ps(bc0, c);
+    for (uint_fast32_t i = 0; i < numQueuedFrags; i += 2)
+    {
+        float* const pBc = reinterpret_cast<float*>(outCoords->bc + i);
+        const __m256 bc = _mm256_mul_ps(_mm256_load_ps(pBc), homogenous);
 
-        a = _mm256_load_ps(i1 + 0);
-        c = _mm256_load_ps(i1 + 8);
-        const __m256 bc1 = _mm256_broadcast_ss(baryCoords+1);
-        v0 = _mm256_fmadd_ps(bc1, a, v0);
-        v2 = _mm256_fmadd_ps(bc1, c, v2);
+        // horizontal add
+        const __m256 a     = _mm256_permute_ps(bc, 0xB1);
+        const __m256 b     = _mm256_add_ps(bc, a);
+        const __m256 c     = _mm256_permute_ps(b, 0x0F);
+        const __m256 d     = _mm256_add_ps(c, b);
+        const __m256 persp = _mm256_rcp_ps(d);
 
-        a = _mm256_load_ps(i2 + 0);
-        c = _mm256_load_ps(i2 + 8);
-        const __m256 bc2 = _mm256_broadcast_ss(baryCoords+2);
-        v0 = _mm256_fmadd_ps(bc2, a, v0);
-        v2 = _mm256_fmadd_ps(bc2, c, v2);
+        _mm256_store_ps(pBc, _mm256_mul_ps(bc, persp));
+    }
 
-        _mm256_store_ps(o + 0,  v0);
-        _mm256_store_ps(o + 8,  v2);
-        _mm256_zeroupper();
+    _mm256_zeroupper();
+}
+
+
+
+#endif /* SL_AVX2_KERNELS_ENABLED */
+
+
+
+/*--------------------------------------
+ * Interpolate varying variables across a triangle
+--------------------------------------*/
+inline void LS_IMPERATIVE interpolate_tri_varyings(
+    const float*      LS_RESTRICT_PTR baryCoords,
+    uint_fast32_t     numVaryings,
+    const math::vec4* inVaryings0,
+    math::vec4*       outVaryings) noexcept
+{
+    static_assert(SL_SHADER_MAX_VARYING_VECTORS == 4, "Please update the varying interpolator.");
+
+    #if defined(LS_X86_AVX2)
+        (void)numVaryings;
+        _sl_interpolate_tri_varyings_avx2(baryCoords, inVaryings0, outVaryings);
 
     #elif defined(LS_X86_SSE)
         (void)numVaryings;
@@ -332,98 +386,19 @@ inline void LS_IMPERATIVE interpolate_tri_varyings(
 
 
 
-} // end anonymous namespace
-
-
-
-/*-----------------------------------------------------------------------------
- * SL_FragmentProcessor Class
------------------------------------------------------------------------------*/
 /*--------------------------------------
- * Bin-Rasterization
+ * Apply perspective correction to queued barycentric coordinates
 --------------------------------------*/
-template <typename depth_type>
-void SL_FragmentProcessor::flush_line_fragments(
-    const SL_FragmentBin& bin,
-    uint_fast32_t         numQueuedFrags,
-    SL_FragCoord* const   outCoords) const noexcept
+inline void _sl_perspective_correct(
+    const math::vec4*   pPoints,
+    uint_fast32_t       numQueuedFrags,
+    SL_FragCoord* const outCoords) noexcept
 {
-    const SL_PipelineState  pipeline      = mShader->pipelineState;
-    const SL_BlendMode      blendMode     = pipeline.blend_mode();
-    const SL_FboOutputMask  fboOutMask    = sl_calc_fbo_out_mask((unsigned)pipeline.num_render_targets(), (blendMode != SL_BLEND_OFF));
-    const uint32_t          numVaryings   = (unsigned)pipeline.num_varyings();
-    const int_fast32_t      haveDepthMask = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
-    const SL_UniformBuffer* pUniforms     = mShader->pUniforms;
-    const auto              fragShader    = mShader->pFragShader;
-    SL_TextureView&         pDepthBuf     = mFbo->get_depth_buffer();
-
-    SL_FragmentParam fragParams;
-    fragParams.pUniforms = pUniforms;
-
-    uint_fast32_t i;
-
-    for (i = 0; i < numQueuedFrags; ++i)
-    {
-        const float interp = outCoords->lineInterp[i];
-
-        interpolate_line_varyings(interp, numVaryings, bin.mVaryings, fragParams.pVaryings);
-
-        fragParams.coord = outCoords->coord[i];
-
-        const bool haveOutputs = fragShader(fragParams);
-
-        if (LS_LIKELY(haveOutputs))
-        {
-            mFbo->put_pixel(fboOutMask, blendMode, fragParams);
-
-            if (LS_LIKELY(haveDepthMask))
-            {
-                ((depth_type*)pDepthBuf.pTexels)[fragParams.coord.x + pDepthBuf.width * fragParams.coord.y] = (depth_type)fragParams.coord.depth;
-            }
-        }
-    }
-}
-
-
-
-template void SL_FragmentProcessor::flush_line_fragments<ls::math::half>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
-template void SL_FragmentProcessor::flush_line_fragments<float>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
-template void SL_FragmentProcessor::flush_line_fragments<double>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
-
-
-
-/*--------------------------------------
- * Bin-Rasterization
---------------------------------------*/
-template <typename depth_type>
-void SL_FragmentProcessor::flush_tri_fragments(
-    const SL_FragmentBin& bin,
-    uint_fast32_t         numQueuedFrags,
-    SL_FragCoord* const   outCoords) const noexcept
-{
-    const SL_PipelineState  pipeline      = mShader->pipelineState;
-    const SL_BlendMode      blendMode     = pipeline.blend_mode();
-    const SL_FboOutputMask  fboOutMask    = sl_calc_fbo_out_mask((unsigned)pipeline.num_render_targets(), (blendMode != SL_BLEND_OFF));
-    const uint32_t          numVaryings   = (unsigned)pipeline.num_varyings();
-    const int_fast32_t      haveDepthMask = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
-    const SL_UniformBuffer* pUniforms     = mShader->pUniforms;
-    const auto              fragShader    = mShader->pFragShader;
-    SL_TextureView&         pDepthBuf     = mFbo->get_depth_buffer();
-
-    SL_FragmentParam fragParams;
-    fragParams.pUniforms = pUniforms;
-
-    const math::vec4* pPoints = bin.mScreenCoords;
+    #if defined(LS_X86_AVX2)
+        _sl_perspective_correct_avx2(pPoints, numQueuedFrags, outCoords);
 
-    // perspective correction
-    #if defined(LS_X86_AVX)
-        #if defined(LS_X86_AVX2)
-            const __m256 mask       = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
-            const __m256i idx       = _mm256_set_epi32(-1, 11, 7, 3, -1, 11, 7, 3);
-            const __m256 homogenous = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), reinterpret_cast<const float*>(pPoints), idx, mask, sizeof(float));
-        #else
-            const __m256 homogenous = _mm256_set_ps(0.f, pPoints[2][3], pPoints[1][3], pPoints[0][3], 0.f, pPoints[2][3], pPoints[1][3], pPoints[0][3]);
-        #endif
+    #elif defined(LS_X86_AVX)
+        const __m256 homogenous = _mm256_set_ps(0.f, pPoints[2][3], pPoints[1][3], pPoints[0][3], 0.f, pPoints[2][3], pPoints[1][3], pPoints[0][3]);
 
         for (uint_fast32_t i = 0; i < numQueuedFrags; i += 2)
         {
@@ -473,10 +448,428 @@ void SL_FragmentProcessor::flush_tri_fragments(
             outCoords->bc[i] = bc * persp;
         }
     #endif
+}
+
+
+
+/*--------------------------------------
+ * Interpolate varying variables for a block of triangle fragments
+--------------------------------------*/
+inline LS_INLINE void _sl_interpolate_tri_block(
+    const math::vec4* LS_RESTRICT_PTR baryCoords,
+    uint_fast32_t     numVaryings,
+    const math::vec4* LS_RESTRICT_PTR inVaryings,
+    float (&outVaryings)[SL_SHADER_MAX_VARYING_VECTORS][4][SL_SHADER_FRAG_BLOCK_SIZE]) noexcept
+{
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float bc0[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float bc1[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float bc2[SL_SHADER_FRAG_BLOCK_SIZE];
+
+    for (unsigned n = 0; n < SL_SHADER_FRAG_BLOCK_SIZE; ++n)
+    {
+        bc0[n] = baryCoords[n][0];
+        bc1[n] = baryCoords[n][1];
+        bc2[n] = baryCoords[n][2];
+    }
+
+    // Every lane is interpolated so the inner loops have a fixed length and
+    // can be vectorized. Inactive lanes are ignored by the shader.
+    for (uint_fast32_t v = 0; v < numVaryings; ++v)
+    {
+        const math::vec4& v0 = inVaryings[v];
+        const math::vec4& v1 = inVaryings[v + SL_SHADER_MAX_VARYING_VECTORS];
+        const math::vec4& v2 = inVaryings[v + SL_SHADER_MAX_VARYING_VECTORS * 2];
+
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            float* const LS_RESTRICT_PTR pOut = outVaryings[v][c];
+
+            for (unsigned n = 0; n < SL_SHADER_FRAG_BLOCK_SIZE; ++n)
+            {
+                pOut[n] = bc0[n] * v0[c] + bc1[n] * v1[c] + bc2[n] * v2[c];
+            }
+        }
+    }
+}
+
+
+
+/*--------------------------------------
+ * Perspective-correct barycentric coordinates at an arbitrary pixel
+--------------------------------------*/
+inline LS_INLINE math::vec4 _sl_perspective_barycentric(
+    const math::vec4* bcClipSpace,
+    const math::vec4& homogenous,
+    float x,
+    float y) noexcept
+{
+    const math::vec4&& bcY = math::fmadd(bcClipSpace[1], math::vec4{y, y, y, 0.f}, bcClipSpace[2]);
+    const math::vec4&& bc  = math::fmadd(bcClipSpace[0], math::vec4{x, x, x, 0.f}, bcY) * homogenous;
+    return bc * math::vec4{math::sum_inv(bc)};
+}
+
+
+
+/*--------------------------------------
+ * Screen-space derivatives of a fragment's barycentric coordinates
+--------------------------------------*/
+inline LS_INLINE void _sl_tri_quad_derivatives(
+    const math::vec4* bcClipSpace,
+    const math::vec4& homogenous,
+    SL_FragCoordXYZ   coord,
+    math::vec4&       outDx,
+    math::vec4&       outDy) noexcept
+{
+    // Quads start on even pixel coordinates & every fragment of a quad
+    // shares its derivatives. The quad's other pixels are evaluated from the
+    // triangle's plane equations whether or not the triangle covers them,
+    // acting as helper lanes.
+    const float x = (float)(coord.x & ~1u);
+    const float y = (float)(coord.y & ~1u);
+
+    const math::vec4&& bc00 = _sl_perspective_barycentric(bcClipSpace, homogenous, x,     y);
+    const math::vec4&& bc10 = _sl_perspective_barycentric(bcClipSpace, homogenous, x+1.f, y);
+    const math::vec4&& bc01 = _sl_perspective_barycentric(bcClipSpace, homogenous, x,     y+1.f);
+
+    outDx = bc10 - bc00;
+    outDy = bc01 - bc00;
+}
+
+
+
+/*--------------------------------------
+ * Triangle interpolation for the instruction sets targeted by the build
+--------------------------------------*/
+struct SL_TriInterpolator
+{
+    inline LS_INLINE void perspective_correct(const math::vec4* pPoints, uint_fast32_t numQueuedFrags, SL_FragCoord* const outCoords) const noexcept
+    {
+        _sl_perspective_correct(pPoints, numQueuedFrags, outCoords);
+    }
+
+    inline LS_INLINE void interpolate(const float* baryCoords, uint_fast32_t numVaryings, const math::vec4* inVaryings, math::vec4* outVaryings) const noexcept
+    {
+        interpolate_tri_varyings(baryCoords, numVaryings, inVaryings, outVaryings);
+    }
+};
+
+
+
+#if SL_AVX2_DISPATCH_ENABLED
+/*--------------------------------------
+ * Triangle interpolation for CPUs with AVX2, selected at runtime
+--------------------------------------*/
+struct SL_TriInterpolatorAVX2
+{
+    SL_TARGET_AVX2 inline void perspective_correct(const math::vec4* pPoints, uint_fast32_t numQueuedFrags, SL_FragCoord* const outCoords) const noexcept
+    {
+        _sl_perspective_correct_avx2(pPoints, numQueuedFrags, outCoords);
+    }
+
+    SL_TARGET_AVX2 inline void interpolate(const float* baryCoords, uint_fast32_t, const math::vec4* inVaryings, math::vec4* outVaryings) const noexcept
+    {
+        _sl_interpolate_tri_varyings_avx2(baryCoords, inVaryings, outVaryings);
+    }
+};
+#endif
+
+
+
+/*--------------------------------------
+ * Shade & output a queue of triangle fragments using a wide shader
+--------------------------------------*/
+template <typename depth_type, class Interpolator>
+inline LS_INLINE void _sl_shade_tri_fragment_blocks(
+    const SL_FragmentProcessor& fragProcessor,
+    const SL_FragmentBin&       bin,
+    uint_fast32_t               numQueuedFrags,
+    SL_FragCoord* const         outCoords) noexcept
+{
+    constexpr Interpolator  interpolator;
+    const SL_Shader*        pShader       = fragProcessor.mShader;
+    SL_Framebuffer*         pFbo          = fragProcessor.mFbo;
+    const SL_PipelineState  pipeline      = pShader->pipelineState;
+    const SL_PixelWriter&   pixelWriter   = fragProcessor.mPixelWriter;
+    const uint32_t          numOutputs    = (unsigned)pipeline.num_render_targets();
+    const uint32_t          numVaryings   = (unsigned)pipeline.num_varyings();
+    const int_fast32_t      haveDepthMask = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
+    const auto              blockShader   = pShader->pFragBlockShader;
+    SL_TextureView&         pDepthBuf     = pFbo->get_depth_buffer();
+    SL_DepthHierarchy&      depthBounds   = pFbo->depth_hierarchy();
+    const bool              haveBounds    = haveDepthMask && depthBounds.valid();
+    const bool              haveDerivs    = pipeline.derivative_mode() == SL_DERIVATIVES_ON;
+    const math::vec4*       pPoints       = bin.mScreenCoords;
+    const math::vec4        homogenous    {pPoints[0][3], pPoints[1][3], pPoints[2][3], 0.f};
+    uint32_t                prevQuad      = ~0u;
+    math::vec4              quadDx        {0.f};
+    math::vec4              quadDy        {0.f};
+
+    SL_FragmentBlockParam blockParams;
+    blockParams.pUniforms = pShader->pUniforms;
+
+    // Framebuffer writes still happen one pixel at a time
+    SL_FragmentParam fragParams;
+    fragParams.pUniforms = pShader->pUniforms;
+
+    interpolator.perspective_correct(bin.mScreenCoords, numQueuedFrags, outCoords);
+
+    for (uint_fast32_t i = 0; i < numQueuedFrags; i += SL_SHADER_FRAG_BLOCK_SIZE)
+    {
+        const uint_fast32_t numFrags = math::min<uint_fast32_t>(SL_SHADER_FRAG_BLOCK_SIZE, numQueuedFrags - i);
+        const SL_FragCoordXYZ* const pCoords = outCoords->coord + i;
+
+        for (unsigned n = 0; n < SL_SHADER_FRAG_BLOCK_SIZE; ++n)
+        {
+            blockParams.x[n]     = pCoords[n].x;
+            blockParams.y[n]     = pCoords[n].y;
+            blockParams.depth[n] = pCoords[n].depth;
+        }
+
+        _sl_interpolate_tri_block(outCoords->bc + i, numVaryings, bin.mVaryings, blockParams.pVaryings);
+
+        if (haveDerivs)
+        {
+            math::vec4 bcDx[SL_SHADER_FRAG_BLOCK_SIZE];
+            math::vec4 bcDy[SL_SHADER_FRAG_BLOCK_SIZE];
+
+            // Fragments are queued in scanline order, so neighboring lanes
+            // within the same quad reuse its derivatives. Inactive lanes
+            // copy the last quad.
+            for (unsigned n = 0; n < SL_SHADER_FRAG_BLOCK_SIZE; ++n)
+            {
+                if (n < numFrags)
+                {
+                    const uint32_t quad = ((uint32_t)(pCoords[n].y >> 1) << 16) | (uint32_t)(pCoords[n].x >> 1);
+
+                    if (quad != prevQuad)
+                    {
+                        _sl_tri_quad_derivatives(bin.mBarycentricCoords, homogenous, pCoords[n], quadDx, quadDy);
+                        prevQuad = quad;
+                    }
+                }
+
+                bcDx[n] = quadDx;
+                bcDy[n] = quadDy;
+            }
+
+            _sl_interpolate_tri_block(bcDx, numVaryings, bin.mVaryings, blockParams.pDdx);
+            _sl_interpolate_tri_block(bcDy, numVaryings, bin.mVaryings, blockParams.pDdy);
+        }
+
+        blockParams.activeMask = (1u << numFrags) - 1u;
+
+        const uint32_t outMask = blockShader(blockParams) & blockParams.activeMask;
+
+        if (pixelWriter.pWriteBlock)
+        {
+            pixelWriter.pWriteBlock(pixelWriter, blockParams.x, blockParams.y, blockParams.pOutputs[0], outMask);
+        }
+
+        for (unsigned n = 0; n < numFrags; ++n)
+        {
+            if (!(outMask & (1u << n)))
+            {
+                continue;
+            }
+
+            fragParams.coord = pCoords[n];
+
+            if (!pixelWriter.pWriteBlock)
+            {
+                for (uint32_t t = 0; t < numOutputs; ++t)
+                {
+                    const float (&o)[4][SL_SHADER_FRAG_BLOCK_SIZE] = blockParams.pOutputs[t];
+                    fragParams.pOutputs[t] = math::vec4{o[0][n], o[1][n], o[2][n], o[3][n]};
+                }
+
+                sl_write_pixel(pixelWriter, fragParams);
+            }
+
+            if (LS_LIKELY(haveDepthMask))
+            {
+                ((depth_type*)pDepthBuf.pTexels)[sl_fbo_index(pDepthBuf, fragParams.coord.x, fragParams.coord.y)] = (depth_type)fragParams.coord.depth;
+
+                if (haveBounds)
+                {
+                    depthBounds.mark_dirty(fragParams.coord.x, fragParams.coord.y);
+                }
+            }
+        }
+    }
+}
+
+
+
+/*--------------------------------------
+ * Shade & output a queue of triangle fragments
+--------------------------------------*/
+template <typename depth_type, class Interpolator>
+inline LS_INLINE void _sl_shade_tri_fragments(
+    const SL_FragmentProcessor& fragProcessor,
+    const SL_FragmentBin&       bin,
+    uint_fast32_t               numQueuedFrags,
+    SL_FragCoord* const         outCoords) noexcept
+{
+    if (fragProcessor.mShader->pFragBlockShader)
+    {
+        _sl_shade_tri_fragment_blocks<depth_type, Interpolator>(fragProcessor, bin, numQueuedFrags, outCoords);
+        return;
+    }
+
+    constexpr Interpolator  interpolator;
+    const SL_Shader*        pShader       = fragProcessor.mShader;
+    SL_Framebuffer*         pFbo          = fragProcessor.mFbo;
+    const SL_PipelineState  pipeline      = pShader->pipelineState;
+    const SL_PixelWriter&   pixelWriter   = fragProcessor.mPixelWriter;
+    const uint32_t          numVaryings   = (unsigned)pipeline.num_varyings();
+    const int_fast32_t      haveDepthMask = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
+    const SL_UniformBuffer* pUniforms     = pShader->pUniforms;
+    const auto              fragShader    = pShader->pFragShader;
+    SL_TextureView&         pDepthBuf     = pFbo->get_depth_buffer();
+    SL_DepthHierarchy&      depthBounds   = pFbo->depth_hierarchy();
+    const bool              haveBounds    = haveDepthMask && depthBounds.valid();
+    const bool              haveDerivs    = pipeline.derivative_mode() == SL_DERIVATIVES_ON;
+    const math::vec4*       pPoints       = bin.mScreenCoords;
+    const math::vec4        homogenous    {pPoints[0][3], pPoints[1][3], pPoints[2][3], 0.f};
+    uint32_t                prevQuad      = ~0u;
+
+    SL_FragmentParam fragParams;
+    fragParams.pUniforms = pUniforms;
+
+    // Shaded colors are batched when the framebuffer supports block writes.
+    // Fragments within a bin never overlap, so a batch can't contain the
+    // same pixel twice.
+    const bool batchOutputs = pixelWriter.pWriteBlock != nullptr;
+    unsigned   numBatched   = 0;
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) uint16_t batchX[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) uint16_t batchY[SL_SHADER_FRAG_BLOCK_SIZE];
+    alignas(sizeof(float)*SL_SHADER_FRAG_BLOCK_SIZE) float    batchRgba[4][SL_SHADER_FRAG_BLOCK_SIZE];
+
+    interpolator.perspective_correct(bin.mScreenCoords, numQueuedFrags, outCoords);
 
     for (uint_fast32_t i = 0; i < numQueuedFrags; ++i)
     {
-        interpolate_tri_varyings(&outCoords->bc[i], numVaryings, bin.mVaryings, fragParams.pVaryings);
+        interpolator.interpolate(reinterpret_cast<const float*>(outCoords->bc + i), numVaryings, bin.mVaryings, fragParams.pVaryings);
+
+        fragParams.coord = outCoords->coord[i];
+
+        if (haveDerivs)
+        {
+            // Fragments are queued in scanline order, so neighbors within
+            // the same quad can reuse its derivatives.
+            const uint32_t quad = ((uint32_t)(fragParams.coord.y >> 1) << 16) | (uint32_t)(fragParams.coord.x >> 1);
+
+            if (quad != prevQuad)
+            {
+                math::vec4 bcDx, bcDy;
+                _sl_tri_quad_derivatives(bin.mBarycentricCoords, homogenous, fragParams.coord, bcDx, bcDy);
+
+                interpolator.interpolate(reinterpret_cast<const float*>(&bcDx), numVaryings, bin.mVaryings, fragParams.pDdx);
+                interpolator.interpolate(reinterpret_cast<const float*>(&bcDy), numVaryings, bin.mVaryings, fragParams.pDdy);
+                prevQuad = quad;
+            }
+        }
+
+        const bool haveOutputs = fragShader(fragParams);
+
+        if (LS_LIKELY(haveOutputs))
+        {
+            if (batchOutputs)
+            {
+                batchX[numBatched] = fragParams.coord.x;
+                batchY[numBatched] = fragParams.coord.y;
+
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    batchRgba[c][numBatched] = fragParams.pOutputs[0][c];
+                }
+
+                if (++numBatched == SL_SHADER_FRAG_BLOCK_SIZE)
+                {
+                    pixelWriter.pWriteBlock(pixelWriter, batchX, batchY, batchRgba, (1u << SL_SHADER_FRAG_BLOCK_SIZE) - 1u);
+                    numBatched = 0;
+                }
+            }
+            else
+            {
+                sl_write_pixel(pixelWriter, fragParams);
+            }
+
+            if (LS_LIKELY(haveDepthMask))
+            {
+                ((depth_type*)pDepthBuf.pTexels)[sl_fbo_index(pDepthBuf, fragParams.coord.x, fragParams.coord.y)] = (depth_type)fragParams.coord.depth;
+
+                if (haveBounds)
+                {
+                    depthBounds.mark_dirty(fragParams.coord.x, fragParams.coord.y);
+                }
+            }
+        }
+    }
+
+    if (numBatched)
+    {
+        pixelWriter.pWriteBlock(pixelWriter, batchX, batchY, batchRgba, (1u << numBatched) - 1u);
+    }
+}
+
+
+
+#if SL_AVX2_DISPATCH_ENABLED
+/*--------------------------------------
+ * Shade triangle fragments using AVX2. Requires a CPU with
+ * SL_CPU_FEATURE_AVX2.
+--------------------------------------*/
+template <typename depth_type>
+SL_TARGET_AVX2 void _sl_shade_tri_fragments_avx2(
+    const SL_FragmentProcessor& fragProcessor,
+    const SL_FragmentBin&       bin,
+    uint_fast32_t               numQueuedFrags,
+    SL_FragCoord* const         outCoords) noexcept
+{
+    _sl_shade_tri_fragments<depth_type, SL_TriInterpolatorAVX2>(fragProcessor, bin, numQueuedFrags, outCoords);
+}
+#endif
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_FragmentProcessor Class
+-----------------------------------------------------------------------------*/
+/*--------------------------------------
+ * Bin-Rasterization
+--------------------------------------*/
+template <typename depth_type>
+void SL_FragmentProcessor::flush_line_fragments(
+    const SL_FragmentBin& bin,
+    uint_fast32_t         numQueuedFrags,
+    SL_FragCoord* const   outCoords) const noexcept
+{
+    const SL_PipelineState  pipeline      = mShader->pipelineState;
+    const uint32_t          numVaryings   = (unsigned)pipeline.num_varyings();
+    const uint32_t          numOutputs    = (unsigned)pipeline.num_render_targets();
+    const int_fast32_t      haveDepthMask = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
+    const SL_UniformBuffer* pUniforms     = mShader->pUniforms;
+    const auto              fragShader    = mShader->pFragShader;
+    SL_TextureView&         pDepthBuf     = mFbo->get_depth_buffer();
+    SL_DepthHierarchy&      depthBounds   = mFbo->depth_hierarchy();
+    const bool              haveBounds    = haveDepthMask && depthBounds.valid();
+
+    SL_FragmentParam fragParams;
+    fragParams.pUniforms = pUniforms;
+
+    uint_fast32_t i;
+
+    for (i = 0; i < numQueuedFrags; ++i)
+    {
+        const float interp   = outCoords->lineInterp[i][0];
+        const float coverage = outCoords->lineInterp[i][1];
+
+        interpolate_line_varyings(interp, numVaryings, bin.mVaryings, fragParams.pVaryings);
 
         fragParams.coord = outCoords->coord[i];
 
@@ -484,11 +877,25 @@ void SL_FragmentProcessor::flush_tri_fragments(
 
         if (LS_LIKELY(haveOutputs))
         {
-            mFbo->put_pixel(fboOutMask, blendMode, fragParams);
+            // Partially-covered pixels of anti-aliased lines fade out
+            if (LS_UNLIKELY(coverage < 1.f))
+            {
+                for (uint32_t t = numOutputs; t--;)
+                {
+                    fragParams.pOutputs[t][3] *= coverage;
+                }
+            }
+
+            sl_write_pixel(mPixelWriter, fragParams);
 
             if (LS_LIKELY(haveDepthMask))
             {
-                ((depth_type*)pDepthBuf.pTexels)[fragParams.coord.x + pDepthBuf.width * fragParams.coord.y] = (depth_type)fragParams.coord.depth;
+                ((depth_type*)pDepthBuf.pTexels)[sl_fbo_index(pDepthBuf, fragParams.coord.x, fragParams.coord.y)] = (depth_type)fragParams.coord.depth;
+
+                if (haveBounds)
+                {
+                    depthBounds.mark_dirty(fragParams.coord.x, fragParams.coord.y);
+                }
             }
         }
     }
@@ -496,6 +903,34 @@ void SL_FragmentProcessor::flush_tri_fragments(
 
 
 
+template void SL_FragmentProcessor::flush_line_fragments<ls::math::half>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
+template void SL_FragmentProcessor::flush_line_fragments<float>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
+template void SL_FragmentProcessor::flush_line_fragments<double>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
+
+
+
+/*--------------------------------------
+ * Bin-Rasterization
+--------------------------------------*/
+template <typename depth_type>
+void SL_FragmentProcessor::flush_tri_fragments(
+    const SL_FragmentBin& bin,
+    uint_fast32_t         numQueuedFrags,
+    SL_FragCoord* const   outCoords) const noexcept
+{
+    #if SL_AVX2_DISPATCH_ENABLED
+        if (sl_cpu_features() & SL_CPU_FEATURE_AVX2)
+        {
+            _sl_shade_tri_fragments_avx2<depth_type>(*this, bin, numQueuedFrags, outCoords);
+            return;
+        }
+    #endif
+
+    _sl_shade_tri_fragments<depth_type, SL_TriInterpolator>(*this, bin, numQueuedFrags, outCoords);
+}
+
+
+
 template void SL_FragmentProcessor::flush_tri_fragments<ls::math::half>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
 template void SL_FragmentProcessor::flush_tri_fragments<float>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
 template void SL_FragmentProcessor::flush_tri_fragments<double>(const SL_FragmentBin&, uint_fast32_t, SL_FragCoord* const) const noexcept;
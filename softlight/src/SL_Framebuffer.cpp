@@ -1,3 +1,4 @@
+#include <utility> // std::move()
 
 #include "lightsky/setup/Compiler.h" // LS_COMPILER_MSC
 
@@ -5,6 +6,7 @@
 
 #include "softlight/SL_Color.hpp"
 #include "softlight/SL_ColorCompressed.hpp"
+#include "softlight/SL_CpuFeatures.hpp" // sl_cpu_features()
 
 #include "softlight/SL_Framebuffer.hpp"
 #include "softlight/SL_PipelineState.hpp" // SL_BlendMode
@@ -29,7 +31,7 @@ template <typename color_type>
 inline LS_INLINE color_type* _sl_fbo_view_pointer(SL_TextureView& view, uint16_t x, uint16_t y) noexcept
 {
     color_type* pData = reinterpret_cast<color_type*>(view.pTexels);
-    return (color_type*)&pData[x + view.width * y];
+    return (color_type*)&pData[sl_fbo_index(view, x, y)];
 }
 
 
@@ -585,6 +587,287 @@ inline void assign_alpha_pixel<SL_ColorRGB1010102>(
 
 
 
+/*-------------------------------------
+ * Write to a single attachment with a known format and blend mode
+-------------------------------------*/
+template <typename color_type, SL_BlendMode blendMode>
+void _sl_write_attachment(SL_TextureView& view, uint16_t x, uint16_t y, const math::vec4& rgba) noexcept
+{
+    if (blendMode == SL_BLEND_OFF)
+    {
+        assign_pixel<color_type>(x, y, rgba, view);
+    }
+    else
+    {
+        assign_alpha_pixel<color_type>(x, y, rgba, view, blendMode);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Pixel writers
+-------------------------------------*/
+void _sl_write_none(const SL_PixelWriter&, const SL_FragmentParam&) noexcept
+{
+}
+
+
+
+template <typename color_type, SL_BlendMode blendMode>
+void _sl_write_single(const SL_PixelWriter& writer, const SL_FragmentParam& fragParam) noexcept
+{
+    _sl_write_attachment<color_type, blendMode>(*writer.pTargets[0], fragParam.coord.x, fragParam.coord.y, fragParam.pOutputs[0]);
+}
+
+
+
+template <unsigned numOutputs>
+void _sl_write_multiple(const SL_PixelWriter& writer, const SL_FragmentParam& fragParam) noexcept
+{
+    for (unsigned t = 0; t < numOutputs; ++t)
+    {
+        writer.pWriters[t](*writer.pTargets[t], fragParam.coord.x, fragParam.coord.y, fragParam.pOutputs[t]);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Blend a block of fragments into an RGBA8 attachment.
+ *
+ * Each loop runs across every lane of the block so the compiler can
+ * vectorize it. Destination texels are unpacked and repacked using integer
+ * operations.
+-------------------------------------*/
+template <SL_BlendMode blendMode>
+inline LS_INLINE void _sl_blend_block_rgba8(
+    const SL_PixelWriter& writer,
+    const uint16_t* pX,
+    const uint16_t* pY,
+    const float (*pRgba)[SL_SHADER_FRAG_BLOCK_SIZE],
+    uint32_t outMask) noexcept
+{
+    constexpr unsigned numLanes = SL_SHADER_FRAG_BLOCK_SIZE;
+    constexpr float    toFloat  = 0.00392156862745f;
+
+    SL_TextureView& view    = *writer.pTargets[0];
+    uint32_t* const pTexels = reinterpret_cast<uint32_t*>(view.pTexels);
+    uint32_t        texels[numLanes];
+    float           d[4][numLanes];
+
+    if (blendMode != SL_BLEND_OFF)
+    {
+        // Coordinates of inactive lanes may be outside of the framebuffer
+        for (unsigned n = 0; n < numLanes; ++n)
+        {
+            texels[n] = (outMask & (1u << n)) ? pTexels[sl_fbo_index(view, pX[n], pY[n])] : 0u;
+        }
+
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = (float)((texels[n] >> (c * 8u)) & 0xFFu) * toFloat;
+            }
+        }
+    }
+
+    // Blending matches assign_alpha_pixel(), using premultiplied alpha.
+    const float* const srcAlpha = pRgba[3];
+
+    if (blendMode == SL_BLEND_OFF)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = pRgba[c][n];
+            }
+        }
+    }
+    else if (blendMode == SL_BLEND_ALPHA)
+    {
+        float dstMod[numLanes];
+        float alphaInv[numLanes];
+
+        for (unsigned n = 0; n < numLanes; ++n)
+        {
+            dstMod[n]   = (1.f - srcAlpha[n]) * d[3][n];
+            d[3][n]     = dstMod[n] + srcAlpha[n];
+            alphaInv[n] = (d[3][n] > 0.f) ? math::rcp(d[3][n]) : 0.f;
+        }
+
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = (pRgba[c][n] * srcAlpha[n] + d[c][n] * dstMod[n]) * alphaInv[n];
+            }
+        }
+    }
+    else if (blendMode == SL_BLEND_PREMULTIPLED_ALPHA)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = d[c][n] * (1.f - srcAlpha[n]) + pRgba[c][n];
+            }
+        }
+    }
+    else if (blendMode == SL_BLEND_ADDITIVE)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = pRgba[c][n] * srcAlpha[n] + d[c][n];
+            }
+        }
+    }
+    else if (blendMode == SL_BLEND_SCREEN)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned n = 0; n < numLanes; ++n)
+            {
+                d[c][n] = pRgba[c][n] * srcAlpha[n] + d[c][n] * (1.f - srcAlpha[n]);
+            }
+        }
+    }
+
+    // Saturating keeps the conversion well-defined for inactive lanes.
+    for (unsigned n = 0; n < numLanes; ++n)
+    {
+        texels[n] = 0u;
+    }
+
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        for (unsigned n = 0; n < numLanes; ++n)
+        {
+            texels[n] |= (uint32_t)(math::clamp(d[c][n], 0.f, 1.f) * 255.f) << (c * 8u);
+        }
+    }
+
+    for (unsigned n = 0; n < numLanes; ++n)
+    {
+        if (outMask & (1u << n))
+        {
+            pTexels[sl_fbo_index(view, pX[n], pY[n])] = texels[n];
+        }
+    }
+}
+
+
+
+template <SL_BlendMode blendMode>
+void _sl_write_block_rgba8(
+    const SL_PixelWriter& writer,
+    const uint16_t* pX,
+    const uint16_t* pY,
+    const float (*pRgba)[SL_SHADER_FRAG_BLOCK_SIZE],
+    uint32_t outMask) noexcept
+{
+    _sl_blend_block_rgba8<blendMode>(writer, pX, pY, pRgba, outMask);
+}
+
+
+
+#if SL_AVX2_DISPATCH_ENABLED
+template <SL_BlendMode blendMode>
+SL_TARGET_AVX2 void _sl_write_block_rgba8_avx2(
+    const SL_PixelWriter& writer,
+    const uint16_t* pX,
+    const uint16_t* pY,
+    const float (*pRgba)[SL_SHADER_FRAG_BLOCK_SIZE],
+    uint32_t outMask) noexcept
+{
+    _sl_blend_block_rgba8<blendMode>(writer, pX, pY, pRgba, outMask);
+}
+#endif
+
+
+
+/*-------------------------------------
+ * Select a block writer for a blend mode
+-------------------------------------*/
+template <SL_BlendMode blendMode>
+inline SL_BlockWriterFunc _sl_block_writer_rgba8() noexcept
+{
+    #if SL_AVX2_DISPATCH_ENABLED
+        if (sl_cpu_features() & SL_CPU_FEATURE_AVX2)
+        {
+            return &_sl_write_block_rgba8_avx2<blendMode>;
+        }
+    #endif
+
+    return &_sl_write_block_rgba8<blendMode>;
+}
+
+
+
+/*-------------------------------------
+ * Select the writers for a color format
+-------------------------------------*/
+template <typename color_type, SL_BlendMode blendMode>
+inline void _sl_set_writers(SL_AttachmentWriterFunc& outAttachWriter, SL_PixelWriterFunc& outPixelWriter) noexcept
+{
+    outAttachWriter = &_sl_write_attachment<color_type, blendMode>;
+    outPixelWriter  = &_sl_write_single<color_type, blendMode>;
+}
+
+
+
+template <SL_BlendMode blendMode>
+void _sl_select_writers(SL_ColorDataType type, SL_AttachmentWriterFunc& outAttachWriter, SL_PixelWriterFunc& outPixelWriter) noexcept
+{
+    switch (type)
+    {
+        case SL_COLOR_R_8U:        _sl_set_writers<SL_ColorR8, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_8U:       _sl_set_writers<SL_ColorRG8, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_8U:      _sl_set_writers<SL_ColorRGB8, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_8U:     _sl_set_writers<SL_ColorRGBA8, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_COLOR_R_16U:       _sl_set_writers<SL_ColorR16, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_16U:      _sl_set_writers<SL_ColorRG16, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_16U:     _sl_set_writers<SL_ColorRGB16, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_16U:    _sl_set_writers<SL_ColorRGBA16, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_COLOR_R_32U:       _sl_set_writers<SL_ColorR32, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_32U:      _sl_set_writers<SL_ColorRG32, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_32U:     _sl_set_writers<SL_ColorRGB32, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_32U:    _sl_set_writers<SL_ColorRGBA32, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_COLOR_R_64U:       _sl_set_writers<SL_ColorR64, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_64U:      _sl_set_writers<SL_ColorRG64, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_64U:     _sl_set_writers<SL_ColorRGB64, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_64U:    _sl_set_writers<SL_ColorRGBA64, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_COLOR_R_FLOAT:     _sl_set_writers<SL_ColorRf, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_FLOAT:    _sl_set_writers<SL_ColorRGf, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_FLOAT:   _sl_set_writers<SL_ColorRGBf, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_FLOAT:  _sl_set_writers<SL_ColorRGBAf, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_COLOR_R_DOUBLE:    _sl_set_writers<SL_ColorRd, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RG_DOUBLE:   _sl_set_writers<SL_ColorRGd, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGB_DOUBLE:  _sl_set_writers<SL_ColorRGBd, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_COLOR_RGBA_DOUBLE: _sl_set_writers<SL_ColorRGBAd, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        case SL_ColorDataType::SL_COLOR_RGB_332:      _sl_set_writers<SL_ColorRGB332, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_ColorDataType::SL_COLOR_RGB_565:      _sl_set_writers<SL_ColorRGB565, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_ColorDataType::SL_COLOR_RGBA_5551:    _sl_set_writers<SL_ColorRGB5551, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_ColorDataType::SL_COLOR_RGBA_4444:    _sl_set_writers<SL_ColorRGB4444, blendMode>(outAttachWriter, outPixelWriter); break;
+        case SL_ColorDataType::SL_COLOR_RGBA_1010102: _sl_set_writers<SL_ColorRGB1010102, blendMode>(outAttachWriter, outPixelWriter); break;
+
+        default:
+            LS_UNREACHABLE();
+    }
+}
+
+
+
 } // end anonymous namespace
 
 
@@ -608,7 +891,8 @@ SL_Framebuffer::~SL_Framebuffer() noexcept
 SL_Framebuffer::SL_Framebuffer() noexcept :
     mNumColors{0},
     mColors{},
-    mDepth{}
+    mDepth{},
+    mDepthHierarchy{}
 {
     terminate();
 }
@@ -628,6 +912,7 @@ SL_Framebuffer::SL_Framebuffer(const SL_Framebuffer& f) noexcept
     }
 
     mDepth = f.mDepth;
+    mDepthHierarchy = f.mDepthHierarchy;
 }
 
 
@@ -648,6 +933,8 @@ SL_Framebuffer::SL_Framebuffer(SL_Framebuffer&& f) noexcept
 
     mDepth = f.mDepth;
     sl_reset(f.mDepth);
+
+    mDepthHierarchy = std::move(f.mDepthHierarchy);
 }
 
 
@@ -675,6 +962,7 @@ SL_Framebuffer& SL_Framebuffer::operator=(const SL_Framebuffer& f) noexcept
     }
 
     mDepth = f.mDepth;
+    mDepthHierarchy = f.mDepthHierarchy;
 
     return *this;
 }
@@ -708,6 +996,8 @@ SL_Framebuffer& SL_Framebuffer::operator=(SL_Framebuffer&& f) noexcept
     mDepth = f.mDepth;
     sl_reset(f.mDepth);
 
+    mDepthHierarchy = std::move(f.mDepthHierarchy);
+
     return *this;
 }
 
@@ -804,6 +1094,11 @@ void SL_Framebuffer::clear_color_buffers() noexcept
 int SL_Framebuffer::attach_depth_buffer(SL_TextureView& d) noexcept
 {
     mDepth = d;
+
+    #if SL_HIZ_ENABLED
+        mDepthHierarchy.init(d.width, d.height);
+    #endif
+
     return 0;
 }
 
@@ -815,6 +1110,7 @@ int SL_Framebuffer::attach_depth_buffer(SL_TextureView& d) noexcept
 int SL_Framebuffer::detach_depth_buffer() noexcept
 {
     sl_reset(mDepth);
+    mDepthHierarchy.terminate();
     return 0;
 }
 
@@ -882,6 +1178,13 @@ int SL_Framebuffer::valid() const noexcept
         return -10;
     }
 
+    #if SL_FBO_TILED_ENABLED
+        if ((width & (SL_TEXELS_PER_CHUNK-1u)) || (height & (SL_TEXELS_PER_CHUNK-1u)))
+        {
+            return -11;
+        }
+    #endif
+
     return 0;
 }
 
@@ -898,6 +1201,7 @@ void SL_Framebuffer::terminate() noexcept
     }
 
     sl_reset(mDepth);
+    mDepthHierarchy.terminate();
 }
 
 
@@ -984,6 +1288,74 @@ void SL_Framebuffer::put_pixel(SL_FboOutputMask outMask, SL_BlendMode blendMode,
 
 
 
+/*-------------------------------------
+ * Resolve a specialized pixel writer for the current attachments
+-------------------------------------*/
+SL_PixelWriter SL_Framebuffer::pixel_writer(SL_FboOutputMask outMask, SL_BlendMode blendMode) noexcept
+{
+    const unsigned numOutputs = (outMask > SL_FBO_OUTPUT_ATTACHMENT_0_1_2_3)
+        ? ((unsigned)outMask - (unsigned)SL_FBO_OUTPUT_ATTACHMENT_0_1_2_3)
+        : (unsigned)outMask;
+
+    SL_PixelWriter writer;
+    writer.pWrite      = &_sl_write_none;
+    writer.pWriteBlock = nullptr;
+
+    SL_PixelWriterFunc singleWriter = &_sl_write_none;
+
+    for (unsigned t = 0; t < (unsigned)SL_FboLimits::SL_FBO_MAX_COLOR_ATTACHMENTS; ++t)
+    {
+        writer.pTargets[t] = &mColors[t];
+        writer.pWriters[t] = nullptr;
+
+        if (t >= numOutputs)
+        {
+            continue;
+        }
+
+        const SL_ColorDataType type = mColors[t].type;
+
+        switch (blendMode)
+        {
+            case SL_BLEND_ALPHA:              _sl_select_writers<SL_BLEND_ALPHA>(type, writer.pWriters[t], singleWriter); break;
+            case SL_BLEND_PREMULTIPLED_ALPHA: _sl_select_writers<SL_BLEND_PREMULTIPLED_ALPHA>(type, writer.pWriters[t], singleWriter); break;
+            case SL_BLEND_ADDITIVE:           _sl_select_writers<SL_BLEND_ADDITIVE>(type, writer.pWriters[t], singleWriter); break;
+            case SL_BLEND_SCREEN:             _sl_select_writers<SL_BLEND_SCREEN>(type, writer.pWriters[t], singleWriter); break;
+            default:                          _sl_select_writers<SL_BLEND_OFF>(type, writer.pWriters[t], singleWriter); break;
+        }
+    }
+
+    switch (numOutputs)
+    {
+        case 1:
+            writer.pWrite = singleWriter;
+
+            if (mColors[0].type == SL_COLOR_RGBA_8U)
+            {
+                switch (blendMode)
+                {
+                    case SL_BLEND_ALPHA:              writer.pWriteBlock = _sl_block_writer_rgba8<SL_BLEND_ALPHA>(); break;
+                    case SL_BLEND_PREMULTIPLED_ALPHA: writer.pWriteBlock = _sl_block_writer_rgba8<SL_BLEND_PREMULTIPLED_ALPHA>(); break;
+                    case SL_BLEND_ADDITIVE:           writer.pWriteBlock = _sl_block_writer_rgba8<SL_BLEND_ADDITIVE>(); break;
+                    case SL_BLEND_SCREEN:             writer.pWriteBlock = _sl_block_writer_rgba8<SL_BLEND_SCREEN>(); break;
+                    default:                          writer.pWriteBlock = _sl_block_writer_rgba8<SL_BLEND_OFF>(); break;
+                }
+            }
+            break;
+
+        case 2: writer.pWrite = &_sl_write_multiple<2>; break;
+        case 3: writer.pWrite = &_sl_write_multiple<3>; break;
+        case 4: writer.pWrite = &_sl_write_multiple<4>; break;
+
+        default:
+            break;
+    }
+
+    return writer;
+}
+
+
+
 /*-------------------------------------
  * Place a pixel onto a texture with alpha blending
 -------------------------------------*/
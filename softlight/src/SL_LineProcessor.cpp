@@ -227,15 +227,20 @@ void SL_LineProcessor::push_bin(size_t primIndex, const math::vec4& viewportDims
     SL_BinCounterAtomic<uint32_t>* const pLocks = mBinsUsed;
     SL_FragmentBin* const pFragBins = mFragBins;
     const uint_fast32_t numVaryings = (uint_fast32_t)mShader->pipelineState.num_varyings();
+    const SL_ViewportState& viewState = mContext->viewport_state();
+    const float lineWidth = viewState.line_width();
+    const float lineSmooth = viewState.line_smoothing() ? 1.f : 0.f;
 
     const math::vec4& p0 = a.vert;
     const math::vec4& p1 = b.vert;
 
-    // establish a bounding box to detect overlap with a thread's tiles
-    const float bboxMinX = math::min(p0[0], p1[0]);
-    const float bboxMinY = math::min(p0[1], p1[1]);
-    const float bboxMaxX = math::max(p0[0], p1[0]);
-    const float bboxMaxY = math::max(p0[1], p1[1]);
+    // establish a bounding box to detect overlap with a thread's tiles. Wide
+    // and anti-aliased lines can reach up to a pixel past their half-width.
+    const float extent   = lineWidth * 0.5f + lineSmooth;
+    const float bboxMinX = math::min(p0[0], p1[0]) - extent;
+    const float bboxMinY = math::min(p0[1], p1[1]) - extent;
+    const float bboxMaxX = math::max(p0[0], p1[0]) + extent;
+    const float bboxMaxY = math::max(p0[1], p1[1]) + extent;
 
     const float fboW = viewportDims[0]+viewportDims[2];
     const float fboH = viewportDims[1]+viewportDims[3];
@@ -259,6 +264,7 @@ void SL_LineProcessor::push_bin(size_t primIndex, const math::vec4& viewportDims
     SL_FragmentBin& bin = pFragBins[binId];
     bin.mScreenCoords[0] = p0;
     bin.mScreenCoords[1] = p1;
+    bin.mScreenCoords[2] = math::vec4{lineWidth, lineSmooth, 0.f, 0.f};
 
     for (unsigned i = 0; i < numVaryings; ++i)
     {
@@ -421,72 +427,65 @@ void SL_LineProcessor::process_verts(
     params.pVao       = &vao;
     params.pVbo       = &mContext->vbo(vao.get_vertex_buffer());
 
-    #if SL_VERTEX_CACHING_ENABLED
-        size_t begin;
-        size_t end;
-        constexpr size_t step = 2;
-
-        sl_calc_indexed_parition<2>(m.elementEnd-m.elementBegin, mNumThreads, mThreadId, begin, end);
-        begin += m.elementBegin;
-        end += m.elementBegin;
+    size_t begin;
+    size_t end;
 
+    #if SL_VERTEX_CACHING_ENABLED
         SL_PTVCache ptvCache{};
         const auto&& vertTransform = [&](size_t key, SL_TransformedVert& tv)->void {
             params.vertId = key;
             params.pVaryings = tv.varyings;
             tv.vert = scissorMat * vertShader(params);
         };
-
-    #else
-        const size_t begin = m.elementBegin + mThreadId * 2u;
-        const size_t end   = m.elementEnd;
-        const size_t step  = mNumThreads * 2u;
     #endif
 
-    for (size_t i = begin; i < end; i += step)
+    while (next_chunk(m.elementBegin, m.elementEnd, 2, begin, end))
     {
-        const size_t index0 = i;
-        const size_t index1 = i + 1;
+        for (size_t i = begin; i < end; i += 2)
+        {
+            const size_t index0 = i;
+            const size_t index1 = i + 1;
 
-        #if SL_VERTEX_CACHING_ENABLED
-            const size_t vertId0 = usingIndices ? pIbo->index(index0) : index0;
-            const size_t vertId1 = usingIndices ? pIbo->index(index1) : index1;
+            #if SL_VERTEX_CACHING_ENABLED
+                const size_t vertId0 = usingIndices ? pIbo->index(index0) : index0;
+                const size_t vertId1 = usingIndices ? pIbo->index(index1) : index1;
 
-            sl_cache_query_or_update(ptvCache, vertId0, pVert0, vertTransform);
-            sl_cache_query_or_update(ptvCache, vertId1, pVert1, vertTransform);
+                sl_cache_query_or_update(ptvCache, vertId0, pVert0, vertTransform);
+                sl_cache_query_or_update(ptvCache, vertId1, pVert1, vertTransform);
 
-        #else
-            params.vertId    = usingIndices ? pIbo->index(index0) : index0;
-            params.pVaryings = pVert0.varyings;
-            pVert0.vert = scissorMat * vertShader(params);
+            #else
+                params.vertId    = usingIndices ? pIbo->index(index0) : index0;
+                params.pVaryings = pVert0.varyings;
+                pVert0.vert = scissorMat * vertShader(params);
 
-            params.vertId = usingIndices ? pIbo->index(index1) : index1;
-            params.pVaryings = pVert1.varyings;
-            pVert1.vert = scissorMat * vertShader(params);
-        #endif
+                params.vertId = usingIndices ? pIbo->index(index1) : index1;
+                params.pVaryings = pVert1.varyings;
+                pVert1.vert = scissorMat * vertShader(params);
+            #endif
 
-        // Clip-space culling
-        if (pVert0.vert[3] < 0.f || pVert1.vert[3] < 0.f)
-        {
-            continue;
-        }
+            // Clip-space culling
+            if (pVert0.vert[3] < 0.f || pVert1.vert[3] < 0.f)
+            {
+                continue;
+            }
 
-        const SL_ClipStatus visStatus = line_visible(pVert0.vert, pVert1.vert);
-        if (visStatus == SL_CLIP_STATUS_NOT_VISIBLE)
-        {
-            continue;
-        }
+            const SL_ClipStatus visStatus = line_visible(pVert0.vert, pVert1.vert);
+            if (visStatus == SL_CLIP_STATUS_NOT_VISIBLE)
+            {
+                continue;
+            }
 
-        sl_perspective_divide2(pVert0.vert, pVert1.vert);
-        sl_world_to_screen_coords_divided2(pVert0.vert, pVert1.vert, viewportDims);
+            sl_perspective_divide2(pVert0.vert, pVert1.vert);
+            sl_world_to_screen_coords_divided2(pVert0.vert, pVert1.vert, viewportDims);
 
-        if (visStatus == SL_CLIP_STATUS_FULLY_VISIBLE)
-        {
-            push_bin(i, viewportDims, pVert0, pVert1);
-        }
-        else if (visStatus == SL_CLIP_STATUS_PARTIALLY_VISIBLE)
-        {
-            clip_and_process_lines(i*instanceId+i, viewportDims, pVert0, pVert1);
+            if (visStatus == SL_CLIP_STATUS_FULLY_VISIBLE)
+            {
+                push_bin(i, viewportDims, pVert0, pVert1);
+            }
+            else if (visStatus == SL_CLIP_STATUS_PARTIALLY_VISIBLE)
+            {
+                clip_and_process_lines(i*instanceId+i, viewportDims, pVert0, pVert1);
+            }
         }
     }
 }
@@ -498,7 +497,7 @@ void SL_LineProcessor::process_verts(
 --------------------------------------*/
 void SL_LineProcessor::execute() noexcept
 {
-    mAmDone = 0;
+    this->begin_draw();
 
     const math::vec4&&      fboDims      = (math::vec4)math::vec4_t<int>{0, 0, mFbo->width(), mFbo->height()};
     const SL_ViewportState& viewState    = mContext->viewport_state();
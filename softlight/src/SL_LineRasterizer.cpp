@@ -1,10 +1,12 @@
+#include <cmath> // std::ceil
 
 #include "lightsky/math/half.h"
 #include "lightsky/math/vec_utils.h"
 
-#include "softlight/SL_Geometry.hpp" // sl_draw_line_bresenham
+#include "softlight/SL_Geometry.hpp" // sl_draw_line_bresenham_rows
 #include "softlight/SL_LineRasterizer.hpp"
 #include "softlight/SL_Framebuffer.hpp" // SL_Framebuffer
+#include "softlight/SL_ScanlineBounds.hpp" // sl_scanline_offset()
 #include "softlight/SL_Shader.hpp" // SL_FragmentShader
 #include "softlight/SL_Texture.hpp"
 
@@ -18,9 +20,165 @@ namespace utils = ls::utils;
 
 
 
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Narrow a range of X offsets to those where "base + x*slope" lies within
+ * [lo, hi]. Returns false if the range becomes empty.
+-------------------------------------*/
+inline bool _sl_clip_line_slab(float base, float slope, float lo, float hi, float& xMin, float& xMax) noexcept
+{
+    if (math::abs(slope) < LS_EPSILON)
+    {
+        return base >= lo && base <= hi;
+    }
+
+    const float invSlope = math::rcp(slope);
+    const float x0 = (lo - base) * invSlope;
+    const float x1 = (hi - base) * invSlope;
+
+    xMin = math::max(xMin, math::min(x0, x1));
+    xMax = math::min(xMax, math::max(x0, x1));
+
+    return xMin <= xMax;
+}
+
+
+
+} // end anonymous namespace
+
+
+
 /*-----------------------------------------------------------------------------
  * SL_LineRasterizer Class
 -----------------------------------------------------------------------------*/
+/*--------------------------------------
+ * Enqueue fragments for wide or anti-aliased lines
+ *
+ * Lines are expanded into a rectangle around their screen-space segment.
+ * Each scanline owned by this thread is clipped against the rectangle's two
+ * slabs (across and along the line) to find the span of covered pixels.
+--------------------------------------*/
+template <class DepthCmpFunc, typename depth_type>
+void SL_LineRasterizer::render_wide_line(const SL_FragmentBin& bin, SL_Framebuffer* fbo) noexcept
+{
+    const math::vec4* coords    = bin.mScreenCoords;
+    const float       z0        = coords[0][2];
+    const float       z1        = coords[1][2];
+    const float       halfWidth = coords[2][0] * 0.5f;
+    const bool        smooth    = coords[2][1] != 0.f;
+
+    // Screen coordinates are whole pixels, so zero-length lines are drawn
+    // as squares rather than having no direction at all.
+    const float ax     = coords[0][0];
+    const float ay     = coords[0][1];
+    const float dx     = coords[1][0] - ax;
+    const float dy     = coords[1][1] - ay;
+    const float len    = math::length(math::vec2{dx, dy});
+    const bool  isDot  = len < 1.f;
+    const float invLen = isDot ? 0.f : math::rcp(len);
+    const float dirX   = isDot ? 1.f : (dx * invLen);
+    const float dirY   = isDot ? 0.f : (dy * invLen);
+    const float nrmX   = -dirY;
+    const float nrmY   = dirX;
+
+    // Anti-aliased lines also touch partially-covered pixels on each edge
+    const float fringe    = smooth ? 0.5f : 0.f;
+    const float capOffset = isDot ? halfWidth : 0.f;
+    const float extentW   = halfWidth + fringe;
+    const float extentL   = capOffset + fringe;
+    const float reach     = extentW + extentL;
+
+    const SL_TextureView& depthBuf = fbo->get_depth_buffer();
+    constexpr DepthCmpFunc depthCmp = {};
+
+    const int32_t fboW      = (int32_t)depthBuf.width;
+    const int32_t fboH      = (int32_t)depthBuf.height;
+    const int32_t increment = (int32_t)mNumProcessors;
+    const int32_t yMin      = math::max<int32_t>(0,    (int32_t)math::floor(math::min(ay, ay+dy) - reach));
+    const int32_t yMax      = math::min<int32_t>(fboH, (int32_t)std::ceil(math::max(ay, ay+dy) + reach) + 1);
+
+    SL_FragCoord* outCoords = mQueues;
+    uint32_t numQueuedFrags = 0;
+
+    for (int32_t y = yMin + sl_scanline_offset<int32_t>(increment, (int32_t)mThreadId, yMin); y < yMax; y += increment)
+    {
+        const float ry = (float)y - ay;
+        float spanMin = -ax;
+        float spanMax = (float)(fboW-1) - ax;
+
+        if (!_sl_clip_line_slab(ry*nrmY, nrmX, -extentW, extentW, spanMin, spanMax)
+        || !_sl_clip_line_slab(ry*dirY, dirX, -extentL, len+extentL, spanMin, spanMax))
+        {
+            continue;
+        }
+
+        const int32_t xMin = math::max<int32_t>(0,      (int32_t)std::ceil(spanMin + ax));
+        const int32_t xMax = math::min<int32_t>(fboW-1, (int32_t)math::floor(spanMax + ax));
+
+        for (int32_t x = xMin; x <= xMax; ++x)
+        {
+            const float rx       = (float)x - ax;
+            const float across   = math::fmadd(rx, nrmX, ry*nrmY);
+            const float along    = math::fmadd(rx, dirX, ry*dirY);
+            float       coverage = 1.f;
+
+            if (smooth)
+            {
+                const float edgeCoverage = math::clamp(halfWidth + 0.5f - math::abs(across), 0.f, 1.f);
+                const float capCoverage  = math::clamp(math::min(along, len-along) + capOffset + 0.5f, 0.f, 1.f);
+
+                coverage = math::min(edgeCoverage, capCoverage);
+                if (coverage <= 0.f)
+                {
+                    continue;
+                }
+            }
+            else if (across >= halfWidth)
+            {
+                // even widths would otherwise gain an extra pixel
+                continue;
+            }
+
+            const float interp = math::clamp(along * invLen, 0.f, 1.f);
+            const float z      = math::mix(z0, z1, interp);
+
+            const depth_type d = ((depth_type*)depthBuf.pTexels)[sl_fbo_index(depthBuf, x, y)];
+            if (!depthCmp(z, (float)d))
+            {
+                continue;
+            }
+
+            outCoords->lineInterp[numQueuedFrags]  = math::vec2{interp, coverage};
+            outCoords->coord[numQueuedFrags].x     = (uint16_t)x;
+            outCoords->coord[numQueuedFrags].y     = (uint16_t)y;
+            outCoords->coord[numQueuedFrags].depth = z;
+
+            ++numQueuedFrags;
+
+            if (LS_UNLIKELY(numQueuedFrags == SL_SHADER_MAX_QUEUED_FRAGS))
+            {
+                numQueuedFrags = 0;
+                flush_line_fragments<depth_type>(bin, SL_SHADER_MAX_QUEUED_FRAGS, outCoords);
+            }
+        }
+    }
+
+    // cleanup remaining fragments
+    if (LS_LIKELY(numQueuedFrags > 0))
+    {
+        flush_line_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+    }
+}
+
+
+
 /*--------------------------------------
  * Enqueue line fragments for shading
 --------------------------------------*/
@@ -28,6 +186,14 @@ template <class DepthCmpFunc, typename depth_type>
 void SL_LineRasterizer::render_line(const SL_FragmentBin& bin, SL_Framebuffer* fbo) noexcept
 {
     const ls::math::vec4* coords     = bin.mScreenCoords;
+
+    // Only thin, aliased lines can use Bresenham's algorithm
+    if (LS_UNLIKELY(coords[2][0] > 1.f || coords[2][1] != 0.f))
+    {
+        render_wide_line<DepthCmpFunc, depth_type>(bin, fbo);
+        return;
+    }
+
     const math::vec4&  screenCoord0  = coords[0];
     const math::vec4&  screenCoord1  = coords[1];
     const float        z0            = screenCoord0[2];
@@ -44,30 +210,28 @@ void SL_LineRasterizer::render_line(const SL_FragmentBin& bin, SL_Framebuffer* f
     SL_FragCoord* outCoords = mQueues;
     uint32_t numQueuedFrags = 0;
 
-    sl_draw_line_bresenham(
+    // Each thread only visits the scanlines it owns
+    sl_draw_line_bresenham_rows(
         (uint16_t)clipCoords[0][0],
         (uint16_t)clipCoords[0][1],
         (uint16_t)clipCoords[1][0],
         (uint16_t)clipCoords[1][1],
+        (sl_highp_t)mThreadId,
+        (sl_highp_t)mNumProcessors,
         [&](uint16_t x, uint16_t y) noexcept->void
         {
-            if ((LS_LIKELY(y % mNumProcessors) != mThreadId))
-            {
-                return;
-            }
-
             const math::vec4&& p = (math::vec4)math::vec4_t<uint16_t>{x, y, 0, 0};
             const float currLen  = math::length(p - p0);
             const float interp   = currLen * dist;
             const float z        = math::mix(z0, z1, interp);
 
-            const depth_type d = ((depth_type*)depthBuf.pTexels)[x + depthBuf.width * y];
+            const depth_type d = ((depth_type*)depthBuf.pTexels)[sl_fbo_index(depthBuf, x, y)];
             if (!depthCmp(z, (float)d))
             {
                 return;
             }
 
-            outCoords->lineInterp[numQueuedFrags]  = interp;
+            outCoords->lineInterp[numQueuedFrags]  = math::vec2{interp, 1.f};
             outCoords->coord[numQueuedFrags].x     = x;
             outCoords->coord[numQueuedFrags].y     = y;
             outCoords->coord[numQueuedFrags].depth = z;
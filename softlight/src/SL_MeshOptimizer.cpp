@@ -0,0 +1,501 @@
+
+#include <algorithm> // std::stable_sort
+#include <cstring> // std::memcpy
+#include <utility> // std::pair
+
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_IndexBuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_MeshOptimizer.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Vertex-to-triangle adjacency. The triangles referencing vertex "v" are
+ * stored in triangles[offsets[v]] through triangles[offsets[v+1]-1].
+-------------------------------------*/
+struct SL_MeshAdjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+
+
+/*-------------------------------------
+ * Build the vertex-to-triangle adjacency of a mesh
+-------------------------------------*/
+void _sl_build_adjacency(const uint32_t* pIndices, size_t numIndices, size_t numVerts, SL_MeshAdjacency& adj) noexcept
+{
+    adj.offsets.assign(numVerts+1, 0);
+    adj.triangles.resize(numIndices);
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        ++adj.offsets[pIndices[i]+1];
+    }
+
+    for (size_t v = 1; v <= numVerts; ++v)
+    {
+        adj.offsets[v] += adj.offsets[v-1];
+    }
+
+    std::vector<uint32_t> fillPos{adj.offsets.begin(), adj.offsets.end()-1};
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        adj.triangles[fillPos[pIndices[i]]++] = (uint32_t)(i / 3u);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Find the next vertex with unprocessed triangles, first from the most
+ * recently used vertices, then in input order.
+-------------------------------------*/
+int_fast64_t _sl_skip_dead_end(
+    const std::vector<uint32_t>& liveTris,
+    std::vector<uint32_t>& deadEnds,
+    size_t& cursor,
+    size_t numVerts) noexcept
+{
+    while (!deadEnds.empty())
+    {
+        const uint32_t v = deadEnds.back();
+        deadEnds.pop_back();
+
+        if (liveTris[v])
+        {
+            return (int_fast64_t)v;
+        }
+    }
+
+    while (cursor < numVerts)
+    {
+        if (liveTris[cursor])
+        {
+            return (int_fast64_t)cursor;
+        }
+
+        ++cursor;
+    }
+
+    return -1;
+}
+
+
+
+/*-------------------------------------
+ * Read a vertex position
+-------------------------------------*/
+inline math::vec3 _sl_vertex_position(const char* pVertices, size_t vertStride, uint32_t v) noexcept
+{
+    math::vec3 pos;
+    std::memcpy(&pos, pVertices + v * vertStride, sizeof(math::vec3));
+    return pos;
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * Mesh Optimization
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Calculate the ACMR of an index buffer
+-------------------------------------*/
+float sl_calc_acmr(
+    const uint32_t* pIndices,
+    size_t numIndices,
+    size_t numVerts,
+    unsigned cacheSize) noexcept
+{
+    const size_t numTris = numIndices / 3u;
+    if (!numTris)
+    {
+        return 0.f;
+    }
+
+    // A vertex is in the FIFO cache if fewer than "cacheSize" vertices have
+    // been inserted since it was last inserted.
+    std::vector<uint32_t> timestamps(numVerts, 0);
+    uint32_t time = cacheSize + 1u;
+    size_t numMisses = 0;
+
+    for (size_t i = 0; i < numTris * 3u; ++i)
+    {
+        const uint32_t v = pIndices[i];
+
+        if (time - timestamps[v] > cacheSize)
+        {
+            timestamps[v] = time++;
+            ++numMisses;
+        }
+    }
+
+    return (float)numMisses / (float)numTris;
+}
+
+
+
+/*-------------------------------------
+ * Vertex cache optimization (Tipsify)
+-------------------------------------*/
+void sl_optimize_vertex_cache(
+    uint32_t* pIndices,
+    size_t numIndices,
+    size_t numVerts,
+    unsigned cacheSize,
+    std::vector<size_t>* pClusters) noexcept
+{
+    const size_t numTris = numIndices / 3u;
+
+    if (pClusters)
+    {
+        pClusters->clear();
+    }
+
+    if (!numTris)
+    {
+        return;
+    }
+
+    numIndices = numTris * 3u;
+
+    SL_MeshAdjacency adj;
+    _sl_build_adjacency(pIndices, numIndices, numVerts, adj);
+
+    std::vector<uint32_t> liveTris(numVerts);
+    for (size_t v = 0; v < numVerts; ++v)
+    {
+        liveTris[v] = adj.offsets[v+1] - adj.offsets[v];
+    }
+
+    std::vector<uint32_t> timestamps(numVerts, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> outIndices;
+    std::vector<bool>     emitted(numTris, false);
+
+    deadEnds.reserve(numIndices);
+    outIndices.reserve(numIndices);
+
+    uint32_t time         = cacheSize + 1u;
+    size_t   cursor       = 0;
+    size_t   clusterBegin = 0;
+    int_fast64_t fanVert  = _sl_skip_dead_end(liveTris, deadEnds, cursor, numVerts);
+
+    if (pClusters && fanVert >= 0)
+    {
+        pClusters->push_back(0);
+    }
+
+    while (fanVert >= 0)
+    {
+        candidates.clear();
+
+        // Emit all remaining triangles around the current fanning vertex
+        for (uint32_t a = adj.offsets[fanVert]; a < adj.offsets[fanVert+1]; ++a)
+        {
+            const uint32_t t = adj.triangles[a];
+            if (emitted[t])
+            {
+                continue;
+            }
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = pIndices[t*3u+k];
+
+                outIndices.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --liveTris[v];
+
+                if (time - timestamps[v] > cacheSize)
+                {
+                    timestamps[v] = time++;
+                }
+            }
+
+            emitted[t] = true;
+        }
+
+        // Prefer the candidate which will remain in the cache after its
+        // remaining triangles are emitted, and which entered the cache first.
+        int_fast64_t nextVert = -1;
+        int_fast64_t bestPriority = -1;
+
+        for (uint32_t v : candidates)
+        {
+            if (!liveTris[v])
+            {
+                continue;
+            }
+
+            int_fast64_t priority = 0;
+            if (time - timestamps[v] + 2u * liveTris[v] <= cacheSize)
+            {
+                priority = (int_fast64_t)(time - timestamps[v]);
+            }
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVert = (int_fast64_t)v;
+            }
+        }
+
+        if (nextVert < 0)
+        {
+            nextVert = _sl_skip_dead_end(liveTris, deadEnds, cursor, numVerts);
+
+            // Mark cluster boundaries at dead ends, but keep clusters large
+            // enough that reordering them doesn't cost much cache locality.
+            if (pClusters && nextVert >= 0 && (outIndices.size() - clusterBegin) >= (size_t)cacheSize * 3u)
+            {
+                clusterBegin = outIndices.size();
+                pClusters->push_back(clusterBegin);
+            }
+        }
+
+        fanVert = nextVert;
+    }
+
+    std::copy(outIndices.begin(), outIndices.end(), pIndices);
+}
+
+
+
+/*-------------------------------------
+ * Overdraw optimization
+-------------------------------------*/
+void sl_optimize_overdraw(
+    uint32_t* pIndices,
+    size_t numIndices,
+    const std::vector<size_t>& clusters,
+    const char* pVertices,
+    size_t numVerts,
+    size_t vertStride) noexcept
+{
+    (void)numVerts;
+
+    const size_t numClusters = clusters.size();
+    if (numClusters < 2)
+    {
+        return;
+    }
+
+    numIndices -= numIndices % 3u;
+
+    // Area-weighted mesh centroid
+    math::vec3 meshCenter{0.f};
+    float meshArea = 0.f;
+
+    for (size_t i = 0; i < numIndices; i += 3)
+    {
+        const math::vec3&& p0 = _sl_vertex_position(pVertices, vertStride, pIndices[i+0]);
+        const math::vec3&& p1 = _sl_vertex_position(pVertices, vertStride, pIndices[i+1]);
+        const math::vec3&& p2 = _sl_vertex_position(pVertices, vertStride, pIndices[i+2]);
+        const float area = math::length(math::cross(p1-p0, p2-p0));
+
+        meshCenter += (p0+p1+p2) * area;
+        meshArea += area;
+    }
+
+    if (meshArea <= 0.f)
+    {
+        return;
+    }
+
+    meshCenter = meshCenter / (meshArea * 3.f);
+
+    // Clusters facing away from the mesh center are more likely to occlude
+    // the rest of the mesh.
+    std::vector<std::pair<float, size_t>> sortKeys(numClusters);
+
+    for (size_t c = 0; c < numClusters; ++c)
+    {
+        const size_t begin = clusters[c];
+        const size_t end   = (c+1u < numClusters) ? clusters[c+1u] : numIndices;
+
+        math::vec3 clusterCenter{0.f};
+        math::vec3 clusterNormal{0.f};
+        float clusterArea = 0.f;
+
+        for (size_t i = begin; i < end; i += 3)
+        {
+            const math::vec3&& p0 = _sl_vertex_position(pVertices, vertStride, pIndices[i+0]);
+            const math::vec3&& p1 = _sl_vertex_position(pVertices, vertStride, pIndices[i+1]);
+            const math::vec3&& p2 = _sl_vertex_position(pVertices, vertStride, pIndices[i+2]);
+            const math::vec3&& n  = math::cross(p1-p0, p2-p0);
+            const float area = math::length(n);
+
+            clusterCenter += (p0+p1+p2) * area;
+            clusterNormal += n;
+            clusterArea += area;
+        }
+
+        float occlusion = 0.f;
+        if (clusterArea > 0.f)
+        {
+            const float normalLen = math::length(clusterNormal);
+            clusterCenter = clusterCenter / (clusterArea * 3.f);
+            occlusion = (normalLen > 0.f) ? math::dot(clusterCenter-meshCenter, clusterNormal / normalLen) : 0.f;
+        }
+
+        sortKeys[c] = std::make_pair(occlusion, c);
+    }
+
+    std::stable_sort(sortKeys.begin(), sortKeys.end(), [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) noexcept->bool
+    {
+        return a.first > b.first;
+    });
+
+    std::vector<uint32_t> outIndices;
+    outIndices.reserve(numIndices);
+
+    for (const std::pair<float, size_t>& key : sortKeys)
+    {
+        const size_t c     = key.second;
+        const size_t begin = clusters[c];
+        const size_t end   = (c+1u < numClusters) ? clusters[c+1u] : numIndices;
+
+        outIndices.insert(outIndices.end(), pIndices+begin, pIndices+end);
+    }
+
+    std::copy(outIndices.begin(), outIndices.end(), pIndices);
+}
+
+
+
+/*-------------------------------------
+ * Vertex fetch optimization
+-------------------------------------*/
+void sl_optimize_vertex_fetch(
+    uint32_t* pIndices,
+    size_t numIndices,
+    char* pVertices,
+    size_t numVerts,
+    size_t vertStride) noexcept
+{
+    constexpr uint32_t unassigned = ~(uint32_t)0;
+
+    std::vector<uint32_t> remap(numVerts, unassigned);
+    uint32_t nextVert = 0;
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        uint32_t& newId = remap[pIndices[i]];
+        if (newId == unassigned)
+        {
+            newId = nextVert++;
+        }
+
+        pIndices[i] = newId;
+    }
+
+    // Unreferenced vertices are moved to the end of the buffer
+    for (uint32_t& newId : remap)
+    {
+        if (newId == unassigned)
+        {
+            newId = nextVert++;
+        }
+    }
+
+    const std::vector<char> oldVerts{pVertices, pVertices + numVerts * vertStride};
+
+    for (size_t v = 0; v < numVerts; ++v)
+    {
+        std::memcpy(pVertices + remap[v] * vertStride, oldVerts.data() + v * vertStride, vertStride);
+    }
+}
+
+
+
+/*-------------------------------------
+ * Optimize an uploaded mesh
+-------------------------------------*/
+int sl_optimize_mesh(
+    const SL_Mesh& mesh,
+    SL_IndexBuffer& ibo,
+    SL_VertexBuffer& vbo,
+    size_t vboOffset,
+    size_t baseVert,
+    size_t numVerts,
+    size_t vertStride,
+    SL_MeshOptimizerStats* pStats) noexcept
+{
+    if (mesh.mode != RENDER_MODE_INDEXED_TRIANGLES)
+    {
+        return -1;
+    }
+
+    const size_t numIndices = mesh.elementEnd - mesh.elementBegin;
+    if (!numVerts || numIndices < 3 || (numIndices % 3u))
+    {
+        return -2;
+    }
+
+    std::vector<uint32_t> indices(numIndices);
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        const size_t idx = ibo.index(mesh.elementBegin + i);
+        if (idx < baseVert || idx >= baseVert + numVerts)
+        {
+            return -3;
+        }
+
+        indices[i] = (uint32_t)(idx - baseVert);
+    }
+
+    char* const pVertices = reinterpret_cast<char*>(vbo.data()) + vboOffset;
+    const float acmrBefore = sl_calc_acmr(indices.data(), numIndices, numVerts);
+
+    std::vector<size_t> clusters;
+    sl_optimize_vertex_cache(indices.data(), numIndices, numVerts, SL_MESH_OPTIMIZER_CACHE_SIZE, &clusters);
+    sl_optimize_overdraw(indices.data(), numIndices, clusters, pVertices, numVerts, vertStride);
+    sl_optimize_vertex_fetch(indices.data(), numIndices, pVertices, numVerts, vertStride);
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        const size_t idx = indices[i] + baseVert;
+        void* const pElement = ibo.element((ptrdiff_t)(mesh.elementBegin + i));
+
+        switch (ibo.type())
+        {
+            case VERTEX_DATA_BYTE:  *reinterpret_cast<unsigned char*>(pElement)  = (unsigned char)idx;  break;
+            case VERTEX_DATA_SHORT: *reinterpret_cast<unsigned short*>(pElement) = (unsigned short)idx; break;
+            case VERTEX_DATA_INT:   *reinterpret_cast<unsigned int*>(pElement)   = (unsigned int)idx;   break;
+            default:
+                LS_UNREACHABLE();
+        }
+    }
+
+    if (pStats)
+    {
+        pStats->acmrBefore = acmrBefore;
+        pStats->acmrAfter  = sl_calc_acmr(indices.data(), numIndices, numVerts);
+    }
+
+    return 0;
+}
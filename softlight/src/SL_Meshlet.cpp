@@ -0,0 +1,199 @@
+
+#include <cmath> // std::sqrt
+
+#include "lightsky/math/scalar_utils.h" // min, max
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Geometry.hpp" // SL_DataType
+#include "softlight/SL_IndexBuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Meshlet.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Normal cones wider than ~84 degrees are not worth testing
+-------------------------------------*/
+constexpr float SL_MESHLET_MIN_CONE_DOT = 0.1f;
+
+
+
+/*-------------------------------------
+ * Retrieve a vertex position
+-------------------------------------*/
+inline math::vec3 _sl_meshlet_vert(const SL_VertexArray& vao, const SL_VertexBuffer& vbo, size_t vertId) noexcept
+{
+    const float* const p = vbo.element<const float>(vao.offset(0, vertId));
+    return math::vec3{p[0], p[1], p[2]};
+}
+
+
+
+/*-------------------------------------
+ * Calculate the bounds of a single meshlet
+-------------------------------------*/
+SL_Meshlet _sl_build_meshlet(const math::vec3* pVerts, size_t numTris) noexcept
+{
+    SL_Meshlet meshlet;
+
+    // Bounding sphere, centered on the AABB
+    math::vec3 boxMin = pVerts[0];
+    math::vec3 boxMax = pVerts[0];
+
+    for (size_t i = 1; i < numTris*3u; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            boxMin[j] = math::min(boxMin[j], pVerts[i][j]);
+            boxMax[j] = math::max(boxMax[j], pVerts[i][j]);
+        }
+    }
+
+    const math::vec3&& center = (boxMin + boxMax) * 0.5f;
+    float radius = 0.f;
+
+    for (size_t i = 0; i < numTris*3u; ++i)
+    {
+        radius = math::max(radius, math::length(pVerts[i] - center));
+    }
+
+    meshlet.bounds = math::vec4{center[0], center[1], center[2], radius};
+
+    // Normal cone
+    math::vec3 normals[SL_VERTEX_CHUNK_SIZE];
+    bool       degenerate[SL_VERTEX_CHUNK_SIZE];
+    math::vec3 axis{0.f, 0.f, 0.f};
+
+    for (size_t t = 0; t < numTris; ++t)
+    {
+        const math::vec3* const p = pVerts + t*3u;
+        const math::vec3&& n = math::cross(p[1]-p[0], p[2]-p[0]);
+        const float len = math::length(n);
+
+        // Degenerate triangles produce no fragments and can be ignored
+        degenerate[t] = !(len > 0.f);
+        if (!degenerate[t])
+        {
+            normals[t] = n * math::rcp(len);
+            axis += normals[t];
+        }
+    }
+
+    meshlet.cone     = math::vec4{0.f, 0.f, 0.f, 2.f};
+    meshlet.coneApex = math::vec4{center[0], center[1], center[2], 1.f};
+
+    const float axisLen = math::length(axis);
+    if (axisLen <= 0.f)
+    {
+        return meshlet;
+    }
+
+    axis = axis * math::rcp(axisLen);
+
+    float minDot = 1.f;
+    for (size_t t = 0; t < numTris; ++t)
+    {
+        if (!degenerate[t])
+        {
+            minDot = math::min(minDot, math::dot(axis, normals[t]));
+        }
+    }
+
+    if (minDot <= SL_MESHLET_MIN_CONE_DOT)
+    {
+        return meshlet;
+    }
+
+    // Move the apex back along the axis so every triangle's plane lies in
+    // front of it.
+    float maxT = 0.f;
+    for (size_t t = 0; t < numTris; ++t)
+    {
+        if (!degenerate[t])
+        {
+            const float dn = math::dot(axis, normals[t]);
+            maxT = math::max(maxT, math::dot(center - pVerts[t*3u], normals[t]) / dn);
+        }
+    }
+
+    const math::vec3&& apex = center - axis * maxT;
+
+    meshlet.cone     = math::vec4{axis[0], axis[1], axis[2], std::sqrt(1.f - minDot*minDot)};
+    meshlet.coneApex = math::vec4{apex[0], apex[1], apex[2], 1.f};
+
+    return meshlet;
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * Meshlet generation
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Build meshlets from a mesh
+-------------------------------------*/
+int sl_build_meshlets(const SL_Context& context, const SL_Mesh& mesh, SL_AlignedVector<SL_Meshlet>& outMeshlets) noexcept
+{
+    outMeshlets.clear();
+
+    if (mesh.mode != RENDER_MODE_TRIANGLES && mesh.mode != RENDER_MODE_INDEXED_TRIANGLES)
+    {
+        return -1;
+    }
+
+    const SL_VertexArray& vao = context.vao(mesh.vaoId);
+    if (!vao.num_bindings() || vao.type(0) != VERTEX_DATA_FLOAT || vao.dimensions(0) < VERTEX_DIMENSION_3)
+    {
+        return -2;
+    }
+
+    const SL_VertexBuffer& vbo  = context.vbo(vao.get_vertex_buffer());
+    const SL_IndexBuffer*  pIbo = (mesh.mode == RENDER_MODE_INDEXED_TRIANGLES) ? &context.ibo(vao.get_index_buffer()) : nullptr;
+
+    // Meshlets must line up with the chunks claimed by the vertex processors
+    constexpr size_t chunkElements = (size_t)SL_VERTEX_CHUNK_SIZE * 3u;
+    const size_t     numElements   = mesh.elementEnd - mesh.elementBegin;
+
+    outMeshlets.reserve((numElements + chunkElements - 1u) / chunkElements);
+
+    math::vec3 verts[chunkElements];
+
+    for (size_t begin = mesh.elementBegin; begin < mesh.elementEnd; begin += chunkElements)
+    {
+        const size_t end     = math::min<size_t>(begin + chunkElements, mesh.elementEnd);
+        const size_t numTris = (end - begin) / 3u;
+
+        if (!numTris)
+        {
+            break;
+        }
+
+        for (size_t i = begin; i < begin + numTris*3u; ++i)
+        {
+            const size_t vertId = pIbo ? pIbo->index(i) : i;
+            verts[i-begin] = _sl_meshlet_vert(vao, vbo, vertId);
+        }
+
+        outMeshlets.push_back(_sl_build_meshlet(verts, numTris));
+    }
+
+    return (int)outMeshlets.size();
+}
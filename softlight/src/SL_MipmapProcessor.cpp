@@ -0,0 +1,158 @@
+
+#include "lightsky/setup/Api.h" // LS_INLINE
+#include "lightsky/setup/Types.h" // IsFloat
+
+#include "lightsky/math/scalar_utils.h" // min
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_MipmapProcessor.hpp"
+#include "softlight/SL_Texture.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Average 4 floating-point components
+-------------------------------------*/
+template <typename value_type>
+inline LS_INLINE typename ls::setup::EnableIf<ls::setup::IsFloat<value_type>::value, value_type>::type
+_sl_average4(value_type a, value_type b, value_type c, value_type d) noexcept
+{
+    return (a + b + c + d) * value_type{0.25};
+}
+
+
+
+/*-------------------------------------
+ * Average 4 integral components with rounding, without overflowing the
+ * component type.
+-------------------------------------*/
+template <typename value_type>
+inline LS_INLINE typename ls::setup::EnableIf<ls::setup::IsIntegral<value_type>::value, value_type>::type
+_sl_average4(value_type a, value_type b, value_type c, value_type d) noexcept
+{
+    const value_type hi = (value_type)((a >> 2u) + (b >> 2u) + (c >> 2u) + (d >> 2u));
+    const value_type lo = (value_type)((a & 3u) + (b & 3u) + (c & 3u) + (d & 3u) + 2u);
+    return (value_type)(hi + (lo >> 2u));
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_MipmapProcessor Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Box-filter a source level into its destination level
+-------------------------------------*/
+template<typename color_type, typename value_type, SL_TexelOrder order>
+void SL_MipmapProcessor::downsample() noexcept
+{
+    constexpr unsigned numComponents = sizeof(color_type) / sizeof(value_type);
+
+    const uint_fast32_t srcW = mSrcTex->width;
+    const uint_fast32_t srcH = mSrcTex->height;
+    const uint_fast32_t dstW = mDstTex->width;
+    const uint_fast32_t dstH = mDstTex->height;
+
+    const color_type* const pSrc = reinterpret_cast<const color_type*>(mSrcTex->pTexels);
+    color_type* const       pDst = reinterpret_cast<color_type*>(mDstTex->pTexels);
+
+    for (uint_fast32_t y = mThreadId; y < dstH; y += mNumThreads)
+    {
+        // Odd or single-texel source dimensions repeat their last row/column
+        const uint_fast32_t y0 = y << 1u;
+        const uint_fast32_t y1 = math::min<uint_fast32_t>(y0 + 1u, srcH - 1u);
+
+        for (uint_fast32_t x = 0; x < dstW; ++x)
+        {
+            const uint_fast32_t x0 = x << 1u;
+            const uint_fast32_t x1 = math::min<uint_fast32_t>(x0 + 1u, srcW - 1u);
+
+            const color_type& a = pSrc[sl_texture_view_index<order>(*mSrcTex, x0, y0)];
+            const color_type& b = pSrc[sl_texture_view_index<order>(*mSrcTex, x1, y0)];
+            const color_type& c = pSrc[sl_texture_view_index<order>(*mSrcTex, x0, y1)];
+            const color_type& d = pSrc[sl_texture_view_index<order>(*mSrcTex, x1, y1)];
+
+            color_type& outColor = pDst[sl_texture_view_index<order>(*mDstTex, x, y)];
+
+            for (unsigned i = 0; i < numComponents; ++i)
+            {
+                outColor[i] = _sl_average4<value_type>(a[i], b[i], c[i], d[i]);
+            }
+        }
+    }
+}
+
+
+
+/*-------------------------------------
+ * Select the source texel ordering
+-------------------------------------*/
+template<typename color_type, typename value_type>
+void SL_MipmapProcessor::downsample_texels() noexcept
+{
+    if (mTexelOrder == SL_TexelOrder::SWIZZLED)
+    {
+        downsample<color_type, value_type, SL_TexelOrder::SWIZZLED>();
+    }
+    else
+    {
+        downsample<color_type, value_type, SL_TexelOrder::ORDERED>();
+    }
+}
+
+
+
+/*-------------------------------------
+ * Run the mipmap generator
+-------------------------------------*/
+void SL_MipmapProcessor::execute() noexcept
+{
+    switch (mDstTex->type)
+    {
+        case SL_COLOR_R_8U:       downsample_texels<SL_ColorRType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_R_16U:      downsample_texels<SL_ColorRType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_R_32U:      downsample_texels<SL_ColorRType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_R_64U:      downsample_texels<SL_ColorRType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_R_FLOAT:    downsample_texels<SL_ColorRType<float>, float>();       break;
+        case SL_COLOR_R_DOUBLE:   downsample_texels<SL_ColorRType<double>, double>();     break;
+
+        case SL_COLOR_RG_8U:      downsample_texels<SL_ColorRGType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RG_16U:     downsample_texels<SL_ColorRGType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RG_32U:     downsample_texels<SL_ColorRGType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RG_64U:     downsample_texels<SL_ColorRGType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RG_FLOAT:   downsample_texels<SL_ColorRGType<float>, float>();       break;
+        case SL_COLOR_RG_DOUBLE:  downsample_texels<SL_ColorRGType<double>, double>();     break;
+
+        case SL_COLOR_RGB_8U:     downsample_texels<SL_ColorRGBType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RGB_16U:    downsample_texels<SL_ColorRGBType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RGB_32U:    downsample_texels<SL_ColorRGBType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RGB_64U:    downsample_texels<SL_ColorRGBType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RGB_FLOAT:  downsample_texels<SL_ColorRGBType<float>, float>();       break;
+        case SL_COLOR_RGB_DOUBLE: downsample_texels<SL_ColorRGBType<double>, double>();     break;
+
+        case SL_COLOR_RGBA_8U:     downsample_texels<SL_ColorRGBAType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RGBA_16U:    downsample_texels<SL_ColorRGBAType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RGBA_32U:    downsample_texels<SL_ColorRGBAType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RGBA_64U:    downsample_texels<SL_ColorRGBAType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RGBA_FLOAT:  downsample_texels<SL_ColorRGBAType<float>, float>();       break;
+        case SL_COLOR_RGBA_DOUBLE: downsample_texels<SL_ColorRGBAType<double>, double>();     break;
+
+        // Packed color types are rejected by SL_Context::generate_mipmaps()
+        default:
+            break;
+    }
+}
@@ -19,6 +19,7 @@ void SL_PipelineState::reset() noexcept
     //this->blend_mode(temp.blend_mode());
     //this->num_varyings(temp.num_varyings());
     //this->num_render_targets(temp.num_render_targets());
+    //this->derivative_mode(temp.derivative_mode());
 }
 
 
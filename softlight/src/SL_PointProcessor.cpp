@@ -142,7 +142,7 @@ inline LS_INLINE void sl_world_to_screen_coords_divided1(math::vec4& LS_RESTRICT
 /*--------------------------------------
  * Publish a vertex to a fragment thread
 --------------------------------------*/
-void SL_PointProcessor::push_bin(size_t primIndex, const ls::math::vec4& viewportDims, const SL_TransformedVert& a) const noexcept
+void SL_PointProcessor::push_bin(size_t primIndex, const ls::math::vec4& viewportDims, int32_t pointSize, const SL_TransformedVert& a) const noexcept
 {
     SL_BinCounterAtomic<uint32_t>* const pLocks = mBinsUsed;
     SL_FragmentBin* const pFragBins = mFragBins;
@@ -150,15 +150,20 @@ void SL_PointProcessor::push_bin(size_t primIndex, const ls::math::vec4& viewpor
 
     const math::vec4& p0 = a.vert;
 
-    const float bboxMinX = p0[0];
-    const float bboxMaxX = p0[0];
-    const float bboxMinY = p0[1];
-    const float bboxMaxY = p0[1];
-
-    const float fboW = viewportDims[0]+viewportDims[2];
-    const float fboH = viewportDims[1]+viewportDims[3];
-
-    if (LS_UNLIKELY(bboxMaxX < viewportDims[0] || bboxMaxY < viewportDims[1] || fboW < bboxMinX || fboH < bboxMinY))
+    // Points are rendered as squares of "pointSize" pixels, centered on the
+    // pixel containing the transformed vertex. Bounds are exclusive.
+    const int32_t viewX0   = math::max<int32_t>((int32_t)viewportDims[0], 0);
+    const int32_t viewY0   = math::max<int32_t>((int32_t)viewportDims[1], 0);
+    const int32_t viewX1   = (int32_t)(viewportDims[0]+viewportDims[2]);
+    const int32_t viewY1   = (int32_t)(viewportDims[1]+viewportDims[3]);
+    const int32_t pointX   = (int32_t)p0[0] - ((pointSize-1) >> 1);
+    const int32_t pointY   = (int32_t)p0[1] - ((pointSize-1) >> 1);
+    const int32_t bboxMinX = math::max<int32_t>(pointX, viewX0);
+    const int32_t bboxMinY = math::max<int32_t>(pointY, viewY0);
+    const int32_t bboxMaxX = math::min<int32_t>(pointX + pointSize, viewX1);
+    const int32_t bboxMaxY = math::min<int32_t>(pointY + pointSize, viewY1);
+
+    if (LS_UNLIKELY(bboxMinX >= bboxMaxX || bboxMinY >= bboxMaxY))
     {
         return;
     }
@@ -181,6 +186,13 @@ void SL_PointProcessor::push_bin(size_t primIndex, const ls::math::vec4& viewpor
     // place a triangle into the next available bin
     SL_FragmentBin& bin = pFragBins[binId];
     bin.mScreenCoords[0] = p0;
+    bin.mScreenCoords[1] = math::vec4{(float)bboxMinX, (float)bboxMinY, (float)bboxMaxX, (float)bboxMaxY};
+
+    // Points are always tiled, regardless of SL_TILED_BINNING_ENABLED
+    bin.mTileBounds[0] = (uint16_t)(bboxMinX / SL_BIN_TILE_SIZE);
+    bin.mTileBounds[1] = (uint16_t)(bboxMinY / SL_BIN_TILE_SIZE);
+    bin.mTileBounds[2] = (uint16_t)((bboxMaxX-1) / SL_BIN_TILE_SIZE);
+    bin.mTileBounds[3] = (uint16_t)((bboxMaxY-1) / SL_BIN_TILE_SIZE);
 
     for (unsigned i = 0; i < numVaryings; ++i)
     {
@@ -200,7 +212,8 @@ void SL_PointProcessor::process_verts(
     const SL_Mesh& m,
     size_t instanceId,
     const ls::math::mat4_t<float>& scissorMat,
-    const ls::math::vec4_t<float>& viewportDims) noexcept
+    const ls::math::vec4_t<float>& viewportDims,
+    int32_t pointSize) noexcept
 {
     if (mFragProcessors->count.load(std::memory_order_consume))
     {
@@ -221,10 +234,6 @@ void SL_PointProcessor::process_verts(
 
     size_t begin;
     size_t end;
-    sl_calc_indexed_parition<1, true>(m.elementEnd-m.elementBegin, mNumThreads, mThreadId, begin, end);
-
-    begin += m.elementBegin;
-    end += m.elementBegin;
 
     SL_PTVCache ptvCache{};
     const auto&& vertTransform = [&](size_t key, SL_TransformedVert& tv)->void {
@@ -233,17 +242,20 @@ void SL_PointProcessor::process_verts(
         tv.vert = scissorMat * vertShader(params);
     };
 
-    for (size_t i = begin; i < end; ++i)
+    while (next_chunk(m.elementBegin, m.elementEnd, 1, begin, end))
     {
-        const size_t vertId = usingIndices ? pIbo->index(i) : i;
-        sl_cache_query_or_update(ptvCache, vertId, pVert0, vertTransform);
-
-        if (pVert0.vert[3] > 0.f)
+        for (size_t i = begin; i < end; ++i)
         {
-            sl_perspective_divide1(pVert0.vert);
-            sl_world_to_screen_coords_divided1(pVert0.vert, viewportDims);
+            const size_t vertId = usingIndices ? pIbo->index(i) : i;
+            sl_cache_query_or_update(ptvCache, vertId, pVert0, vertTransform);
+
+            if (pVert0.vert[3] > 0.f)
+            {
+                sl_perspective_divide1(pVert0.vert);
+                sl_world_to_screen_coords_divided1(pVert0.vert, viewportDims);
 
-            push_bin(i, viewportDims, pVert0);
+                push_bin(i, viewportDims, pointSize, pVert0);
+            }
         }
     }
 }
@@ -255,25 +267,26 @@ void SL_PointProcessor::process_verts(
 --------------------------------------*/
 void SL_PointProcessor::execute() noexcept
 {
-    mAmDone = 0;
+    this->begin_draw();
 
     const math::vec4&&      fboDims      = (math::vec4)math::vec4_t<int>{0, 0, mFbo->width(), mFbo->height()};
     const SL_ViewportState& viewState    = mContext->viewport_state();
     const math::mat4&&      scissorMat   = viewState.scissor_matrix(fboDims[2], fboDims[3]);
     const math::vec4&&      viewportDims = viewState.viewport_rect(fboDims[2], fboDims[3]);
+    const int32_t           pointSize    = (int32_t)(viewState.point_size() + 0.5f);
 
     if (mNumInstances == 1)
     {
         for (size_t i = 0; i < mNumMeshes; ++i)
         {
-            process_verts(mMeshes[i], 0, scissorMat, viewportDims);
+            process_verts(mMeshes[i], 0, scissorMat, viewportDims, pointSize);
         }
     }
     else
     {
         for (size_t i = 0; i < mNumInstances; ++i)
         {
-            process_verts(mMeshes[0], i, scissorMat, viewportDims);
+            process_verts(mMeshes[0], i, scissorMat, viewportDims, pointSize);
         }
     }
 
@@ -3,7 +3,9 @@
 
 #include "softlight/SL_PointRasterizer.hpp"
 #include "softlight/SL_Framebuffer.hpp" // SL_Framebuffer
+#include "softlight/SL_ScanlineBounds.hpp" // sl_scanline_offset()
 #include "softlight/SL_Shader.hpp" // SL_FragmentShader
+#include "softlight/SL_ShaderUtil.hpp" // SL_BinTileMap
 #include "softlight/SL_Texture.hpp"
 #include "softlight/SL_ViewportState.hpp"
 
@@ -21,7 +23,7 @@ namespace utils = ls::utils;
  * SL_FragmentProcessor Class
 -----------------------------------------------------------------------------*/
 /*--------------------------------------
- * Determine if a point can be rendered.
+ * Render the squares covered by each point.
 --------------------------------------*/
 template <class DepthCmpFunc, typename depth_type>
 void SL_PointRasterizer::render_point(SL_Framebuffer* const fbo) noexcept
@@ -29,8 +31,6 @@ void SL_PointRasterizer::render_point(SL_Framebuffer* const fbo) noexcept
     constexpr DepthCmpFunc  depthCmp    {};
     const SL_TextureView&   pDepthBuf   = fbo->get_depth_buffer();
     const SL_PipelineState  pipeline    = mShader->pipelineState;
-    const SL_BlendMode      blendMode   = pipeline.blend_mode();
-    const SL_FboOutputMask  fboOutMask  = sl_calc_fbo_out_mask((unsigned)pipeline.num_render_targets(), (blendMode != SL_BLEND_OFF));
     const uint32_t          numVaryings = (unsigned)pipeline.num_varyings();
     const bool              depthMask   = pipeline.depth_mask() == SL_DEPTH_MASK_ON;
     const auto              shader      = mShader->pFragShader;
@@ -39,40 +39,103 @@ void SL_PointRasterizer::render_point(SL_Framebuffer* const fbo) noexcept
 
     fragParams.pUniforms = pUniforms;
 
-    for (uint64_t binId = 0; binId < mNumBins; ++binId)
+    // Shade the pixels of a point within [x0, x1) and every "yStep" rows of
+    // [y0, y1).
+    const auto&& shade_point = [&](const SL_FragmentBin& bin, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t yStep) noexcept->void
     {
-        const SL_FragmentBin& bin = mBins[binId];
-        const math::vec4& screenCoord = bin.mScreenCoords[0];
+        fragParams.coord.depth = bin.mScreenCoords[0][2];
 
-        fragParams.coord.x     = (uint16_t)screenCoord[0];
-        fragParams.coord.y     = (uint16_t)screenCoord[1];
-        fragParams.coord.depth = screenCoord[2];
-        if (LS_LIKELY(fragParams.coord.y % mNumProcessors != mThreadId))
+        for (int32_t y = y0; y < y1; y += yStep)
         {
-            continue;
+            for (int32_t x = x0; x < x1; ++x)
+            {
+                fragParams.coord.x = (uint16_t)x;
+                fragParams.coord.y = (uint16_t)y;
+
+                const depth_type d = ((depth_type*)pDepthBuf.pTexels)[sl_fbo_index(pDepthBuf, fragParams.coord.x, fragParams.coord.y)];
+                if (LS_UNLIKELY(!depthCmp(fragParams.coord.depth, (float)d)))
+                {
+                    continue;
+                }
+
+                for (unsigned i = numVaryings; i--;)
+                {
+                    fragParams.pVaryings[i] = bin.mVaryings[i];
+                }
+
+                const bool haveOutputs = shader(fragParams);
+                if (LS_LIKELY(haveOutputs))
+                {
+                    sl_write_pixel(mPixelWriter, fragParams);
+
+                    if (depthMask)
+                    {
+                        fbo->put_depth_pixel<depth_type>(fragParams.coord.x, fragParams.coord.y, (depth_type)fragParams.coord.depth);
+                    }
+                }
+            }
         }
+    };
 
-        const depth_type d = ((depth_type*)pDepthBuf.pTexels)[fragParams.coord.x + pDepthBuf.width * fragParams.coord.y];
-        if (LS_UNLIKELY(!depthCmp(fragParams.coord.depth, (float)d)))
-        {
-            continue;
-        }
+    // Threads claim whole tiles, so each only reads the points which
+    // overlap its own tiles. Points are tiled even without
+    // SL_TILED_BINNING_ENABLED. Tiles are only unavailable if there are too
+    // many large points in a single batch.
+    SL_BinTileMap* const pTiles = mBinTiles;
 
-        for (unsigned i = numVaryings; i--;)
-        {
-            fragParams.pVaryings[i] = bin.mVaryings[i];
-        }
+    if (LS_LIKELY(pTiles->numActiveTiles > 0))
+    {
+        const uint32_t numActiveTiles = pTiles->numActiveTiles;
+        const uint32_t numTilesX      = pTiles->numTilesX;
+        uint_fast32_t  activeId       = pTiles->nextTile.fetch_add(1, std::memory_order_acq_rel);
 
-        const bool haveOutputs = shader(fragParams);
-        if (LS_LIKELY(haveOutputs))
+        while (activeId < numActiveTiles)
         {
-            mFbo->put_pixel(fboOutMask, blendMode, fragParams);
+            const uint32_t  tileId      = pTiles->activeTiles[activeId];
+            const int32_t   tileX0      = (int32_t)((tileId % numTilesX) * SL_BIN_TILE_SIZE);
+            const int32_t   tileY0      = (int32_t)((tileId / numTilesX) * SL_BIN_TILE_SIZE);
+            const uint32_t* pTileBins   = pTiles->binIds + pTiles->tileOffsets[tileId];
+            const uint32_t  numTileBins = pTiles->tileCounts[tileId];
 
-            if (depthMask)
+            for (uint32_t i = 0; i < numTileBins; ++i)
             {
-                fbo->put_depth_pixel<depth_type>(fragParams.coord.x, fragParams.coord.y, (depth_type)fragParams.coord.depth);
+                const SL_FragmentBin& bin    = mBins[pTileBins[i]];
+                const math::vec4&     bounds = bin.mScreenCoords[1];
+
+                shade_point(
+                    bin,
+                    math::max<int32_t>((int32_t)bounds[0], tileX0),
+                    math::max<int32_t>((int32_t)bounds[1], tileY0),
+                    math::min<int32_t>((int32_t)bounds[2], tileX0 + SL_BIN_TILE_SIZE),
+                    math::min<int32_t>((int32_t)bounds[3], tileY0 + SL_BIN_TILE_SIZE),
+                    1
+                );
             }
+
+            activeId = pTiles->nextTile.fetch_add(1, std::memory_order_acq_rel);
         }
+
+        return;
+    }
+
+    // Fall back to an interleaved set of scanlines per thread
+    const int32_t yOffset   = (int32_t)mThreadId;
+    const int32_t increment = (int32_t)mNumProcessors;
+
+    for (uint64_t binId = 0; binId < mNumBins; ++binId)
+    {
+        const SL_FragmentBin& bin    = mBins[binId];
+        const math::vec4&     bounds = bin.mScreenCoords[1];
+        const int32_t         y0     = (int32_t)bounds[1];
+        const int32_t         y1     = (int32_t)bounds[3];
+        const int32_t         y      = y0 + sl_scanline_offset<int32_t>(increment, yOffset, y0);
+
+        if (LS_LIKELY(y >= y1))
+        {
+            continue;
+        }
+
+        shade_point(bin, (int32_t)bounds[0], y, (int32_t)bounds[2], y1, increment);
     }
 }
 
@@ -9,11 +9,15 @@
 
 #include "lightsky/math/vec4.h"
 
+#include "softlight/SL_CommandList.hpp" // SL_DrawCommand
+#include "softlight/SL_Config.hpp"
 #include "softlight/SL_FragmentProcessor.hpp"
 #include "softlight/SL_Framebuffer.hpp"
 #include "softlight/SL_ProcessorPool.hpp"
+#include "softlight/SL_Shader.hpp"
 #include "softlight/SL_ShaderProcessor.hpp"
 #include "softlight/SL_ShaderUtil.hpp" // SL_FragmentBin
+#include "softlight/SL_Texture.hpp"
 
 
 
@@ -24,6 +28,91 @@ class SL_Framebuffer;
 
 
 
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Uniforms read by a draw
+-------------------------------------*/
+inline const SL_UniformBuffer* _sl_draw_uniforms(const SL_DrawCommand& draw, const SL_Shader* shaders) noexcept
+{
+    return draw.pUniforms ? draw.pUniforms : shaders[draw.shaderId].pUniforms;
+}
+
+
+
+/*-------------------------------------
+ * Determine if a draw can be merged into the run containing the previous draw
+-------------------------------------*/
+inline bool _sl_can_merge_draws(const SL_DrawRun& run, const SL_DrawCommand& prev, const SL_DrawCommand& draw, const SL_Shader* shaders) noexcept
+{
+    // Blended primitives are ordered by their index within a mesh, which
+    // would interleave the primitives of separate draws. Merged meshes are
+    // shaded by a single run, so they must also read the same uniforms.
+    return prev.shaderId == draw.shaderId
+        && prev.fboId == draw.fboId
+        && _sl_draw_uniforms(prev, shaders) == _sl_draw_uniforms(draw, shaders)
+        && run.mode == draw.mesh.mode
+        && run.numInstances == 1
+        && draw.numInstances == 1
+        && shaders[draw.shaderId].pipelineState.blend_mode() == SL_BLEND_OFF;
+}
+
+
+
+/*-------------------------------------
+ * Determine if a run must wait for its predecessor to complete
+-------------------------------------*/
+inline uint32_t _sl_must_serialize_runs(const SL_DrawRun& prev, const SL_DrawRun& next) noexcept
+{
+    #if SL_TILED_BINNING_ENABLED
+        // Tiles are claimed dynamically, so pixels have no fixed owner.
+        (void)prev;
+        (void)next;
+        return 1u;
+    #else
+        // Each rasterizer type distributes scanlines differently. Draws to a
+        // separate framebuffer may also read from the previous framebuffer's
+        // attachments.
+        if (prev.pFbo != next.pFbo || sl_processor_type_for_draw_mode(prev.mode) != sl_processor_type_for_draw_mode(next.mode))
+        {
+            return 1u;
+        }
+
+        // Points are always tiled, so their pixels have no fixed owner.
+        if (sl_processor_type_for_draw_mode(next.mode) == SL_POINT_PROCESSOR)
+        {
+            return 1u;
+        }
+
+        #if SL_HIZ_ENABLED
+            // Coarse depth tiles may be read while the previous run is still
+            // writing depth. Stale tiles are only conservative if both runs
+            // move depth values in the same direction.
+            const SL_DepthTest prevTest = prev.pShader->pipelineState.depth_test();
+            const SL_DepthTest nextTest = next.pShader->pipelineState.depth_test();
+
+            if (sl_depth_test_is_ordered(nextTest) && prev.pShader->pipelineState.depth_mask() == SL_DEPTH_MASK_ON && prevTest != nextTest)
+            {
+                return 1u;
+            }
+        #endif
+
+        return 0u;
+    #endif
+}
+
+
+
+} // end anonymous namespace
+
+
+
 /*-----------------------------------------------------------------------------
  * SL_ProcessorPool Class
 -----------------------------------------------------------------------------*/
@@ -51,6 +140,23 @@ SL_ProcessorPool::SL_ProcessorPool(unsigned numThreads) noexcept :
     mBinsUsed{ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint32_t>>()},
     mFragBins{ls::utils::make_unique_aligned_array<SL_FragmentBin>(SL_SHADER_MAX_BINNED_PRIMS)},
     mFragQueues{ls::utils::make_unique_aligned_array<SL_FragCoord>(numThreads)},
+    mBinTiles{ls::utils::make_unique_aligned_pointer<SL_BinTileMap>()},
+    mVertChunks{ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint_fast64_t>>()},
+    mThreadStats{ls::utils::make_unique_aligned_array<SL_ThreadStats>(numThreads)},
+    mBatchFragSemaphore{nullptr},
+    mBatchShadingSemaphore{nullptr},
+    mBatchBinIds{nullptr},
+    mBatchTempBinIds{nullptr},
+    mBatchBinsUsed{nullptr},
+    mBatchFragBins{nullptr},
+    mBatchBinTiles{nullptr},
+    mBatchVertChunks{nullptr},
+    mRunExits{nullptr},
+    mRunsRetired{nullptr},
+    mBatchMeshes{},
+    mBatchCulls{},
+    mBatchRuns{},
+    mBatchShaders{},
     mWorkers{numThreads > 1 ? ls::utils::make_unique_aligned_array<SL_ProcessorPool::ThreadedWorker>(numThreads - 1) : nullptr},
     mNumThreads{numThreads}
 {
@@ -64,6 +170,7 @@ SL_ProcessorPool::SL_ProcessorPool(unsigned numThreads) noexcept :
     }
 
     clear_fragment_bins();
+    reset_thread_stats();
 }
 
 
@@ -88,6 +195,23 @@ SL_ProcessorPool::SL_ProcessorPool(const SL_ProcessorPool& p) noexcept :
     mBinsUsed{ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint32_t>>()},
     mFragBins{ls::utils::make_unique_aligned_array<SL_FragmentBin>(SL_SHADER_MAX_BINNED_PRIMS)},
     mFragQueues{ls::utils::make_unique_aligned_array<SL_FragCoord>(p.mNumThreads)},
+    mBinTiles{ls::utils::make_unique_aligned_pointer<SL_BinTileMap>()},
+    mVertChunks{ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint_fast64_t>>()},
+    mThreadStats{ls::utils::make_unique_aligned_array<SL_ThreadStats>(p.mNumThreads)},
+    mBatchFragSemaphore{nullptr},
+    mBatchShadingSemaphore{nullptr},
+    mBatchBinIds{nullptr},
+    mBatchTempBinIds{nullptr},
+    mBatchBinsUsed{nullptr},
+    mBatchFragBins{nullptr},
+    mBatchBinTiles{nullptr},
+    mBatchVertChunks{nullptr},
+    mRunExits{nullptr},
+    mRunsRetired{nullptr},
+    mBatchMeshes{},
+    mBatchCulls{},
+    mBatchRuns{},
+    mBatchShaders{},
     mWorkers{p.mNumThreads > 1 ? ls::utils::make_unique_aligned_array<SL_ProcessorPool::ThreadedWorker>(p.mNumThreads - 1) : nullptr},
     mNumThreads{p.mNumThreads}
 {
@@ -99,6 +223,7 @@ SL_ProcessorPool::SL_ProcessorPool(const SL_ProcessorPool& p) noexcept :
     }
 
     clear_fragment_bins();
+    reset_thread_stats();
 }
 
 
@@ -114,6 +239,23 @@ SL_ProcessorPool::SL_ProcessorPool(SL_ProcessorPool&& p) noexcept :
     mBinsUsed{std::move(p.mBinsUsed)},
     mFragBins{std::move(p.mFragBins)},
     mFragQueues{std::move(p.mFragQueues)},
+    mBinTiles{std::move(p.mBinTiles)},
+    mVertChunks{std::move(p.mVertChunks)},
+    mThreadStats{std::move(p.mThreadStats)},
+    mBatchFragSemaphore{std::move(p.mBatchFragSemaphore)},
+    mBatchShadingSemaphore{std::move(p.mBatchShadingSemaphore)},
+    mBatchBinIds{std::move(p.mBatchBinIds)},
+    mBatchTempBinIds{std::move(p.mBatchTempBinIds)},
+    mBatchBinsUsed{std::move(p.mBatchBinsUsed)},
+    mBatchFragBins{std::move(p.mBatchFragBins)},
+    mBatchBinTiles{std::move(p.mBatchBinTiles)},
+    mBatchVertChunks{std::move(p.mBatchVertChunks)},
+    mRunExits{std::move(p.mRunExits)},
+    mRunsRetired{std::move(p.mRunsRetired)},
+    mBatchMeshes{std::move(p.mBatchMeshes)},
+    mBatchCulls{std::move(p.mBatchCulls)},
+    mBatchRuns{std::move(p.mBatchRuns)},
+    mBatchShaders{std::move(p.mBatchShaders)},
     mWorkers{std::move(p.mWorkers)},
     mNumThreads{p.mNumThreads}
 {
@@ -156,6 +298,23 @@ SL_ProcessorPool& SL_ProcessorPool::operator=(SL_ProcessorPool&& p) noexcept
     mBinsUsed = std::move(p.mBinsUsed);
     mFragBins = std::move(p.mFragBins);
     mFragQueues = std::move(p.mFragQueues);
+    mBinTiles = std::move(p.mBinTiles);
+    mVertChunks = std::move(p.mVertChunks);
+    mThreadStats = std::move(p.mThreadStats);
+    mBatchFragSemaphore = std::move(p.mBatchFragSemaphore);
+    mBatchShadingSemaphore = std::move(p.mBatchShadingSemaphore);
+    mBatchBinIds = std::move(p.mBatchBinIds);
+    mBatchTempBinIds = std::move(p.mBatchTempBinIds);
+    mBatchBinsUsed = std::move(p.mBatchBinsUsed);
+    mBatchFragBins = std::move(p.mBatchFragBins);
+    mBatchBinTiles = std::move(p.mBatchBinTiles);
+    mBatchVertChunks = std::move(p.mBatchVertChunks);
+    mRunExits = std::move(p.mRunExits);
+    mRunsRetired = std::move(p.mRunsRetired);
+    mBatchMeshes = std::move(p.mBatchMeshes);
+    mBatchCulls = std::move(p.mBatchCulls);
+    mBatchRuns = std::move(p.mBatchRuns);
+    mBatchShaders = std::move(p.mBatchShaders);
 
     for (unsigned i = 0; i < mNumThreads-1u; ++i)
     {
@@ -258,6 +417,7 @@ unsigned SL_ProcessorPool::concurrency(unsigned inNumThreads) noexcept
     mBinsUsed = ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint32_t>>();
     mFragBins = ls::utils::make_unique_aligned_array<SL_FragmentBin>(SL_SHADER_MAX_BINNED_PRIMS);
     mFragQueues = ls::utils::make_unique_aligned_array<SL_FragCoord>(inNumThreads);
+    mThreadStats = ls::utils::make_unique_aligned_array<SL_ThreadStats>(inNumThreads);
 
     mWorkers.reset();
     if (inNumThreads > 1)
@@ -274,6 +434,7 @@ unsigned SL_ProcessorPool::concurrency(unsigned inNumThreads) noexcept
 
     mNumThreads = inNumThreads;
     clear_fragment_bins();
+    reset_thread_stats();
 
     LS_LOG_MSG(
         "Rendering threads updated:"
@@ -294,11 +455,12 @@ unsigned SL_ProcessorPool::concurrency(unsigned inNumThreads) noexcept
 
 /*-------------------------------------
 -------------------------------------*/
-void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh& m, size_t numInstances, const SL_Shader& s, SL_Framebuffer& fbo) noexcept
+void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh& m, size_t numInstances, const SL_Shader& s, SL_Framebuffer& fbo, const SL_MeshletCull* pCull) noexcept
 {
     // Reserve enough space for each thread to contain all triangles
     mFragSemaphore->count.store(0);
     mShadingSemaphore->count.store(mNumThreads);
+    mVertChunks->count.store(0);
     clear_fragment_bins();
 
     const SL_RenderMode renderMode = m.mode;
@@ -322,6 +484,11 @@ void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh&
     vertTask->mTempBinIds     = mTempBinIds.get();
     vertTask->mFragBins       = mFragBins.get();
     vertTask->mFragQueues     = mFragQueues.get();
+    vertTask->mBinTiles       = mBinTiles.get();
+    vertTask->mVertChunks     = mVertChunks.get();
+    vertTask->mThreadStats    = mThreadStats.get();
+    vertTask->mRebuildDepthTiles = 1;
+    vertTask->mMeshletCulls   = pCull ? &pCull : nullptr;
 
     // Divide all vertex processing amongst the available worker threads. Let
     // The threads work out between themselves how to partition the data.
@@ -350,11 +517,12 @@ void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh&
 
 /*-------------------------------------
 -------------------------------------*/
-void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh* meshes, size_t numMeshes, const SL_Shader& s, SL_Framebuffer& fbo) noexcept
+void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh* meshes, size_t numMeshes, const SL_Shader& s, SL_Framebuffer& fbo, const SL_MeshletCull* const* pCulls) noexcept
 {
     // Reserve enough space for each thread to contain all triangles
     mFragSemaphore->count.store(0);
     mShadingSemaphore->count.store(mNumThreads);
+    mVertChunks->count.store(0);
     clear_fragment_bins();
 
     const SL_RenderMode renderMode = meshes[0].mode;
@@ -378,6 +546,11 @@ void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh*
     vertTask->mTempBinIds     = mTempBinIds.get();
     vertTask->mFragBins       = mFragBins.get();
     vertTask->mFragQueues     = mFragQueues.get();
+    vertTask->mBinTiles       = mBinTiles.get();
+    vertTask->mVertChunks     = mVertChunks.get();
+    vertTask->mThreadStats    = mThreadStats.get();
+    vertTask->mRebuildDepthTiles = 1;
+    vertTask->mMeshletCulls   = pCulls;
 
     // Divide all vertex processing amongst the available worker threads. Let
     // The threads work out between themselves how to partition the data.
@@ -404,6 +577,177 @@ void SL_ProcessorPool::run_shader_processors(const SL_Context& c, const SL_Mesh*
 
 
 
+
+/*-------------------------------------
+ * Allocate the secondary bins used for batched draws
+-------------------------------------*/
+void SL_ProcessorPool::allocate_batch_bins() noexcept
+{
+    mBatchFragSemaphore = ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<int_fast64_t>>();
+    mBatchShadingSemaphore = ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint_fast64_t>>();
+    mBatchBinIds = ls::utils::make_unique_aligned_array<SL_BinCounter<uint32_t>>(SL_SHADER_MAX_BINNED_PRIMS);
+    mBatchTempBinIds = ls::utils::make_unique_aligned_array<SL_BinCounter<uint32_t>>(SL_SHADER_MAX_BINNED_PRIMS);
+    mBatchBinsUsed = ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint32_t>>();
+    mBatchFragBins = ls::utils::make_unique_aligned_array<SL_FragmentBin>(SL_SHADER_MAX_BINNED_PRIMS);
+    mBatchBinTiles = ls::utils::make_unique_aligned_pointer<SL_BinTileMap>();
+    mBatchVertChunks = ls::utils::make_unique_aligned_pointer<SL_BinCounterAtomic<uint_fast64_t>>();
+    mRunExits = ls::utils::make_unique_aligned_array<SL_BinCounterAtomic<uint32_t>>(2);
+    mRunsRetired = ls::utils::make_unique_aligned_array<SL_BinCounterAtomic<uint32_t>>(2);
+}
+
+
+
+/*-------------------------------------
+ * Execute a batch of draws, overlapping the vertex processing of each draw
+ * with fragment processing of the draw before it.
+-------------------------------------*/
+void SL_ProcessorPool::run_shader_batch(const SL_Context& c, const SL_DrawCommand* draws, size_t numDraws, const SL_Shader* shaders, SL_Framebuffer* fbos) noexcept
+{
+    if (!numDraws)
+    {
+        return;
+    }
+
+    if (numDraws == 1)
+    {
+        SL_Shader shader = shaders[draws->shaderId];
+        shader.pUniforms = const_cast<SL_UniformBuffer*>(_sl_draw_uniforms(*draws, shaders));
+
+        run_shader_processors(c, draws->mesh, draws->numInstances, shader, fbos[draws->fboId], draws->pCull);
+        return;
+    }
+
+    if (!mBatchFragBins)
+    {
+        allocate_batch_bins();
+    }
+
+    // Consecutive draws with identical state are merged into a single run,
+    // the same as a call to draw_multiple(). Mesh & shader storage must not
+    // be reallocated while runs reference it.
+    mBatchMeshes.clear();
+    mBatchCulls.clear();
+    mBatchRuns.clear();
+    mBatchShaders.clear();
+    mBatchMeshes.reserve(numDraws);
+    mBatchCulls.reserve(numDraws);
+    mBatchShaders.reserve(numDraws);
+
+    for (size_t i = 0; i < numDraws; ++i)
+    {
+        const SL_DrawCommand& draw    = draws[i];
+        const SL_Shader*      pShader = shaders + draw.shaderId;
+        SL_Framebuffer*       pFbo    = fbos + draw.fboId;
+
+        mBatchMeshes.push_back(draw.mesh);
+        mBatchCulls.push_back(draw.pCull);
+
+        if (i && _sl_can_merge_draws(mBatchRuns.back(), draws[i-1u], draw, shaders))
+        {
+            mBatchRuns.back().numMeshes++;
+            continue;
+        }
+
+        // Shaders read uniforms through their own pointer. Runs which use a
+        // snapshot of the uniforms are given a copy of the shader instead.
+        if (draw.pUniforms && draw.pUniforms != pShader->pUniforms)
+        {
+            mBatchShaders.push_back(*pShader);
+            mBatchShaders.back().pUniforms = const_cast<SL_UniformBuffer*>(draw.pUniforms);
+            pShader = &mBatchShaders.back();
+        }
+
+        SL_DrawRun run;
+        run.pShader         = pShader;
+        run.pFbo            = pFbo;
+        run.pMeshes         = &mBatchMeshes.back();
+        run.pCulls          = &mBatchCulls.back();
+        run.numMeshes       = 1;
+        run.numInstances    = draw.numInstances;
+        run.mode            = draw.mesh.mode;
+        run.waitForPrevious = mBatchRuns.empty() ? 0u : _sl_must_serialize_runs(mBatchRuns.back(), run);
+
+        mBatchRuns.push_back(run);
+    }
+
+    mFragSemaphore->count.store(0);
+    mShadingSemaphore->count.store(mNumThreads);
+    mVertChunks->count.store(0);
+    clear_fragment_bins();
+
+    mBatchFragSemaphore->count.store(0);
+    mBatchShadingSemaphore->count.store(mNumThreads);
+    mBatchVertChunks->count.store(0);
+    mBatchBinsUsed->count.store(0);
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        mRunExits[i].count.store(0);
+        mRunsRetired[i].count.store(0);
+    }
+
+    const SL_BinSet binSets[2] = {
+        {
+            mFragSemaphore.get(),
+            mShadingSemaphore.get(),
+            mBinsUsed.get(),
+            mBinIds.get(),
+            mTempBinIds.get(),
+            mFragBins.get(),
+            mBinTiles.get(),
+            mVertChunks.get(),
+            &mRunExits[0],
+            &mRunsRetired[0]
+        },
+        {
+            mBatchFragSemaphore.get(),
+            mBatchShadingSemaphore.get(),
+            mBatchBinsUsed.get(),
+            mBatchBinIds.get(),
+            mBatchTempBinIds.get(),
+            mBatchFragBins.get(),
+            mBatchBinTiles.get(),
+            mBatchVertChunks.get(),
+            &mRunExits[1],
+            &mRunsRetired[1]
+        }
+    };
+
+    SL_ShaderProcessor task;
+    task.mType = SL_BATCH_PROCESSOR;
+
+    SL_BatchProcessor& batch = task.mBatch;
+    batch.mThreadId   = 0;
+    batch.mNumThreads = (uint16_t)mNumThreads;
+    batch.mContext    = &c;
+    batch.mRuns       = mBatchRuns.data();
+    batch.mNumRuns    = mBatchRuns.size();
+    batch.mBinSets    = binSets;
+    batch.mFragQueues = mFragQueues.get();
+    batch.mStats      = mThreadStats.get();
+
+    // Every thread processes all runs in order. Threads only synchronize
+    // within a run, or when a run depends on the one before it.
+    for (uint16_t threadId = 0; threadId < mNumThreads; ++threadId)
+    {
+        batch.mThreadId = threadId;
+
+        if (threadId < mNumThreads-1)
+        {
+            SL_ProcessorPool::ThreadedWorker& worker = mWorkers[threadId];
+            worker.busy_waiting(false);
+            worker.push(task);
+        }
+    }
+
+    flush();
+    task();
+
+    // Each thread should now pause except for the main thread.
+    wait();
+}
+
+
 /*-------------------------------------
  * Remove all bins from potential processing
 -------------------------------------*/
@@ -413,6 +757,19 @@ void SL_ProcessorPool::clear_fragment_bins() noexcept
 }
 
 
+
+/*-------------------------------------
+ * Reset the per-thread load-balancing statistics
+-------------------------------------*/
+void SL_ProcessorPool::reset_thread_stats() noexcept
+{
+    for (unsigned i = 0; i < mNumThreads; ++i)
+    {
+        sl_thread_stats_reset(mThreadStats[i]);
+    }
+}
+
+
 /*-------------------------------------
  * Execute a texture blit across threads
 -------------------------------------*/
@@ -426,7 +783,9 @@ void SL_ProcessorPool::run_blit_processors(
     uint16_t dstX0,
     uint16_t dstY0,
     uint16_t dstX1,
-    uint16_t dstY1) noexcept
+    uint16_t dstY1,
+    bool srcIsAttachment,
+    bool dstIsAttachment) noexcept
 {
     SL_ShaderProcessor processor;
     LS_ASSERT(!sl_is_compressed_color(inTex->type) && !sl_is_compressed_color(outTex->type));
@@ -445,6 +804,8 @@ void SL_ProcessorPool::run_blit_processors(
     blitter.dstY1       = dstY1;
     blitter.mSrcTex     = inTex;
     blitter.mDstTex     = outTex;
+    blitter.mSrcTiled   = srcIsAttachment ? 1u : 0u;
+    blitter.mDstTiled   = dstIsAttachment ? 1u : 0u;
 
     // Process most of the rendering on other threads first.
     for (uint16_t threadId = 0; threadId < mNumThreads - 1; ++threadId)
@@ -478,7 +839,9 @@ void SL_ProcessorPool::run_blit_compressed_processors(
     uint16_t dstX0,
     uint16_t dstY0,
     uint16_t dstX1,
-    uint16_t dstY1) noexcept
+    uint16_t dstY1,
+    bool srcIsAttachment,
+    bool dstIsAttachment) noexcept
 {
     SL_ShaderProcessor processor;
     LS_ASSERT(sl_is_compressed_color(inTex->type) || sl_is_compressed_color(outTex->type));
@@ -497,6 +860,8 @@ void SL_ProcessorPool::run_blit_compressed_processors(
     blitter.dstY1       = dstY1;
     blitter.mSrcTex     = inTex;
     blitter.mDstTex     = outTex;
+    blitter.mSrcTiled   = srcIsAttachment ? 1u : 0u;
+    blitter.mDstTiled   = dstIsAttachment ? 1u : 0u;
 
     // Process most of the rendering on other threads first.
     for (uint16_t threadId = 0; threadId < mNumThreads - 1; ++threadId)
@@ -781,3 +1146,131 @@ void SL_ProcessorPool::run_clear_processors(const std::array<const void*, 4>& in
     // Each thread should now pause except for the main thread.
     wait();
 }
+
+
+
+/*-------------------------------------
+ * Generate all mip levels of a texture across threads
+-------------------------------------*/
+void SL_ProcessorPool::run_mipmap_processors(SL_Texture& tex, SL_TexelOrder order) noexcept
+{
+    SL_ShaderProcessor processor;
+    processor.mType = SL_MIPMAP_PROCESSOR;
+
+    SL_MipmapProcessor& mipmapper = processor.mMipmap;
+    mipmapper.mTexelOrder = order;
+
+    // Each level depends on the one before it, so the threads must be
+    // synchronized between levels.
+    for (uint32_t level = 1; level < tex.num_levels(); ++level)
+    {
+        mipmapper.mSrcTex = &tex.level_view(level-1u);
+        mipmapper.mDstTex = &tex.level_view(level);
+
+        // Small levels aren't worth the cost of waking the worker threads
+        if (mipmapper.mDstTex->height < mNumThreads)
+        {
+            mipmapper.mThreadId   = 0;
+            mipmapper.mNumThreads = 1;
+            mipmapper.execute();
+            continue;
+        }
+
+        mipmapper.mNumThreads = (uint16_t)mNumThreads;
+
+        // Process most of the rows on other threads first.
+        for (uint16_t threadId = 0; threadId < mNumThreads - 1; ++threadId)
+        {
+            mipmapper.mThreadId = threadId;
+
+            SL_ProcessorPool::ThreadedWorker& worker = mWorkers[threadId];
+            worker.busy_waiting(false);
+            worker.push(processor);
+        }
+
+        flush();
+        mipmapper.mThreadId = (uint16_t)(mNumThreads - 1u);
+        mipmapper.execute();
+
+        // Each thread should now pause except for the main thread.
+        wait();
+    }
+}
+
+
+
+/*-------------------------------------
+ * Convert and copy texels into a texture across threads
+-------------------------------------*/
+void SL_ProcessorPool::run_texture_upload_processors(const void* pTexels, SL_ColorDataType srcType, SL_TextureView& outTex, SL_TexelOrder order) noexcept
+{
+    SL_ShaderProcessor processor;
+    processor.mType = SL_TEXTURE_UPLOAD_PROCESSOR;
+
+    SL_TextureUploadProcessor& uploader = processor.mTexUpload;
+    uploader.mTexelOrder = order;
+    uploader.mSrcType    = srcType;
+    uploader.mSrcTexels  = reinterpret_cast<const char*>(pTexels);
+    uploader.mDstTex     = &outTex;
+
+    // Small textures aren't worth the cost of waking the worker threads
+    const uint_fast32_t numBands = ((outTex.height + (SL_TEXELS_PER_CHUNK-1u)) >> SL_TEXEL_SHIFTS_PER_CHUNK) * outTex.depth;
+    if (numBands < mNumThreads)
+    {
+        uploader.mThreadId   = 0;
+        uploader.mNumThreads = 1;
+        uploader.execute();
+        return;
+    }
+
+    uploader.mNumThreads = (uint16_t)mNumThreads;
+
+    // Process most of the texels on other threads first.
+    for (uint16_t threadId = 0; threadId < mNumThreads - 1; ++threadId)
+    {
+        uploader.mThreadId = threadId;
+
+        SL_ProcessorPool::ThreadedWorker& worker = mWorkers[threadId];
+        worker.busy_waiting(false);
+        worker.push(processor);
+    }
+
+    flush();
+    uploader.mThreadId = (uint16_t)(mNumThreads - 1u);
+    uploader.execute();
+
+    // Each thread should now pause except for the main thread.
+    wait();
+}
+
+
+
+/*-------------------------------------
+ * Run a user-defined task on all threads
+-------------------------------------*/
+void SL_ProcessorPool::run_task_processors(SL_TaskFunc task, void* pUserData) noexcept
+{
+    SL_ShaderProcessor processor;
+    processor.mType = SL_TASK_PROCESSOR;
+
+    SL_TaskProcessor& taskRunner = processor.mTask;
+    taskRunner.mNumThreads = (uint16_t)mNumThreads;
+    taskRunner.mTask       = task;
+    taskRunner.mUserData   = pUserData;
+
+    for (uint16_t threadId = 0; threadId < mNumThreads - 1; ++threadId)
+    {
+        taskRunner.mThreadId = threadId;
+
+        SL_ProcessorPool::ThreadedWorker& worker = mWorkers[threadId];
+        worker.busy_waiting(false);
+        worker.push(processor);
+    }
+
+    flush();
+    taskRunner.mThreadId = (uint16_t)(mNumThreads - 1u);
+    taskRunner.execute();
+
+    // Each thread should now pause except for the main thread.
+    wait();
+}
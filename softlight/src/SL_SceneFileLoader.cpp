@@ -12,9 +12,10 @@
 
 #include "softlight/SL_BoundingBox.hpp"
 #include "softlight/SL_Camera.hpp"
-#include "softlight/SL_Config.hpp" // SL_VERTEX_CACHING_ENABLED
+#include "softlight/SL_Config.hpp" // SL_VERTEX_CACHING_ENABLED, SL_ANIM_CLIP_SAMPLE_RATE
 #include "softlight/SL_ImgFile.hpp"
 #include "softlight/SL_IndexBuffer.hpp"
+#include "softlight/SL_MeshOptimizer.hpp"
 #include "softlight/SL_SceneFileLoader.hpp"
 #include "softlight/SL_SceneFileUtility.hpp"
 #include "softlight/SL_Texture.hpp"
@@ -140,6 +141,9 @@ SL_SceneLoadOpts sl_default_scene_load_opts() noexcept
     opts.genSmoothNormals = true;
     opts.genTangents = false;
     opts.swizzleTexels = false;
+    opts.optimizeMeshes = false;
+    opts.packAnimations = false;
+    opts.quantizeAnimations = false;
 
     return opts;
 }
@@ -1091,9 +1095,9 @@ SL_Texture* SL_SceneFileLoader::load_texture_at_path(const std::string& path, SL
     const size_t loadedTexture = graph.mContext.create_texture();
     SL_Texture& t = graph.mContext.texture(loadedTexture);
 
+    // Textures are swizzled across all of the context's threads
     SL_TexelOrder texelOrder = mPreloader.mLoadOpts.swizzleTexels ? SL_TexelOrder::SWIZZLED : SL_TexelOrder::ORDERED;
-    //if (t.init(imgLoader, SL_TexelOrder::ORDERED) != 0)
-    if (t.init(imgLoader, texelOrder) != 0)
+    if (graph.mContext.upload_texture(loadedTexture, imgLoader, texelOrder) != 0)
     {
         graph.mContext.destroy_texture(loadedTexture);
         return nullptr;
@@ -1123,6 +1127,9 @@ bool SL_SceneFileLoader::import_mesh_data(const aiScene* const pScene, const SL_
     size_t                            baseIndex    = 0;
     char* const                       pVbo         = reinterpret_cast<char*>(vbo.data());
     char*                             pIbo         = reinterpret_cast<char*>(ibo.data());
+    size_t                            numOptTris   = 0;
+    double                            acmrBefore   = 0.0;
+    double                            acmrAfter    = 0.0;
 
     // vertex data in ASSIMP is not interleaved. It has to be converted into
     // the internally used vertex format which is recommended for use on mobile
@@ -1156,12 +1163,42 @@ bool SL_SceneFileLoader::import_mesh_data(const aiScene* const pScene, const SL_
         // increment the mesh offset for the next mesh
         meshGroup.meshOffset += sl_vertex_stride(meshGroup.vertType) * pMesh->mNumVertices;
         pIbo = upload_mesh_indices(pMesh, pIbo, baseIndex, meshGroup.baseVert, mesh, numIndices);
+
+        // Vertex positions are needed to sort triangles by overdraw
+        if (opts.optimizeMeshes && (vertType & SL_CommonVertType::POSITION_VERTEX))
+        {
+            SL_MeshOptimizerStats stats;
+            const int optResult = sl_optimize_mesh(
+                mesh, ibo, vbo,
+                meshOffset,
+                meshGroup.baseVert,
+                pMesh->mNumVertices,
+                sl_vertex_stride(vertType),
+                &stats);
+
+            if (optResult == 0)
+            {
+                const size_t numTris = numIndices / 3u;
+                acmrBefore += (double)stats.acmrBefore * (double)numTris;
+                acmrAfter  += (double)stats.acmrAfter * (double)numTris;
+                numOptTris += numTris;
+            }
+        }
+
         meshGroup.baseVert += pMesh->mNumVertices;
         baseIndex += numIndices;
 
         sl_update_mesh_bounds(pMesh, box);
     }
 
+    if (numOptTris)
+    {
+        LS_LOG_MSG(
+            "\t\tOptimized ", numOptTris, " triangles.",
+            "\n\t\t\tACMR Before: ", acmrBefore / (double)numOptTris,
+            "\n\t\t\tACMR After:  ", acmrAfter / (double)numOptTris);
+    }
+
     LS_LOG_MSG("\t\tDone.");
 
     return true;
@@ -1620,6 +1657,8 @@ bool SL_SceneFileLoader::import_animations(const aiScene* const pScene) noexcept
 
     SL_AlignedVector<SL_AlignedVector<SL_AnimationChannel>>& allChannels = graph.mNodeAnims;
 
+    const SL_SceneLoadOpts&         opts                       = mPreloader.mLoadOpts;
+
     std::unordered_map<size_t, size_t> nodesToAnimChannels;
 
     for (unsigned i = 0; i < totalAnimations; ++i)
@@ -1666,12 +1705,18 @@ bool SL_SceneFileLoader::import_animations(const aiScene* const pScene) noexcept
             anim.add_channel(nodesToAnimChannels[nodeId], nodeChannels.size() - 1, nodeId);
         }
 
+        if (opts.packAnimations && anim.pack(graph, SL_ANIM_CLIP_SAMPLE_RATE, opts.quantizeAnimations) != 0)
+        {
+            LS_LOG_ERR("\tWarning: Unable to pack the animation \"", anim.name(), "\".");
+        }
+
         std::cout
             << "\tLoaded Animation " << i+1 << '/' << totalAnimations
             << "\n\t\tName:      " << anim.name()
             << "\n\t\tDuration:  " << anim.duration()
             << "\n\t\tTicks/Sec: " << anim.ticks_per_sec()
             << "\n\t\tChannels:  " << anim.size()
+            << "\n\t\tPacked:    " << (anim.clip().valid() ? (anim.clip().quantized() ? "Quantized" : "Yes") : "No")
             << std::endl;
     }
 
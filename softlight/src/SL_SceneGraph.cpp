@@ -53,6 +53,25 @@ void rotate_right(RandomIter nums, size_t size, size_t numRotations)
 
 
 
+/*-------------------------------------
+ * Depths with fewer nodes than this are updated on the calling thread
+-------------------------------------*/
+constexpr size_t SL_SCENE_GRAPH_MIN_PARALLEL_NODES = 256;
+
+
+
+/*-------------------------------------
+ * Nodes at a single depth, shared between threads
+-------------------------------------*/
+struct _SL_SceneUpdateTask
+{
+    SL_SceneGraph* pGraph;
+    const size_t* pNodeIds;
+    size_t numNodes;
+};
+
+
+
 } // end anonymous namespace
 
 
@@ -90,7 +109,11 @@ SL_SceneGraph::SL_SceneGraph() noexcept :
     mBoneOffsets(),
     mCameras(),
     mAnimations(),
-    mNodeAnims()
+    mNodeAnims(),
+    mDirtyRanges(),
+    mNodeDepths(),
+    mUpdateNodes(),
+    mUpdateLevels()
 {}
 
 
@@ -213,6 +236,10 @@ void SL_SceneGraph::terminate() noexcept
     mCameras.clear();
     mAnimations.clear();
     mNodeAnims.clear();
+    mDirtyRanges.clear();
+    mNodeDepths.clear();
+    mUpdateNodes.clear();
+    mUpdateLevels.clear();
 }
 
 
@@ -253,6 +280,26 @@ void SL_SceneGraph::update_node_transform(const size_t transformId) noexcept
 
 
 
+/*-------------------------------------
+ * Update a thread's share of a single depth
+-------------------------------------*/
+void SL_SceneGraph::update_transforms_task(void* pUserData, uint32_t threadId, uint32_t numThreads) noexcept
+{
+    const _SL_SceneUpdateTask* const pTask = reinterpret_cast<const _SL_SceneUpdateTask*>(pUserData);
+    SL_SceneGraph* const pGraph = pTask->pGraph;
+
+    // Contiguous partitions keep each thread's model matrices together
+    const size_t begin = (pTask->numNodes * threadId) / numThreads;
+    const size_t end   = (pTask->numNodes * (threadId+1u)) / numThreads;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        pGraph->update_node_transform(pTask->pNodeIds[i]);
+    }
+}
+
+
+
 /*-------------------------------------
  * Scene Updating
 -------------------------------------*/
@@ -263,29 +310,93 @@ void SL_SceneGraph::update() noexcept
     // If the child node is less than the parent node's ID, we have ourselves
     // a good-old-fashioned bug.
     const size_t numNodes = mCurrentTransforms.size();
-    std::size_t* const pParentIds = mNodeParentIds.data();
-    SL_Transform* const pTransforms = mCurrentTransforms.data();
+    const std::size_t* const pParentIds = mNodeParentIds.data();
+    const SL_Transform* const pTransforms = mCurrentTransforms.data();
 
-    for (size_t i = 0; i < numNodes; ++i)
+    mDirtyRanges.clear();
+    mUpdateLevels.clear();
+    mNodeDepths.resize(numNodes);
+
+    size_t* const pDepths = mNodeDepths.data();
+    size_t numDirty = 0;
+
+    // Children are grouped sequentially after their parents, so a dirty node
+    // and all of its children form a single range. Everything in the range
+    // must be updated.
+    for (size_t i = 0; i < numNodes;)
     {
-        // If a parent node is dirty, update all child nodes, iteratively
-        if (pTransforms[i].is_dirty())
+        if (!pTransforms[i].is_dirty())
         {
-            update_node_transform(i);
+            ++i;
+            continue;
+        }
+
+        size_t end = i + 1;
+        pDepths[i] = 0;
+
+        while (end < numNodes && pParentIds[end] != SCENE_NODE_ROOT_ID && pParentIds[end] >= i)
+        {
+            pDepths[end] = pDepths[pParentIds[end]] + 1u;
+            ++end;
+        }
 
-            for (size_t j = i+1; j < numNodes; ++j)
+        // Count the nodes at each depth, offset by two so the counts can be
+        // turned into the end of each depth in-place.
+        for (size_t j = i; j < end; ++j)
+        {
+            if (mUpdateLevels.size() < pDepths[j] + 3u)
             {
-                if (pParentIds[j] < i)
-                {
-                    i = j-1;
-                    break;
-                }
-                else
+                mUpdateLevels.resize(pDepths[j] + 3u, 0);
+            }
+
+            ++mUpdateLevels[pDepths[j] + 2u];
+        }
+
+        mDirtyRanges.emplace_back(i, end);
+        numDirty += end - i;
+        i = end;
+    }
+
+    if (numDirty)
+    {
+        for (size_t d = 1; d < mUpdateLevels.size(); ++d)
+        {
+            mUpdateLevels[d] += mUpdateLevels[d-1u];
+        }
+
+        // Bucket nodes by depth, keeping them sorted by ID within each depth
+        mUpdateNodes.resize(numDirty);
+
+        for (const std::pair<size_t, size_t>& range : mDirtyRanges)
+        {
+            for (size_t j = range.first; j < range.second; ++j)
+            {
+                mUpdateNodes[mUpdateLevels[pDepths[j] + 1u]++] = j;
+            }
+        }
+
+        // Nodes at the same depth only depend on their parents, which were
+        // updated at the previous depth.
+        const size_t numLevels = mUpdateLevels.size() - 2u;
+        const bool   useTasks  = mContext.num_threads() > 1;
+
+        for (size_t d = 0; d < numLevels; ++d)
+        {
+            const size_t begin = mUpdateLevels[d];
+            const size_t end   = mUpdateLevels[d+1u];
+
+            if (!useTasks || (end - begin) < SL_SCENE_GRAPH_MIN_PARALLEL_NODES)
+            {
+                for (size_t j = begin; j < end; ++j)
                 {
-                    // force an update to the child node.
-                    update_node_transform(j);
+                    update_node_transform(mUpdateNodes[j]);
                 }
             }
+            else
+            {
+                _SL_SceneUpdateTask task{this, mUpdateNodes.data() + begin, end - begin};
+                mContext.run_tasks(&SL_SceneGraph::update_transforms_task, &task);
+            }
         }
     }
 
@@ -87,6 +87,22 @@ SL_ShaderProcessor::SL_ShaderProcessor(const SL_ShaderProcessor& sp) noexcept :
         case SL_CLEAR_PROCESSOR:
             mClear = sp.mClear;
             break;
+
+        case SL_MIPMAP_PROCESSOR:
+            mMipmap = sp.mMipmap;
+            break;
+
+        case SL_TEXTURE_UPLOAD_PROCESSOR:
+            mTexUpload = sp.mTexUpload;
+            break;
+
+        case SL_TASK_PROCESSOR:
+            mTask = sp.mTask;
+            break;
+
+        case SL_BATCH_PROCESSOR:
+            mBatch = sp.mBatch;
+            break;
     }
 }
 
@@ -123,6 +139,22 @@ SL_ShaderProcessor::SL_ShaderProcessor(SL_ShaderProcessor&& sp) noexcept :
         case SL_CLEAR_PROCESSOR:
             mClear = sp.mClear;
             break;
+
+        case SL_MIPMAP_PROCESSOR:
+            mMipmap = sp.mMipmap;
+            break;
+
+        case SL_TEXTURE_UPLOAD_PROCESSOR:
+            mTexUpload = sp.mTexUpload;
+            break;
+
+        case SL_TASK_PROCESSOR:
+            mTask = sp.mTask;
+            break;
+
+        case SL_BATCH_PROCESSOR:
+            mBatch = sp.mBatch;
+            break;
     }
 }
 
@@ -162,6 +194,22 @@ SL_ShaderProcessor& SL_ShaderProcessor::operator=(const SL_ShaderProcessor& sp)
             case SL_CLEAR_PROCESSOR:
                 mClear = sp.mClear;
                 break;
+
+            case SL_MIPMAP_PROCESSOR:
+                mMipmap = sp.mMipmap;
+                break;
+
+            case SL_TEXTURE_UPLOAD_PROCESSOR:
+                mTexUpload = sp.mTexUpload;
+                break;
+
+            case SL_TASK_PROCESSOR:
+                mTask = sp.mTask;
+                break;
+
+            case SL_BATCH_PROCESSOR:
+                mBatch = sp.mBatch;
+                break;
         }
     }
 
@@ -204,6 +252,22 @@ SL_ShaderProcessor& SL_ShaderProcessor::operator=(SL_ShaderProcessor&& sp) noexc
             case SL_CLEAR_PROCESSOR:
                 mClear = sp.mClear;
                 break;
+
+            case SL_MIPMAP_PROCESSOR:
+                mMipmap = sp.mMipmap;
+                break;
+
+            case SL_TEXTURE_UPLOAD_PROCESSOR:
+                mTexUpload = sp.mTexUpload;
+                break;
+
+            case SL_TASK_PROCESSOR:
+                mTask = sp.mTask;
+                break;
+
+            case SL_BATCH_PROCESSOR:
+                mBatch = sp.mBatch;
+                break;
         }
     }
 
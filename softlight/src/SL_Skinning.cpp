@@ -0,0 +1,535 @@
+
+#include <limits> // std::numeric_limits
+#include <vector>
+
+#include "lightsky/utils/Assertions.h"
+
+#include "lightsky/math/half.h"
+#include "lightsky/math/mat3.h"
+#include "lightsky/math/quat.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Geometry.hpp"
+#include "softlight/SL_IndexBuffer.hpp"
+#include "softlight/SL_PackedVertex.hpp"
+#include "softlight/SL_Skinning.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Meshes with fewer vertices are cheaper to skin on a single thread
+-------------------------------------*/
+constexpr size_t SL_SKINNING_MIN_PARALLEL_VERTS = 1024;
+
+
+
+/*-------------------------------------
+ * Mesh data shared between threads
+-------------------------------------*/
+struct _SL_SkinningTask
+{
+    const SL_SkinnedMesh* pMesh;
+    const SL_VertexArray* pSrcVao;
+    const SL_VertexArray* pDstVao;
+    const SL_VertexBuffer* pSrcVbo;
+    SL_VertexBuffer* pDstVbo;
+    const math::mat4* pBones;
+    const math::vec4* pDualQuats; // real/dual pairs, dual-quaternion mode only
+    size_t numBones;
+};
+
+
+
+/*-------------------------------------
+ * Convert a rigid bone matrix into a dual quaternion
+-------------------------------------*/
+inline math::vec4 _sl_bone_dual_quat(const math::mat4& m, math::vec4& outDual) noexcept
+{
+    // Strip any scaling so the rotation extracts cleanly
+    math::mat3 r3 = math::mat3{m};
+    r3[0] = math::normalize(r3[0]);
+    r3[1] = math::normalize(r3[1]);
+    r3[2] = math::normalize(r3[2]);
+
+    const math::quat&& q  = math::mat_to_quat(r3);
+    const math::vec4   r  = math::vec4{q[0], q[1], q[2], q[3]};
+    const math::vec3&& rv = math::vec3_cast(r);
+    const math::vec3&& t  = math::vec3_cast(m[3]);
+
+    // dual = 0.5 * (t, 0) * real
+    const math::vec3&& dv = (t * r[3] + math::cross(t, rv)) * 0.5f;
+    outDual = math::vec4{dv[0], dv[1], dv[2], -0.5f * math::dot(t, rv)};
+
+    return r;
+}
+
+
+
+/*-------------------------------------
+ * Blend the bones of a single vertex as a matrix
+-------------------------------------*/
+template <typename id_type>
+inline math::mat4 _sl_blend_bones(
+    const math::mat4* pBones,
+    const math::vec4_t<id_type>& ids,
+    const math::vec4& weights) noexcept
+{
+    math::mat4 m = pBones[ids[0]] * weights[0];
+
+    for (unsigned k = 1; k < SL_BONE_MAX_WEIGHTS; ++k)
+    {
+        if (weights[k] != 0.f)
+        {
+            m = m + pBones[ids[k]] * weights[k];
+        }
+    }
+
+    return m;
+}
+
+
+
+/*-------------------------------------
+ * Blend the bones of a single vertex as a dual quaternion
+-------------------------------------*/
+template <typename id_type>
+inline void _sl_blend_dual_quats(
+    const math::vec4* pDualQuats,
+    const math::vec4_t<id_type>& ids,
+    const math::vec4& weights,
+    math::vec4& outReal,
+    math::vec4& outDual) noexcept
+{
+    const math::vec4& r0 = pDualQuats[ids[0]*2u];
+    math::vec4 real = r0 * weights[0];
+    math::vec4 dual = pDualQuats[ids[0]*2u+1u] * weights[0];
+
+    for (unsigned k = 1; k < SL_BONE_MAX_WEIGHTS; ++k)
+    {
+        if (weights[k] == 0.f)
+        {
+            continue;
+        }
+
+        // keep all rotations in the same hemisphere as the first bone
+        const math::vec4& rk = pDualQuats[ids[k]*2u];
+        const float w = math::dot(r0, rk) < 0.f ? -weights[k] : weights[k];
+
+        real = math::fmadd(rk, math::vec4{w}, real);
+        dual = math::fmadd(pDualQuats[ids[k]*2u+1u], math::vec4{w}, dual);
+    }
+
+    const math::vec4 invLen{math::inversesqrt(math::dot(real, real))};
+    outReal = real * invLen;
+    outDual = dual * invLen;
+}
+
+
+
+/*-------------------------------------
+ * Skin a range of vertices
+-------------------------------------*/
+template <typename id_type, typename weight_type, SL_SkinningMode mode>
+void _sl_skin_vertices(const _SL_SkinningTask& task, size_t begin, size_t end) noexcept
+{
+    const SL_SkinnedMesh& mesh   = *task.pMesh;
+    const SL_VertexArray& vao    = *task.pSrcVao;
+    const SL_VertexArray& dstVao = *task.pDstVao;
+    const SL_VertexBuffer& src   = *task.pSrcVbo;
+    SL_VertexBuffer& dst         = *task.pDstVbo;
+    const bool haveNormals       = mesh.normalBinding != SL_SKINNING_NO_BINDING;
+    const bool packedNormals     = haveNormals && vao.type(mesh.normalBinding) == VERTEX_DATA_INT;
+
+    for (size_t v = begin; v < end; ++v)
+    {
+        const ptrdiff_t posOffset = vao.offset(mesh.positionBinding, v);
+        const ptrdiff_t normOffset = haveNormals ? vao.offset(mesh.normalBinding, v) : 0;
+        const ptrdiff_t dstPosOffset = dstVao.offset(mesh.positionBinding, v);
+        const ptrdiff_t dstNormOffset = haveNormals ? dstVao.offset(mesh.normalBinding, v) : 0;
+
+        const math::vec4_t<id_type>& ids = *src.element<const math::vec4_t<id_type>>(vao.offset(mesh.boneIdBinding, v));
+        const math::vec4&& weights = (math::vec4)(*src.element<const math::vec4_t<weight_type>>(vao.offset(mesh.boneWeightBinding, v)));
+        const math::vec3& pos = *src.element<const math::vec3>(posOffset);
+
+        math::vec3 norm{0.f};
+        if (haveNormals)
+        {
+            norm = packedNormals
+                ? sl_unpack_vertex_vec3(*src.element<const int32_t>(normOffset))
+                : *src.element<const math::vec3>(normOffset);
+        }
+
+        math::vec3 skinnedPos;
+        math::vec3 skinnedNorm;
+
+        if (mode == SL_SKINNING_DUAL_QUATERNION)
+        {
+            math::vec4 real, dual;
+            _sl_blend_dual_quats<id_type>(task.pDualQuats, ids, weights, real, dual);
+
+            const math::vec3&& rv = math::vec3_cast(real);
+            const math::vec3&& dv = math::vec3_cast(dual);
+            const float rw = real[3];
+            const float dw = dual[3];
+
+            const math::vec3&& translation = (dv * rw - rv * dw + math::cross(rv, dv)) * 2.f;
+            skinnedPos  = pos + math::cross(rv, math::cross(rv, pos) + pos * rw) * 2.f + translation;
+            skinnedNorm = norm + math::cross(rv, math::cross(rv, norm) + norm * rw) * 2.f;
+        }
+        else
+        {
+            const math::mat4&& m = _sl_blend_bones<id_type>(task.pBones, ids, weights);
+            skinnedPos  = math::vec3_cast(m * math::vec4{pos[0], pos[1], pos[2], 1.f});
+            skinnedNorm = math::vec3_cast(m * math::vec4{norm[0], norm[1], norm[2], 0.f});
+        }
+
+        *dst.element<math::vec3>(dstPosOffset) = skinnedPos;
+
+        if (haveNormals)
+        {
+            skinnedNorm = math::normalize(skinnedNorm);
+
+            if (packedNormals)
+            {
+                *dst.element<int32_t>(dstNormOffset) = sl_pack_vertex_2_10_10_10(skinnedNorm);
+            }
+            else
+            {
+                *dst.element<math::vec3>(dstNormOffset) = skinnedNorm;
+            }
+        }
+    }
+}
+
+
+
+/*-------------------------------------
+ * Select the vertex formats of a mesh
+-------------------------------------*/
+template <SL_SkinningMode mode>
+inline void _sl_skin_vertex_range(const _SL_SkinningTask& task, size_t begin, size_t end) noexcept
+{
+    const SL_VertexArray& vao = *task.pSrcVao;
+    const bool shortIds = vao.type(task.pMesh->boneIdBinding) == VERTEX_DATA_SHORT;
+    const bool halfWeights = vao.type(task.pMesh->boneWeightBinding) == VERTEX_DATA_SHORT;
+
+    if (shortIds)
+    {
+        if (halfWeights)
+        {
+            _sl_skin_vertices<uint16_t, math::half, mode>(task, begin, end);
+        }
+        else
+        {
+            _sl_skin_vertices<uint16_t, float, mode>(task, begin, end);
+        }
+    }
+    else
+    {
+        if (halfWeights)
+        {
+            _sl_skin_vertices<uint32_t, math::half, mode>(task, begin, end);
+        }
+        else
+        {
+            _sl_skin_vertices<uint32_t, float, mode>(task, begin, end);
+        }
+    }
+}
+
+
+
+/*-------------------------------------
+ * Skin a contiguous range of vertices on each thread
+-------------------------------------*/
+void _sl_skin_mesh_task(void* pUserData, uint32_t threadId, uint32_t numThreads) noexcept
+{
+    const _SL_SkinningTask* const pTask = reinterpret_cast<const _SL_SkinningTask*>(pUserData);
+    const size_t vertBegin = pTask->pMesh->vertBegin;
+    const size_t numVerts = pTask->pMesh->vertEnd - vertBegin;
+
+    const size_t begin = vertBegin + (numVerts * threadId) / numThreads;
+    const size_t end   = vertBegin + (numVerts * (threadId+1u)) / numThreads;
+
+    if (begin >= end)
+    {
+        return;
+    }
+
+    if (pTask->pDualQuats)
+    {
+        _sl_skin_vertex_range<SL_SKINNING_DUAL_QUATERNION>(*pTask, begin, end);
+    }
+    else
+    {
+        _sl_skin_vertex_range<SL_SKINNING_LINEAR>(*pTask, begin, end);
+    }
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * CPU Skinning
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Create a skinned copy of a mesh
+-------------------------------------*/
+int sl_init_skinned_mesh(
+    SL_Context& context,
+    const SL_Mesh& srcMesh,
+    unsigned positionBinding,
+    unsigned normalBinding,
+    unsigned boneIdBinding,
+    unsigned boneWeightBinding,
+    SL_SkinnedMesh& outMesh) noexcept
+{
+    if (srcMesh.mode != RENDER_MODE_TRIANGLES && srcMesh.mode != RENDER_MODE_INDEXED_TRIANGLES)
+    {
+        return -1;
+    }
+
+    const SL_VertexArray& srcVao = context.vao(srcMesh.vaoId);
+    const size_t numBindings = srcVao.num_bindings();
+
+    if (positionBinding >= numBindings
+    || boneIdBinding >= numBindings
+    || boneWeightBinding >= numBindings
+    || (normalBinding != SL_SKINNING_NO_BINDING && normalBinding >= numBindings))
+    {
+        return -2;
+    }
+
+    if (srcVao.type(positionBinding) != VERTEX_DATA_FLOAT || srcVao.dimensions(positionBinding) < VERTEX_DIMENSION_3)
+    {
+        return -2;
+    }
+
+    if (normalBinding != SL_SKINNING_NO_BINDING)
+    {
+        const SL_DataType normType = srcVao.type(normalBinding);
+        const SL_Dimension normDims = srcVao.dimensions(normalBinding);
+
+        if (!(normType == VERTEX_DATA_FLOAT && normDims == VERTEX_DIMENSION_3)
+        && !(normType == VERTEX_DATA_INT && normDims == VERTEX_DIMENSION_1))
+        {
+            return -2;
+        }
+    }
+
+    const SL_DataType idType = srcVao.type(boneIdBinding);
+    const SL_DataType weightType = srcVao.type(boneWeightBinding);
+
+    if ((idType != VERTEX_DATA_SHORT && idType != VERTEX_DATA_INT) || srcVao.dimensions(boneIdBinding) != VERTEX_DIMENSION_4)
+    {
+        return -2;
+    }
+
+    if ((weightType != VERTEX_DATA_SHORT && weightType != VERTEX_DATA_FLOAT) || srcVao.dimensions(boneWeightBinding) != VERTEX_DIMENSION_4)
+    {
+        return -2;
+    }
+
+    // Only vertices referenced by the mesh need to be skinned
+    size_t vertBegin = srcMesh.elementBegin;
+    size_t vertEnd = srcMesh.elementEnd;
+
+    if (srcMesh.mode == RENDER_MODE_INDEXED_TRIANGLES)
+    {
+        const SL_IndexBuffer& ibo = context.ibo(srcVao.get_index_buffer());
+        vertBegin = std::numeric_limits<size_t>::max();
+        vertEnd = 0;
+
+        for (size_t i = srcMesh.elementBegin; i < srcMesh.elementEnd; ++i)
+        {
+            const size_t index = ibo.index(i);
+            vertBegin = index < vertBegin ? index : vertBegin;
+            vertEnd = index >= vertEnd ? index+1u : vertEnd;
+        }
+
+        if (vertBegin > vertEnd)
+        {
+            vertBegin = vertEnd;
+        }
+    }
+
+    if (vertBegin >= vertEnd)
+    {
+        return -1;
+    }
+
+    // Meshes loaded from a scene file share a single VBO. Only copy the bytes
+    // spanned by this mesh's vertices.
+    ptrdiff_t spanBegin = std::numeric_limits<ptrdiff_t>::max();
+    ptrdiff_t spanEnd = 0;
+
+    for (size_t b = 0; b < numBindings; ++b)
+    {
+        const ptrdiff_t first = srcVao.offset(b, vertBegin);
+        const ptrdiff_t last = srcVao.offset(b, vertEnd-1u) + (ptrdiff_t)sl_bytes_per_vertex(srcVao.type(b), srcVao.dimensions(b));
+
+        spanBegin = first < spanBegin ? first : spanBegin;
+        spanEnd = last > spanEnd ? last : spanEnd;
+    }
+
+    // The context's containers may reallocate while creating new objects.
+    // Fetch all references afterwards.
+    const size_t srcVaoId = srcMesh.vaoId;
+    const size_t srcVboId = srcVao.get_vertex_buffer();
+    const size_t vboId = context.create_vbo();
+    const size_t vaoId = context.create_vao();
+
+    const SL_VertexBuffer& srcVbo = context.vbo(srcVboId);
+    SL_VertexBuffer& vbo = context.vbo(vboId);
+
+    if (spanEnd > (ptrdiff_t)srcVbo.num_bytes()
+    || vbo.init((size_t)(spanEnd - spanBegin), srcVbo.element<const char>(spanBegin)) != 0)
+    {
+        // Both objects were just appended, removing them won't shift any
+        // other IDs.
+        context.destroy_vao(vaoId);
+        context.destroy_vbo(vboId);
+        return -3;
+    }
+
+    // Rebase each binding so vertex IDs (and the mesh's index buffer) remain
+    // valid within the smaller copy.
+    SL_VertexArray& vao = context.vao(vaoId);
+    vao = context.vao(srcVaoId);
+    vao.set_vertex_buffer(vboId);
+
+    for (size_t b = 0; b < numBindings; ++b)
+    {
+        vao.set_binding(b, vao.offset(b) - spanBegin, vao.stride(b), vao.dimensions(b), vao.type(b));
+    }
+
+    outMesh.mesh = srcMesh;
+    outMesh.mesh.vaoId = vaoId;
+    outMesh.srcVaoId = srcVaoId;
+    outMesh.vboId = vboId;
+    outMesh.vertBegin = vertBegin;
+    outMesh.vertEnd = vertEnd;
+    outMesh.positionBinding = positionBinding;
+    outMesh.normalBinding = normalBinding;
+    outMesh.boneIdBinding = boneIdBinding;
+    outMesh.boneWeightBinding = boneWeightBinding;
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Release a skinned mesh
+-------------------------------------*/
+void sl_terminate_skinned_mesh(SL_Context& context, SL_SkinnedMesh& mesh) noexcept
+{
+    const size_t vaoId = mesh.mesh.vaoId;
+    const size_t vboId = mesh.vboId;
+
+    if (vaoId < context.vaos().size())
+    {
+        // Erasing objects from the middle of the context would shift the IDs
+        // of everything after them. Those are only cleared instead.
+        if (vaoId + 1u == context.vaos().size())
+        {
+            context.destroy_vao(vaoId);
+        }
+        else
+        {
+            context.finish();
+            context.vao(vaoId).terminate();
+        }
+    }
+
+    if (vboId < context.vbos().size())
+    {
+        if (vboId + 1u == context.vbos().size())
+        {
+            context.destroy_vbo(vboId);
+        }
+        else
+        {
+            context.finish();
+            context.vbo(vboId).terminate();
+        }
+    }
+
+    mesh.mesh.vaoId = ~(size_t)0;
+    mesh.mesh.elementBegin = 0;
+    mesh.mesh.elementEnd = 0;
+    mesh.vboId = ~(size_t)0;
+    mesh.vertBegin = 0;
+    mesh.vertEnd = 0;
+}
+
+
+
+/*-------------------------------------
+ * Skin the positions and normals of a mesh
+-------------------------------------*/
+void sl_skin_mesh(
+    SL_Context& context,
+    const SL_SkinnedMesh& mesh,
+    const math::mat4* pBones,
+    size_t numBones,
+    SL_SkinningMode mode) noexcept
+{
+    LS_DEBUG_ASSERT(pBones != nullptr || numBones == 0);
+
+    if (mesh.vertBegin >= mesh.vertEnd || !numBones)
+    {
+        return;
+    }
+
+    // Queued draws may still be reading the skinned vertices
+    context.finish();
+
+    const SL_VertexArray& srcVao = context.vao(mesh.srcVaoId);
+
+    // Convert each bone once rather than once per vertex
+    std::vector<math::vec4> dualQuats;
+    if (mode == SL_SKINNING_DUAL_QUATERNION)
+    {
+        dualQuats.resize(numBones * 2u);
+        for (size_t b = 0; b < numBones; ++b)
+        {
+            dualQuats[b*2u] = _sl_bone_dual_quat(pBones[b], dualQuats[b*2u+1u]);
+        }
+    }
+
+    _SL_SkinningTask task;
+    task.pMesh      = &mesh;
+    task.pSrcVao    = &srcVao;
+    task.pDstVao    = &context.vao(mesh.mesh.vaoId);
+    task.pSrcVbo    = &context.vbo(srcVao.get_vertex_buffer());
+    task.pDstVbo    = &context.vbo(mesh.vboId);
+    task.pBones     = pBones;
+    task.pDualQuats = dualQuats.empty() ? nullptr : dualQuats.data();
+    task.numBones   = numBones;
+
+    if (context.num_threads() > 1 && (mesh.vertEnd - mesh.vertBegin) >= SL_SKINNING_MIN_PARALLEL_VERTS)
+    {
+        context.run_tasks(&_sl_skin_mesh_task, &task);
+    }
+    else
+    {
+        _sl_skin_mesh_task(&task, 0, 1);
+    }
+}
@@ -14,6 +14,7 @@
 
 #include "softlight/SL_ImgFile.hpp"
 #include "softlight/SL_Texture.hpp"
+#include "softlight/SL_TextureUploadProcessor.hpp"
 
 
 
@@ -92,6 +93,20 @@ char* _sl_copy_texture(size_t w, size_t h, size_t d, size_t bpt, const char* pDa
 
 
 
+/*-------------------------------------
+ * Release memory from _sl_allocate_texture()
+-------------------------------------*/
+void _sl_free_texture(char* pTexels) noexcept
+{
+    #if defined(LS_OS_WINDOWS)
+    ls::utils::aligned_free(pTexels);
+    #else
+    free(pTexels);
+    #endif
+}
+
+
+
 } // end anonymous namespace
 
 
@@ -157,7 +172,9 @@ SL_Texture::SL_Texture() noexcept :
         0,
         nullptr,
         SL_COLOR_RGB_DEFAULT
-    }
+    },
+    mNumLevels{1},
+    mMips{}
 {}
 
 
@@ -175,8 +192,16 @@ SL_Texture::SL_Texture(const SL_Texture& r) noexcept :
         r.mView.numChannels,
         _sl_copy_texture(r.mView.width, r.mView.height, r.mView.depth, r.mView.bytesPerTexel, r.mView.pTexels),
         r.mView.type
+    },
+    mNumLevels{r.mNumLevels},
+    mMips{}
+{
+    for (uint32_t i = 0; i+1u < r.mNumLevels; ++i)
+    {
+        const SL_TextureView& mip = r.mMips[i];
+        sl_texture_view_from_buffer(mMips[i], mip.width, mip.height, mip.depth, mip.type, _sl_copy_texture(mip.width, mip.height, mip.depth, mip.bytesPerTexel, mip.pTexels));
     }
-{}
+}
 
 
 
@@ -193,8 +218,17 @@ SL_Texture::SL_Texture(SL_Texture&& r) noexcept :
         r.mView.numChannels,
         r.mView.pTexels,
         r.mView.type
-    }
+    },
+    mNumLevels{r.mNumLevels},
+    mMips{}
 {
+    for (uint32_t i = 0; i+1u < r.mNumLevels; ++i)
+    {
+        mMips[i] = r.mMips[i];
+        sl_reset(r.mMips[i]);
+    }
+
+    r.mNumLevels = 1;
     r.mView.width = 0;
     r.mView.height = 0;
     r.mView.depth = 0;
@@ -227,6 +261,14 @@ SL_Texture& SL_Texture::operator=(const SL_Texture& r) noexcept
     mView.pTexels = _sl_copy_texture(r.mView.width, r.mView.height, r.mView.depth, r.mView.bytesPerTexel, r.mView.pTexels);
     mView.type = r.mView.type;
 
+    for (uint32_t i = 0; i+1u < r.mNumLevels; ++i)
+    {
+        const SL_TextureView& mip = r.mMips[i];
+        sl_texture_view_from_buffer(mMips[i], mip.width, mip.height, mip.depth, mip.type, _sl_copy_texture(mip.width, mip.height, mip.depth, mip.bytesPerTexel, mip.pTexels));
+    }
+
+    mNumLevels = r.mNumLevels;
+
     return *this;
 }
 
@@ -265,6 +307,15 @@ SL_Texture& SL_Texture::operator=(SL_Texture&& r) noexcept
     mView.type = r.mView.type;
     r.mView.type = SL_COLOR_RGB_DEFAULT;
 
+    for (uint32_t i = 0; i+1u < r.mNumLevels; ++i)
+    {
+        mMips[i] = r.mMips[i];
+        sl_reset(r.mMips[i]);
+    }
+
+    mNumLevels = r.mNumLevels;
+    r.mNumLevels = 1;
+
     return *this;
 }
 
@@ -323,24 +374,19 @@ int SL_Texture::init(const SL_ImgFile& imgFile, SL_TexelOrder texelOrder) noexce
 
     if (retCode == 0)
     {
-        const unsigned char* pInTex = reinterpret_cast<const unsigned char*>(imgFile.data());
+        const char* pInTex = reinterpret_cast<const char*>(imgFile.data());
 
         if (texelOrder == SL_TexelOrder::SWIZZLED)
         {
-            const size_t bytesPerColor = mView.bytesPerTexel;
-
-            for (uint16_t z = 0; z < mView.depth; ++z)
-            {
-                for (uint16_t y = 0; y < mView.height; ++y)
-                {
-                    for (uint16_t x = 0; x < mView.width; ++x)
-                    {
-                        const ptrdiff_t index = x + mView.width * (y + mView.height * z);
-                        const ptrdiff_t offset = bytesPerColor * index;
-                        set_texel<SL_TexelOrder::SWIZZLED>(x, y, z, pInTex + offset);
-                    }
-                }
-            }
+            // Use SL_Context::upload_texture() to swizzle on all threads
+            SL_TextureUploadProcessor uploader;
+            uploader.mThreadId   = 0;
+            uploader.mNumThreads = 1;
+            uploader.mTexelOrder = SL_TexelOrder::SWIZZLED;
+            uploader.mSrcType    = imgFile.format();
+            uploader.mSrcTexels  = pInTex;
+            uploader.mDstTex     = &mView;
+            uploader.execute();
         }
         else
         {
@@ -358,19 +404,77 @@ int SL_Texture::init(const SL_ImgFile& imgFile, SL_TexelOrder texelOrder) noexce
 -------------------------------------*/
 void SL_Texture::terminate() noexcept
 {
+    terminate_levels();
+
     mView.width = 0;
     mView.height = 0;
     mView.depth = 0;
     mView.bytesPerTexel = 0;
     mView.numChannels = 0;
 
-    #if defined(LS_OS_WINDOWS)
-    ls::utils::aligned_free(mView.pTexels);
-    #else
-    free(mView.pTexels);
-    #endif
-
+    _sl_free_texture(mView.pTexels);
     mView.pTexels = nullptr;
 
     mView.type = SL_COLOR_RGB_DEFAULT;
 }
+
+
+
+/*-------------------------------------
+ * Allocate storage for a chain of mip levels. Each level is half the size of
+ * the one before it, down to 1x1 texels.
+-------------------------------------*/
+int SL_Texture::init_levels(uint32_t numLevels) noexcept
+{
+    if (!mView.pTexels)
+    {
+        return -1;
+    }
+
+    // Only 2D textures can be mipmapped
+    if (mView.depth > 1)
+    {
+        return -2;
+    }
+
+    terminate_levels();
+
+    numLevels = ls::math::clamp<uint32_t>(numLevels, 1u, SL_TEXTURE_MAX_LEVELS);
+
+    uint_fast32_t w = mView.width;
+    uint_fast32_t h = mView.height;
+
+    while (mNumLevels < numLevels && (w > 1u || h > 1u))
+    {
+        w = ls::math::max<uint_fast32_t>(w >> 1u, 1u);
+        h = ls::math::max<uint_fast32_t>(h >> 1u, 1u);
+
+        char* const pTexels = _sl_allocate_texture(w, h, 1, mView.bytesPerTexel);
+        if (!pTexels)
+        {
+            terminate_levels();
+            return -3;
+        }
+
+        sl_texture_view_from_buffer(mMips[mNumLevels-1u], (uint16_t)w, (uint16_t)h, 1, mView.type, pTexels);
+        ++mNumLevels;
+    }
+
+    return 0;
+}
+
+
+
+/*-------------------------------------
+ * Release all mip levels except the base
+-------------------------------------*/
+void SL_Texture::terminate_levels() noexcept
+{
+    for (uint32_t i = 0; i+1u < mNumLevels; ++i)
+    {
+        _sl_free_texture(mMips[i].pTexels);
+        sl_reset(mMips[i]);
+    }
+
+    mNumLevels = 1;
+}
@@ -0,0 +1,266 @@
+
+#include <cstring> // std::memcpy
+#include <limits> // std::numeric_limits
+
+#include "lightsky/setup/Api.h" // LS_INLINE
+#include "lightsky/setup/Types.h" // IsFloat
+
+#include "lightsky/math/scalar_utils.h" // min
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_TextureUploadProcessor.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Anonymous helper functions and namespaces
+-----------------------------------------------------------------------------*/
+namespace math = ls::math;
+
+namespace
+{
+
+
+
+/*-------------------------------------
+ * Default value of a missing alpha channel
+-------------------------------------*/
+template <typename value_type>
+constexpr typename ls::setup::EnableIf<ls::setup::IsFloat<value_type>::value, value_type>::type
+_sl_texel_opaque() noexcept
+{
+    return value_type{1};
+}
+
+
+
+template <typename value_type>
+constexpr typename ls::setup::EnableIf<ls::setup::IsIntegral<value_type>::value, value_type>::type
+_sl_texel_opaque() noexcept
+{
+    return std::numeric_limits<value_type>::max();
+}
+
+
+
+/*-------------------------------------
+ * Convert a texel between color types with the same component type. New
+ * color channels are set to 0, except for alpha.
+-------------------------------------*/
+template <typename value_type, typename src_type, typename dst_type>
+inline LS_INLINE void _sl_convert_texel(const src_type& inColor, dst_type& outColor) noexcept
+{
+    constexpr unsigned numSrcComponents = sizeof(src_type) / sizeof(value_type);
+    constexpr unsigned numDstComponents = sizeof(dst_type) / sizeof(value_type);
+
+    for (unsigned i = 0; i < numDstComponents; ++i)
+    {
+        outColor[i] = (i < numSrcComponents) ? inColor[i] : ((i == 3u) ? _sl_texel_opaque<value_type>() : value_type{0});
+    }
+}
+
+
+
+/*-------------------------------------
+ * Copy a run of texels using 16-byte vector registers
+-------------------------------------*/
+template <size_t numBytes>
+inline LS_INLINE typename ls::setup::EnableIf<(numBytes % 16u) == 0, void>::type
+_sl_copy_texel_run(char* pDst, const char* pSrc) noexcept
+{
+    for (size_t i = 0; i < numBytes; i += 16u)
+    {
+        #if defined(LS_X86_SSE2)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc+i)));
+        #elif defined(LS_ARM_NEON)
+            vst1q_u8(reinterpret_cast<uint8_t*>(pDst+i), vld1q_u8(reinterpret_cast<const uint8_t*>(pSrc+i)));
+        #else
+            std::memcpy(pDst+i, pSrc+i, 16u);
+        #endif
+    }
+}
+
+
+
+/*-------------------------------------
+ * Copy a run of texels which doesn't fill a vector register
+-------------------------------------*/
+template <size_t numBytes>
+inline LS_INLINE typename ls::setup::EnableIf<(numBytes % 16u) != 0, void>::type
+_sl_copy_texel_run(char* pDst, const char* pSrc) noexcept
+{
+    std::memcpy(pDst, pSrc, numBytes);
+}
+
+
+
+/*-------------------------------------
+ * Upload SL_TEXELS_PER_CHUNK texels of the same color type
+-------------------------------------*/
+template <typename value_type, typename color_type>
+inline LS_INLINE void _sl_upload_run(const color_type* pSrc, color_type* pDst) noexcept
+{
+    _sl_copy_texel_run<sizeof(color_type)*SL_TEXELS_PER_CHUNK>(reinterpret_cast<char*>(pDst), reinterpret_cast<const char*>(pSrc));
+}
+
+
+
+/*-------------------------------------
+ * Upload SL_TEXELS_PER_CHUNK texels with a color conversion
+-------------------------------------*/
+template <typename value_type, typename src_type, typename dst_type>
+inline LS_INLINE void _sl_upload_run(const src_type* pSrc, dst_type* pDst) noexcept
+{
+    for (unsigned i = 0; i < SL_TEXELS_PER_CHUNK; ++i)
+    {
+        _sl_convert_texel<value_type, src_type, dst_type>(pSrc[i], pDst[i]);
+    }
+}
+
+
+
+} // end anonymous namespace
+
+
+
+/*-----------------------------------------------------------------------------
+ * SL_TextureUploadProcessor Class
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Copy texels into the destination texture
+-------------------------------------*/
+template<typename src_type, typename dst_type, typename value_type, SL_TexelOrder order>
+void SL_TextureUploadProcessor::upload() noexcept
+{
+    const uint_fast32_t w = mDstTex->width;
+    const uint_fast32_t h = mDstTex->height;
+    const uint_fast32_t d = mDstTex->depth;
+
+    // Every run of SL_TEXELS_PER_CHUNK texels starting at a multiple of
+    // SL_TEXELS_PER_CHUNK is contiguous in both texel orders.
+    const uint_fast32_t runEnd     = w & ~(uint_fast32_t)(SL_TEXELS_PER_CHUNK-1u);
+    const uint_fast32_t sliceBands = (h + (SL_TEXELS_PER_CHUNK-1u)) >> SL_TEXEL_SHIFTS_PER_CHUNK;
+    const uint_fast32_t numBands   = sliceBands * d;
+
+    const src_type* const pSrc = reinterpret_cast<const src_type*>(mSrcTexels);
+    dst_type* const       pDst = reinterpret_cast<dst_type*>(mDstTex->pTexels);
+
+    for (uint_fast32_t band = mThreadId; band < numBands; band += mNumThreads)
+    {
+        const uint_fast32_t z      = band / sliceBands;
+        const uint_fast32_t yBegin = (band % sliceBands) << SL_TEXEL_SHIFTS_PER_CHUNK;
+        const uint_fast32_t yEnd   = math::min<uint_fast32_t>(yBegin + SL_TEXELS_PER_CHUNK, h);
+
+        for (uint_fast32_t y = yBegin; y < yEnd; ++y)
+        {
+            const src_type* const pSrcRow = pSrc + w * (y + h * z);
+            uint_fast32_t x = 0;
+
+            for (; x < runEnd; x += SL_TEXELS_PER_CHUNK)
+            {
+                _sl_upload_run<value_type>(pSrcRow + x, pDst + sl_texture_view_index<order>(*mDstTex, x, y, z));
+            }
+
+            for (; x < w; ++x)
+            {
+                _sl_convert_texel<value_type, src_type, dst_type>(pSrcRow[x], pDst[sl_texture_view_index<order>(*mDstTex, x, y, z)]);
+            }
+        }
+    }
+}
+
+
+
+/*-------------------------------------
+ * Select the destination texel ordering
+-------------------------------------*/
+template<typename src_type, typename dst_type, typename value_type>
+void SL_TextureUploadProcessor::upload_texels() noexcept
+{
+    if (mTexelOrder == SL_TexelOrder::SWIZZLED)
+    {
+        upload<src_type, dst_type, value_type, SL_TexelOrder::SWIZZLED>();
+    }
+    else
+    {
+        upload<src_type, dst_type, value_type, SL_TexelOrder::ORDERED>();
+    }
+}
+
+
+
+/*-------------------------------------
+ * Select the source color type
+-------------------------------------*/
+template<typename dst_type, typename value_type>
+void SL_TextureUploadProcessor::upload_from() noexcept
+{
+    switch (sl_elements_per_color(mSrcType))
+    {
+        case 1: upload_texels<SL_ColorRType<value_type>, dst_type, value_type>();    break;
+        case 2: upload_texels<SL_ColorRGType<value_type>, dst_type, value_type>();   break;
+        case 3: upload_texels<SL_ColorRGBType<value_type>, dst_type, value_type>();  break;
+        case 4: upload_texels<SL_ColorRGBAType<value_type>, dst_type, value_type>(); break;
+
+        default:
+            break;
+    }
+}
+
+
+
+/*-------------------------------------
+ * Run the texture uploader
+-------------------------------------*/
+void SL_TextureUploadProcessor::execute() noexcept
+{
+    switch (mDstTex->type)
+    {
+        case SL_COLOR_R_8U:       upload_from<SL_ColorRType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_R_16U:      upload_from<SL_ColorRType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_R_32U:      upload_from<SL_ColorRType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_R_64U:      upload_from<SL_ColorRType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_R_FLOAT:    upload_from<SL_ColorRType<float>, float>();       break;
+        case SL_COLOR_R_DOUBLE:   upload_from<SL_ColorRType<double>, double>();     break;
+
+        case SL_COLOR_RG_8U:      upload_from<SL_ColorRGType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RG_16U:     upload_from<SL_ColorRGType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RG_32U:     upload_from<SL_ColorRGType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RG_64U:     upload_from<SL_ColorRGType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RG_FLOAT:   upload_from<SL_ColorRGType<float>, float>();       break;
+        case SL_COLOR_RG_DOUBLE:  upload_from<SL_ColorRGType<double>, double>();     break;
+
+        case SL_COLOR_RGB_8U:     upload_from<SL_ColorRGBType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RGB_16U:    upload_from<SL_ColorRGBType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RGB_32U:    upload_from<SL_ColorRGBType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RGB_64U:    upload_from<SL_ColorRGBType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RGB_FLOAT:  upload_from<SL_ColorRGBType<float>, float>();       break;
+        case SL_COLOR_RGB_DOUBLE: upload_from<SL_ColorRGBType<double>, double>();     break;
+
+        case SL_COLOR_RGBA_8U:     upload_from<SL_ColorRGBAType<uint8_t>, uint8_t>();   break;
+        case SL_COLOR_RGBA_16U:    upload_from<SL_ColorRGBAType<uint16_t>, uint16_t>(); break;
+        case SL_COLOR_RGBA_32U:    upload_from<SL_ColorRGBAType<uint32_t>, uint32_t>(); break;
+        case SL_COLOR_RGBA_64U:    upload_from<SL_ColorRGBAType<uint64_t>, uint64_t>(); break;
+        case SL_COLOR_RGBA_FLOAT:  upload_from<SL_ColorRGBAType<float>, float>();       break;
+        case SL_COLOR_RGBA_DOUBLE: upload_from<SL_ColorRGBAType<double>, double>();     break;
+
+        // Packed color types are copied as plain integers
+        case SL_COLOR_RGB_332:
+            upload_texels<SL_ColorRType<uint8_t>, SL_ColorRType<uint8_t>, uint8_t>();
+            break;
+
+        case SL_COLOR_RGB_565:
+        case SL_COLOR_RGBA_5551:
+        case SL_COLOR_RGBA_4444:
+            upload_texels<SL_ColorRType<uint16_t>, SL_ColorRType<uint16_t>, uint16_t>();
+            break;
+
+        case SL_COLOR_RGBA_1010102:
+            upload_texels<SL_ColorRType<uint32_t>, SL_ColorRType<uint32_t>, uint32_t>();
+            break;
+
+        default:
+            break;
+    }
+}
@@ -2,8 +2,10 @@
 #include "lightsky/math/mat_utils.h"
 
 #include "softlight/SL_Context.hpp"
+#include "softlight/SL_CpuFeatures.hpp" // sl_cpu_features()
 #include "softlight/SL_Framebuffer.hpp"
 #include "softlight/SL_IndexBuffer.hpp"
+#include "softlight/SL_Meshlet.hpp"
 #include "softlight/SL_Shader.hpp"
 #include "softlight/SL_ShaderUtil.hpp" // SL_BinCounter
 #include "softlight/SL_TriProcessor.hpp"
@@ -24,23 +26,124 @@ namespace
 
 
 
+/*--------------------------------------
+ * Test a triangle's screen-space bounding box against the framebuffer's
+ * coarse depth tiles
+--------------------------------------*/
+inline bool _sl_is_tri_occluded(
+    const SL_Framebuffer* pFbo,
+    SL_DepthTest depthTest,
+    const math::vec4& depth,
+    const math::vec4& bboxMin,
+    const math::vec4& bboxMax,
+    const math::vec4& bcX,
+    const math::vec4& bcY,
+    const math::vec4& bcZ) noexcept
+{
+    const SL_DepthHierarchy& depthBounds = pFbo->depth_hierarchy();
+
+    if (!sl_depth_test_is_ordered(depthTest) || !depthBounds.valid())
+    {
+        return false;
+    }
+
+    // Pixels along a triangle's edges can be interpolated slightly beyond
+    // the range of its vertices. Pad the range by one pixel's change in
+    // depth, plus any rounding error from the rasterizer.
+    const float xf = math::max(math::abs(bboxMin[0]), math::abs(bboxMax[0]));
+    const float yf = math::max(math::abs(bboxMin[1]), math::abs(bboxMax[1]));
+
+    float bias = 1.f;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        bias += math::abs(depth[i]) * (math::abs(bcX[i])*xf + math::abs(bcY[i])*yf + math::abs(bcZ[i]));
+    }
+
+    const float pad = math::abs(math::dot(depth, bcX)) + math::abs(math::dot(depth, bcY)) + bias*1.0e-5f;
+
+    return depthBounds.is_rect_occluded(
+        depthTest,
+        (int32_t)bboxMin[0],
+        (int32_t)bboxMin[1],
+        (int32_t)bboxMax[0] + 1,
+        (int32_t)bboxMax[1] + 1,
+        bboxMin[2] - pad,
+        bboxMax[2] + pad);
+}
+
+
+
+#if SL_SSE41_KERNELS_ENABLED
+/*--------------------------------------
+ * Convert world coordinates to screen coordinates (SSE4.1)
+--------------------------------------*/
+SL_TARGET_SSE41 inline void _sl_perspective_divide3_sse41(math::vec4& LS_RESTRICT_PTR v0, math::vec4& LS_RESTRICT_PTR v1, math::vec4& LS_RESTRICT_PTR v2) noexcept
+{
+    const __m128 wInv0 = _mm_rcp_ps(_mm_shuffle_ps(v0.simd, v0.simd, 0xFF));
+    const __m128 wInv1 = _mm_rcp_ps(_mm_shuffle_ps(v1.simd, v1.simd, 0xFF));
+    const __m128 wInv2 = _mm_rcp_ps(_mm_shuffle_ps(v2.simd, v2.simd, 0xFF));
+
+    const __m128 vMul0 = _mm_mul_ps(v0.simd, wInv0);
+    const __m128 vMul1 = _mm_mul_ps(v1.simd, wInv1);
+    const __m128 vMul2 = _mm_mul_ps(v2.simd, wInv2);
+
+    v0.simd = _mm_blend_ps(wInv0, vMul0, 0x07);
+    v1.simd = _mm_blend_ps(wInv1, vMul1, 0x07);
+    v2.simd = _mm_blend_ps(wInv2, vMul2, 0x07);
+}
+
+
+
+/*--------------------------------------
+ * Triangle determinants for backface culling (SSE4.1)
+--------------------------------------*/
+SL_TARGET_SSE41 inline float _sl_face_determinant_sse41(
+    const math::vec4& LS_RESTRICT_PTR p0,
+    const math::vec4& LS_RESTRICT_PTR p1,
+    const math::vec4& LS_RESTRICT_PTR p2
+) noexcept
+{
+    constexpr int shuffleMask120 = 0x8D; // indices: <base> + (2, 0, 3, 1): 10001101
+    constexpr int shuffleMask201 = 0x93; // indices: <base> + (2, 1, 0, 3): 10010011
+
+    // Swap the z and w components for each vector while placing the
+    // remaining elements in a position optimal for calculating the
+    // determinant.
+    const __m128 col4   = _mm_insert_ps( p0.simd, p0.simd, 0xE8);
+    const __m128 p1_201 = _mm_shuffle_ps(p1.simd, p1.simd, shuffleMask201);
+    const __m128 p2_120 = _mm_shuffle_ps(p2.simd, p2.simd, shuffleMask120);
+    const __m128 p1_120 = _mm_shuffle_ps(p1.simd, p1.simd, shuffleMask120);
+    const __m128 p2_201 = _mm_shuffle_ps(p2.simd, p2.simd, shuffleMask201);
+
+    const __m128 col3 = _mm_mul_ps(p1_201, p2_120);
+    const __m128 col1 = _mm_mul_ps(p1_120, p2_201);
+    const __m128 sub0 = _mm_sub_ps(col1,   col3);
+
+    // Remove the Z component which was shuffled earlier
+    const __m128 mul2 = _mm_mul_ps(sub0, col4);
+
+    // horizontal add of only the first 3 elements. We're using the
+    // W-component of each vector as the 3rd dimension for out determinant
+    // calculation
+    const __m128 hi = _mm_movehdup_ps(mul2);
+    const __m128 lo = _mm_add_ss(hi, mul2);
+    const __m128 w  = _mm_shuffle_ps(mul2, mul2, 0xAA);
+    return _mm_cvtss_f32(_mm_add_ss(w, lo));
+}
+
+
+
+#endif /* SL_SSE41_KERNELS_ENABLED */
+
+
+
 /*--------------------------------------
  * Convert world coordinates to screen coordinates
 --------------------------------------*/
 inline LS_INLINE void sl_perspective_divide3(math::vec4& LS_RESTRICT_PTR v0, math::vec4& LS_RESTRICT_PTR v1, math::vec4& LS_RESTRICT_PTR v2) noexcept
 {
     #if defined(LS_X86_SSE4_1)
-        const __m128 wInv0 = _mm_rcp_ps(_mm_shuffle_ps(v0.simd, v0.simd, 0xFF));
-        const __m128 wInv1 = _mm_rcp_ps(_mm_shuffle_ps(v1.simd, v1.simd, 0xFF));
-        const __m128 wInv2 = _mm_rcp_ps(_mm_shuffle_ps(v2.simd, v2.simd, 0xFF));
-
-        const __m128 vMul0 = _mm_mul_ps(v0.simd, wInv0);
-        const __m128 vMul1 = _mm_mul_ps(v1.simd, wInv1);
-        const __m128 vMul2 = _mm_mul_ps(v2.simd, wInv2);
-
-        v0.simd = _mm_blend_ps(wInv0, vMul0, 0x07);
-        v1.simd = _mm_blend_ps(wInv1, vMul1, 0x07);
-        v2.simd = _mm_blend_ps(wInv2, vMul2, 0x07);
+        _sl_perspective_divide3_sse41(v0, v1, v2);
 
     #elif defined(LS_X86_SSSE3)
         const __m128 wInv0 = _mm_rcp_ps(_mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v0.simd), 0xFF)));
@@ -249,32 +352,7 @@ inline LS_INLINE float face_determinant(
     // Z-component of each 3D vertex is replaced by the 4D W-component.
 
     #if defined(LS_X86_SSE4_1)
-        constexpr int shuffleMask120 = 0x8D; // indices: <base> + (2, 0, 3, 1): 10001101
-        constexpr int shuffleMask201 = 0x93; // indices: <base> + (2, 1, 0, 3): 10010011
-
-        // Swap the z and w components for each vector while placing the
-        // remaining elements in a position optimal for calculating the
-        // determinant.
-        const __m128 col4   = _mm_insert_ps( p0.simd, p0.simd, 0xE8);
-        const __m128 p1_201 = _mm_permute_ps(p1.simd, shuffleMask201);
-        const __m128 p2_120 = _mm_permute_ps(p2.simd, shuffleMask120);
-        const __m128 p1_120 = _mm_permute_ps(p1.simd, shuffleMask120);
-        const __m128 p2_201 = _mm_permute_ps(p2.simd, shuffleMask201);
-
-        const __m128 col3 = _mm_mul_ps(p1_201, p2_120);
-        const __m128 col1 = _mm_mul_ps(p1_120, p2_201);
-        const __m128 sub0 = _mm_sub_ps(col1,   col3);
-
-        // Remove the Z component which was shuffled earlier
-        const __m128 mul2 = _mm_mul_ps(sub0, col4);
-
-        // horizontal add of only the first 3 elements. We're using the
-        // W-component of each vector as the 3rd dimension for out determinant
-        // calculation
-        const __m128 hi = _mm_movehdup_ps(mul2);
-        const __m128 lo = _mm_add_ss(hi, mul2);
-        const __m128 w = _mm_permute_ps(mul2, 0xAA);
-        return _mm_cvtss_f32(_mm_add_ss(w, lo));
+        return _sl_face_determinant_sse41(p0, p1, p2);
 
     #elif defined(LS_ARM_NEON) // based on the AVX implementation
         const float32x4_t col4 = vcombine_f32(vget_low_f32(p0.simd), vrev64_f32(vget_high_f32(p0.simd)));
@@ -536,6 +614,44 @@ inline LS_INLINE math::vec4_t<size_t> get_next_vertex3(const SL_IndexBuffer* LS_
 
 
 
+/*--------------------------------------
+ * Per-triangle setup for the instruction sets targeted by the build
+--------------------------------------*/
+struct SL_TriSetup
+{
+    static inline LS_INLINE float determinant(const math::vec4& p0, const math::vec4& p1, const math::vec4& p2) noexcept
+    {
+        return face_determinant(p0, p1, p2);
+    }
+
+    static inline LS_INLINE void perspective_divide3(math::vec4& v0, math::vec4& v1, math::vec4& v2) noexcept
+    {
+        sl_perspective_divide3(v0, v1, v2);
+    }
+};
+
+
+
+#if SL_SSE41_DISPATCH_ENABLED
+/*--------------------------------------
+ * Per-triangle setup for CPUs with SSE4.1, selected at runtime
+--------------------------------------*/
+struct SL_TriSetupSSE41
+{
+    SL_TARGET_SSE41 static inline float determinant(const math::vec4& p0, const math::vec4& p1, const math::vec4& p2) noexcept
+    {
+        return _sl_face_determinant_sse41(p0, p1, p2);
+    }
+
+    SL_TARGET_SSE41 static inline void perspective_divide3(math::vec4& v0, math::vec4& v1, math::vec4& v2) noexcept
+    {
+        _sl_perspective_divide3_sse41(v0, v1, v2);
+    }
+};
+#endif
+
+
+
 } // end anonymous namespace
 
 
@@ -589,6 +705,13 @@ void SL_TriProcessor::push_bin(size_t primIndex, const SL_TransformedVert& a, co
         const math::vec4&& ddy = math::cross(math::vec4{1.f}, pt.m[0]);
         const math::vec4&& ddz = math::cross(pt.m[0], pt.m[1]);
 
+        #if SL_HIZ_ENABLED
+            if (_sl_is_tri_occluded(mFbo, mShader->pipelineState.depth_test(), pt.m[2], bboxMin, bboxMax, denom*ddx, denom*ddy, denom*ddz))
+            {
+                return;
+            }
+        #endif
+
         // Check if the output bin is full
         uint_fast64_t binId;
 
@@ -616,6 +739,15 @@ void SL_TriProcessor::push_bin(size_t primIndex, const SL_TransformedVert& a, co
         bin.mBarycentricCoords[2] = denom * ddz;
     //}
 
+    #if SL_TILED_BINNING_ENABLED
+        // Record the range of tiles this triangle overlaps so the
+        // rasterizers only visit it from within those tiles.
+        bin.mTileBounds[0] = (uint16_t)(math::max<int32_t>((int32_t)bboxMin[0], 0) / SL_BIN_TILE_SIZE);
+        bin.mTileBounds[1] = (uint16_t)(math::max<int32_t>((int32_t)bboxMin[1], 0) / SL_BIN_TILE_SIZE);
+        bin.mTileBounds[2] = (uint16_t)(math::max<int32_t>((int32_t)bboxMax[0], 0) / SL_BIN_TILE_SIZE);
+        bin.mTileBounds[3] = (uint16_t)(math::max<int32_t>((int32_t)bboxMax[1], 0) / SL_BIN_TILE_SIZE);
+    #endif
+
     switch (numVaryings)
     {
         case 4:
@@ -825,8 +957,8 @@ void SL_TriProcessor::clip_and_process_tris(
 /*--------------------------------------
  * Process Points
 --------------------------------------*/
-template <bool usingIndices>
-void SL_TriProcessor::process_verts(
+template <bool usingIndices, class TriSetup>
+inline LS_INLINE void SL_TriProcessor::process_verts_impl(
     const SL_Mesh& m,
     size_t instanceId,
     const ls::math::mat4_t<float>& scissorMat,
@@ -849,15 +981,15 @@ void SL_TriProcessor::process_verts(
     const size_t numElements = m.elementEnd - m.elementBegin;
     const size_t primOffset = numElements * instanceId;
 
-    #if SL_VERTEX_CACHING_ENABLED
-        size_t begin;
-        size_t end;
-        constexpr size_t step = 3;
+    size_t begin;
+    size_t end;
 
-        sl_calc_indexed_parition<3, true>(numElements, mNumThreads, mThreadId, begin, end);
-        begin += m.elementBegin;
-        end += m.elementBegin;
+    // Meshlets line up with vertex chunks, allowing an entire chunk to be
+    // rejected before any of its vertices are shaded.
+    const SL_MeshletCull* const pCull = (mMeshletCulls && mNumInstances == 1) ? mMeshletCulls[&m - mMeshes] : nullptr;
+    const bool cullBackFaces = cullMode == SL_CULL_BACK_FACE;
 
+    #if SL_VERTEX_CACHING_ENABLED
         SL_PTVCache ptvCache{};
         const auto&& vertTransform = [&](size_t key, SL_TransformedVert& tv)noexcept ->void
         {
@@ -865,84 +997,157 @@ void SL_TriProcessor::process_verts(
             params.pVaryings = tv.varyings;
             tv.vert = scissorMat * vertShader(params);
         };
+    #endif
 
+    #if SL_VERTEX_BATCHING_ENABLED
+        // Indexed chunks shade each unique vertex once into a thread-local
+        // buffer, then assemble triangles from it.
+        constexpr bool useBatch = usingIndices;
+        SL_PTVBatch        ptvBatch;
+        uint16_t           batchSlots[SL_VERTEX_BATCH_MAX_INDICES];
+        SL_TransformedVert batchVerts[SL_VERTEX_BATCH_MAX_INDICES];
     #else
-        //const size_t begin = m.elementBegin + mThreadId * 3u;
-        const size_t begin = m.elementBegin + ((instanceId + mThreadId) % mNumThreads) * 3u;
-        const size_t end   = m.elementEnd;
-        const size_t step  = mNumThreads * 3u;
+        constexpr bool useBatch = false;
     #endif
 
-    for (size_t i = begin; i < end; i += step)
+    // Primitives are claimed in chunks so threads which cull or clip most of
+    // their work can take on more of the mesh.
+    while (next_chunk(m.elementBegin, m.elementEnd, 3, begin, end))
     {
-        const math::vec4_t<size_t>&& vertId = usingIndices ? get_next_vertex3(pIbo, i) : math::vec4_t<size_t>{i+0, i+1, i+2, i+3};
-
-        #if SL_VERTEX_CACHING_ENABLED
-            sl_cache_query_or_update(ptvCache, vertId[0], pVert0, vertTransform);
-            sl_cache_query_or_update(ptvCache, vertId[1], pVert1, vertTransform);
-            sl_cache_query_or_update(ptvCache, vertId[2], pVert2, vertTransform);
-
-        #else
-            params.vertId    = vertId.v[0];
-            params.pVaryings = pVert0.varyings;
-            pVert0.vert      = vertShader(params);
-
-            params.vertId    = vertId.v[1];
-            params.pVaryings = pVert1.varyings;
-            pVert1.vert      = vertShader(params);
-
-            params.vertId    = vertId.v[2];
-            params.pVaryings = pVert2.varyings;
-            pVert2.vert      = vertShader(params);
-        #endif
-
-        if (LS_LIKELY(cullMode != SL_CULL_OFF))
+        if (pCull)
         {
-            const float det = face_determinant(pVert0.vert, pVert1.vert, pVert2.vert);
-
-            // Using bitwise magic to reduce time spent making comparisons.
-            // We can cull the backface with (det < 0.f) or cull the front
-            // face with (det > 0.f).
-
-            const bool culled = (cullMode == SL_CULL_FRONT_FACE) ^ math::sign_mask(det);
-            //if ((cullMode == SL_CULL_BACK_FACE && det < 0.f)
-            //|| (cullMode == SL_CULL_FRONT_FACE && det > 0.f))
-            if (culled)
+            const size_t meshletId = (begin - m.elementBegin) / ((size_t)SL_VERTEX_CHUNK_SIZE * 3u);
+            if (meshletId < pCull->numMeshlets && !sl_meshlet_visible(pCull->pMeshlets[meshletId], *pCull, cullBackFaces))
             {
                 continue;
             }
         }
 
-        #if !SL_VERTEX_CACHING_ENABLED
-            pVert0.vert = scissorMat * pVert0.vert;
-            pVert1.vert = scissorMat * pVert1.vert;
-            pVert2.vert = scissorMat * pVert2.vert;
+        #if SL_VERTEX_BATCHING_ENABLED
+            if (useBatch)
+            {
+                ptvBatch.reset();
+
+                for (size_t i = begin; i < end; i += 3)
+                {
+                    const math::vec4_t<size_t>&& vertId = get_next_vertex3(pIbo, i);
+                    const size_t j = i - begin;
+                    batchSlots[j+0] = (uint16_t)ptvBatch.insert(vertId.v[0]);
+                    batchSlots[j+1] = (uint16_t)ptvBatch.insert(vertId.v[1]);
+                    batchSlots[j+2] = (uint16_t)ptvBatch.insert(vertId.v[2]);
+                }
+
+                for (uint_fast32_t slot = 0; slot < ptvBatch.size(); ++slot)
+                {
+                    SL_TransformedVert& tv = batchVerts[slot];
+                    params.vertId    = ptvBatch.vertex_id(slot);
+                    params.pVaryings = tv.varyings;
+                    tv.vert          = scissorMat * vertShader(params);
+                }
+            }
         #endif
 
-        // Clip-space culling
-        const SL_ClipStatus visStatus = face_visible(pVert0.vert, pVert1.vert, pVert2.vert);
-        if (visStatus == SL_CLIP_STATUS_FULLY_VISIBLE)
+        for (size_t i = begin; i < end; i += 3)
         {
-            sl_perspective_divide3(pVert0.vert, pVert1.vert, pVert2.vert);
-            sl_world_to_screen_coords_divided3(pVert0.vert, pVert1.vert, pVert2.vert, viewportDims);
-            push_bin(primOffset+i, pVert0, pVert1, pVert2);
-        }
-        else if (visStatus == SL_CLIP_STATUS_PARTIALLY_VISIBLE)
-        {
-            clip_and_process_tris(primOffset+i, viewportDims, pVert0, pVert1, pVert2);
-        }
+            #if SL_VERTEX_BATCHING_ENABLED
+            if (useBatch)
+            {
+                const size_t j = i - begin;
+                pVert0 = batchVerts[batchSlots[j+0]];
+                pVert1 = batchVerts[batchSlots[j+1]];
+                pVert2 = batchVerts[batchSlots[j+2]];
+            }
+            else
+            #endif
+            {
+                const math::vec4_t<size_t>&& vertId = usingIndices ? get_next_vertex3(pIbo, i) : math::vec4_t<size_t>{i+0, i+1, i+2, i+3};
+
+                #if SL_VERTEX_CACHING_ENABLED
+                    sl_cache_query_or_update(ptvCache, vertId[0], pVert0, vertTransform);
+                    sl_cache_query_or_update(ptvCache, vertId[1], pVert1, vertTransform);
+                    sl_cache_query_or_update(ptvCache, vertId[2], pVert2, vertTransform);
+
+                #else
+                    params.vertId    = vertId.v[0];
+                    params.pVaryings = pVert0.varyings;
+                    pVert0.vert      = vertShader(params);
+
+                    params.vertId    = vertId.v[1];
+                    params.pVaryings = pVert1.varyings;
+                    pVert1.vert      = vertShader(params);
+
+                    params.vertId    = vertId.v[2];
+                    params.pVaryings = pVert2.varyings;
+                    pVert2.vert      = vertShader(params);
+                #endif
+            }
 
-        #if SL_VERTEX_CACHING_ENABLED
-            if (LS_LIKELY(visStatus != SL_CLIP_STATUS_NOT_VISIBLE))
+            if (LS_LIKELY(cullMode != SL_CULL_OFF))
             {
-                LS_PREFETCH(&ptvCache, LS_PREFETCH_ACCESS_RW, LS_PREFETCH_LEVEL_NONTEMPORAL);
+                const float det = TriSetup::determinant(pVert0.vert, pVert1.vert, pVert2.vert);
+
+                // Using bitwise magic to reduce time spent making comparisons.
+                // We can cull the backface with (det < 0.f) or cull the front
+                // face with (det > 0.f).
+
+                const bool culled = (cullMode == SL_CULL_FRONT_FACE) ^ math::sign_mask(det);
+                //if ((cullMode == SL_CULL_BACK_FACE && det < 0.f)
+                //|| (cullMode == SL_CULL_FRONT_FACE && det > 0.f))
+                if (culled)
+                {
+                    continue;
+                }
             }
-        #endif
+
+            #if !SL_VERTEX_CACHING_ENABLED
+                if (!useBatch)
+                {
+                    pVert0.vert = scissorMat * pVert0.vert;
+                    pVert1.vert = scissorMat * pVert1.vert;
+                    pVert2.vert = scissorMat * pVert2.vert;
+                }
+            #endif
+
+            // Clip-space culling
+            const SL_ClipStatus visStatus = face_visible(pVert0.vert, pVert1.vert, pVert2.vert);
+            if (visStatus == SL_CLIP_STATUS_FULLY_VISIBLE)
+            {
+                TriSetup::perspective_divide3(pVert0.vert, pVert1.vert, pVert2.vert);
+                sl_world_to_screen_coords_divided3(pVert0.vert, pVert1.vert, pVert2.vert, viewportDims);
+                push_bin(primOffset+i, pVert0, pVert1, pVert2);
+            }
+            else if (visStatus == SL_CLIP_STATUS_PARTIALLY_VISIBLE)
+            {
+                clip_and_process_tris(primOffset+i, viewportDims, pVert0, pVert1, pVert2);
+            }
+
+            #if SL_VERTEX_CACHING_ENABLED
+                if (!useBatch && LS_LIKELY(visStatus != SL_CLIP_STATUS_NOT_VISIBLE))
+                {
+                    LS_PREFETCH(&ptvCache, LS_PREFETCH_ACCESS_RW, LS_PREFETCH_LEVEL_NONTEMPORAL);
+                }
+            #endif
+        }
     }
 }
 
 
 
+/*--------------------------------------
+ * Process Points (build target instruction set)
+--------------------------------------*/
+template <bool usingIndices>
+void SL_TriProcessor::process_verts(
+    const SL_Mesh& m,
+    size_t instanceId,
+    const ls::math::mat4_t<float>& scissorMat,
+    const ls::math::vec4_t<float>& viewportDims) noexcept
+{
+    process_verts_impl<usingIndices, SL_TriSetup>(m, instanceId, scissorMat, viewportDims);
+}
+
+
+
 template void SL_TriProcessor::process_verts<true>(
     const SL_Mesh&,
     size_t,
@@ -961,12 +1166,59 @@ template void SL_TriProcessor::process_verts<false>(
 
 
 
+#if SL_SSE41_DISPATCH_ENABLED
+/*--------------------------------------
+ * Process Points (SSE4.1)
+--------------------------------------*/
+template <bool usingIndices>
+SL_TARGET_SSE41 void SL_TriProcessor::process_verts_sse41(
+    const SL_Mesh& m,
+    size_t instanceId,
+    const ls::math::mat4_t<float>& scissorMat,
+    const ls::math::vec4_t<float>& viewportDims) noexcept
+{
+    process_verts_impl<usingIndices, SL_TriSetupSSE41>(m, instanceId, scissorMat, viewportDims);
+}
+
+
+
+template void SL_TriProcessor::process_verts_sse41<true>(
+    const SL_Mesh&,
+    size_t,
+    const ls::math::mat4_t<float>&,
+    const ls::math::vec4_t<float>&
+) noexcept;
+
+
+
+template void SL_TriProcessor::process_verts_sse41<false>(
+    const SL_Mesh&,
+    size_t,
+    const ls::math::mat4_t<float>&,
+    const ls::math::vec4_t<float>&
+) noexcept;
+
+
+
+#endif /* SL_SSE41_DISPATCH_ENABLED */
+
+
+
 /*--------------------------------------
  * Execute the point rasterization
 --------------------------------------*/
 void SL_TriProcessor::execute() noexcept
 {
-    mAmDone = 0;
+    this->begin_draw();
+
+    #if SL_HIZ_ENABLED
+        // Every thread must arrive in flush_rasterizer() before any pixels can
+        // be written, so rebuilding tiles here cannot race with rasterization.
+        if (mRebuildDepthTiles)
+        {
+            mFbo->depth_hierarchy().update_tiles(mThreadId, mNumThreads);
+        }
+    #endif
 
     if (mFragProcessors->count.load(std::memory_order_consume))
     {
@@ -978,6 +1230,17 @@ void SL_TriProcessor::execute() noexcept
     const math::mat4&&      scissorMat   = viewState.scissor_matrix(fboDims[2], fboDims[3]);
     const math::vec4&&      viewportDims = viewState.viewport_rect(fboDims[2], fboDims[3]);
 
+    auto processIndexed = &SL_TriProcessor::process_verts<true>;
+    auto processArrays  = &SL_TriProcessor::process_verts<false>;
+
+    #if SL_SSE41_DISPATCH_ENABLED
+        if (sl_cpu_features() & SL_CPU_FEATURE_SSE4_1)
+        {
+            processIndexed = &SL_TriProcessor::process_verts_sse41<true>;
+            processArrays  = &SL_TriProcessor::process_verts_sse41<false>;
+        }
+    #endif
+
     if (mNumInstances == 1)
     {
         for (size_t i = 0; i < mNumMeshes; ++i)
@@ -987,11 +1250,11 @@ void SL_TriProcessor::execute() noexcept
 
             if (usingIndices)
             {
-                process_verts<true>(m, 0, scissorMat, viewportDims);
+                (this->*processIndexed)(m, 0, scissorMat, viewportDims);
             }
             else
             {
-                process_verts<false>(m, 0, scissorMat, viewportDims);
+                (this->*processArrays)(m, 0, scissorMat, viewportDims);
             }
         }
     }
@@ -1004,14 +1267,14 @@ void SL_TriProcessor::execute() noexcept
         {
             for (size_t i = 0; i < mNumInstances; ++i)
             {
-                process_verts<true>(m, i, scissorMat, viewportDims);
+                (this->*processIndexed)(m, i, scissorMat, viewportDims);
             }
         }
         else
         {
             for (size_t i = 0; i < mNumInstances; ++i)
             {
-                process_verts<false>(m, i, scissorMat, viewportDims);
+                (this->*processArrays)(m, i, scissorMat, viewportDims);
             }
         }
     }
@@ -7,6 +7,7 @@
 #include "lightsky/math/vec_utils.h"
 #include "lightsky/math/mat_utils.h"
 
+#include "softlight/SL_CpuFeatures.hpp" // sl_cpu_features()
 #include "softlight/SL_Framebuffer.hpp" // SL_Framebuffer
 #include "softlight/SL_ScanlineBounds.hpp"
 #include "softlight/SL_Shader.hpp" // SL_FragmentShader
@@ -103,6 +104,144 @@ inline LS_INLINE math::vec4 _sl_get_depth_texel4(const depth_type* LS_RESTRICT_P
 
 
 
+/*--------------------------------------
+ * Compare two sets of integers (used for bounds checks)
+--------------------------------------*/
+inline LS_INLINE ls::math::vec4_t<int> _sl_cmp_vec4_lt(const ls::math::vec4_t<int>& a, const ls::math::vec4_t<int>& b) noexcept
+{
+    return ls::math::vec4_t<int>{
+        a[0] < b[0],
+        a[1] < b[1],
+        a[2] < b[2],
+        a[3] < b[3]
+    };
+}
+
+
+
+/*--------------------------------------
+ * Determine if a set of integers lies within the range (lo, hi)
+--------------------------------------*/
+inline LS_INLINE ls::math::vec4_t<int> _sl_cmp_vec4_between(const ls::math::vec4_t<int>& lo, const ls::math::vec4_t<int>& a, const ls::math::vec4_t<int>& hi) noexcept
+{
+    return ls::math::vec4_t<int>{
+        lo[0] < a[0] && a[0] < hi[0],
+        lo[1] < a[1] && a[1] < hi[1],
+        lo[2] < a[2] && a[2] < hi[2],
+        lo[3] < a[3] && a[3] < hi[3]
+    };
+}
+
+
+
+/*--------------------------------------
+ * Retrieve the coarse depth bounds of a framebuffer if they can be used to
+ * reject fragments for a depth test.
+--------------------------------------*/
+inline const SL_DepthHierarchy* _sl_depth_bounds_for_test(const SL_Framebuffer* pFbo, SL_DepthTest depthTest) noexcept
+{
+    #if SL_HIZ_ENABLED
+        const SL_DepthHierarchy& depthBounds = pFbo->depth_hierarchy();
+        return (sl_depth_test_is_ordered(depthTest) && depthBounds.valid()) ? &depthBounds : nullptr;
+    #else
+        (void)pFbo;
+        (void)depthTest;
+        return nullptr;
+    #endif
+}
+
+
+
+/*--------------------------------------
+ * Determine if all pixels within [xMin, xMax) of a scanline would fail the
+ * depth test.
+--------------------------------------*/
+inline bool _sl_is_scanline_occluded(
+    const SL_DepthHierarchy* pDepthBounds,
+    SL_DepthTest depthTest,
+    const math::vec4& depth,
+    const math::vec4& bcX,
+    const math::vec4& bcY,
+    const math::vec4& bcZ,
+    int32_t y,
+    int32_t xMin,
+    int32_t xMax) noexcept
+{
+    if (!pDepthBounds)
+    {
+        return false;
+    }
+
+    // Depth is interpolated linearly along a scanline, placing its extremes
+    // at either end.
+    const float xf   = (float)math::max(math::abs(xMin), math::abs(xMax));
+    const float yf   = (float)y;
+    const float dzdx = math::dot(depth, bcX);
+    const float z0   = math::dot(depth, bcY) * yf + math::dot(depth, bcZ) + dzdx * (float)xMin;
+    const float z1   = z0 + dzdx * (float)(xMax - xMin - 1);
+
+    // The bias covers any rounding in the rasterizer, which is proportional
+    // to the magnitude of each interpolated term.
+    float bias = 1.f;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        bias += math::abs(depth[i]) * (math::abs(bcX[i])*xf + math::abs(bcY[i])*yf + math::abs(bcZ[i]));
+    }
+    bias *= 1.0e-5f;
+
+    return pDepthBounds->is_span_occluded(depthTest, y, xMin, xMax, math::min(z0, z1) - bias, math::max(z0, z1) + bias);
+}
+
+
+
+/*--------------------------------------
+ * Recalculate the depth bounds of every scanline owned by a thread
+--------------------------------------*/
+template <typename depth_type>
+inline void _sl_update_depth_bounds(SL_Framebuffer* pFbo, int32_t threadId, int32_t numThreads) noexcept
+{
+    SL_DepthHierarchy&    depthBounds = pFbo->depth_hierarchy();
+    const SL_TextureView& depthBuf    = pFbo->get_depth_buffer();
+
+    if (depthBounds.valid())
+    {
+        depthBounds.update_spans<depth_type>(depthBuf, 0, threadId, (int32_t)depthBuf.width, (int32_t)depthBuf.height, numThreads);
+    }
+}
+
+
+
+/*--------------------------------------
+ * Rasterize triangles using the widest kernel supported by the CPU
+--------------------------------------*/
+template <class DepthCmpFunc, typename depth_type>
+inline void _sl_render_triangles(const SL_TriRasterizer* pRasterizer, const SL_TextureView& depthBuffer) noexcept
+{
+    // The 8 and 16-wide kernels load contiguous rows of depth texels, which
+    // would cross tile boundaries in a tiled framebuffer.
+    #if SL_AVX2_KERNELS_ENABLED && !SL_FBO_TILED_ENABLED
+        const uint32_t cpuFeatures = sl_cpu_features();
+
+        #if SL_AVX512_KERNELS_ENABLED
+            if (cpuFeatures & SL_CPU_FEATURE_AVX512)
+            {
+                pRasterizer->render_triangle_simd16<DepthCmpFunc, depth_type>(depthBuffer);
+                return;
+            }
+        #endif
+
+        if (cpuFeatures & SL_CPU_FEATURE_AVX2)
+        {
+            pRasterizer->render_triangle_simd8<DepthCmpFunc, depth_type>(depthBuffer);
+            return;
+        }
+    #endif
+
+    pRasterizer->render_triangle_simd<DepthCmpFunc, depth_type>(depthBuffer);
+}
+
+
+
 } // end anonymous namespace
 
 
@@ -157,7 +296,7 @@ void SL_TriRasterizer::render_wireframe(const SL_TextureView& depthBuffer) const
             const int32_t d0 = math::max(math::abs(xMinMax0[0]-xMinMax1[0]), 1);
             const int32_t d1 = math::max(math::abs(xMinMax0[1]-xMinMax1[1]), 1);
 
-            const depth_type* const pDepth = (depth_type*)depthBuffer.pTexels + (depthBuffer.width * y);
+            const depth_type* const pDepth = (const depth_type*)depthBuffer.pTexels;
 
             for (int32_t ix = 0, x = xMinMax0[0]; (uint32_t)x < (uint32_t)xMinMax0[1]; ++ix, ++x)
             {
@@ -172,7 +311,7 @@ void SL_TriRasterizer::render_wireframe(const SL_TextureView& depthBuffer) const
                 const float   xf = (float)x;
                 math::vec4&&  bc = math::fmadd(bcClipSpace[0], math::vec4{xf, xf, xf, 0.f}, bcY);
                 const float   z  = math::dot(depth, bc);
-                const float   d  = _sl_get_depth_texel<depth_type>(pDepth+x);
+                const float   d  = _sl_get_depth_texel<depth_type>(pDepth + sl_fbo_index(depthBuffer, x, y));
 
                 const int_fast32_t&& depthTest = depthCmpFunc(z, d);
 
@@ -293,7 +432,7 @@ void SL_TriRasterizer::render_triangle(const SL_TextureView& depthBuffer) const
             math::vec4&& xf{(float)x};
             const math::vec4&& bcY = math::fmadd(bcClipSpace[1], math::vec4{yf}, bcClipSpace[2]);
             math::vec4&& bcX = math::fmadd(bcClipSpace[0], xf, bcY);
-            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + (x + (int32_t)depthBuffer.width * y);
+            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + sl_fbo_index(depthBuffer, x, y);
 
             do
             {
@@ -320,7 +459,7 @@ void SL_TriRasterizer::render_triangle(const SL_TextureView& depthBuffer) const
 
                 bcX += bcClipSpace[0];
                 ++x;
-                ++pDepth;
+                pDepth += sl_fbo_step_x(x);
             } while (LS_UNLIKELY(x < xMax));
 
             y += increment;
@@ -422,6 +561,9 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& LS_RESTRICT_PT
     const int32_t     increment    = (int32_t)mNumProcessors;
     SL_ScanlineBounds scanline;
 
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+
     for (uint32_t i = 0; i < numBins; ++i)
     {
         const uint32_t binId = pBinIds[i].count;
@@ -468,10 +610,17 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& LS_RESTRICT_PT
                 continue;
             }
 
+            if (_sl_is_scanline_occluded(pDepthBounds, depthTest, math::vec4{depth}, math::vec4{bcClipSpace0}, math::vec4{bcClipSpace1}, math::vec4{bcClipSpace2}, y, _mm_cvtsi128_si32(xMin), _mm_cvtsi128_si32(xMax)))
+            {
+                y += increment;
+                continue;
+            }
+
             const int32_t     y16    = y << 16;
-            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + (_mm_cvtsi128_si32(xMin) + (int32_t)depthBuffer.width * y);
+            const int32_t     xBegin = sl_fbo_span_begin(_mm_cvtsi128_si32(xMin));
+            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + sl_fbo_index(depthBuffer, xBegin, y);
             const __m128      bcY    = _mm_fmadd_ps(bcClipSpace1, yf, bcClipSpace2);
-            __m128i           x4     = _mm_add_epi32(_mm_set_epi32(3, 2, 1, 0), xMin);
+            __m128i           x4     = _mm_add_epi32(_mm_set_epi32(3, 2, 1, 0), _mm_set1_epi32(xBegin));
 
             __m128 bc[4];
             _sl_vec4_outer_ps(_mm_cvtepi32_ps(x4), bcClipSpace0, bc);
@@ -484,7 +633,11 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& LS_RESTRICT_PT
             do
             {
                 // calculate barycentric coordinates and perform a depth test
-                const __m128  xBound    = _mm_castsi128_ps(_mm_cmplt_epi32(x4, xMax));
+                #if SL_FBO_TILED_ENABLED
+                    const __m128 xBound = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmplt_epi32(x4, xMin), _mm_cmplt_epi32(x4, xMax)));
+                #else
+                    const __m128 xBound = _mm_castsi128_ps(_mm_cmplt_epi32(x4, xMax));
+                #endif
                 const __m128  z         = _sl_mul_vec4_mat4_ps(depth, bc);
                 const __m128  d         = _sl_get_depth_texel4<depth_type>(pDepth).simd;
                 const __m128  depthTestV = _mm_and_ps(xBound, depthCmpFunc(z, d));
@@ -542,7 +695,7 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& LS_RESTRICT_PT
 
                 x4 = _mm_add_epi32(x4, _mm_set1_epi32(4));
 
-                pDepth += 4;
+                pDepth += SL_FBO_SPAN_STEP;
             }
             while (_mm_movemask_epi8(_mm_cmplt_epi32(x4, xMax)));
 
@@ -655,6 +808,9 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
     const int32_t     increment    = (int32_t)mNumProcessors;
     SL_ScanlineBounds scanline;
 
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+
     for (uint32_t i = 0; i < numBins; ++i)
     {
         const uint32_t binId = pBinIds[i].count;
@@ -695,12 +851,13 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
             int32x4_t xMax;
             scanline.step(yf, xMin, xMax);
 
-            if (LS_LIKELY(vgetq_lane_s32(vcltq_s32(xMin, xMax), 0)))
+            if (LS_LIKELY(vgetq_lane_s32(vcltq_s32(xMin, xMax), 0)) && !_sl_is_scanline_occluded(pDepthBounds, depthTest, math::vec4{depth}, math::vec4{bcClipSpace.val[0]}, math::vec4{bcClipSpace.val[1]}, math::vec4{bcClipSpace.val[2]}, y, vgetq_lane_s32(xMin, 0), vgetq_lane_s32(xMax, 0)))
             {
                 constexpr int32_t indices[4] = {0, 1, 2, 3};
-                const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + (vgetq_lane_s32(xMin, 0) + (int32_t)depthBuffer.width * y);
+                const int32_t     xBegin = sl_fbo_span_begin(vgetq_lane_s32(xMin, 0));
+                const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + sl_fbo_index(depthBuffer, xBegin, y);
                 const float32x4_t bcY    = vmlaq_f32(bcClipSpace.val[2], bcClipSpace.val[1], yf);
-                int32x4_t         x4     = vaddq_s32(vld1q_s32(indices), xMin);
+                int32x4_t         x4     = vaddq_s32(vld1q_s32(indices), vdupq_n_s32(xBegin));
                 const int32x4_t   xMax4  = xMax;
                 const float32x4_t bcX    = vmulq_f32(bcClipSpace.val[0], vdupq_n_f32(4.f));
 
@@ -714,7 +871,11 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
                 do
                 {
                     // calculate barycentric coordinates and perform a depth test
-                    const uint32x4_t  xBound     = vshrq_n_u32(vcltq_s32(x4, xMax4), 31);
+                    #if SL_FBO_TILED_ENABLED
+                        const uint32x4_t  xBound     = vshrq_n_u32(vandq_u32(vcgeq_s32(x4, xMin), vcltq_s32(x4, xMax4)), 31);
+                    #else
+                        const uint32x4_t  xBound     = vshrq_n_u32(vcltq_s32(x4, xMax4), 31);
+                    #endif
                     const float32x4_t d          = _sl_get_depth_texel4<depth_type>(pDepth).simd;
                     const float32x4_t z          = _sl_mul_vec4_mat4_ps(depth, bc);
                     const uint32x4_t  storeMask4 = vandq_u32(xBound, vreinterpretq_u32_f32(depthCmpFunc(z, d)));
@@ -763,7 +924,7 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
                         }
                     }
 
-                    pDepth += 4;
+                    pDepth += SL_FBO_SPAN_STEP;
                     bc.val[0] = vaddq_f32(bc.val[0], bcX);
                     bc.val[1] = vaddq_f32(bc.val[1], bcX);
                     bc.val[2] = vaddq_f32(bc.val[2], bcX);
@@ -790,18 +951,6 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
 
 
 
-inline LS_INLINE ls::math::vec4_t<int> _sl_cmp_vec4_lt(const ls::math::vec4_t<int>& a, const ls::math::vec4_t<int>& b) noexcept
-{
-    return ls::math::vec4_t<int>{
-        a[0] < b[0],
-        a[1] < b[1],
-        a[2] < b[2],
-        a[3] < b[3]
-    };
-}
-
-
-
 template <class DepthCmpFunc, typename depth_type>
 void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) const noexcept
 {
@@ -815,6 +964,9 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
     const int32_t     increment    = (int32_t)mNumProcessors;
     SL_ScanlineBounds scanline;
 
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+
     for (uint32_t i = 0; i < numBins; ++i)
     {
         const uint32_t binId = pBinIds[i].count;
@@ -850,11 +1002,13 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
             int32_t xMax;
             scanline.step(yf, xMin, xMax);
 
-            if (LS_LIKELY((uint32_t)xMin < (uint32_t)xMax))
+            if (LS_LIKELY((uint32_t)xMin < (uint32_t)xMax) && !_sl_is_scanline_occluded(pDepthBounds, depthTest, depth, bcClipSpace[0], bcClipSpace[1], bcClipSpace[2], y, xMin, xMax))
             {
-                const depth_type*  pDepth = (depth_type*)depthBuffer.pTexels + (xMin + (int32_t)depthBuffer.width * y);
+                const int32_t      xBegin = sl_fbo_span_begin(xMin);
+                const depth_type*  pDepth = (depth_type*)depthBuffer.pTexels + sl_fbo_index(depthBuffer, xBegin, y);
                 const math::vec4&& bcY    = math::fmadd(bcClipSpace[1], math::vec4{yf}, bcClipSpace[2]);
-                math::vec4i&&      x4     = math::vec4i{0, 1, 2, 3} + xMin;
+                math::vec4i&&      x4     = math::vec4i{0, 1, 2, 3} + xBegin;
+                const math::vec4i  xMin4  {xMin-1};
                 const math::vec4i  xMax4  {xMax};
                 math::mat4&&       bc     = math::outer((math::vec4)x4, bcClipSpace[0]) + bcY;
                 const math::vec4&& bcX    = bcClipSpace[0] * 4.f;
@@ -862,7 +1016,11 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
                 do
                 {
                     // calculate barycentric coordinates and perform a depth test
-                    const math::vec4i&& xBound = _sl_cmp_vec4_lt(x4, xMax4);
+                    #if SL_FBO_TILED_ENABLED
+                        const math::vec4i&& xBound = _sl_cmp_vec4_between(xMin4, x4, xMax4);
+                    #else
+                        const math::vec4i&& xBound = _sl_cmp_vec4_lt(x4, xMax4);
+                    #endif
                     const math::vec4&&  d      = _sl_get_depth_texel4<depth_type>(pDepth);
                     const math::vec4&&  z      = depth * bc;
 
@@ -903,7 +1061,7 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
                         }
                     }
 
-                    pDepth += 4;
+                    pDepth += SL_FBO_SPAN_STEP;
                     bc += bcX;
                     x4 += 4;
                 }
@@ -927,6 +1085,416 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
 
 
 
+#if SL_AVX2_KERNELS_ENABLED
+
+
+
+/*-------------------------------------
+ * Load and convert 8 depth texels from memory
+-------------------------------------*/
+template <typename depth_type>
+SL_TARGET_AVX2 inline LS_INLINE __m256 _sl_get_depth_texel8(const depth_type* LS_RESTRICT_PTR pDepth) noexcept;
+
+template <>
+SL_TARGET_AVX2 inline LS_INLINE __m256 _sl_get_depth_texel8<math::half>(const math::half* LS_RESTRICT_PTR pDepth) noexcept
+{
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDepth)));
+}
+
+template <>
+SL_TARGET_AVX2 inline LS_INLINE __m256 _sl_get_depth_texel8<float>(const float* LS_RESTRICT_PTR pDepth) noexcept
+{
+    return _mm256_loadu_ps(pDepth);
+}
+
+template <>
+SL_TARGET_AVX2 inline LS_INLINE __m256 _sl_get_depth_texel8<double>(const double* LS_RESTRICT_PTR pDepth) noexcept
+{
+    const __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(pDepth));
+    const __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(pDepth+4));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+
+
+/*-------------------------------------
+ * Lane indices used to left-pack the fragments of an 8-wide register which
+ * passed the depth test. Entry "i" holds one byte-sized lane index for each
+ * bit set in "i".
+-------------------------------------*/
+struct SL_FragCompactTable8
+{
+    alignas(64) uint64_t indices[256];
+
+    SL_FragCompactTable8() noexcept
+    {
+        for (uint32_t mask = 0; mask < 256; ++mask)
+        {
+            uint64_t entry    = 0;
+            uint32_t numLanes = 0;
+
+            for (uint32_t lane = 0; lane < 8; ++lane)
+            {
+                if (mask & (1u << lane))
+                {
+                    entry |= (uint64_t)lane << (numLanes * 8u);
+                    ++numLanes;
+                }
+            }
+
+            indices[mask] = entry;
+        }
+    }
+};
+
+static const SL_FragCompactTable8 _slFragCompactTable8;
+
+
+
+/*-------------------------------------
+ * Render a triangle using 8 elements at a time
+ *
+ * Barycentric coordinates are evaluated as a structure-of-arrays, then
+ * compacted & transposed into the fragment queue.
+-------------------------------------*/
+template <class DepthCmpFunc, typename depth_type>
+SL_TARGET_AVX2 void SL_TriRasterizer::render_triangle_simd8(const SL_TextureView& LS_RESTRICT_PTR depthBuffer) const noexcept
+{
+    constexpr DepthCmpFunc         depthCmpFunc;
+    const SL_BinCounter<uint32_t>* pBinIds     = mBinIds;
+    const SL_FragmentBin* const    pBins       = mBins;
+    const uint32_t                 numBins     = (uint32_t)mNumBins;
+    const uint64_t* const          pCompactIds = _slFragCompactTable8.indices;
+
+    SL_FragCoord*     outCoords    = mQueues;
+    const int32_t     yOffset      = (int32_t)mThreadId;
+    const int32_t     increment    = (int32_t)mNumProcessors;
+    SL_ScanlineBounds scanline;
+
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+
+    const __m256i laneIds = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    for (uint32_t i = 0; i < numBins; ++i)
+    {
+        const uint32_t binId = pBinIds[i].count;
+        const SL_FragmentBin& bin = pBins[binId];
+
+        const __m128 points0 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+0));
+        const __m128 points1 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+1));
+        const __m128 points2 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+2));
+
+        const int32_t bboxMinY       = _mm_extract_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_min_ps(points0, points1), points2)), 1);
+        const int32_t bboxMaxY       = _mm_extract_epi32(_mm_cvtps_epi32(_mm_max_ps(_mm_max_ps(points0, points1), points2)), 1);
+        const int32_t scanLineOffset = sl_scanline_offset<int32_t>(increment, yOffset, bboxMinY);
+
+        int32_t y = bboxMinY + scanLineOffset;
+        if (LS_UNLIKELY(y >= bboxMaxY))
+        {
+            continue;
+        }
+
+        const __m128 d01   = _mm_unpackhi_ps(points0, points1);
+        const __m128 depth = _mm_insert_ps(d01, points2, 0xA8);
+
+        scanline.init(math::vec4{points0}, math::vec4{points1}, math::vec4{points2});
+
+        const __m128 bcClipSpace0   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+0));
+        const __m128 bcClipSpace1   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+1));
+        const __m128 bcClipSpace2   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+2));
+        const __m256 bcX0           = _mm256_broadcastss_ps(bcClipSpace0);
+        const __m256 bcX1           = _mm256_broadcastss_ps(_mm_permute_ps(bcClipSpace0, 0x55));
+        const __m256 bcX2           = _mm256_broadcastss_ps(_mm_permute_ps(bcClipSpace0, 0xAA));
+        const __m256 depth0         = _mm256_broadcastss_ps(depth);
+        const __m256 depth1         = _mm256_broadcastss_ps(_mm_permute_ps(depth, 0x55));
+        const __m256 depth2         = _mm256_broadcastss_ps(_mm_permute_ps(depth, 0xAA));
+        unsigned     numQueuedFrags = 0;
+
+        do
+        {
+            // The scalar scanline step is used since these kernels may be
+            // compiled for a newer instruction set than SL_ScanlineBounds.
+            int32_t x0;
+            int32_t x1;
+            const __m128 yf = _mm_set1_ps((float)y);
+            scanline.step((float)y, x0, x1);
+
+            if (LS_UNLIKELY(x0 >= x1) || _sl_is_scanline_occluded(pDepthBounds, depthTest, math::vec4{depth}, math::vec4{bcClipSpace0}, math::vec4{bcClipSpace1}, math::vec4{bcClipSpace2}, y, x0, x1))
+            {
+                y += increment;
+                continue;
+            }
+
+            const __m128      bcY    = _mm_fmadd_ps(bcClipSpace1, yf, bcClipSpace2);
+            const __m256      bcY0   = _mm256_broadcastss_ps(bcY);
+            const __m256      bcY1   = _mm256_broadcastss_ps(_mm_permute_ps(bcY, 0x55));
+            const __m256      bcY2   = _mm256_broadcastss_ps(_mm_permute_ps(bcY, 0xAA));
+            const __m256i     y16    = _mm256_set1_epi32(y << 16);
+            const __m256i     xMax8  = _mm256_set1_epi32(x1);
+            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + (x0 + (int32_t)depthBuffer.width * y);
+            __m256i           x8     = _mm256_add_epi32(_mm256_set1_epi32(x0), laneIds);
+
+            for (int32_t x = x0; x < x1; x += 8)
+            {
+                // calculate barycentric coordinates and perform a depth test
+                const __m256  xf         = _mm256_cvtepi32_ps(x8);
+                const __m256  bc0        = _mm256_fmadd_ps(bcX0, xf, bcY0);
+                const __m256  bc1        = _mm256_fmadd_ps(bcX1, xf, bcY1);
+                const __m256  bc2        = _mm256_fmadd_ps(bcX2, xf, bcY2);
+                const __m256  z          = _mm256_fmadd_ps(bc0, depth0, _mm256_fmadd_ps(bc1, depth1, _mm256_mul_ps(bc2, depth2)));
+                const __m256  d          = _sl_get_depth_texel8<depth_type>(pDepth);
+                const __m256  xBound     = _mm256_castsi256_ps(_mm256_cmpgt_epi32(xMax8, x8));
+                const int32_t depthTestI = _mm256_movemask_ps(_mm256_and_ps(xBound, depthCmpFunc(z, d)));
+
+                if (LS_LIKELY(depthTestI))
+                {
+                    // Left-pack every fragment which passed
+                    const __m256i compactIds = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pCompactIds + depthTestI)));
+                    const __m256  b0         = _mm256_permutevar8x32_ps(bc0, compactIds);
+                    const __m256  b1         = _mm256_permutevar8x32_ps(bc1, compactIds);
+                    const __m256  b2         = _mm256_permutevar8x32_ps(bc2, compactIds);
+                    const __m256i zi         = _mm256_permutevar8x32_epi32(_mm256_castps_si256(z), compactIds);
+                    const __m256i xy         = _mm256_permutevar8x32_epi32(_mm256_or_si256(x8, y16), compactIds);
+
+                    {
+                        const __m256i xyz0 = _mm256_unpacklo_epi32(xy, zi);
+                        const __m256i xyz1 = _mm256_unpackhi_epi32(xy, zi);
+
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outCoords->coord + numQueuedFrags + 0), _mm256_permute2x128_si256(xyz0, xyz1, 0x20));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outCoords->coord + numQueuedFrags + 4), _mm256_permute2x128_si256(xyz0, xyz1, 0x31));
+                    }
+
+                    {
+                        // transpose back to one vector per fragment
+                        const __m256 t0  = _mm256_unpacklo_ps(b0, b1);
+                        const __m256 t1  = _mm256_unpackhi_ps(b0, b1);
+                        const __m256 t2  = _mm256_unpacklo_ps(b2, _mm256_setzero_ps());
+                        const __m256 t3  = _mm256_unpackhi_ps(b2, _mm256_setzero_ps());
+                        const __m256 v0  = _mm256_shuffle_ps(t0, t2, 0x44);
+                        const __m256 v1  = _mm256_shuffle_ps(t0, t2, 0xEE);
+                        const __m256 v2  = _mm256_shuffle_ps(t1, t3, 0x44);
+                        const __m256 v3  = _mm256_shuffle_ps(t1, t3, 0xEE);
+                        float* const pBc = reinterpret_cast<float*>(outCoords->bc + numQueuedFrags);
+
+                        _mm256_storeu_ps(pBc + 0,  _mm256_permute2f128_ps(v0, v1, 0x20));
+                        _mm256_storeu_ps(pBc + 8,  _mm256_permute2f128_ps(v2, v3, 0x20));
+                        _mm256_storeu_ps(pBc + 16, _mm256_permute2f128_ps(v0, v1, 0x31));
+                        _mm256_storeu_ps(pBc + 24, _mm256_permute2f128_ps(v2, v3, 0x31));
+                    }
+
+                    numQueuedFrags += (unsigned)_mm_popcnt_u32((unsigned)depthTestI);
+                    if (LS_UNLIKELY(numQueuedFrags > SL_SHADER_MAX_QUEUED_FRAGS - 8))
+                    {
+                        flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+                        numQueuedFrags = 0;
+                    }
+                }
+
+                x8 = _mm256_add_epi32(x8, _mm256_set1_epi32(8));
+                pDepth += 8;
+            }
+
+            y += increment;
+        }
+        while (LS_UNLIKELY(y < bboxMaxY));
+
+        if (LS_LIKELY(0 < numQueuedFrags))
+        {
+            flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+        }
+    }
+}
+
+
+
+#if SL_AVX512_KERNELS_ENABLED
+
+
+
+/*-------------------------------------
+ * Load and convert up to 16 depth texels from memory. Texels outside of
+ * "mask" are never read.
+-------------------------------------*/
+template <typename depth_type>
+SL_TARGET_AVX512 inline LS_INLINE __m512 _sl_get_depth_texel16(const depth_type* LS_RESTRICT_PTR pDepth, __mmask16 mask) noexcept;
+
+template <>
+SL_TARGET_AVX512 inline LS_INLINE __m512 _sl_get_depth_texel16<math::half>(const math::half* LS_RESTRICT_PTR pDepth, __mmask16 mask) noexcept
+{
+    return _mm512_cvtph_ps(_mm256_maskz_loadu_epi16(mask, pDepth));
+}
+
+template <>
+SL_TARGET_AVX512 inline LS_INLINE __m512 _sl_get_depth_texel16<float>(const float* LS_RESTRICT_PTR pDepth, __mmask16 mask) noexcept
+{
+    return _mm512_maskz_loadu_ps(mask, pDepth);
+}
+
+template <>
+SL_TARGET_AVX512 inline LS_INLINE __m512 _sl_get_depth_texel16<double>(const double* LS_RESTRICT_PTR pDepth, __mmask16 mask) noexcept
+{
+    const __m256 lo = _mm512_cvtpd_ps(_mm512_maskz_loadu_pd((__mmask8)mask, pDepth));
+    const __m256 hi = _mm512_cvtpd_ps(_mm512_maskz_loadu_pd((__mmask8)(mask >> 8u), pDepth+8));
+    return _mm512_insertf32x8(_mm512_castps256_ps512(lo), hi, 1);
+}
+
+
+
+/*-------------------------------------
+ * Render a triangle using 16 elements at a time
+-------------------------------------*/
+template <class DepthCmpFunc, typename depth_type>
+SL_TARGET_AVX512 void SL_TriRasterizer::render_triangle_simd16(const SL_TextureView& LS_RESTRICT_PTR depthBuffer) const noexcept
+{
+    constexpr DepthCmpFunc         depthCmpFunc;
+    const SL_BinCounter<uint32_t>* pBinIds = mBinIds;
+    const SL_FragmentBin* const    pBins   = mBins;
+    const uint32_t                 numBins = (uint32_t)mNumBins;
+
+    SL_FragCoord*     outCoords    = mQueues;
+    const int32_t     yOffset      = (int32_t)mThreadId;
+    const int32_t     increment    = (int32_t)mNumProcessors;
+    SL_ScanlineBounds scanline;
+
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+
+    // Indices used to interleave the elements of two registers
+    const __m512i laneIds = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i zipLo32 = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i zipHi32 = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+    const __m512i zipLo64 = _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11);
+    const __m512i zipHi64 = _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15);
+
+    for (uint32_t i = 0; i < numBins; ++i)
+    {
+        const uint32_t binId = pBinIds[i].count;
+        const SL_FragmentBin& bin = pBins[binId];
+
+        const __m128 points0 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+0));
+        const __m128 points1 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+1));
+        const __m128 points2 = _mm_load_ps(reinterpret_cast<const float*>(bin.mScreenCoords+2));
+
+        const int32_t bboxMinY       = _mm_extract_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_min_ps(points0, points1), points2)), 1);
+        const int32_t bboxMaxY       = _mm_extract_epi32(_mm_cvtps_epi32(_mm_max_ps(_mm_max_ps(points0, points1), points2)), 1);
+        const int32_t scanLineOffset = sl_scanline_offset<int32_t>(increment, yOffset, bboxMinY);
+
+        int32_t y = bboxMinY + scanLineOffset;
+        if (LS_UNLIKELY(y >= bboxMaxY))
+        {
+            continue;
+        }
+
+        const __m128 d01   = _mm_unpackhi_ps(points0, points1);
+        const __m128 depth = _mm_insert_ps(d01, points2, 0xA8);
+
+        scanline.init(math::vec4{points0}, math::vec4{points1}, math::vec4{points2});
+
+        const __m128 bcClipSpace0   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+0));
+        const __m128 bcClipSpace1   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+1));
+        const __m128 bcClipSpace2   = _mm_load_ps(reinterpret_cast<const float*>(bin.mBarycentricCoords+2));
+        const __m512 bcX0           = _mm512_broadcastss_ps(bcClipSpace0);
+        const __m512 bcX1           = _mm512_broadcastss_ps(_mm_permute_ps(bcClipSpace0, 0x55));
+        const __m512 bcX2           = _mm512_broadcastss_ps(_mm_permute_ps(bcClipSpace0, 0xAA));
+        const __m512 depth0         = _mm512_broadcastss_ps(depth);
+        const __m512 depth1         = _mm512_broadcastss_ps(_mm_permute_ps(depth, 0x55));
+        const __m512 depth2         = _mm512_broadcastss_ps(_mm_permute_ps(depth, 0xAA));
+        unsigned     numQueuedFrags = 0;
+
+        do
+        {
+            int32_t x0;
+            int32_t x1;
+            const __m128 yf = _mm_set1_ps((float)y);
+            scanline.step((float)y, x0, x1);
+
+            if (LS_UNLIKELY(x0 >= x1) || _sl_is_scanline_occluded(pDepthBounds, depthTest, math::vec4{depth}, math::vec4{bcClipSpace0}, math::vec4{bcClipSpace1}, math::vec4{bcClipSpace2}, y, x0, x1))
+            {
+                y += increment;
+                continue;
+            }
+
+            const __m128      bcY    = _mm_fmadd_ps(bcClipSpace1, yf, bcClipSpace2);
+            const __m512      bcY0   = _mm512_broadcastss_ps(bcY);
+            const __m512      bcY1   = _mm512_broadcastss_ps(_mm_permute_ps(bcY, 0x55));
+            const __m512      bcY2   = _mm512_broadcastss_ps(_mm_permute_ps(bcY, 0xAA));
+            const __m512i     y16    = _mm512_set1_epi32(y << 16);
+            const __m512i     xMax16 = _mm512_set1_epi32(x1);
+            const depth_type* pDepth = (depth_type*)depthBuffer.pTexels + (x0 + (int32_t)depthBuffer.width * y);
+            __m512i           x16    = _mm512_add_epi32(_mm512_set1_epi32(x0), laneIds);
+
+            for (int32_t x = x0; x < x1; x += 16)
+            {
+                // calculate barycentric coordinates and perform a depth test
+                const __mmask16 xBound     = _mm512_cmplt_epi32_mask(x16, xMax16);
+                const __m512    xf         = _mm512_cvtepi32_ps(x16);
+                const __m512    bc0        = _mm512_fmadd_ps(bcX0, xf, bcY0);
+                const __m512    bc1        = _mm512_fmadd_ps(bcX1, xf, bcY1);
+                const __m512    bc2        = _mm512_fmadd_ps(bcX2, xf, bcY2);
+                const __m512    z          = _mm512_fmadd_ps(bc0, depth0, _mm512_fmadd_ps(bc1, depth1, _mm512_mul_ps(bc2, depth2)));
+                const __m512    d          = _sl_get_depth_texel16<depth_type>(pDepth, xBound);
+                const __mmask16 depthTestM = xBound & depthCmpFunc(z, d);
+
+                if (LS_LIKELY(depthTestM))
+                {
+                    // Left-pack every fragment which passed
+                    const __m512  b0 = _mm512_maskz_compress_ps(depthTestM, bc0);
+                    const __m512  b1 = _mm512_maskz_compress_ps(depthTestM, bc1);
+                    const __m512  b2 = _mm512_maskz_compress_ps(depthTestM, bc2);
+                    const __m512i zi = _mm512_maskz_compress_epi32(depthTestM, _mm512_castps_si512(z));
+                    const __m512i xy = _mm512_maskz_compress_epi32(depthTestM, _mm512_or_si512(x16, y16));
+
+                    _mm512_storeu_si512(outCoords->coord + numQueuedFrags + 0, _mm512_permutex2var_epi32(xy, zipLo32, zi));
+                    _mm512_storeu_si512(outCoords->coord + numQueuedFrags + 8, _mm512_permutex2var_epi32(xy, zipHi32, zi));
+
+                    {
+                        // transpose back to one vector per fragment
+                        const __m512d ab0 = _mm512_castps_pd(_mm512_permutex2var_ps(b0, zipLo32, b1));
+                        const __m512d ab1 = _mm512_castps_pd(_mm512_permutex2var_ps(b0, zipHi32, b1));
+                        const __m512d c0  = _mm512_castps_pd(_mm512_permutex2var_ps(b2, zipLo32, _mm512_setzero_ps()));
+                        const __m512d c1  = _mm512_castps_pd(_mm512_permutex2var_ps(b2, zipHi32, _mm512_setzero_ps()));
+                        float* const  pBc = reinterpret_cast<float*>(outCoords->bc + numQueuedFrags);
+
+                        _mm512_storeu_pd(pBc + 0,  _mm512_permutex2var_pd(ab0, zipLo64, c0));
+                        _mm512_storeu_pd(pBc + 16, _mm512_permutex2var_pd(ab0, zipHi64, c0));
+                        _mm512_storeu_pd(pBc + 32, _mm512_permutex2var_pd(ab1, zipLo64, c1));
+                        _mm512_storeu_pd(pBc + 48, _mm512_permutex2var_pd(ab1, zipHi64, c1));
+                    }
+
+                    numQueuedFrags += (unsigned)_mm_popcnt_u32((unsigned)depthTestM);
+                    if (LS_UNLIKELY(numQueuedFrags > SL_SHADER_MAX_QUEUED_FRAGS - 16))
+                    {
+                        flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+                        numQueuedFrags = 0;
+                    }
+                }
+
+                x16 = _mm512_add_epi32(x16, _mm512_set1_epi32(16));
+                pDepth += 16;
+            }
+
+            y += increment;
+        }
+        while (LS_UNLIKELY(y < bboxMaxY));
+
+        if (LS_LIKELY(0 < numQueuedFrags))
+        {
+            flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+        }
+    }
+}
+
+
+
+#endif /* SL_AVX512_KERNELS_ENABLED */
+
+
+
+#endif /* SL_AVX2_KERNELS_ENABLED */
+
+
+
  template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
  template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
  template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
@@ -955,6 +1523,251 @@ void SL_TriRasterizer::render_triangle_simd(const SL_TextureView& depthBuffer) c
  template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
  template void SL_TriRasterizer::render_triangle_simd<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
 
+#if SL_AVX2_KERNELS_ENABLED
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd8<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+
+
+
+#if SL_AVX512_KERNELS_ENABLED
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_simd16<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+#endif /* SL_AVX512_KERNELS_ENABLED */
+#endif /* SL_AVX2_KERNELS_ENABLED */
+
+
+
+/*-------------------------------------
+ * Render triangles one screen-space tile at a time
+-------------------------------------*/
+template <class DepthCmpFunc, typename depth_type>
+void SL_TriRasterizer::render_triangle_tiled(const SL_TextureView& depthBuffer) const noexcept
+{
+    constexpr DepthCmpFunc      depthCmpFunc;
+    SL_BinTileMap* const        pTiles         = mBinTiles;
+    const SL_FragmentBin* const pBins          = mBins;
+    const uint32_t              numActiveTiles = pTiles->numActiveTiles;
+    const uint32_t              numTilesX      = pTiles->numTilesX;
+    const int32_t               fboW           = (int32_t)depthBuffer.width;
+    const int32_t               fboH           = (int32_t)depthBuffer.height;
+
+    SL_FragCoord*     outCoords = mQueues;
+    SL_ScanlineBounds scanline;
+
+    const SL_DepthTest       depthTest    = mShader->pipelineState.depth_test();
+    const SL_DepthHierarchy* pDepthBounds = _sl_depth_bounds_for_test(mFbo, depthTest);
+    SL_DepthHierarchy&       depthBounds  = mFbo->depth_hierarchy();
+    const bool               updateBounds = depthBounds.valid() && mShader->pipelineState.depth_mask() == SL_DEPTH_MASK_ON;
+
+    // Threads claim whole tiles at a time. Every primitive within a tile is
+    // rendered by the same thread, in the order it was sorted.
+    uint_fast32_t activeId = pTiles->nextTile.fetch_add(1, std::memory_order_acq_rel);
+
+    while (activeId < numActiveTiles)
+    {
+        const uint32_t  tileId      = pTiles->activeTiles[activeId];
+        const int32_t   tileX0      = (int32_t)((tileId % numTilesX) * SL_BIN_TILE_SIZE);
+        const int32_t   tileY0      = (int32_t)((tileId / numTilesX) * SL_BIN_TILE_SIZE);
+        const int32_t   tileX1      = math::min<int32_t>(tileX0 + SL_BIN_TILE_SIZE, fboW);
+        const int32_t   tileY1      = math::min<int32_t>(tileY0 + SL_BIN_TILE_SIZE, fboH);
+        const uint32_t* pTileBins   = pTiles->binIds + pTiles->tileOffsets[tileId];
+        const uint32_t  numTileBins = pTiles->tileCounts[tileId];
+
+        for (uint32_t i = 0; i < numTileBins; ++i)
+        {
+            const SL_FragmentBin& bin = pBins[pTileBins[i]];
+
+            unsigned          numQueuedFrags = 0;
+            const math::vec4* pPoints        = bin.mScreenCoords;
+            const int32_t     bboxMinY       = (int32_t)math::min(pPoints[0][1], pPoints[1][1], pPoints[2][1]);
+            const int32_t     bboxMaxY       = (int32_t)math::max(pPoints[0][1], pPoints[1][1], pPoints[2][1]);
+            const int32_t     yMax           = math::min<int32_t>(bboxMaxY, tileY1);
+
+            int32_t y = math::max<int32_t>(bboxMinY, tileY0);
+            if (LS_UNLIKELY(y >= yMax))
+            {
+                continue;
+            }
+
+            const math::vec4 depth{pPoints[0][2], pPoints[1][2], pPoints[2][2], 0.f};
+
+            scanline.init(pPoints[0], pPoints[1], pPoints[2]);
+
+            const math::vec4* bcClipSpace = bin.mBarycentricCoords;
+
+            do
+            {
+                // calculate the bounds of the current scan-line, restricted
+                // to the current tile
+                const float yf = (float)y;
+
+                int32_t xMin;
+                int32_t xMax;
+                scanline.step(yf, xMin, xMax);
+                xMin = math::max<int32_t>(xMin, tileX0);
+                xMax = math::min<int32_t>(xMax, tileX1);
+
+                if (LS_LIKELY(xMin < xMax) && !_sl_is_scanline_occluded(pDepthBounds, depthTest, depth, bcClipSpace[0], bcClipSpace[1], bcClipSpace[2], y, xMin, xMax))
+                {
+                    const int32_t      xBegin = sl_fbo_span_begin(xMin);
+                    const depth_type*  pDepth = (depth_type*)depthBuffer.pTexels + sl_fbo_index(depthBuffer, xBegin, y);
+                    const math::vec4&& bcY    = math::fmadd(bcClipSpace[1], math::vec4{yf}, bcClipSpace[2]);
+                    math::vec4i&&      x4     = math::vec4i{0, 1, 2, 3} + xBegin;
+                    const math::vec4i  xMin4  {xMin-1};
+                    const math::vec4i  xMax4  {xMax};
+                    math::mat4&&       bc     = math::outer((math::vec4)x4, bcClipSpace[0]) + bcY;
+                    const math::vec4&& bcX    = bcClipSpace[0] * 4.f;
+
+                    do
+                    {
+                        // calculate barycentric coordinates and perform a depth test
+                        #if SL_FBO_TILED_ENABLED
+                            const math::vec4i&& xBound = _sl_cmp_vec4_between(xMin4, x4, xMax4);
+                        #else
+                            const math::vec4i&& xBound = _sl_cmp_vec4_lt(x4, xMax4);
+                        #endif
+                        const math::vec4&&  d      = _sl_get_depth_texel4<depth_type>(pDepth);
+                        const math::vec4&&  z      = depth * bc;
+
+                        math::vec4i&& storeMask4 = depthCmpFunc(z, d);
+                        storeMask4[0] &= xBound[0];
+                        storeMask4[1] &= xBound[1];
+                        storeMask4[2] &= xBound[2];
+                        storeMask4[3] &= xBound[3];
+
+                        if (LS_LIKELY(storeMask4 != 0))
+                        {
+                            const unsigned storeMask0 = numQueuedFrags;
+                            const unsigned storeMask1 = storeMask4[0]+storeMask0;
+                            const unsigned storeMask2 = storeMask4[1]+storeMask1;
+                            const unsigned storeMask3 = storeMask4[2]+storeMask2;
+                            const uint16_t y16        = (uint16_t)y;
+
+                            outCoords->coord[storeMask0] = SL_FragCoordXYZ{(uint16_t)x4.v[0], y16, z[0]};
+                            outCoords->coord[storeMask1] = SL_FragCoordXYZ{(uint16_t)x4.v[1], y16, z[1]};
+                            outCoords->coord[storeMask2] = SL_FragCoordXYZ{(uint16_t)x4.v[2], y16, z[2]};
+                            outCoords->coord[storeMask3] = SL_FragCoordXYZ{(uint16_t)x4.v[3], y16, z[3]};
+
+                            outCoords->bc[storeMask0] = bc[0];
+                            outCoords->bc[storeMask1] = bc[1];
+                            outCoords->bc[storeMask2] = bc[2];
+                            outCoords->bc[storeMask3] = bc[3];
+
+                            numQueuedFrags += math::sum(storeMask4);
+                            if (LS_UNLIKELY(numQueuedFrags > SL_SHADER_MAX_QUEUED_FRAGS - 4))
+                            {
+                                flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+                                numQueuedFrags = 0;
+                            }
+                        }
+
+                        pDepth += SL_FBO_SPAN_STEP;
+                        bc += bcX;
+                        x4 += 4;
+                    }
+                    while (x4.v[0] < xMax);
+                }
+
+                ++y;
+            }
+            while (y < yMax);
+
+            if (LS_LIKELY(0 < numQueuedFrags))
+            {
+                flush_tri_fragments<depth_type>(bin, numQueuedFrags, outCoords);
+            }
+        }
+
+        // Nobody else can write to this tile until the next flush.
+        if (updateBounds)
+        {
+            depthBounds.update_spans<depth_type>(depthBuffer, tileX0, tileY0, tileX1, tileY1, 1);
+        }
+
+        activeId = pTiles->nextTile.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncLE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGT, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncGE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncEQ, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncNE, double>(const SL_TextureView&) const noexcept;
+
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, ls::math::half>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, float>(const SL_TextureView&) const noexcept;
+ template void SL_TriRasterizer::render_triangle_tiled<SL_DepthFuncOFF, double>(const SL_TextureView&) const noexcept;
+
 
 
 /*-------------------------------------
@@ -985,22 +1798,45 @@ void SL_TriRasterizer::dispatch_bins() noexcept
 
         case RENDER_MODE_TRIANGLES:
         case RENDER_MODE_INDEXED_TRIANGLES:
+            #if SL_TILED_BINNING_ENABLED
+                // Tiles are only unavailable if the framebuffer is too
+                // large or the bins overlap too many of them.
+                if (LS_LIKELY(mBinTiles->numActiveTiles > 0))
+                {
+                    if (depthBpp == sizeof(math::half))
+                    {
+                        render_triangle_tiled<DepthCmpFunc, math::half>(mFbo->get_depth_buffer());
+                    }
+                    else if (depthBpp == sizeof(float))
+                    {
+                        render_triangle_tiled<DepthCmpFunc, float>(mFbo->get_depth_buffer());
+                    }
+                    else if (depthBpp == sizeof(double))
+                    {
+                        render_triangle_tiled<DepthCmpFunc, double>(mFbo->get_depth_buffer());
+                    }
+
+                    // Depth bounds were updated as each tile completed
+                    return;
+                }
+            #endif
+
             // Triangles assign scan-lines per thread for rasterization.
             // There's No need to subdivide the output framebuffer
             if (depthBpp == sizeof(math::half))
             {
                 //render_triangle<DepthCmpFunc, math::half>(mFbo->get_depth_buffer());
-                render_triangle_simd<DepthCmpFunc, math::half>(mFbo->get_depth_buffer());
+                _sl_render_triangles<DepthCmpFunc, math::half>(this, mFbo->get_depth_buffer());
             }
             else if (depthBpp == sizeof(float))
             {
                 //render_triangle<DepthCmpFunc, float>(mFbo->get_depth_buffer());
-                render_triangle_simd<DepthCmpFunc, float>(mFbo->get_depth_buffer());
+                _sl_render_triangles<DepthCmpFunc, float>(this, mFbo->get_depth_buffer());
             }
             else if (depthBpp == sizeof(double))
             {
                 //render_triangle<DepthCmpFunc, double>(mFbo->get_depth_buffer());
-                render_triangle_simd<DepthCmpFunc, double>(mFbo->get_depth_buffer());
+                _sl_render_triangles<DepthCmpFunc, double>(this, mFbo->get_depth_buffer());
             }
             break;
 
@@ -1008,6 +1844,24 @@ void SL_TriRasterizer::dispatch_bins() noexcept
             LS_DEBUG_ASSERT(false);
             LS_UNREACHABLE();
     }
+
+    // Each thread owns a fixed set of scanlines, so the depth bounds of those
+    // scanlines can be updated without waiting on other threads.
+    if (mShader->pipelineState.depth_mask() == SL_DEPTH_MASK_ON)
+    {
+        if (depthBpp == sizeof(math::half))
+        {
+            _sl_update_depth_bounds<math::half>(mFbo, (int32_t)mThreadId, (int32_t)mNumProcessors);
+        }
+        else if (depthBpp == sizeof(float))
+        {
+            _sl_update_depth_bounds<float>(mFbo, (int32_t)mThreadId, (int32_t)mNumProcessors);
+        }
+        else if (depthBpp == sizeof(double))
+        {
+            _sl_update_depth_bounds<double>(mFbo, (int32_t)mThreadId, (int32_t)mNumProcessors);
+        }
+    }
 }
 
 
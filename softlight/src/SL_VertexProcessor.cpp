@@ -1,13 +1,16 @@
 
 #include "lightsky/setup/Types.h"
 
+#include "lightsky/utils/Copy.h" // utils::fast_memset_4
 #include "lightsky/utils/Sort.hpp" // utils::sort_radix
 
 #include "softlight/SL_Context.hpp"
+#include "softlight/SL_Framebuffer.hpp"
 #include "softlight/SL_LineRasterizer.hpp"
 #include "softlight/SL_PointRasterizer.hpp"
 #include "softlight/SL_Shader.hpp" // SL_Shader
 #include "softlight/SL_ShaderUtil.hpp" // SL_BinCounter, SL_BinCounterAtomic
+#include "softlight/SL_ThreadStats.hpp"
 #include "softlight/SL_TriRasterizer.hpp"
 #include "softlight/SL_VertexProcessor.hpp"
 #include "softlight/SL_ViewportState.hpp"
@@ -81,14 +84,122 @@ inline LS_INLINE IntegralType _sl_cpu_yield_exponential(IntegralType yieldCount)
  * Exponential CPU-yielding to reduce spinlock overhead
 -------------------------------------*/
 template <typename WaitCondition>
-inline LS_INLINE void _sl_cpu_yield_loop(const WaitCondition& cond) noexcept
+inline LS_INLINE void _sl_cpu_yield_loop(SL_ThreadStats* pStats, const WaitCondition& cond) noexcept
 {
     uint_fast32_t yieldCount = 0;
+    const uint64_t idleStart = sl_thread_stats_timestamp();
 
     while (cond())
     {
         yieldCount = _sl_cpu_yield_exponential<uint_fast32_t>(yieldCount);
     }
+
+    sl_thread_stats_add_idle(pStats, idleStart);
+}
+
+
+
+/*-------------------------------------
+ * Distribute sorted bins into screen-space tiles
+-------------------------------------*/
+void _sl_build_bin_tiles(
+    SL_BinTileMap& tiles,
+    const SL_BinCounter<uint32_t>* pBinIds,
+    const SL_FragmentBin* pBins,
+    uint_fast64_t numBins,
+    uint32_t fboWidth,
+    uint32_t fboHeight) noexcept
+{
+    const uint32_t numTilesX = (fboWidth + SL_BIN_TILE_SIZE - 1u) / SL_BIN_TILE_SIZE;
+    const uint32_t numTilesY = (fboHeight + SL_BIN_TILE_SIZE - 1u) / SL_BIN_TILE_SIZE;
+    const uint32_t numTiles  = numTilesX * numTilesY;
+
+    tiles.numTilesX      = numTilesX;
+    tiles.numTilesY      = numTilesY;
+    tiles.numActiveTiles = 0;
+    tiles.nextTile.store(0, std::memory_order_relaxed);
+
+    if (LS_UNLIKELY(!numTiles || numTiles > SL_SHADER_MAX_BIN_TILES))
+    {
+        return;
+    }
+
+    uint32_t* const LS_RESTRICT_PTR pOffsets = tiles.tileOffsets;
+    uint32_t* const LS_RESTRICT_PTR pCounts  = tiles.tileCounts;
+    uint_fast64_t numRefs = 0;
+
+    utils::fast_memset_4(pCounts, 0, sizeof(uint32_t) * numTiles);
+
+    // Count the number of primitives overlapping each tile
+    for (uint_fast64_t i = 0; i < numBins; ++i)
+    {
+        const uint16_t* bounds = pBins[pBinIds[i].count].mTileBounds;
+        const uint32_t  tx0    = math::min<uint32_t>(bounds[0], numTilesX-1u);
+        const uint32_t  ty0    = math::min<uint32_t>(bounds[1], numTilesY-1u);
+        const uint32_t  tx1    = math::min<uint32_t>(bounds[2], numTilesX-1u);
+        const uint32_t  ty1    = math::min<uint32_t>(bounds[3], numTilesY-1u);
+
+        numRefs += (uint_fast64_t)(tx1-tx0+1u) * (uint_fast64_t)(ty1-ty0+1u);
+        if (LS_UNLIKELY(numRefs > SL_SHADER_MAX_TILE_REFS))
+        {
+            // Too many references, let the rasterizers fall back to
+            // scanline interleaving for this batch of bins.
+            return;
+        }
+
+        for (uint32_t ty = ty0; ty <= ty1; ++ty)
+        {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx)
+            {
+                ++pCounts[tx + ty * numTilesX];
+            }
+        }
+    }
+
+    // Reserve a contiguous range of bin IDs per tile. Only non-empty tiles
+    // need to be visited by the rasterizers.
+    uint32_t numActive = 0;
+    for (uint32_t t = 0, offset = 0; t < numTiles; ++t)
+    {
+        const uint32_t count = pCounts[t];
+        pOffsets[t] = offset;
+        pCounts[t]  = 0;
+        offset     += count;
+
+        if (count)
+        {
+            tiles.activeTiles[numActive++] = t;
+        }
+    }
+
+    // Scatter bin IDs into their tiles, keeping the sorted order intact
+    for (uint_fast64_t i = 0; i < numBins; ++i)
+    {
+        const uint32_t  binId  = pBinIds[i].count;
+        const uint16_t* bounds = pBins[binId].mTileBounds;
+        const uint32_t  tx0    = math::min<uint32_t>(bounds[0], numTilesX-1u);
+        const uint32_t  ty0    = math::min<uint32_t>(bounds[1], numTilesY-1u);
+        const uint32_t  tx1    = math::min<uint32_t>(bounds[2], numTilesX-1u);
+        const uint32_t  ty1    = math::min<uint32_t>(bounds[3], numTilesY-1u);
+
+        for (uint32_t ty = ty0; ty <= ty1; ++ty)
+        {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx)
+            {
+                const uint32_t t = tx + ty * numTilesX;
+                tiles.binIds[pOffsets[t] + pCounts[t]++] = binId;
+            }
+        }
+    }
+
+    // Hand out the busiest tiles first. Threads which pick up the smaller
+    // tiles near the end can then finish at roughly the same time.
+    utils::sort_radix<uint32_t>(tiles.activeTiles, tiles.tempTiles, (uint64_t)numActive, [&](uint32_t t) noexcept->unsigned long long
+    {
+        return (unsigned long long)(~pCounts[t]);
+    });
+
+    tiles.numActiveTiles = numActive;
 }
 
 
@@ -100,6 +211,48 @@ inline LS_INLINE void _sl_cpu_yield_loop(const WaitCondition& cond) noexcept
 /*-----------------------------------------------------------------------------
  * SL_VertexProcessor Class
 -----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Prepare for processing a new draw
+-------------------------------------*/
+void SL_VertexProcessor::begin_draw() noexcept
+{
+    mAmDone = 0;
+
+    sl_thread_stats_begin_draw(mThreadStats ? (mThreadStats + mThreadId) : nullptr);
+
+    // All meshes in a draw are split into fixed-size chunks which are
+    // numbered consecutively. Claiming the first chunk up-front lets
+    // next_chunk() skip over meshes which were completed by other threads.
+    mChunkBase = 0;
+    mChunkId   = (size_t)mVertChunks->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+
+/*-------------------------------------
+ * Claim a range of primitives from the current mesh
+-------------------------------------*/
+bool SL_VertexProcessor::next_chunk(size_t elementBegin, size_t elementEnd, size_t vertsPerPrim, size_t& outBegin, size_t& outEnd) noexcept
+{
+    const size_t chunkElements = (size_t)SL_VERTEX_CHUNK_SIZE * vertsPerPrim;
+    const size_t numChunks     = (elementEnd - elementBegin + chunkElements - 1u) / chunkElements;
+
+    // Move onto the next mesh once all chunks in this one have been claimed.
+    if (mChunkId >= mChunkBase + numChunks)
+    {
+        mChunkBase += numChunks;
+        return false;
+    }
+
+    outBegin = elementBegin + (mChunkId - mChunkBase) * chunkElements;
+    outEnd   = math::min<size_t>(outBegin + chunkElements, elementEnd);
+    mChunkId = (size_t)mVertChunks->count.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+
+
 /*-------------------------------------
  * Execute the rasterizer
 -------------------------------------*/
@@ -111,6 +264,7 @@ void SL_VertexProcessor::flush_rasterizer() const noexcept
     const int_fast64_t    syncPoint1   = -numThreads - 1;
     const int_fast64_t    tileId       = mFragProcessors->count.fetch_add(1ll, std::memory_order_acq_rel);
     const SL_FragmentBin* pBins        = mFragBins;
+    SL_ThreadStats*       pStats       = mThreadStats ? (mThreadStats + mThreadId) : nullptr;
     uint_fast64_t         maxElements;
     int_fast64_t          syncPoint2;
 
@@ -151,12 +305,33 @@ void SL_VertexProcessor::flush_rasterizer() const noexcept
             });
         }
 
+        #if SL_TILED_BINNING_ENABLED
+            if (ls::setup::IsSame<RasterizerType, SL_TriRasterizer>::value || ls::setup::IsSame<RasterizerType, SL_PointRasterizer>::value)
+            {
+                if (mRenderMode == RENDER_MODE_TRIANGLES || mRenderMode == RENDER_MODE_INDEXED_TRIANGLES || mRenderMode == RENDER_MODE_POINTS || mRenderMode == RENDER_MODE_INDEXED_POINTS)
+                {
+                    _sl_build_bin_tiles(*mBinTiles, mBinIds, pBins, maxElements, mFbo->width(), mFbo->height());
+                }
+                else
+                {
+                    mBinTiles->numActiveTiles = 0;
+                }
+            }
+        #else
+            // Points cover so few pixels that interleaving scanlines would
+            // have every thread visit every point, so they're always tiled.
+            if (ls::setup::IsSame<RasterizerType, SL_PointRasterizer>::value)
+            {
+                _sl_build_bin_tiles(*mBinTiles, mBinIds, pBins, maxElements, mFbo->width(), mFbo->height());
+            }
+        #endif
+
         // Let all threads know they can process fragments.
         mFragProcessors->count.store(syncPoint1, std::memory_order_release);
     }
     else
     {
-        _sl_cpu_yield_loop([&]()->bool {
+        _sl_cpu_yield_loop(pStats, [&]()->bool {
             return mFragProcessors->count.load(std::memory_order_consume) > 0;
         });
 
@@ -175,6 +350,10 @@ void SL_VertexProcessor::flush_rasterizer() const noexcept
     rasterizer.mBinIds = mBinIds;
     rasterizer.mBins = pBins;
     rasterizer.mQueues = mFragQueues + mThreadId;
+    rasterizer.mBinTiles = mBinTiles;
+
+    const SL_BlendMode blendMode = mShader->pipelineState.blend_mode();
+    rasterizer.mPixelWriter = mFbo->pixel_writer(sl_calc_fbo_out_mask((unsigned)mShader->pipelineState.num_render_targets(), (blendMode != SL_BLEND_OFF)), blendMode);
 
     rasterizer.execute();
 
@@ -190,7 +369,7 @@ void SL_VertexProcessor::flush_rasterizer() const noexcept
     {
         if (LS_UNLIKELY(!mAmDone))
         {
-            _sl_cpu_yield_loop([&]()->bool {
+            _sl_cpu_yield_loop(pStats, [&]()->bool {
                 return mFragProcessors->count.load(std::memory_order_consume) < 0;
             });
         }
@@ -207,6 +386,7 @@ void SL_VertexProcessor::cleanup() noexcept
 {
     static_assert(ls::setup::IsBaseOf<SL_FragmentProcessor, RasterizerType>::value, "Template parameter 'RasterizerType' must derive from SL_FragmentProcessor.");
     uint_fast32_t currentIters = 0;
+    SL_ThreadStats* pStats = mThreadStats ? (mThreadStats + mThreadId) : nullptr;
 
     mBusyProcessors->count.fetch_sub(1, std::memory_order_acq_rel);
     while (mBusyProcessors->count.load(std::memory_order_acquire))
@@ -215,13 +395,15 @@ void SL_VertexProcessor::cleanup() noexcept
         {
             flush_rasterizer<RasterizerType>();
 
-            _sl_cpu_yield_loop([&]()->bool {
+            _sl_cpu_yield_loop(pStats, [&]()->bool {
                 return mFragProcessors->count.load(std::memory_order_consume) < 0;
             });
         }
         else
         {
+            const uint64_t idleStart = sl_thread_stats_timestamp();
             currentIters = _sl_cpu_yield_exponential<uint_fast32_t>(currentIters);
+            sl_thread_stats_add_idle(pStats, idleStart);
         }
     }
 
@@ -229,6 +411,8 @@ void SL_VertexProcessor::cleanup() noexcept
     {
         flush_rasterizer<RasterizerType>();
     }
+
+    sl_thread_stats_end_draw(pStats);
 }
 
 
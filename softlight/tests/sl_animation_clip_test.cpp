@@ -0,0 +1,255 @@
+
+#include <cmath> // std::abs, std::sin, std::cos
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/vec_utils.h"
+#include "lightsky/math/quat.h"
+
+#include "softlight/SL_Animation.hpp"
+#include "softlight/SL_AnimationChannel.hpp"
+#include "softlight/SL_AnimationClip.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp"
+#include "softlight/SL_Transform.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Keys are placed on the packed clip's sample grid, so resampling alone
+ * doesn't introduce any error.
+-----------------------------------------------------------------------------*/
+constexpr size_t           NUM_TEST_CHANNELS   = 7;
+constexpr SL_AnimPrecision TEST_KEY_STEP       = SL_AnimPrecision{0.125};
+constexpr SL_AnimPrecision TEST_SAMPLE_RATE    = SL_AnimPrecision{32.0};
+constexpr float            TEST_EPSILON        = 1.0e-3f;
+constexpr float            TEST_ROT_EPSILON    = 1.0e-4f;
+const math::vec3           TEST_SENTINEL_VALUE = math::vec3{100.f};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Channel setup
+ *
+ * Every third channel covers the whole animation, the next only covers part
+ * of it with each type of key, and the last jumps between keys.
+-----------------------------------------------------------------------------*/
+bool build_channel(SL_AnimationChannel& track, size_t channelId, uint32_t& seed)
+{
+    const bool partial = (channelId % 3u) == 1u;
+    const bool stepped = (channelId % 3u) == 2u;
+
+    const size_t           numKeys  = partial ? 5u : 9u;
+    const SL_AnimPrecision posStart = partial ? SL_AnimPrecision{0.25} : SL_AnimPrecision{0.0};
+    const SL_AnimPrecision sclStart = partial ? SL_AnimPrecision{0.5} : SL_AnimPrecision{0.0};
+    const SL_AnimPrecision rotStart = SL_AnimPrecision{0.0};
+
+    if (!track.size(numKeys, numKeys, numKeys))
+    {
+        return false;
+    }
+
+    track.mAnimMode = stepped ? SL_ANIM_FLAG_IMMEDIATE : SL_ANIM_FLAG_INTERPOLATE;
+
+    const math::vec3&& axis = math::normalize(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} + math::vec3{0.f, 2.f, 0.f});
+
+    for (size_t k = 0; k < numKeys; ++k)
+    {
+        const SL_AnimPrecision keyOffset = TEST_KEY_STEP * (SL_AnimPrecision)k;
+        const float angle = 0.15f * (float)k + 0.05f * sl_test_random(seed);
+
+        track.mPosFrames.frame(k, posStart + keyOffset, math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} * 5.f);
+        track.mScaleFrames.frame(k, sclStart + keyOffset, math::vec3{2.f} + math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)});
+        track.mOrientFrames.frame(k, rotStart + keyOffset, math::quat{axis[0] * std::sin(angle), axis[1] * std::sin(angle), axis[2] * std::sin(angle), std::cos(angle)});
+    }
+
+    return true;
+}
+
+
+
+bool build_animation(SL_SceneGraph& graph, SL_Animation& anim, uint32_t& seed)
+{
+    graph.mNodeAnims.emplace_back();
+    SL_AlignedVector<SL_AnimationChannel>& channels = graph.mNodeAnims.back();
+    channels.resize(NUM_TEST_CHANNELS);
+
+    anim.duration(SL_AnimPrecision{1.0});
+    anim.ticks_per_sec(SL_AnimPrecision{1.0});
+
+    for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+    {
+        if (!build_channel(channels[c], c, seed))
+        {
+            return false;
+        }
+
+        const std::string nodeName = "node_" + std::to_string(c);
+        const size_t nodeId = graph.insert_empty_node(SCENE_NODE_ROOT_ID, nodeName.c_str(), SL_Transform{});
+        anim.add_channel(0, c, nodeId);
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Animate a set of nodes from a known state
+-----------------------------------------------------------------------------*/
+void animate_nodes(SL_SceneGraph& graph, const SL_Animation& anim, SL_AnimPrecision percent, SL_Transform* pOutTransforms)
+{
+    for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+    {
+        SL_Transform& t = graph.mCurrentTransforms[anim.transforms()[c]];
+        t.position(TEST_SENTINEL_VALUE);
+        t.scaling(TEST_SENTINEL_VALUE);
+        t.orientation(math::quat{0.f, 0.f, 0.f, 1.f});
+    }
+
+    anim.animate(graph, percent);
+
+    for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+    {
+        pOutTransforms[c] = graph.mCurrentTransforms[anim.transforms()[c]];
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare the packed & unpacked animations at a point in time
+-----------------------------------------------------------------------------*/
+bool compare_animations(SL_SceneGraph& graph, const SL_Animation& anim, const SL_Animation& packedAnim, SL_AnimPrecision percent)
+{
+    SL_Transform expected[NUM_TEST_CHANNELS];
+    SL_Transform packed[NUM_TEST_CHANNELS];
+
+    animate_nodes(graph, anim, percent, expected);
+    animate_nodes(graph, packedAnim, percent, packed);
+
+    for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+    {
+        const math::vec3& pa = expected[c].position();
+        const math::vec3& pb = packed[c].position();
+        const math::vec3& sa = expected[c].scale();
+        const math::vec3& sb = packed[c].scale();
+
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            if (std::abs(pa[i] - pb[i]) > TEST_EPSILON || std::abs(sa[i] - sb[i]) > TEST_EPSILON)
+            {
+                std::cerr << "Channel " << c << " mismatch at " << percent << ": "
+                    << "position " << pa[i] << " != " << pb[i] << ", "
+                    << "scale " << sa[i] << " != " << sb[i] << std::endl;
+                return false;
+            }
+        }
+
+        // Both q and -q represent the same rotation
+        const math::quat& ra = expected[c].orientation();
+        const math::quat& rb = packed[c].orientation();
+        const float cosTheta = std::abs(ra[0]*rb[0] + ra[1]*rb[1] + ra[2]*rb[2] + ra[3]*rb[3]);
+        if (1.f - cosTheta > TEST_ROT_EPSILON)
+        {
+            std::cerr << "Channel " << c << " rotation mismatch at " << percent << ": " << cosTheta << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+bool compare_all(SL_SceneGraph& graph, const SL_Animation& anim, const SL_Animation& packedAnim)
+{
+    // Uneven steps, which rarely land on a sample
+    for (SL_AnimPrecision t = 0.0; t <= SL_AnimPrecision{1.0}; t += SL_AnimPrecision{0.0029})
+    {
+        if (!compare_animations(graph, anim, packedAnim, t))
+        {
+            return false;
+        }
+    }
+
+    // Every sample, including each key time and the ends of each range
+    for (unsigned f = 0; f <= (unsigned)TEST_SAMPLE_RATE; ++f)
+    {
+        if (!compare_animations(graph, anim, packedAnim, (SL_AnimPrecision)f / TEST_SAMPLE_RATE))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Pack an animation with & without quantization, then compare each against
+ * the original keyframes
+-----------------------------------------------------------------------------*/
+int main()
+{
+    uint32_t seed = 0x13572468u;
+    SL_SceneGraph graph;
+    SL_Animation anim;
+
+    if (!build_animation(graph, anim, seed))
+    {
+        std::cerr << "Unable to build the test animation." << std::endl;
+        return -1;
+    }
+
+    SL_Animation packedAnim = anim;
+    if (packedAnim.pack(graph, TEST_SAMPLE_RATE, false) != 0)
+    {
+        std::cerr << "Unable to pack the test animation." << std::endl;
+        return -2;
+    }
+
+    if (packedAnim.clip().num_frames() != 33u || packedAnim.clip().quantized())
+    {
+        std::cerr << "Invalid packed clip: " << packedAnim.clip().num_frames() << " frames." << std::endl;
+        return -3;
+    }
+
+    if (!(packedAnim.clip().channel_flags(2) & SL_ANIM_CLIP_FLAG_STEPPED) || (packedAnim.clip().channel_flags(0) & SL_ANIM_CLIP_FLAG_STEPPED))
+    {
+        std::cerr << "Stepped channels were not flagged." << std::endl;
+        return -4;
+    }
+
+    if (!compare_all(graph, anim, packedAnim))
+    {
+        std::cerr << "Packed animation does not match its keyframes." << std::endl;
+        return -5;
+    }
+
+    SL_Animation quantizedAnim = anim;
+    if (quantizedAnim.pack(graph, TEST_SAMPLE_RATE, true) != 0 || !quantizedAnim.clip().quantized())
+    {
+        std::cerr << "Unable to quantize the test animation." << std::endl;
+        return -6;
+    }
+
+    if (!compare_all(graph, anim, quantizedAnim))
+    {
+        std::cerr << "Quantized animation does not match its keyframes." << std::endl;
+        return -7;
+    }
+
+    std::cout << "Packed animations matched." << std::endl;
+
+    return 0;
+}
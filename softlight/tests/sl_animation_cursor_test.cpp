@@ -0,0 +1,497 @@
+
+#include <cmath> // std::abs, std::sin, std::cos
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility> // std::move
+
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/vec_utils.h"
+#include "lightsky/math/quat.h"
+
+#include "softlight/SL_Animation.hpp"
+#include "softlight/SL_AnimationChannel.hpp"
+#include "softlight/SL_AnimationKeyList.hpp"
+#include "softlight/SL_AnimationPlayer.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp"
+#include "softlight/SL_Transform.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Keyframes with uneven spacing
+-----------------------------------------------------------------------------*/
+constexpr size_t NUM_TEST_FRAMES = 97;
+
+bool build_keys(SL_AnimationKeyListVec3& keys)
+{
+    if (!keys.init(NUM_TEST_FRAMES))
+    {
+        return false;
+    }
+
+    SL_AnimPrecision t = 0.0;
+    uint32_t seed = 0x12345678u;
+
+    for (size_t i = 0; i < NUM_TEST_FRAMES; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const float x = (float)(seed >> 16u) * (1.f / 65536.f);
+
+        keys.frame(i, t, math::vec3{x, (float)i, -x});
+        t += SL_AnimPrecision{0.001} + SL_AnimPrecision{0.02} * (SL_AnimPrecision)(seed % 7u);
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Reference implementation using a linear search
+-----------------------------------------------------------------------------*/
+math::vec3 reference_keys(const SL_AnimationKeyListVec3& keys, SL_AnimPrecision percent)
+{
+    if (percent <= keys.start_time())
+    {
+        return keys.start_data();
+    }
+
+    if (percent >= keys.end_time())
+    {
+        return keys.end_data();
+    }
+
+    size_t nextFrame = 1;
+    while (keys.frame_time(nextFrame) < percent)
+    {
+        ++nextFrame;
+    }
+
+    const size_t currFrame = nextFrame - 1;
+    const SL_AnimPrecision currTime = keys.frame_time(currFrame);
+    const SL_AnimPrecision nextTime = keys.frame_time(nextFrame);
+    const float interp = (float)(SL_AnimPrecision{1} - ((nextTime - percent) / (nextTime - currTime)));
+
+    return math::mix(keys.frame_data(currFrame), keys.frame_data(nextFrame), interp);
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare the cached and uncached lookups against the reference
+-----------------------------------------------------------------------------*/
+bool compare_keys(const SL_AnimationKeyListVec3& keys, SL_AnimPrecision percent, size_t& cursor)
+{
+    const math::vec3&& expected = reference_keys(keys, percent);
+    const math::vec3&& cached   = keys.interpolated_data(percent, SL_ANIM_FLAG_INTERPOLATE, cursor);
+    const math::vec3&& searched = keys.interpolated_data(percent, SL_ANIM_FLAG_INTERPOLATE);
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        if (std::abs(expected[i] - cached[i]) > 1.0e-4f || std::abs(expected[i] - searched[i]) > 1.0e-4f)
+        {
+            std::cerr << "Error: Keyframe mismatch at " << percent << ": " << expected[i] << " != " << cached[i] << " / " << searched[i] << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Several players, each animating its own copy of a set of nodes
+ *
+ * There are enough channels in total for tick_all() to split its work
+ * across threads.
+-----------------------------------------------------------------------------*/
+constexpr size_t           NUM_TEST_ANIMS    = 3;
+constexpr size_t           NUM_TEST_PLAYERS  = 6;
+constexpr size_t           NUM_TEST_CHANNELS = 24;
+constexpr size_t           NUM_TEST_KEYS     = 13;
+constexpr float            TEST_EPSILON      = 1.0e-5f;
+const math::vec3           TEST_SENTINEL     = math::vec3{100.f};
+
+bool build_players(SL_SceneGraph& graph, size_t* pOutBaseIds)
+{
+    uint32_t seed = 0x2468ACE0u;
+
+    for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+    {
+        for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+        {
+            const std::string nodeName = "node_" + std::to_string(p) + '_' + std::to_string(c);
+            const size_t nodeId = graph.insert_empty_node(SCENE_NODE_ROOT_ID, nodeName.c_str(), SL_Transform{});
+
+            if (!c)
+            {
+                pOutBaseIds[p] = nodeId;
+            }
+            else if (nodeId != pOutBaseIds[p] + c)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (size_t a = 0; a < NUM_TEST_ANIMS; ++a)
+    {
+        graph.mNodeAnims.emplace_back();
+        graph.mAnimations.emplace_back();
+
+        SL_AlignedVector<SL_AnimationChannel>& channels = graph.mNodeAnims.back();
+        SL_Animation& anim = graph.mAnimations.back();
+
+        channels.resize(NUM_TEST_CHANNELS);
+        anim.duration(SL_AnimPrecision{2.0} + (SL_AnimPrecision)a);
+        anim.ticks_per_sec(SL_AnimPrecision{1.0});
+        anim.play_mode(SL_AnimPlayMode::SL_ANIM_PLAY_REPEAT);
+
+        for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+        {
+            SL_AnimationChannel& track = channels[c];
+            if (!track.size(NUM_TEST_KEYS, NUM_TEST_KEYS, NUM_TEST_KEYS))
+            {
+                return false;
+            }
+
+            track.mAnimMode = SL_ANIM_FLAG_INTERPOLATE;
+
+            for (size_t k = 0; k < NUM_TEST_KEYS; ++k)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const float x = (float)(seed >> 16u) * (1.f / 65536.f);
+                const SL_AnimPrecision t = (SL_AnimPrecision)k / (SL_AnimPrecision)(NUM_TEST_KEYS-1u);
+
+                track.mPosFrames.frame(k, t, math::vec3{x, (float)k, -x} * 3.f);
+                track.mScaleFrames.frame(k, t, math::vec3{1.f + x, 2.f - x, 1.f});
+                track.mOrientFrames.frame(k, t, math::quat{0.f, std::sin(x), 0.f, std::cos(x)});
+            }
+
+            // Each animation targets the nodes of the player sharing its index
+            anim.add_channel(a, c, pOutBaseIds[a] + c);
+        }
+    }
+
+    return true;
+}
+
+
+
+void reset_nodes(SL_SceneGraph& graph, const size_t* pBaseIds)
+{
+    for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+    {
+        for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+        {
+            SL_Transform& t = graph.mCurrentTransforms[pBaseIds[p] + c];
+            t.position(TEST_SENTINEL);
+            t.scaling(TEST_SENTINEL);
+            t.orientation(math::quat{0.f, 0.f, 0.f, 1.f});
+        }
+    }
+}
+
+
+
+void init_players(SL_AnimationPlayer* pPlayers)
+{
+    for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+    {
+        pPlayers[p].set_play_state(SL_AnimationState::SL_ANIM_STATE_PLAYING);
+        pPlayers[p].set_num_plays(SL_AnimationPlayer::PLAY_REPEAT);
+        pPlayers[p].set_time_dilation(SL_AnimPrecision{0.5} + SL_AnimPrecision{0.375} * (SL_AnimPrecision)p);
+    }
+
+    // Paused players must leave their nodes untouched
+    pPlayers[NUM_TEST_PLAYERS-1u].set_play_state(SL_AnimationState::SL_ANIM_STATE_PAUSED);
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare batched playback against individual players
+-----------------------------------------------------------------------------*/
+bool compare_transforms(const SL_Transform& a, const SL_Transform& b)
+{
+    const math::vec3& pa = a.position();
+    const math::vec3& pb = b.position();
+    const math::vec3& sa = a.scale();
+    const math::vec3& sb = b.scale();
+    const math::quat& ra = a.orientation();
+    const math::quat& rb = b.orientation();
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        if (std::abs(pa[i] - pb[i]) > TEST_EPSILON || std::abs(sa[i] - sb[i]) > TEST_EPSILON)
+        {
+            return false;
+        }
+    }
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (std::abs(ra[i] - rb[i]) > TEST_EPSILON)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+int test_players()
+{
+    SL_SceneGraph graph;
+    graph.mContext.num_threads(4);
+
+    size_t baseIds[NUM_TEST_PLAYERS];
+    if (!build_players(graph, baseIds))
+    {
+        std::cerr << "Error: Unable to build the test animations." << std::endl;
+        return -1;
+    }
+
+    size_t animIds[NUM_TEST_PLAYERS];
+    for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+    {
+        animIds[p] = p % NUM_TEST_ANIMS;
+    }
+
+    SL_AnimationPlayer players[NUM_TEST_PLAYERS];
+    SL_AnimationPlayer batchedPlayers[NUM_TEST_PLAYERS];
+    SL_Transform expected[NUM_TEST_PLAYERS * NUM_TEST_CHANNELS];
+
+    init_players(players);
+    init_players(batchedPlayers);
+
+    for (unsigned f = 0; f < 500; ++f)
+    {
+        const int64_t millis = 3 + (int64_t)((f * 37u) % 61u);
+
+        reset_nodes(graph, baseIds);
+        for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+        {
+            players[p].tick(graph, animIds[p], millis, baseIds[p]);
+
+            for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+            {
+                expected[p * NUM_TEST_CHANNELS + c] = graph.mCurrentTransforms[baseIds[p] + c];
+            }
+        }
+
+        reset_nodes(graph, baseIds);
+        SL_AnimationPlayer::tick_all(graph, batchedPlayers, animIds, baseIds, NUM_TEST_PLAYERS, millis);
+
+        for (size_t p = 0; p < NUM_TEST_PLAYERS; ++p)
+        {
+            if (players[p].get_current_ticks() != batchedPlayers[p].get_current_ticks()
+            || players[p].get_anim_state() != batchedPlayers[p].get_anim_state())
+            {
+                std::cerr << "Error: Player " << p << " state mismatch at frame " << f << '.' << std::endl;
+                return -2;
+            }
+
+            for (size_t c = 0; c < NUM_TEST_CHANNELS; ++c)
+            {
+                if (!compare_transforms(expected[p * NUM_TEST_CHANNELS + c], graph.mCurrentTransforms[baseIds[p] + c]))
+                {
+                    std::cerr << "Error: Player " << p << ", channel " << c << " transform mismatch at frame " << f << '.' << std::endl;
+                    return -3;
+                }
+            }
+        }
+    }
+
+    // Make sure the paused player was really skipped
+    const math::vec3& pausedPos = graph.mCurrentTransforms[baseIds[NUM_TEST_PLAYERS-1u]].position();
+    if (pausedPos[0] != TEST_SENTINEL[0] || pausedPos[1] != TEST_SENTINEL[1] || pausedPos[2] != TEST_SENTINEL[2])
+    {
+        std::cerr << "Error: A paused player was animated." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * When several channels target the same node, the first channel wins
+ *
+ * Channels 1 & 5 both animate the same node, and fall into different groups
+ * of a packed clip.
+-----------------------------------------------------------------------------*/
+constexpr size_t NUM_ORDER_CHANNELS = 6;
+
+bool build_shared_channels(SL_SceneGraph& graph, size_t& outSharedId)
+{
+    size_t nodeIds[NUM_ORDER_CHANNELS];
+
+    for (size_t c = 0; c < NUM_ORDER_CHANNELS-1u; ++c)
+    {
+        const std::string nodeName = "order_" + std::to_string(c);
+        nodeIds[c] = graph.insert_empty_node(SCENE_NODE_ROOT_ID, nodeName.c_str(), SL_Transform{});
+    }
+
+    nodeIds[NUM_ORDER_CHANNELS-1u] = nodeIds[1];
+    outSharedId = nodeIds[1];
+
+    graph.mNodeAnims.emplace_back();
+    graph.mAnimations.emplace_back();
+
+    SL_AlignedVector<SL_AnimationChannel>& channels = graph.mNodeAnims.back();
+    SL_Animation& anim = graph.mAnimations.back();
+
+    channels.resize(NUM_ORDER_CHANNELS);
+    anim.duration(SL_AnimPrecision{1.0});
+    anim.ticks_per_sec(SL_AnimPrecision{1.0});
+    anim.play_mode(SL_AnimPlayMode::SL_ANIM_PLAY_REPEAT);
+
+    for (size_t c = 0; c < NUM_ORDER_CHANNELS; ++c)
+    {
+        SL_AnimationChannel& track = channels[c];
+        if (!track.size(2, 2, 2))
+        {
+            return false;
+        }
+
+        track.mAnimMode = SL_ANIM_FLAG_INTERPOLATE;
+
+        for (size_t k = 0; k < 2; ++k)
+        {
+            track.mPosFrames.frame(k, (SL_AnimPrecision)k, math::vec3{(float)c});
+            track.mScaleFrames.frame(k, (SL_AnimPrecision)k, math::vec3{1.f});
+            track.mOrientFrames.frame(k, (SL_AnimPrecision)k, math::quat{0.f, 0.f, 0.f, 1.f});
+        }
+
+        anim.add_channel(graph.mNodeAnims.size()-1u, c, nodeIds[c]);
+    }
+
+    // Keep an identical, packed copy of the animation
+    SL_Animation packedAnim = anim;
+    if (packedAnim.pack(graph) != 0)
+    {
+        return false;
+    }
+
+    graph.mAnimations.emplace_back(std::move(packedAnim));
+
+    return true;
+}
+
+
+
+int test_channel_order()
+{
+    SL_SceneGraph graph;
+    size_t sharedId = 0;
+
+    if (!build_shared_channels(graph, sharedId))
+    {
+        std::cerr << "Error: Unable to build the channel order animation." << std::endl;
+        return -1;
+    }
+
+    for (size_t animId = 0; animId < graph.mAnimations.size(); ++animId)
+    {
+        SL_AnimationPlayer players[2];
+        for (SL_AnimationPlayer& player : players)
+        {
+            player.set_play_state(SL_AnimationState::SL_ANIM_STATE_PLAYING);
+            player.set_num_plays(SL_AnimationPlayer::PLAY_REPEAT);
+        }
+
+        graph.mCurrentTransforms[sharedId].position(TEST_SENTINEL);
+        players[0].tick(graph, animId, 250);
+        const float tickedPos = graph.mCurrentTransforms[sharedId].position()[0];
+
+        graph.mCurrentTransforms[sharedId].position(TEST_SENTINEL);
+        SL_AnimationPlayer::tick_all(graph, players+1, &animId, nullptr, 1, 250);
+        const float batchedPos = graph.mCurrentTransforms[sharedId].position()[0];
+
+        if (std::abs(tickedPos - 1.f) > TEST_EPSILON || std::abs(batchedPos - 1.f) > TEST_EPSILON)
+        {
+            std::cerr << "Error: Animation " << animId << " applied the wrong channel to a shared node: " << tickedPos << " / " << batchedPos << std::endl;
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+
+
+int main()
+{
+    SL_AnimationKeyListVec3 keys;
+    if (!build_keys(keys))
+    {
+        std::cerr << "Error: Unable to allocate keyframes." << std::endl;
+        return -1;
+    }
+
+    const SL_AnimPrecision endTime = keys.end_time();
+    size_t cursor = 0;
+
+    // Forward playback, both small steps and steps skipping several frames
+    for (SL_AnimPrecision step : {SL_AnimPrecision{0.0007}, SL_AnimPrecision{0.013}, SL_AnimPrecision{0.21}})
+    {
+        cursor = 0;
+        for (SL_AnimPrecision t = 0.0; t <= endTime; t += step)
+        {
+            if (!compare_keys(keys, t, cursor))
+            {
+                return -2;
+            }
+        }
+    }
+
+    // Reverse playback
+    for (SL_AnimPrecision t = endTime; t >= 0.0; t -= SL_AnimPrecision{0.0031})
+    {
+        if (!compare_keys(keys, t, cursor))
+        {
+            return -3;
+        }
+    }
+
+    // Random seeking, including exact keyframe times
+    uint32_t seed = 0x87654321u;
+    for (unsigned i = 0; i < 10000; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const SL_AnimPrecision t = (i & 1u)
+            ? keys.frame_time(seed % NUM_TEST_FRAMES)
+            : endTime * ((SL_AnimPrecision)(seed >> 8u) / (SL_AnimPrecision)(1u << 24u));
+
+        if (!compare_keys(keys, t, cursor))
+        {
+            return -4;
+        }
+    }
+
+    std::cout << "Keyframe lookups matched." << std::endl;
+
+    if (test_players() != 0)
+    {
+        return -5;
+    }
+
+    std::cout << "Batched animation players matched." << std::endl;
+
+    if (test_channel_order() != 0)
+    {
+        return -6;
+    }
+
+    return 0;
+}
@@ -29,6 +29,7 @@
 #include "softlight/SL_SceneFileLoader.hpp"
 #include "softlight/SL_SceneGraph.hpp"
 #include "softlight/SL_Shader.hpp"
+#include "softlight/SL_Skinning.hpp"
 #include "softlight/SL_Transform.hpp"
 #include "softlight/SL_UniformBuffer.hpp"
 #include "softlight/SL_VertexArray.hpp"
@@ -70,7 +71,6 @@ using Tuple = utils::Tuple<data_t...>;
 struct AnimUniforms
 {
     const SL_Texture* pTexture;
-    const math::mat4* pBones;
     math::mat4        modelMatrix;
     math::mat4        vpMatrix;
     math::vec4        camPos;
@@ -193,53 +193,6 @@ SL_VertexShader textured_vert_shader()
 
 
 
-/*--------------------------------------
- * Vertex Shader
---------------------------------------*/
-math::vec4 _textured_skin_vert_shader_impl(SL_VertexParam& param)
-{
-    typedef Tuple<math::vec3, math::vec2h, int32_t, math::vec4s, math::vec4h> Vertex;
-
-    const AnimUniforms* pUniforms   = param.pUniforms->as<AnimUniforms>();
-    const math::mat4*   pBones      = pUniforms->pBones;
-
-    const Vertex* const v           = param.pVbo->element<const Vertex>(param.pVao->offset(0, param.vertId));
-    const math::vec4&&  vert        = math::vec4_cast(v->const_element<0>(), 1.f);
-    const math::vec2h   uv          = v->const_element<1>();
-    const math::vec4&&  norm        = sl_unpack_vertex_vec4(v->const_element<2>());
-    const math::vec4s   boneIds     = v->const_element<3>();
-    const math::vec4&&  boneWeights = (math::vec4)v->const_element<4>();
-
-    math::mat4&& boneTrans =
-        (pBones[boneIds[0]] * boneWeights[0]) +
-        (pBones[boneIds[1]] * boneWeights[1]) +
-        (pBones[boneIds[2]] * boneWeights[2]) +
-        (pBones[boneIds[3]] * boneWeights[3]);
-
-    const math::mat4&& modelPos = pUniforms->modelMatrix * boneTrans;
-    const math::vec4&& pos = modelPos * vert;
-
-    param.pVaryings[0] = pos;
-    param.pVaryings[1] = math::vec4_cast((math::vec2)uv, 0.f, 0.f);
-    param.pVaryings[2] = modelPos * norm;
-
-    return pUniforms->vpMatrix * pos;
-}
-
-
-
-SL_VertexShader textured_skin_vert_shader()
-{
-    SL_VertexShader shader;
-    shader.numVaryings = 3;
-    shader.cullMode = SL_CULL_BACK_FACE;
-    shader.shader = _textured_skin_vert_shader_impl;
-
-    return shader;
-}
-
-
-
 /*--------------------------------------
  * Fragment Shader
 --------------------------------------*/
@@ -394,10 +347,28 @@ void update_cam_position(SL_Transform& camTrans, float tickTime, utils::Pointer<
 
 
 
+/*-------------------------------------
+ * Skin all animated meshes before rendering
+-------------------------------------*/
+void skin_meshes(SL_SceneGraph& graph, const SL_AlignedVector<SL_SkinnedMesh>& skinnedMeshes)
+{
+    for (size_t meshId = 0; meshId < graph.mMeshes.size(); ++meshId)
+    {
+        const SL_SkeletonIndex& skeleton = graph.mMeshSkeletons[meshId];
+
+        if (skeleton.count > 0)
+        {
+            sl_skin_mesh(graph.mContext, skinnedMeshes[meshId], graph.mModelMatrices.data() + skeleton.index, skeleton.count);
+        }
+    }
+}
+
+
+
 /*-------------------------------------
  * Render the Scene
 -------------------------------------*/
-void render_scene(SL_SceneGraph* pGraph, const math::mat4& vpMatrix)
+void render_scene(SL_SceneGraph* pGraph, const SL_AlignedVector<SL_SkinnedMesh>& skinnedMeshes, const math::mat4& vpMatrix)
 {
     SL_Context& context = pGraph->mContext;
     AnimUniforms* pUniforms = context.ubo(0).as<AnimUniforms>();
@@ -432,17 +403,13 @@ void render_scene(SL_SceneGraph* pGraph, const math::mat4& vpMatrix)
 
             pUniforms->pTexture = material.pTextures[SL_MATERIAL_TEXTURE_DIFFUSE];
 
-            const size_t skeletonIndex = pGraph->mMeshSkeletons[nodeMeshId].index;
-            const size_t skeletonCount = pGraph->mMeshSkeletons[nodeMeshId].count;
-
-            if (skeletonCount > 0)
+            if (pGraph->mMeshSkeletons[nodeMeshId].count > 0)
             {
-                pUniforms->pBones = pGraph->mModelMatrices.data() + skeletonIndex;
-                context.draw(m, 2, 0); // pos, uv, norm, bone IDs, bone weights
+                // pos, uv, norm, skinned by skin_meshes()
+                context.draw(skinnedMeshes[nodeMeshId].mesh, 1, 0);
             }
             else
             {
-                pUniforms->pBones = nullptr;
                 if (vao.num_bindings() == 3)
                 {
                     // pos, uv, norm
@@ -463,7 +430,7 @@ void render_scene(SL_SceneGraph* pGraph, const math::mat4& vpMatrix)
 /*-----------------------------------------------------------------------------
  * Create the context for a demo scene
 -----------------------------------------------------------------------------*/
-utils::Pointer<SL_SceneGraph> create_context()
+utils::Pointer<SL_SceneGraph> create_context(SL_AlignedVector<SL_SkinnedMesh>& outSkinnedMeshes)
 {
     int retCode = 0;
 
@@ -527,14 +494,26 @@ utils::Pointer<SL_SceneGraph> create_context()
 
     pGraph->update();
 
+    // Skinned meshes are drawn from their own copy of the vertex data, which
+    // is updated with each frame of animation.
+    outSkinnedMeshes.resize(pGraph->mMeshes.size(), SL_SkinnedMesh{});
+
+    for (size_t meshId = 0; meshId < pGraph->mMeshes.size(); ++meshId)
+    {
+        if (pGraph->mMeshSkeletons[meshId].count > 0)
+        {
+            // pos, uv, norm, bone IDs, bone weights
+            retCode = sl_init_skinned_mesh(context, pGraph->mMeshes[meshId], 0, 2, 3, 4, outSkinnedMeshes[meshId]);
+            LS_ASSERT(retCode == 0);
+        }
+    }
+
     const SL_VertexShader&&   noTexVertShader  = untextured_vert_shader();
     const SL_FragmentShader&& noTexFragShader  = untextured_frag_shader();
 
     const SL_VertexShader&&   texVertShader    = textured_vert_shader();
     const SL_FragmentShader&& texFragShader    = textured_frag_shader();
 
-    const SL_VertexShader&&   texSkinVertShader = textured_skin_vert_shader();
-
     size_t uboId = context.create_ubo();
     LS_ASSERT(uboId == 0);
 
@@ -546,10 +525,6 @@ utils::Pointer<SL_SceneGraph> create_context()
     LS_ASSERT(texShaderId == 1);
     (void)texShaderId;
 
-    size_t skinTexShaderId  = context.create_shader(texSkinVertShader,  texFragShader,  uboId);
-    LS_ASSERT(skinTexShaderId == 2);
-    (void)skinTexShaderId;
-
     (void)retCode;
     return pGraph;
 }
@@ -563,7 +538,8 @@ int main()
 {
     utils::Pointer<SL_RenderWindow> pWindow{std::move(SL_RenderWindow::create())};
     utils::Pointer<SL_WindowBuffer> pRenderBuf{SL_WindowBuffer::create()};
-    utils::Pointer<SL_SceneGraph>   pGraph{std::move(create_context())};
+    SL_AlignedVector<SL_SkinnedMesh> skinnedMeshes;
+    utils::Pointer<SL_SceneGraph>   pGraph{std::move(create_context(skinnedMeshes))};
     utils::Pointer<bool[]>          pKeySyms{new bool[65536]};
 
     std::fill_n(pKeySyms.get(), 65536, false);
@@ -750,9 +726,10 @@ int main()
 
             update_animations(*pGraph, animPlayer, currentAnimId, tickTime);
             pGraph->update();
+            skin_meshes(*pGraph, skinnedMeshes);
 
             context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.6, 0.6, 0.6, 1.0}, 0.0);
-            render_scene(pGraph.get(), vpMatrix);
+            render_scene(pGraph.get(), skinnedMeshes, vpMatrix);
 
             context.blit(pRenderBuf->texture().view(), 0);
             pWindow->render(*pRenderBuf);
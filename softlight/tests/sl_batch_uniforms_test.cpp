@@ -0,0 +1,248 @@
+
+#include <iostream>
+
+#include "lightsky/math/mat_utils.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_CommandList.hpp"
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Shader.hpp"
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_UniformBuffer.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_SIZE = 64;
+
+struct TestUniforms
+{
+    math::mat4 modelMatrix;
+    math::vec4 color;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Shader which moves & colors a mesh using only its uniforms
+-----------------------------------------------------------------------------*/
+/*--------------------------------------
+ * Vertex Shader
+--------------------------------------*/
+math::vec4 _uniform_vert_shader_impl(SL_VertexParam& param)
+{
+    const TestUniforms* pUniforms = param.pUniforms->as<TestUniforms>();
+    const math::vec4& vert = *param.pVbo->element<const math::vec4>(param.pVao->offset(0, param.vertId));
+
+    return pUniforms->modelMatrix * vert;
+}
+
+
+
+SL_VertexShader uniform_vert_shader()
+{
+    SL_VertexShader shader;
+    shader.numVaryings = 0;
+    shader.cullMode = SL_CULL_OFF;
+    shader.shader = _uniform_vert_shader_impl;
+
+    return shader;
+}
+
+
+
+/*--------------------------------------
+ * Fragment Shader
+--------------------------------------*/
+bool _uniform_frag_shader_impl(SL_FragmentParam& fragParam)
+{
+    fragParam.pOutputs[0] = fragParam.pUniforms->as<TestUniforms>()->color;
+    return true;
+}
+
+
+
+SL_FragmentShader uniform_frag_shader()
+{
+    SL_FragmentShader shader;
+    shader.numVaryings = 0;
+    shader.numOutputs = 1;
+    shader.blend = SL_BLEND_OFF;
+    shader.depthMask = SL_DEPTH_MASK_OFF;
+    shader.depthTest = SL_DEPTH_TEST_OFF;
+    shader.shader = _uniform_frag_shader_impl;
+
+    return shader;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Create a render target & a quad in the center of the screen
+-----------------------------------------------------------------------------*/
+int init_context(SL_Context& context, SL_Mesh& outMesh)
+{
+    if (sl_test_init_framebuffer(context, SL_ColorDataType::SL_COLOR_RGBA_8U, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE) < 0)
+    {
+        return -1;
+    }
+
+    const math::vec4 quad[6] = {
+        {-0.25f, -0.25f, 0.f, 1.f},
+        { 0.25f, -0.25f, 0.f, 1.f},
+        { 0.25f,  0.25f, 0.f, 1.f},
+        { 0.25f,  0.25f, 0.f, 1.f},
+        {-0.25f,  0.25f, 0.f, 1.f},
+        {-0.25f, -0.25f, 0.f, 1.f}
+    };
+
+    if (sl_test_init_mesh(context, quad, sizeof(math::vec4), 6, outMesh) != 0)
+    {
+        return -2;
+    }
+
+    const size_t uboId = context.create_ubo();
+    context.create_shader(uniform_vert_shader(), uniform_frag_shader(), uboId);
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Set the uniforms of a quad
+-----------------------------------------------------------------------------*/
+void set_uniforms(SL_UniformBuffer& ubo, float x, const math::vec4& color)
+{
+    TestUniforms* pUniforms = ubo.as<TestUniforms>();
+    pUniforms->modelMatrix = math::translate(math::mat4{1.f}, math::vec3{x, 0.f, 0.f});
+    pUniforms->color = color;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Verify the color at a point in the framebuffer
+-----------------------------------------------------------------------------*/
+bool check_pixel(const SL_Context& context, uint16_t x, uint16_t y, const SL_ColorRGBA8& expected)
+{
+    const SL_TextureView& view = context.framebuffer(0).get_color_buffer(0);
+    const SL_ColorRGBA8& c = reinterpret_cast<const SL_ColorRGBA8*>(view.pTexels)[sl_fbo_index(view, x, y)];
+
+    if (c[0] != expected[0] || c[1] != expected[1] || c[2] != expected[2])
+    {
+        std::cerr << "Invalid color at (" << x << ", " << y << "): "
+            << (unsigned)c[0] << ", " << (unsigned)c[1] << ", " << (unsigned)c[2] << " != "
+            << (unsigned)expected[0] << ", " << (unsigned)expected[1] << ", " << (unsigned)expected[2] << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Both quads should be drawn at their own positions, in their own colors
+-----------------------------------------------------------------------------*/
+bool check_quads(const SL_Context& context)
+{
+    constexpr uint16_t y = TEST_IMAGE_SIZE / 2;
+    constexpr uint16_t left = TEST_IMAGE_SIZE / 4;
+    constexpr uint16_t right = TEST_IMAGE_SIZE - TEST_IMAGE_SIZE / 4;
+
+    return check_pixel(context, left, y, SL_ColorRGBA8{255, 0, 0, 255})
+        && check_pixel(context, TEST_IMAGE_SIZE / 2, y, SL_ColorRGBA8{0, 0, 0, 255})
+        && check_pixel(context, right, y, SL_ColorRGBA8{0, 255, 0, 255});
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Draw the same mesh twice within a batch, using different uniforms, both
+ * directly & through a command list
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    SL_Mesh mesh;
+    int retCode = init_context(context, mesh);
+    if (retCode != 0)
+    {
+        std::cerr << "Unable to initialize the test context: " << retCode << std::endl;
+        return -1;
+    }
+
+    SL_UniformBuffer leftUniforms;
+    SL_UniformBuffer rightUniforms;
+    set_uniforms(leftUniforms, -0.5f, math::vec4{1.f, 0.f, 0.f, 1.f});
+    set_uniforms(rightUniforms, 0.5f, math::vec4{0.f, 1.f, 0.f, 1.f});
+
+    // The first draw uses the shader's own uniform buffer
+    context.ubo(0) = leftUniforms;
+
+    const SL_DrawCommand draws[2] = {
+        {mesh, 1, 0, 0, nullptr, nullptr},
+        {mesh, 1, 0, 0, &rightUniforms, nullptr}
+    };
+
+    context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 1.0}, 0.0);
+    context.draw_batch(draws, 2);
+
+    if (!check_quads(context))
+    {
+        std::cerr << "Batched draws did not use their own uniforms." << std::endl;
+        return -2;
+    }
+
+    // Command lists record uniform updates between draws
+    SL_CommandList cmds;
+    cmds.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 1.0}, 0.0);
+    cmds.update_uniforms(0, leftUniforms.buffer(), 0, sizeof(TestUniforms));
+    cmds.draw(mesh, 0, 0);
+    cmds.update_uniforms(0, rightUniforms.buffer(), 0, sizeof(TestUniforms));
+    cmds.draw(mesh, 0, 0);
+
+    context.ubo(0).clear();
+    context.execute(cmds);
+
+    if (!check_quads(context))
+    {
+        std::cerr << "Command list draws did not use their recorded uniforms." << std::endl;
+        return -3;
+    }
+
+    // The last recorded update should persist
+    const math::vec4& lastColor = context.ubo(0).as<TestUniforms>()->color;
+    if (lastColor[0] != 0.f || lastColor[1] != 1.f)
+    {
+        std::cerr << "Recorded uniforms were not applied to the uniform buffer." << std::endl;
+        return -4;
+    }
+
+    // Asynchronous submission should produce the same image
+    context.ubo(0).clear();
+    context.submit(cmds);
+    context.finish();
+
+    if (!check_quads(context))
+    {
+        std::cerr << "Submitted draws did not use their recorded uniforms." << std::endl;
+        return -5;
+    }
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+
+#include <cmath> // std::abs
+#include <iostream>
+#include <vector>
+
+#include "lightsky/math/vec4.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Shader.hpp"
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_SIZE = 64;
+constexpr float    TEST_EPSILON = 1.0e-4f;
+
+// Scales derivatives up to roughly the same range as the varyings
+constexpr float    TEST_DERIV_SCALE = 16.f;
+
+struct TestVertex
+{
+    math::vec4 pos;
+    math::vec4 uv;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Shaders which output a varying & its derivatives
+-----------------------------------------------------------------------------*/
+/*--------------------------------------
+ * Vertex Shader
+--------------------------------------*/
+math::vec4 _block_vert_shader_impl(SL_VertexParam& param)
+{
+    const TestVertex& vert = *param.pVbo->element<const TestVertex>(param.pVao->offset(0, param.vertId));
+    param.pVaryings[0] = vert.uv;
+
+    return vert.pos;
+}
+
+
+
+SL_VertexShader block_vert_shader()
+{
+    SL_VertexShader shader;
+    shader.numVaryings = 1;
+    shader.cullMode = SL_CULL_OFF;
+    shader.shader = _block_vert_shader_impl;
+
+    return shader;
+}
+
+
+
+/*--------------------------------------
+ * Per-fragment Shader
+--------------------------------------*/
+bool _scalar_frag_shader_impl(SL_FragmentParam& fragParam)
+{
+    const math::vec4& uv = fragParam.pVaryings[0];
+    const math::vec4& dx = sl_dfdx(fragParam, 0);
+    const math::vec4& dy = sl_dfdy(fragParam, 0);
+
+    fragParam.pOutputs[0] = math::vec4{uv[0], uv[1], dx[0] * TEST_DERIV_SCALE, dy[1] * TEST_DERIV_SCALE};
+
+    // Discard part of the triangle so the output masks are tested too
+    return uv[0] < 0.75f;
+}
+
+
+
+/*--------------------------------------
+ * Wide Shader, matching the per-fragment shader
+--------------------------------------*/
+uint32_t _block_frag_shader_impl(SL_FragmentBlockParam& blockParams)
+{
+    uint32_t outMask = 0;
+
+    for (unsigned n = 0; n < SL_SHADER_FRAG_BLOCK_SIZE; ++n)
+    {
+        blockParams.pOutputs[0][0][n] = blockParams.pVaryings[0][0][n];
+        blockParams.pOutputs[0][1][n] = blockParams.pVaryings[0][1][n];
+        blockParams.pOutputs[0][2][n] = blockParams.pDdx[0][0][n] * TEST_DERIV_SCALE;
+        blockParams.pOutputs[0][3][n] = blockParams.pDdy[0][1][n] * TEST_DERIV_SCALE;
+
+        outMask |= (blockParams.pVaryings[0][0][n] < 0.75f) ? (1u << n) : 0u;
+    }
+
+    return outMask & blockParams.activeMask;
+}
+
+
+
+SL_FragmentShader block_frag_shader(bool useBlocks)
+{
+    SL_FragmentShader shader;
+    shader.numVaryings = 1;
+    shader.numOutputs = 1;
+    shader.blend = SL_BLEND_OFF;
+    shader.depthMask = SL_DEPTH_MASK_OFF;
+    shader.depthTest = SL_DEPTH_TEST_OFF;
+    shader.shader = _scalar_frag_shader_impl;
+    shader.blockShader = useBlocks ? _block_frag_shader_impl : nullptr;
+    shader.derivatives = SL_DERIVATIVES_ON;
+
+    return shader;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Create a float render target & a triangle with perspective
+-----------------------------------------------------------------------------*/
+int init_context(SL_Context& context, SL_Mesh& outMesh)
+{
+    if (sl_test_init_framebuffer(context, SL_ColorDataType::SL_COLOR_RGBA_FLOAT, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE) < 0)
+    {
+        return -1;
+    }
+
+    // Each vertex has a different W, so derivatives vary across the screen
+    const TestVertex verts[3] = {
+        {{-0.9f, -0.9f, 0.f, 1.f}, {0.f, 0.f, 0.f, 1.f}},
+        {{ 1.8f, -1.6f, 0.f, 2.f}, {1.f, 0.f, 0.f, 1.f}},
+        {{-0.3f,  2.7f, 0.f, 3.f}, {0.f, 1.f, 0.f, 1.f}}
+    };
+
+    if (sl_test_init_mesh(context, verts, sizeof(TestVertex), 3, outMesh) != 0)
+    {
+        return -2;
+    }
+
+    context.create_shader(block_vert_shader(), block_frag_shader(false));
+    context.create_shader(block_vert_shader(), block_frag_shader(true));
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Render the triangle with a shader, then copy the image
+-----------------------------------------------------------------------------*/
+void render_image(SL_Context& context, const SL_Mesh& mesh, size_t shaderId, std::vector<SL_ColorRGBAf>& outPixels)
+{
+    context.clear_framebuffer(0, 0, SL_ColorRGBAd{-1.0, -1.0, -1.0, -1.0}, 0.0);
+    context.draw(mesh, shaderId, 0);
+
+    const SL_TextureView& view = context.framebuffer(0).get_color_buffer(0);
+    const SL_ColorRGBAf* pTexels = reinterpret_cast<const SL_ColorRGBAf*>(view.pTexels);
+
+    outPixels.resize(TEST_IMAGE_SIZE * TEST_IMAGE_SIZE);
+
+    for (uint16_t y = 0; y < TEST_IMAGE_SIZE; ++y)
+    {
+        for (uint16_t x = 0; x < TEST_IMAGE_SIZE; ++x)
+        {
+            outPixels[x + TEST_IMAGE_SIZE * y] = pTexels[sl_fbo_index(view, x, y)];
+        }
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * The wide shader should produce the same image as the per-fragment shader
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    SL_Mesh mesh;
+    int retCode = init_context(context, mesh);
+    if (retCode != 0)
+    {
+        std::cerr << "Unable to initialize the test context: " << retCode << std::endl;
+        return -1;
+    }
+
+    std::vector<SL_ColorRGBAf> scalarPixels;
+    std::vector<SL_ColorRGBAf> blockPixels;
+
+    render_image(context, mesh, 0, scalarPixels);
+    render_image(context, mesh, 1, blockPixels);
+
+    size_t numShaded = 0;
+
+    for (uint16_t y = 0; y < TEST_IMAGE_SIZE; ++y)
+    {
+        for (uint16_t x = 0; x < TEST_IMAGE_SIZE; ++x)
+        {
+            const SL_ColorRGBAf& a = scalarPixels[x + TEST_IMAGE_SIZE * y];
+            const SL_ColorRGBAf& b = blockPixels[x + TEST_IMAGE_SIZE * y];
+
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                if (std::abs(a[c] - b[c]) > TEST_EPSILON)
+                {
+                    std::cerr << "Pixel mismatch at (" << x << ", " << y << "), component " << c << ": " << a[c] << " != " << b[c] << std::endl;
+                    return -2;
+                }
+            }
+
+            numShaded += (a[0] != -1.f) ? 1u : 0u;
+        }
+    }
+
+    // The triangle covers most of the image, minus the discarded fragments
+    if (numShaded < (TEST_IMAGE_SIZE * TEST_IMAGE_SIZE) / 4u)
+    {
+        std::cerr << "Too few pixels were shaded: " << numShaded << std::endl;
+        return -3;
+    }
+
+    std::cout << "Shaded " << numShaded << " pixels." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lightsky/math/mat_utils.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_BoundingBox.hpp"
+#include "softlight/SL_BoundingVolumeHierarchy.hpp"
+#include "softlight/SL_Camera.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp"
+#include "softlight/SL_Transform.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Scene layout
+-----------------------------------------------------------------------------*/
+constexpr size_t NUM_TEST_GROUPS = 200;
+constexpr size_t NUM_TEST_CHILDREN = 12;
+constexpr size_t NUM_TEST_MESHES = 3;
+constexpr float  TEST_EPSILON = 1.0e-3f;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Groups of mesh nodes attached to empty parent nodes
+-----------------------------------------------------------------------------*/
+void build_scene(SL_SceneGraph& graph, uint32_t& seed)
+{
+    size_t meshIds[NUM_TEST_MESHES];
+
+    for (size_t m = 0; m < NUM_TEST_MESHES; ++m)
+    {
+        SL_BoundingBox box;
+        box.min_point(math::vec3{-0.5f * (float)(m+1u)});
+        box.max_point(math::vec3{0.25f * (float)(m+1u)});
+        meshIds[m] = graph.insert_mesh(SL_Mesh{0, 0, 0, RENDER_MODE_TRIANGLES, 0}, box);
+    }
+
+    for (size_t g = 0; g < NUM_TEST_GROUPS; ++g)
+    {
+        SL_Transform groupTrans;
+        groupTrans.position(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} * 100.f);
+
+        const std::string groupName = "group_" + std::to_string(g);
+        const size_t groupId = graph.insert_empty_node(SCENE_NODE_ROOT_ID, groupName.c_str(), groupTrans);
+
+        for (size_t c = 0; c < NUM_TEST_CHILDREN; ++c)
+        {
+            SL_Transform childTrans;
+            childTrans.position(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} * 10.f);
+            childTrans.rotate(math::vec3{sl_test_random(seed), sl_test_random(seed), 0.f});
+
+            const std::string childName = groupName + "_" + std::to_string(c);
+            const size_t numMeshes = 1u + (c % NUM_TEST_MESHES);
+            graph.insert_mesh_node(groupId, childName.c_str(), numMeshes, meshIds, childTrans);
+        }
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Reference visibility test, using all 8 corners of a mesh's bounding box
+-----------------------------------------------------------------------------*/
+float reference_distance(const SL_SceneGraph& graph, const SL_DrawItem& item, const math::vec4 planes[6])
+{
+    const SL_BoundingBox& box = graph.mMeshBounds[item.meshId];
+    const math::mat4& modelMat = graph.mModelMatrices[item.nodeId];
+    const math::vec4& boxMin = box.min_point();
+    const math::vec4& boxMax = box.max_point();
+
+    math::vec4 worldMin{0.f};
+    math::vec4 worldMax{0.f};
+
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        const math::vec4 corner{
+            (i & 1u) ? boxMax[0] : boxMin[0],
+            (i & 2u) ? boxMax[1] : boxMin[1],
+            (i & 4u) ? boxMax[2] : boxMin[2],
+            1.f
+        };
+
+        const math::vec4&& p = modelMat * corner;
+        worldMin = i ? math::min(worldMin, p) : p;
+        worldMax = i ? math::max(worldMax, p) : p;
+    }
+
+    // Signed distance of the box's most-inside corner to the worst plane
+    float minDist = 0.f;
+
+    for (unsigned p = 0; p < 6; ++p)
+    {
+        const math::vec4 corner{
+            planes[p][0] >= 0.f ? worldMax[0] : worldMin[0],
+            planes[p][1] >= 0.f ? worldMax[1] : worldMin[1],
+            planes[p][2] >= 0.f ? worldMax[2] : worldMin[2],
+            1.f
+        };
+
+        const float dist = math::dot(planes[p], corner);
+        minDist = (p == 0 || dist < minDist) ? dist : minDist;
+    }
+
+    return minDist;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare the culled draw list against every mesh in the scene
+-----------------------------------------------------------------------------*/
+int compare_draw_list(SL_SceneGraph& graph, SL_BoundingVolumeHierarchy& bvh, const math::vec4 planes[6])
+{
+    SL_AlignedVector<SL_DrawItem> drawList;
+    const size_t numVisible = bvh.cull(graph.mContext, planes, drawList);
+
+    if (numVisible != drawList.size())
+    {
+        std::cerr << "Invalid number of visible items: " << numVisible << " != " << drawList.size() << std::endl;
+        return -1;
+    }
+
+    // Count how many times each item was returned
+    std::vector<unsigned> itemCounts;
+    itemCounts.resize(bvh.num_items(), 0);
+
+    for (const SL_DrawItem& item : drawList)
+    {
+        size_t itemId = 0;
+        while (itemId < bvh.num_items() && (bvh.item(itemId).nodeId != item.nodeId || bvh.item(itemId).meshId != item.meshId))
+        {
+            ++itemId;
+        }
+
+        if (itemId == bvh.num_items())
+        {
+            std::cerr << "Unknown draw item: " << item.nodeId << ", " << item.meshId << std::endl;
+            return -2;
+        }
+
+        if (++itemCounts[itemId] > 1u)
+        {
+            std::cerr << "Draw item returned more than once: " << item.nodeId << ", " << item.meshId << std::endl;
+            return -3;
+        }
+
+        if (reference_distance(graph, item, planes) < -TEST_EPSILON)
+        {
+            std::cerr << "Invisible draw item was not culled: " << item.nodeId << ", " << item.meshId << std::endl;
+            return -4;
+        }
+    }
+
+    for (size_t i = 0; i < bvh.num_items(); ++i)
+    {
+        if (!itemCounts[i] && reference_distance(graph, bvh.item(i), planes) > TEST_EPSILON)
+        {
+            std::cerr << "Visible draw item was culled: " << bvh.item(i).nodeId << ", " << bvh.item(i).meshId << std::endl;
+            return -5;
+        }
+    }
+
+    std::cout << "Visible items: " << drawList.size() << " / " << bvh.num_items() << std::endl;
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Build, cull, move some nodes, refit, then cull again
+-----------------------------------------------------------------------------*/
+int main()
+{
+    uint32_t seed = 0x2468ACE1u;
+    SL_SceneGraph graph;
+    graph.mContext.num_threads(4);
+
+    build_scene(graph, seed);
+    graph.update();
+
+    SL_BoundingVolumeHierarchy bvh;
+    if (bvh.init(graph) != 0)
+    {
+        std::cerr << "Unable to build the BVH." << std::endl;
+        return -1;
+    }
+
+    std::cout << "Built a BVH with " << bvh.num_nodes() << " nodes and " << bvh.num_items() << " items." << std::endl;
+
+    const math::mat4&& projection = math::perspective(math::radians(60.f), 4.f/3.f, 0.1f, 150.f);
+    const math::mat4&& view = math::look_at(math::vec3{0.f, 0.f, 0.f}, math::vec3{1.f, 0.f, 0.5f}, math::vec3{0.f, 1.f, 0.f});
+
+    math::vec4 planes[6];
+    sl_extract_frustum_planes(projection * view, planes);
+
+    int retCode = compare_draw_list(graph, bvh, planes);
+    if (retCode != 0)
+    {
+        return retCode;
+    }
+
+    // Move every third group, along with its children
+    for (size_t nodeId = 0; nodeId < graph.mNodes.size(); ++nodeId)
+    {
+        if (graph.mNodes[nodeId].type == NODE_TYPE_EMPTY && (nodeId % 3u) == 0)
+        {
+            graph.mCurrentTransforms[nodeId].move(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} * 50.f);
+        }
+    }
+
+    graph.update();
+    bvh.refit(graph);
+
+    retCode = compare_draw_list(graph, bvh, planes);
+    if (retCode != 0)
+    {
+        return retCode - 10;
+    }
+
+    // A single thread should return the same items
+    graph.mContext.num_threads(1);
+
+    retCode = compare_draw_list(graph, bvh, planes);
+    if (retCode != 0)
+    {
+        return retCode - 20;
+    }
+
+    return 0;
+}
@@ -0,0 +1,393 @@
+
+#include <cstdint>
+#include <iostream>
+
+#include "lightsky/math/vec4.h"
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Config.hpp" // SL_HIZ_ENABLED, SL_HIZ_TILE_SIZE
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_DepthHierarchy.hpp"
+#include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Shader.hpp"
+#include "softlight/SL_Texture.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Occluders are drawn at Z = 0, in front of target triangles at Z = 0.5.
+ * Depth is cleared to 1, and the depth buffer is later overwritten with a
+ * value behind the targets.
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_SIZE  = 128;
+constexpr double   TEST_CLEAR_DEPTH = 1.0;
+constexpr float    TEST_BLIT_DEPTH  = 0.9f;
+
+struct TestVertex
+{
+    math::vec4 pos;
+    math::vec4 color;
+};
+
+const math::vec4 TEST_OCCLUDER_COLOR = {1.f, 0.f, 0.f, 1.f};
+const math::vec4 TEST_TARGET_COLOR   = {0.f, 1.f, 0.f, 1.f};
+
+const TestVertex TEST_VERTS[] = {
+    // full-screen occluder
+    {{-1.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 1.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 1.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 1.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{-1.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{-1.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+
+    // occluder covering the left half of the screen
+    {{-1.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 0.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 0.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{ 0.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{-1.f,  1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+    {{-1.f, -1.f, 0.f, 1.f}, TEST_OCCLUDER_COLOR},
+
+    // targets, one across the screen & one behind the left occluder
+    {{-0.9f, -0.9f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+    {{ 0.9f, -0.9f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+    {{ 0.f,   0.9f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+    {{-0.9f, -0.5f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+    {{-0.2f, -0.5f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+    {{-0.5f,  0.5f, 0.5f, 1.f}, TEST_TARGET_COLOR},
+};
+
+constexpr size_t NUM_TEST_VERTS = sizeof(TEST_VERTS) / sizeof(TEST_VERTS[0]);
+
+enum TestMeshId : unsigned
+{
+    TEST_MESH_OCCLUDER_FULL,
+    TEST_MESH_OCCLUDER_LEFT,
+    TEST_MESH_TARGETS,
+
+    TEST_MESH_COUNT
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Depth-tested shader which writes each vertex's color
+-----------------------------------------------------------------------------*/
+math::vec4 _depth_vert_shader_impl(SL_VertexParam& param)
+{
+    const TestVertex& vert = *param.pVbo->element<const TestVertex>(param.pVao->offset(0, param.vertId));
+    param.pVaryings[0] = vert.color;
+
+    return vert.pos;
+}
+
+
+
+bool _depth_frag_shader_impl(SL_FragmentParam& fragParam)
+{
+    fragParam.pOutputs[0] = fragParam.pVaryings[0];
+    return true;
+}
+
+
+
+size_t create_depth_shader(SL_Context& context)
+{
+    SL_VertexShader vertShader;
+    vertShader.numVaryings = 1;
+    vertShader.cullMode = SL_CULL_OFF;
+    vertShader.shader = _depth_vert_shader_impl;
+
+    SL_FragmentShader fragShader;
+    fragShader.numVaryings = 1;
+    fragShader.numOutputs = 1;
+    fragShader.blend = SL_BLEND_OFF;
+    fragShader.depthMask = SL_DEPTH_MASK_ON;
+    fragShader.depthTest = SL_DEPTH_TEST_LESS_THAN;
+    fragShader.shader = _depth_frag_shader_impl;
+
+    return context.create_shader(vertShader, fragShader);
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Render targets
+ *
+ * Both framebuffers receive the same commands. The reference framebuffer has
+ * no depth hierarchy, so it never rejects fragments early.
+-----------------------------------------------------------------------------*/
+struct TestTargets
+{
+    size_t fboIds[2];
+    size_t depthTexIds[2];
+    size_t blitTexId;
+    size_t shaderId;
+    SL_Mesh meshes[TEST_MESH_COUNT];
+};
+
+
+
+int init_targets(SL_Context& context, TestTargets& targets)
+{
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        const int fboId = sl_test_init_framebuffer(context, SL_ColorDataType::SL_COLOR_RGBA_FLOAT, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE);
+        if (fboId < 0)
+        {
+            return -1;
+        }
+
+        targets.fboIds[i] = (size_t)fboId;
+        targets.depthTexIds[i] = context.textures().size() - 1u;
+    }
+
+    context.framebuffer(targets.fboIds[1]).depth_hierarchy().terminate();
+
+    // Texture which is copied over the depth buffers
+    targets.blitTexId = context.create_texture();
+    SL_Texture& blitTex = context.texture(targets.blitTexId);
+
+    if (blitTex.init(SL_ColorDataType::SL_COLOR_R_FLOAT, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE, 1) != 0)
+    {
+        return -2;
+    }
+
+    for (uint16_t y = 0; y < TEST_IMAGE_SIZE; ++y)
+    {
+        for (uint16_t x = 0; x < TEST_IMAGE_SIZE; ++x)
+        {
+            blitTex.set_texel(x, y, 0, &TEST_BLIT_DEPTH);
+        }
+    }
+
+    SL_Mesh mesh;
+    if (sl_test_init_mesh(context, TEST_VERTS, sizeof(TestVertex), NUM_TEST_VERTS, mesh) != 0)
+    {
+        return -3;
+    }
+
+    for (unsigned i = 0; i < TEST_MESH_COUNT; ++i)
+    {
+        targets.meshes[i] = mesh;
+        targets.meshes[i].elementBegin = i * 6u;
+        targets.meshes[i].elementEnd   = i * 6u + 6u;
+    }
+
+    targets.shaderId = create_depth_shader(context);
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare the color & depth of both framebuffers
+-----------------------------------------------------------------------------*/
+bool compare_targets(SL_Context& context, const TestTargets& targets, const char* pName)
+{
+    const SL_Framebuffer& a = context.framebuffer(targets.fboIds[0]);
+    const SL_Framebuffer& b = context.framebuffer(targets.fboIds[1]);
+
+    const SL_TextureView& colorA = a.get_color_buffer(0);
+    const SL_TextureView& colorB = b.get_color_buffer(0);
+    const SL_TextureView& depthA = a.get_depth_buffer();
+    const SL_TextureView& depthB = b.get_depth_buffer();
+
+    for (uint16_t y = 0; y < TEST_IMAGE_SIZE; ++y)
+    {
+        for (uint16_t x = 0; x < TEST_IMAGE_SIZE; ++x)
+        {
+            const SL_ColorRGBAf& ca = reinterpret_cast<const SL_ColorRGBAf*>(colorA.pTexels)[sl_fbo_index(colorA, x, y)];
+            const SL_ColorRGBAf& cb = reinterpret_cast<const SL_ColorRGBAf*>(colorB.pTexels)[sl_fbo_index(colorB, x, y)];
+            const float          da = reinterpret_cast<const float*>(depthA.pTexels)[sl_fbo_index(depthA, x, y)];
+            const float          db = reinterpret_cast<const float*>(depthB.pTexels)[sl_fbo_index(depthB, x, y)];
+
+            if (ca[0] != cb[0] || ca[1] != cb[1] || ca[2] != cb[2] || ca[3] != cb[3] || da != db)
+            {
+                std::cerr << pName << ": pixel (" << x << ", " << y << ") doesn't match the reference image." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-------------------------------------
+ * Make sure a test isn't trivially passing by checking which primitive
+ * covers the center of the screen.
+-------------------------------------*/
+bool check_center(SL_Context& context, const TestTargets& targets, const math::vec4& expected, const char* pName)
+{
+    const SL_TextureView& view  = context.framebuffer(targets.fboIds[0]).get_color_buffer(0);
+    const SL_ColorRGBAf&  color = reinterpret_cast<const SL_ColorRGBAf*>(view.pTexels)[sl_fbo_index(view, TEST_IMAGE_SIZE/2, TEST_IMAGE_SIZE/2)];
+
+    if (color[0] != expected[0] || color[1] != expected[1] || color[2] != expected[2] || color[3] != expected[3])
+    {
+        std::cerr << pName << ": the wrong primitive is visible." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Check the rows of the depth hierarchy, excluding pixels along the screen's
+ * edges which the occluders might not cover.
+-----------------------------------------------------------------------------*/
+bool check_spans(SL_Context& context, const TestTargets& targets, float depth, bool expectOccluded, const char* pName)
+{
+    #if SL_HIZ_ENABLED
+        const SL_DepthHierarchy& bounds = context.framebuffer(targets.fboIds[0]).depth_hierarchy();
+
+        for (int32_t y = SL_HIZ_TILE_SIZE; y < TEST_IMAGE_SIZE - SL_HIZ_TILE_SIZE; ++y)
+        {
+            if (bounds.is_span_occluded(SL_DEPTH_TEST_LESS_THAN, y, SL_HIZ_TILE_SIZE, TEST_IMAGE_SIZE - SL_HIZ_TILE_SIZE, depth, depth) != expectOccluded)
+            {
+                std::cerr << pName << ": invalid depth bounds for row " << y << '.' << std::endl;
+                return false;
+            }
+        }
+    #else
+        (void)context;
+        (void)targets;
+        (void)depth;
+        (void)expectOccluded;
+        (void)pName;
+    #endif
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Draw commands, applied to both framebuffers
+-----------------------------------------------------------------------------*/
+void clear_targets(SL_Context& context, const TestTargets& targets)
+{
+    for (size_t fboId : targets.fboIds)
+    {
+        context.clear_framebuffer(fboId, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 0.0}, TEST_CLEAR_DEPTH);
+    }
+}
+
+
+
+void draw_targets(SL_Context& context, const TestTargets& targets, TestMeshId meshId)
+{
+    for (size_t fboId : targets.fboIds)
+    {
+        context.draw(targets.meshes[meshId], targets.shaderId, fboId);
+    }
+}
+
+
+
+void blit_targets(SL_Context& context, const TestTargets& targets)
+{
+    for (size_t depthTexId : targets.depthTexIds)
+    {
+        context.blit(depthTexId, targets.blitTexId);
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Coarse depth rejection should never change the rendered image
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    TestTargets targets;
+    if (init_targets(context, targets) != 0)
+    {
+        std::cerr << "Unable to initialize the test context." << std::endl;
+        return -1;
+    }
+
+    // Partially occluded targets
+    clear_targets(context, targets);
+
+    if (!check_spans(context, targets, (float)TEST_CLEAR_DEPTH, true, "Clear"))
+    {
+        return -2;
+    }
+
+    draw_targets(context, targets, TEST_MESH_OCCLUDER_LEFT);
+    draw_targets(context, targets, TEST_MESH_TARGETS);
+
+    if (!compare_targets(context, targets, "Partial occluder"))
+    {
+        return -3;
+    }
+
+    // Fully occluded targets
+    clear_targets(context, targets);
+    draw_targets(context, targets, TEST_MESH_OCCLUDER_FULL);
+
+    const SL_TextureView& depthBuf = context.framebuffer(targets.fboIds[0]).get_depth_buffer();
+    const float occluderDepth = reinterpret_cast<const float*>(depthBuf.pTexels)[sl_fbo_index(depthBuf, TEST_IMAGE_SIZE/2, TEST_IMAGE_SIZE/2)];
+
+    if (!check_spans(context, targets, occluderDepth, true, "Full occluder"))
+    {
+        return -4;
+    }
+
+    draw_targets(context, targets, TEST_MESH_TARGETS);
+
+    if (!compare_targets(context, targets, "Full occluder") || !check_center(context, targets, TEST_OCCLUDER_COLOR, "Full occluder"))
+    {
+        return -5;
+    }
+
+    // Overwriting the depth buffer makes the targets visible. Bounds from the
+    // occluder can no longer be used.
+    blit_targets(context, targets);
+
+    if (!check_spans(context, targets, (float)TEST_CLEAR_DEPTH, false, "Blit"))
+    {
+        return -6;
+    }
+
+    draw_targets(context, targets, TEST_MESH_TARGETS);
+
+    if (!compare_targets(context, targets, "Blit") || !check_center(context, targets, TEST_TARGET_COLOR, "Blit"))
+    {
+        return -7;
+    }
+
+    // Clearing restores the bounds
+    clear_targets(context, targets);
+
+    if (!check_spans(context, targets, (float)TEST_CLEAR_DEPTH, true, "Clear after blit"))
+    {
+        return -8;
+    }
+
+    draw_targets(context, targets, TEST_MESH_OCCLUDER_LEFT);
+    draw_targets(context, targets, TEST_MESH_TARGETS);
+
+    if (!compare_targets(context, targets, "Clear after blit"))
+    {
+        return -9;
+    }
+
+    return 0;
+}
@@ -14,6 +14,7 @@
 #include "lightsky/utils/Tuple.h"
 
 #include "softlight/SL_BoundingBox.hpp"
+#include "softlight/SL_BoundingVolumeHierarchy.hpp"
 #include "softlight/SL_Camera.hpp"
 #include "softlight/SL_Config.hpp"
 #include "softlight/SL_Context.hpp"
@@ -675,7 +676,15 @@ void update_cam_position(SL_Transform& camTrans, float tickTime, utils::Pointer<
 /*-------------------------------------
  * Render the Scene
 -------------------------------------*/
-void render_scene(SL_SceneGraph* pGraph, unsigned w, unsigned h, const math::mat4& projection, const SL_Transform& camTrans, bool usePbr)
+void render_scene(
+    SL_SceneGraph* pGraph,
+    SL_BoundingVolumeHierarchy& bvh,
+    SL_AlignedVector<SL_DrawItem>& drawList,
+    unsigned w,
+    unsigned h,
+    const math::mat4& projection,
+    const SL_Transform& camTrans,
+    bool usePbr)
 {
     SL_Context&    context   = pGraph->mContext;
     MeshUniforms*  pUniforms = context.ubo(0).as<MeshUniforms>();
@@ -684,75 +693,57 @@ void render_scene(SL_SceneGraph* pGraph, unsigned w, unsigned h, const math::mat
     const math::mat4&& p  = math::perspective(math::radians(60.f), (float)w/(float)h, 0.1f, 100.f);
     const math::mat4&& vp = projection * camTrans.transform();
 
-    sl_extract_frustum_planes(p, planes);
+    // The BVH stores world-space bounds
+    sl_extract_frustum_planes(p * camTrans.transform(), planes);
+    bvh.cull(context, planes, drawList);
 
-    for (size_t nodeId = 0; nodeId < pGraph->mNodes.size(); ++nodeId)
+    for (const SL_DrawItem& item : drawList)
     {
-        const SL_SceneNode& n = pGraph->mNodes[nodeId];
-        if (n.type != NODE_TYPE_MESH)
-        {
-            continue;
-        }
-
-        const math::mat4&  modelMat      = pGraph->mModelMatrices[nodeId];
-        const math::mat4&& mv            = camTrans.transform() * modelMat;
-        const size_t       numNodeMeshes = pGraph->mNumNodeMeshes[n.dataId];
+        const math::mat4&  modelMat = pGraph->mModelMatrices[item.nodeId];
+        const SL_Mesh&     m        = pGraph->mMeshes[item.meshId];
+        const SL_Material& material = pGraph->mMaterials[m.materialId];
 
         pUniforms->modelMatrix = modelMat;
         pUniforms->mvpMatrix   = vp * modelMat;
 
-        const utils::Pointer<size_t[]>& meshIds = pGraph->mNodeMeshes[n.dataId];
-        for (size_t meshId = 0; meshId < numNodeMeshes; ++meshId)
+        if (!(m.mode & SL_RenderMode::RENDER_MODE_TRIANGLES))
         {
-            const size_t          nodeMeshId = meshIds[meshId];
-            const SL_Mesh&        m          = pGraph->mMeshes[nodeMeshId];
-            const SL_BoundingBox& box        = pGraph->mMeshBounds[nodeMeshId];
-            const SL_Material&    material   = pGraph->mMaterials[m.materialId];
-
-            if (!sl_is_visible(box, mv, planes))
-            {
-                continue;
-            }
-
-            if (!(m.mode & SL_RenderMode::RENDER_MODE_TRIANGLES))
-            {
-                continue;
-            }
+            continue;
+        }
 
-            pUniforms->pTexture = material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT];
+        pUniforms->pTexture = material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT];
 
-            #if SL_TEST_BUMP_MAPS
-                pUniforms->pBump = material.pTextures[SL_MATERIAL_TEXTURE_HEIGHT];
-            #endif
+        #if SL_TEST_BUMP_MAPS
+            pUniforms->pBump = material.pTextures[SL_MATERIAL_TEXTURE_HEIGHT];
+        #endif
 
-            // Use the textureless shader if needed
-            size_t shaderId;
-            if (material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT])
+        // Use the textureless shader if needed
+        size_t shaderId;
+        if (material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT])
+        {
+            if (material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT]->channels() == 4)
             {
-                if (material.pTextures[SL_MATERIAL_TEXTURE_AMBIENT]->channels() == 4)
-                {
-                    shaderId = 2;
-                }
-                else
-                {
-                    shaderId = 1;
-                }
+                shaderId = 2;
             }
             else
             {
-                shaderId = 0;
+                shaderId = 1;
             }
+        }
+        else
+        {
+            shaderId = 0;
+        }
 
-            if (usePbr)
-            {
-                shaderId += 3;
-            }
+        if (usePbr)
+        {
+            shaderId += 3;
+        }
 
-            pUniforms->light.ambient = material.ambient;
-            pUniforms->light.diffuse = material.diffuse;
+        pUniforms->light.ambient = material.ambient;
+        pUniforms->light.diffuse = material.diffuse;
 
-            context.draw(m, shaderId, 0);
-        }
+        context.draw(m, shaderId, 0);
     }
 }
 
@@ -864,10 +855,13 @@ int main()
     utils::Pointer<SL_WindowBuffer> pRenderBuf{SL_WindowBuffer::create()};
     utils::Pointer<SL_SceneGraph>   pGraph{std::move(create_context())};
     utils::Pointer<bool[]>          pKeySyms{new bool[65536]};
+    SL_BoundingVolumeHierarchy      bvh;
+    SL_AlignedVector<SL_DrawItem>   drawList;
 
     std::fill_n(pKeySyms.get(), 65536, false);
 
     SL_Context& context = pGraph->mContext;
+    bvh.init(*pGraph);
 
     int shouldQuit = pWindow->init(IMAGE_WIDTH, IMAGE_HEIGHT);
 
@@ -1069,6 +1063,7 @@ int main()
             }
 
             pGraph->update();
+            bvh.refit(*pGraph);
 
             #if TEST_REVERSED_DEPTH
                 context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 1.0}, 0.0);
@@ -1076,7 +1071,7 @@ int main()
                 context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 1.0}, 1.0);
             #endif
 
-            render_scene(pGraph.get(), pWindow->width(), pWindow->height(), projMatrix, camTrans, usePbr);
+            render_scene(pGraph.get(), bvh, drawList, pWindow->width(), pWindow->height(), projMatrix, camTrans, usePbr);
 
             context.blit(pRenderBuf->texture().view(), texIndex);
             pWindow->render(*pRenderBuf);
@@ -0,0 +1,138 @@
+
+#include <algorithm> // std::sort
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "softlight/SL_Geometry.hpp" // sl_draw_line_bresenham(), sl_draw_line_bresenham_rows()
+
+#include "sl_test_utils.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+-----------------------------------------------------------------------------*/
+constexpr sl_lowp_t    TEST_GRID_SIZE = 24;
+constexpr sl_lowp_t    TEST_ORIGIN_X  = 11;
+constexpr sl_lowp_t    TEST_ORIGIN_Y  = 13;
+constexpr unsigned     NUM_TEST_LINES = 2000;
+constexpr sl_highp_t   TEST_MAX_COORD = 2048;
+constexpr sl_highp_t   TEST_THREAD_COUNTS[] = {1, 2, 3, 8};
+
+// Pixels are packed as (y << 16) | x so they can be sorted & compared
+typedef std::vector<uint32_t> PixelList;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Rasterize a line using both algorithms
+-----------------------------------------------------------------------------*/
+PixelList reference_pixels(sl_lowp_t x1, sl_lowp_t y1, sl_lowp_t x2, sl_lowp_t y2)
+{
+    PixelList pixels;
+
+    sl_draw_line_bresenham(x1, y1, x2, y2, [&](sl_lowp_t x, sl_lowp_t y)->void
+    {
+        pixels.push_back(((uint32_t)(uint16_t)y << 16u) | (uint32_t)(uint16_t)x);
+    });
+
+    std::sort(pixels.begin(), pixels.end());
+    return pixels;
+}
+
+
+
+bool row_pixels(sl_lowp_t x1, sl_lowp_t y1, sl_lowp_t x2, sl_lowp_t y2, sl_highp_t numThreads, PixelList& outPixels)
+{
+    bool ownedRows = true;
+    outPixels.clear();
+
+    for (sl_highp_t threadId = 0; threadId < numThreads; ++threadId)
+    {
+        sl_draw_line_bresenham_rows(x1, y1, x2, y2, threadId, numThreads, [&](sl_lowp_t x, sl_lowp_t y)->void
+        {
+            ownedRows = ownedRows && ((sl_highp_t)y % numThreads) == threadId;
+            outPixels.push_back(((uint32_t)(uint16_t)y << 16u) | (uint32_t)(uint16_t)x);
+        });
+    }
+
+    std::sort(outPixels.begin(), outPixels.end());
+    return ownedRows;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Merging the rows of every thread should reproduce the original line
+-----------------------------------------------------------------------------*/
+bool compare_line(sl_lowp_t x1, sl_lowp_t y1, sl_lowp_t x2, sl_lowp_t y2)
+{
+    const PixelList&& expected = reference_pixels(x1, y1, x2, y2);
+    PixelList pixels;
+
+    for (sl_highp_t numThreads : TEST_THREAD_COUNTS)
+    {
+        if (!row_pixels(x1, y1, x2, y2, numThreads, pixels))
+        {
+            std::cerr << "Line (" << x1 << ", " << y1 << ") -> (" << x2 << ", " << y2 << ") wrote to unowned rows with " << numThreads << " threads." << std::endl;
+            return false;
+        }
+
+        if (pixels != expected)
+        {
+            std::cerr << "Line (" << x1 << ", " << y1 << ") -> (" << x2 << ", " << y2 << ") mismatch with " << numThreads << " threads: "
+                << pixels.size() << " pixels, expected " << expected.size() << '.' << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+int main()
+{
+    // Every line from a point to a small grid, covering all octants,
+    // diagonals, horizontal & vertical lines, and the zero-length line.
+    for (sl_lowp_t y = 0; y < TEST_GRID_SIZE; ++y)
+    {
+        for (sl_lowp_t x = 0; x < TEST_GRID_SIZE; ++x)
+        {
+            if (!compare_line(TEST_ORIGIN_X, TEST_ORIGIN_Y, x, y) || !compare_line(x, y, TEST_ORIGIN_X, TEST_ORIGIN_Y))
+            {
+                return -1;
+            }
+        }
+    }
+
+    // Long lines, which step over many rows between each thread's pixels
+    uint32_t seed = 0xC0FFEE11u;
+
+    for (unsigned i = 0; i < NUM_TEST_LINES; ++i)
+    {
+        const sl_lowp_t x1 = (sl_lowp_t)((0.5f + 0.5f * sl_test_random(seed)) * (float)(TEST_MAX_COORD-1));
+        const sl_lowp_t y1 = (sl_lowp_t)((0.5f + 0.5f * sl_test_random(seed)) * (float)(TEST_MAX_COORD-1));
+        const sl_lowp_t x2 = (sl_lowp_t)((0.5f + 0.5f * sl_test_random(seed)) * (float)(TEST_MAX_COORD-1));
+        const sl_lowp_t y2 = (sl_lowp_t)((0.5f + 0.5f * sl_test_random(seed)) * (float)(TEST_MAX_COORD-1));
+
+        if (!compare_line(x1, y1, x2, y2))
+        {
+            return -2;
+        }
+    }
+
+    // Axis-aligned lines along the edges of a large framebuffer
+    if (!compare_line(0, 0, TEST_MAX_COORD-1, 0)
+    || !compare_line(0, 0, 0, TEST_MAX_COORD-1)
+    || !compare_line(TEST_MAX_COORD-1, TEST_MAX_COORD-1, 0, TEST_MAX_COORD-1)
+    || !compare_line(TEST_MAX_COORD-1, TEST_MAX_COORD-1, TEST_MAX_COORD-1, 0))
+    {
+        return -3;
+    }
+
+    std::cout << "Scanline partitioned lines matched." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,297 @@
+
+#include <cmath> // std::abs, std::sqrt
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <vector>
+
+#include "lightsky/math/vec4.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Config.hpp" // SL_MAX_LINE_WIDTH
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Shader.hpp"
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_ViewportState.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Line endpoints are given in pixels, then offset by a quarter pixel so they
+ * land on the same whole pixels after the NDC to screen-space transform. The
+ * rasterizer may use approximate reciprocals for each line's direction, so
+ * coverage is only compared within a small tolerance.
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_SIZE = 160;
+constexpr float    TEST_EPSILON    = 0.05f;
+
+struct TestLine
+{
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    float width;
+    bool  smooth;
+};
+
+const TestLine TEST_LINES[] = {
+    // horizontal, vertical & zero-length lines
+    {20.f,  40.f,  140.f, 40.f,  3.f,   false},
+    {30.f,  10.f,  30.f,  150.f, 4.f,   false},
+    {80.f,  80.f,  80.f,  80.f,  5.f,   false},
+    {20.f,  40.f,  140.f, 40.f,  4.5f,  true},
+    {80.f,  80.f,  80.f,  80.f,  6.f,   true},
+
+    // one line within each octant
+    {10.f,  20.f,  150.f, 70.f,  3.f,   false},
+    {10.f,  10.f,  50.f,  150.f, 6.f,   false},
+    {150.f, 20.f,  10.f,  60.f,  2.5f,  false},
+    {140.f, 150.f, 90.f,  10.f,  7.f,   false},
+    {30.f,  150.f, 145.f, 120.f, 1.f,   true},
+    {20.f,  140.f, 60.f,  15.f,  3.f,   true},
+    {150.f, 130.f, 10.f,  90.f,  5.5f,  true},
+    {110.f, 10.f,  70.f,  150.f, 8.f,   true},
+
+    // 45 degree diagonals
+    {10.f,  10.f,  150.f, 150.f, 3.f,   false},
+    {10.f,  150.f, 150.f, 10.f,  4.f,   true},
+
+    // widths at & beyond the limit, which are clamped
+    {20.f,  80.f,  140.f, 80.f,  (float)SL_MAX_LINE_WIDTH,      false},
+    {20.f,  80.f,  140.f, 80.f,  (float)SL_MAX_LINE_WIDTH * 2.f, false},
+    {40.f,  40.f,  120.f, 120.f, (float)SL_MAX_LINE_WIDTH * 2.f, true},
+};
+
+constexpr size_t NUM_TEST_LINES = sizeof(TEST_LINES) / sizeof(TEST_LINES[0]);
+
+
+
+/*-----------------------------------------------------------------------------
+ * Shader which writes opaque white, leaving coverage in the alpha channel
+-----------------------------------------------------------------------------*/
+math::vec4 _line_vert_shader_impl(SL_VertexParam& param)
+{
+    return *param.pVbo->element<const math::vec4>(param.pVao->offset(0, param.vertId));
+}
+
+
+
+bool _line_frag_shader_impl(SL_FragmentParam& fragParam)
+{
+    fragParam.pOutputs[0] = math::vec4{1.f};
+    return true;
+}
+
+
+
+size_t create_line_shader(SL_Context& context)
+{
+    SL_VertexShader vertShader;
+    vertShader.numVaryings = 0;
+    vertShader.cullMode = SL_CULL_OFF;
+    vertShader.shader = _line_vert_shader_impl;
+
+    SL_FragmentShader fragShader;
+    fragShader.numVaryings = 0;
+    fragShader.numOutputs = 1;
+    fragShader.blend = SL_BLEND_OFF;
+    fragShader.depthMask = SL_DEPTH_MASK_OFF;
+    fragShader.depthTest = SL_DEPTH_TEST_OFF;
+    fragShader.shader = _line_frag_shader_impl;
+
+    return context.create_shader(vertShader, fragShader);
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Build a pair of vertices for each line
+-----------------------------------------------------------------------------*/
+math::vec4 pixel_to_ndc(float x, float y)
+{
+    constexpr float halfSize = (float)TEST_IMAGE_SIZE * 0.5f;
+    return math::vec4{(x + 0.25f) / halfSize - 1.f, (y + 0.25f) / halfSize - 1.f, 0.f, 1.f};
+}
+
+
+
+std::vector<math::vec4> create_verts()
+{
+    std::vector<math::vec4> verts;
+    verts.reserve(NUM_TEST_LINES * 2u);
+
+    for (const TestLine& line : TEST_LINES)
+    {
+        verts.push_back(pixel_to_ndc(line.x0, line.y0));
+        verts.push_back(pixel_to_ndc(line.x1, line.y1));
+    }
+
+    return verts;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Analytic coverage of each pixel
+ *
+ * Returns a negative value for pixels of aliased lines which lie on the edge
+ * of the line's rectangle, where rounding decides if they're drawn.
+-----------------------------------------------------------------------------*/
+float expected_coverage(const TestLine& line, float x, float y)
+{
+    const float halfWidth = math::min(line.width, (float)SL_MAX_LINE_WIDTH) * 0.5f;
+    const float dx        = line.x1 - line.x0;
+    const float dy        = line.y1 - line.y0;
+    const float len       = std::sqrt(dx*dx + dy*dy);
+    const bool  isDot     = len < 1.f;
+    const float dirX      = isDot ? 1.f : (dx / len);
+    const float dirY      = isDot ? 0.f : (dy / len);
+    const float capOffset = isDot ? halfWidth : 0.f;
+
+    const float rx     = x - line.x0;
+    const float ry     = y - line.y0;
+    const float across = std::abs(ry*dirX - rx*dirY);
+    const float along  = rx*dirX + ry*dirY;
+
+    if (line.smooth)
+    {
+        const float edgeCoverage = math::clamp(halfWidth + 0.5f - across, 0.f, 1.f);
+        const float capCoverage  = math::clamp(math::min(along, len-along) + capOffset + 0.5f, 0.f, 1.f);
+        return math::min(edgeCoverage, capCoverage);
+    }
+
+    if (std::abs(across - halfWidth) < TEST_EPSILON
+    || std::abs(along + capOffset) < TEST_EPSILON
+    || std::abs(along - len - capOffset) < TEST_EPSILON)
+    {
+        return -1.f;
+    }
+
+    return (across < halfWidth && along > -capOffset && along < len+capOffset) ? 1.f : 0.f;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Draw a line, then compare every pixel against its expected coverage
+-----------------------------------------------------------------------------*/
+bool check_line(SL_Context& context, const SL_Mesh& mesh, size_t shaderId, size_t lineId, size_t& numPartial)
+{
+    const TestLine& line = TEST_LINES[lineId];
+    SL_ViewportState& viewState = context.viewport_state();
+
+    viewState.line_width(line.width);
+    viewState.line_smoothing(line.smooth);
+
+    if (viewState.line_width() != math::min(line.width, (float)SL_MAX_LINE_WIDTH))
+    {
+        std::cerr << "Line " << lineId << ": invalid line width " << viewState.line_width() << '.' << std::endl;
+        return false;
+    }
+
+    SL_Mesh lineMesh = mesh;
+    lineMesh.elementBegin = lineId * 2u;
+    lineMesh.elementEnd   = lineId * 2u + 2u;
+
+    context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 0.0}, 0.0);
+    context.draw(lineMesh, shaderId, 0);
+
+    const SL_TextureView& view = context.framebuffer(0).get_color_buffer(0);
+    const SL_ColorRGBAf* pTexels = reinterpret_cast<const SL_ColorRGBAf*>(view.pTexels);
+    size_t numCovered = 0;
+
+    for (uint16_t y = 0; y < TEST_IMAGE_SIZE; ++y)
+    {
+        for (uint16_t x = 0; x < TEST_IMAGE_SIZE; ++x)
+        {
+            const float alpha    = pTexels[sl_fbo_index(view, x, y)][3];
+            const float expected = expected_coverage(line, (float)x, (float)y);
+
+            if (alpha < 0.f || alpha > 1.f)
+            {
+                std::cerr << "Line " << lineId << ": coverage " << alpha << " at (" << x << ", " << y << ") is out of range." << std::endl;
+                return false;
+            }
+
+            if (expected >= 0.f && std::abs(alpha - expected) > TEST_EPSILON)
+            {
+                std::cerr << "Line " << lineId << ": coverage at (" << x << ", " << y << ") is " << alpha << ", expected " << expected << '.' << std::endl;
+                return false;
+            }
+
+            numCovered += alpha > 0.f;
+            numPartial += alpha > 0.f && alpha < 1.f;
+        }
+    }
+
+    if (!numCovered)
+    {
+        std::cerr << "Line " << lineId << " was not drawn." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Wide & anti-aliased lines should cover the pixels within their rectangle
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+
+    if (sl_test_init_framebuffer(context, SL_ColorDataType::SL_COLOR_RGBA_FLOAT, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE) < 0)
+    {
+        std::cerr << "Unable to initialize the test framebuffer." << std::endl;
+        return -1;
+    }
+
+    const std::vector<math::vec4>&& verts = create_verts();
+
+    SL_Mesh mesh;
+    if (sl_test_init_mesh(context, verts.data(), sizeof(math::vec4), verts.size(), mesh) != 0)
+    {
+        std::cerr << "Unable to initialize the test mesh." << std::endl;
+        return -2;
+    }
+
+    mesh.mode = RENDER_MODE_LINES;
+    const size_t shaderId = create_line_shader(context);
+
+    // Threads own interleaved scanlines of each line
+    for (unsigned numThreads : {1u, 3u, 4u})
+    {
+        size_t numPartial = 0;
+        context.num_threads(numThreads);
+
+        for (size_t i = 0; i < NUM_TEST_LINES; ++i)
+        {
+            if (!check_line(context, mesh, shaderId, i, numPartial))
+            {
+                std::cerr << "Failed with " << numThreads << " threads." << std::endl;
+                return -3;
+            }
+        }
+
+        // Smoothed lines must fade out across their edges
+        if (!numPartial)
+        {
+            std::cerr << "Anti-aliased lines had no partially covered pixels." << std::endl;
+            return -4;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+
+#include <algorithm> // std::sort
+#include <array>
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <iostream>
+#include <vector>
+
+#include "lightsky/math/vec3.h"
+
+#include "softlight/SL_MeshOptimizer.hpp"
+
+
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Build a grid of quads with its triangles in a scrambled order
+-----------------------------------------------------------------------------*/
+void build_grid(unsigned gridSize, std::vector<math::vec3>& outVerts, std::vector<uint32_t>& outIndices)
+{
+    outVerts.clear();
+    outIndices.clear();
+
+    for (unsigned y = 0; y <= gridSize; ++y)
+    {
+        for (unsigned x = 0; x <= gridSize; ++x)
+        {
+            outVerts.push_back(math::vec3{(float)x, (float)y, 0.f});
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> tris;
+
+    for (unsigned y = 0; y < gridSize; ++y)
+    {
+        for (unsigned x = 0; x < gridSize; ++x)
+        {
+            const uint32_t i0 = y * (gridSize+1) + x;
+            const uint32_t i1 = i0 + 1;
+            const uint32_t i2 = i0 + gridSize + 1;
+            const uint32_t i3 = i2 + 1;
+
+            tris.push_back(std::array<uint32_t, 3>{{i0, i1, i2}});
+            tris.push_back(std::array<uint32_t, 3>{{i1, i3, i2}});
+        }
+    }
+
+    // Deterministic shuffle so the test is repeatable
+    uint32_t seed = 0x12345678u;
+    for (size_t i = tris.size()-1u; i > 0; --i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(tris[i], tris[seed % (uint32_t)(i+1u)]);
+    }
+
+    for (const std::array<uint32_t, 3>& t : tris)
+    {
+        outIndices.insert(outIndices.end(), t.begin(), t.end());
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Sorted list of triangle positions, used to ensure no triangles were lost
+-----------------------------------------------------------------------------*/
+std::vector<std::array<float, 9>> sorted_triangles(const std::vector<math::vec3>& verts, const std::vector<uint32_t>& indices)
+{
+    std::vector<std::array<float, 9>> tris;
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<std::array<float, 3>, 3> t;
+        for (size_t j = 0; j < 3; ++j)
+        {
+            const math::vec3& v = verts[indices[i+j]];
+            t[j] = std::array<float, 3>{{v[0], v[1], v[2]}};
+        }
+
+        // Triangle winding is preserved, so only rotate the smallest vertex
+        // to the front.
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+
+        std::array<float, 9> flat;
+        std::memcpy(flat.data(), t.data(), sizeof(flat));
+        tris.push_back(flat);
+    }
+
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+
+
+int main()
+{
+    std::vector<math::vec3> verts;
+    std::vector<uint32_t> indices;
+    build_grid(64, verts, indices);
+
+    const std::vector<std::array<float, 9>>&& origTris = sorted_triangles(verts, indices);
+    const float acmrBefore = sl_calc_acmr(indices.data(), indices.size(), verts.size());
+
+    std::vector<size_t> clusters;
+    sl_optimize_vertex_cache(indices.data(), indices.size(), verts.size(), SL_MESH_OPTIMIZER_CACHE_SIZE, &clusters);
+    const float acmrCache = sl_calc_acmr(indices.data(), indices.size(), verts.size());
+
+    sl_optimize_overdraw(indices.data(), indices.size(), clusters, reinterpret_cast<const char*>(verts.data()), verts.size(), sizeof(math::vec3));
+    sl_optimize_vertex_fetch(indices.data(), indices.size(), reinterpret_cast<char*>(verts.data()), verts.size(), sizeof(math::vec3));
+    const float acmrAfter = sl_calc_acmr(indices.data(), indices.size(), verts.size());
+
+    std::cout << "Triangles:           " << indices.size()/3u << std::endl;
+    std::cout << "Clusters:            " << clusters.size()   << std::endl;
+    std::cout << "ACMR (original):     " << acmrBefore        << std::endl;
+    std::cout << "ACMR (vertex cache): " << acmrCache         << std::endl;
+    std::cout << "ACMR (final):        " << acmrAfter         << std::endl;
+
+    if (sorted_triangles(verts, indices) != origTris)
+    {
+        std::cerr << "Error: Mesh optimization changed the mesh geometry." << std::endl;
+        return -1;
+    }
+
+    // Indices must be in first-use order after vertex fetch optimization
+    uint32_t maxIndex = 0;
+    for (uint32_t i : indices)
+    {
+        if (i > maxIndex + 1u)
+        {
+            std::cerr << "Error: Vertices were not reordered by first use." << std::endl;
+            return -2;
+        }
+
+        maxIndex = std::max(maxIndex, i);
+    }
+
+    if (acmrAfter >= acmrBefore)
+    {
+        std::cerr << "Error: Mesh optimization did not reduce the ACMR." << std::endl;
+        return -3;
+    }
+
+    return 0;
+}
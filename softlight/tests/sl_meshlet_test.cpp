@@ -0,0 +1,289 @@
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "lightsky/math/mat4.h"
+#include "lightsky/math/vec4.h"
+
+#include "softlight/SL_Camera.hpp" // sl_extract_frustum_planes()
+#include "softlight/SL_CommandList.hpp"
+#include "softlight/SL_Config.hpp" // SL_VERTEX_CHUNK_SIZE
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Meshlet.hpp"
+#include "softlight/SL_Shader.hpp"
+#include "softlight/SL_UniformBuffer.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Each vertex chunk holds a cluster of small triangles in a column of the
+ * screen. The columns span (-4, 4) in clip space, so about half of them are
+ * outside the view frustum. The last chunk is only partially filled.
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_SIZE = 64;
+constexpr size_t   NUM_TEST_CHUNKS = 8;
+constexpr size_t   NUM_TEST_TRIS   = NUM_TEST_CHUNKS * SL_VERTEX_CHUNK_SIZE - 5u;
+
+// Meshes drawn together are split on this chunk
+constexpr size_t   TEST_SPLIT_CHUNK = 3;
+
+struct TestUniforms
+{
+    std::atomic<uint32_t>* pNumVerts;
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Shader which counts its vertex invocations
+-----------------------------------------------------------------------------*/
+math::vec4 _counting_vert_shader_impl(SL_VertexParam& param)
+{
+    param.pUniforms->as<TestUniforms>()->pNumVerts->fetch_add(1u, std::memory_order_relaxed);
+    return *param.pVbo->element<const math::vec4>(param.pVao->offset(0, param.vertId));
+}
+
+
+
+bool _counting_frag_shader_impl(SL_FragmentParam& fragParam)
+{
+    fragParam.pOutputs[0] = math::vec4{1.f};
+    return true;
+}
+
+
+
+size_t create_counting_shader(SL_Context& context)
+{
+    SL_VertexShader vertShader;
+    vertShader.numVaryings = 0;
+    vertShader.cullMode = SL_CULL_OFF;
+    vertShader.shader = _counting_vert_shader_impl;
+
+    SL_FragmentShader fragShader;
+    fragShader.numVaryings = 0;
+    fragShader.numOutputs = 1;
+    fragShader.blend = SL_BLEND_OFF;
+    fragShader.depthMask = SL_DEPTH_MASK_OFF;
+    fragShader.depthTest = SL_DEPTH_TEST_OFF;
+    fragShader.shader = _counting_frag_shader_impl;
+
+    return context.create_shader(vertShader, fragShader, context.create_ubo());
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Build the columns of triangles
+-----------------------------------------------------------------------------*/
+std::vector<math::vec4> create_verts()
+{
+    std::vector<math::vec4> verts;
+    verts.reserve(NUM_TEST_TRIS * 3u);
+
+    for (size_t t = 0; t < NUM_TEST_TRIS; ++t)
+    {
+        const size_t chunk = t / SL_VERTEX_CHUNK_SIZE;
+        const float  x     = -3.5f + (float)chunk;
+        const float  y     = -0.5f + (float)(t % SL_VERTEX_CHUNK_SIZE) * (1.f / (float)SL_VERTEX_CHUNK_SIZE);
+
+        verts.push_back(math::vec4{x - 0.25f, y,         0.f, 1.f});
+        verts.push_back(math::vec4{x + 0.25f, y,         0.f, 1.f});
+        verts.push_back(math::vec4{x,         y + 0.1f, 0.f, 1.f});
+    }
+
+    return verts;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Number of vertices which should be shaded after culling a mesh
+-----------------------------------------------------------------------------*/
+uint32_t expected_verts(const SL_Mesh& m, const SL_MeshletCull& cull, size_t& outNumCulled)
+{
+    constexpr size_t chunkElements = (size_t)SL_VERTEX_CHUNK_SIZE * 3u;
+    uint32_t numVerts = 0;
+
+    for (size_t i = 0; i < cull.numMeshlets; ++i)
+    {
+        const size_t begin = m.elementBegin + i * chunkElements;
+        const size_t end   = (begin + chunkElements < m.elementEnd) ? (begin + chunkElements) : m.elementEnd;
+
+        if (sl_meshlet_visible(cull.pMeshlets[i], cull, false))
+        {
+            numVerts += (uint32_t)(end - begin);
+        }
+        else
+        {
+            ++outNumCulled;
+        }
+    }
+
+    return numVerts;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Draw meshes, then verify the number of vertices which were shaded
+-----------------------------------------------------------------------------*/
+template <typename DrawFunc>
+bool check_draw(SL_Context& context, std::atomic<uint32_t>& numVerts, uint32_t expected, const char* pName, DrawFunc&& draw)
+{
+    numVerts.store(0u);
+    context.clear_framebuffer(0, 0, SL_ColorRGBAd{0.0, 0.0, 0.0, 1.0}, 0.0);
+    draw();
+
+    const uint32_t shaded = numVerts.load();
+    if (shaded != expected)
+    {
+        std::cerr << pName << ": shaded " << shaded << " vertices, expected " << expected << '.' << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Meshlet culling should reject the same chunks through every draw path
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    if (sl_test_init_framebuffer(context, SL_ColorDataType::SL_COLOR_RGBA_8U, TEST_IMAGE_SIZE, TEST_IMAGE_SIZE) < 0)
+    {
+        std::cerr << "Unable to initialize the test framebuffer." << std::endl;
+        return -1;
+    }
+
+    const std::vector<math::vec4>&& verts = create_verts();
+
+    SL_Mesh mesh;
+    if (sl_test_init_mesh(context, verts.data(), sizeof(math::vec4), verts.size(), mesh) != 0)
+    {
+        std::cerr << "Unable to initialize the test mesh." << std::endl;
+        return -2;
+    }
+
+    std::atomic<uint32_t> numVerts{0u};
+    const size_t shaderId = create_counting_shader(context);
+    context.ubo(0).as<TestUniforms>()->pNumVerts = &numVerts;
+
+    // Split the mesh in two for multi-mesh draws
+    SL_Mesh halves[2] = {mesh, mesh};
+    halves[0].elementEnd   = TEST_SPLIT_CHUNK * SL_VERTEX_CHUNK_SIZE * 3u;
+    halves[1].elementBegin = halves[0].elementEnd;
+
+    SL_AlignedVector<SL_Meshlet> meshlets;
+    SL_AlignedVector<SL_Meshlet> halfMeshlets[2];
+
+    if (sl_build_meshlets(context, mesh, meshlets) != (int)NUM_TEST_CHUNKS
+    || sl_build_meshlets(context, halves[0], halfMeshlets[0]) != (int)TEST_SPLIT_CHUNK
+    || sl_build_meshlets(context, halves[1], halfMeshlets[1]) != (int)(NUM_TEST_CHUNKS-TEST_SPLIT_CHUNK))
+    {
+        std::cerr << "Invalid number of meshlets." << std::endl;
+        return -3;
+    }
+
+    SL_MeshletCull cull;
+    sl_extract_frustum_planes(math::mat4{1.f}, cull.planes);
+    cull.viewPos = math::vec4{0.f, 0.f, -2.f, 1.f};
+
+    SL_MeshletCull halfCulls[2] = {cull, cull};
+    const SL_MeshletCull* pHalfCulls[2] = {halfCulls, halfCulls+1};
+
+    cull.pMeshlets = meshlets.data();
+    cull.numMeshlets = meshlets.size();
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        halfCulls[i].pMeshlets = halfMeshlets[i].data();
+        halfCulls[i].numMeshlets = halfMeshlets[i].size();
+    }
+
+    size_t numCulled = 0;
+    const uint32_t expected = expected_verts(mesh, cull, numCulled);
+
+    if (numCulled == 0 || numCulled == NUM_TEST_CHUNKS)
+    {
+        std::cerr << "Invalid test setup, " << numCulled << " chunks are culled." << std::endl;
+        return -4;
+    }
+
+    // Only the first half is culled in this draw
+    size_t numHalfCulled = 0;
+    const uint32_t halfExpected = expected_verts(halves[0], halfCulls[0], numHalfCulled) + (uint32_t)(halves[1].elementEnd - halves[1].elementBegin);
+
+    std::cout << "Culling " << numCulled << " of " << NUM_TEST_CHUNKS << " chunks." << std::endl;
+
+    if (!check_draw(context, numVerts, (uint32_t)verts.size(), "draw", [&]()->void {
+        context.draw(mesh, shaderId, 0);
+    }))
+    {
+        return -5;
+    }
+
+    if (!check_draw(context, numVerts, expected, "draw_clustered", [&]()->void {
+        context.draw_clustered(mesh, cull, shaderId, 0);
+    }))
+    {
+        return -6;
+    }
+
+    if (!check_draw(context, numVerts, expected, "draw_clustered (multiple)", [&]()->void {
+        context.draw_clustered(halves, pHalfCulls, 2, shaderId, 0);
+    }))
+    {
+        return -7;
+    }
+
+    const SL_MeshletCull* pPartialCulls[2] = {halfCulls, nullptr};
+    if (!check_draw(context, numVerts, halfExpected, "draw_clustered (partial)", [&]()->void {
+        context.draw_clustered(halves, pPartialCulls, 2, shaderId, 0);
+    }))
+    {
+        return -8;
+    }
+
+    // Both draws are merged into a single run
+    const SL_DrawCommand draws[2] = {
+        {halves[0], 1, shaderId, 0, nullptr, halfCulls},
+        {halves[1], 1, shaderId, 0, nullptr, halfCulls+1}
+    };
+
+    if (!check_draw(context, numVerts, expected, "draw_batch", [&]()->void {
+        context.draw_batch(draws, 2);
+    }))
+    {
+        return -9;
+    }
+
+    SL_CommandList cmds;
+    cmds.draw_clustered(mesh, cull, shaderId, 0);
+    cmds.draw_clustered(halves, pHalfCulls, 2, shaderId, 0);
+
+    if (!check_draw(context, numVerts, expected * 2u, "SL_CommandList", [&]()->void {
+        context.execute(cmds);
+    }))
+    {
+        return -10;
+    }
+
+    return 0;
+}
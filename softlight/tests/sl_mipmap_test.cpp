@@ -0,0 +1,184 @@
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "lightsky/math/scalar_utils.h"
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Texture.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Neither dimension is a multiple of SL_TEXELS_PER_CHUNK, so every level of
+ * a swizzled texture contains partial chunks.
+-----------------------------------------------------------------------------*/
+constexpr uint16_t TEST_IMAGE_WIDTH = 10;
+constexpr uint16_t TEST_IMAGE_HEIGHT = 6;
+
+typedef SL_ColorRType<uint16_t> TestColor;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Reference box filter, matching SL_MipmapProcessor
+-----------------------------------------------------------------------------*/
+std::vector<uint16_t> reference_level(const std::vector<uint16_t>& src, uint_fast32_t srcW, uint_fast32_t srcH, uint_fast32_t dstW, uint_fast32_t dstH)
+{
+    std::vector<uint16_t> dst;
+    dst.resize(dstW * dstH);
+
+    for (uint_fast32_t y = 0; y < dstH; ++y)
+    {
+        const uint_fast32_t y0 = y << 1u;
+        const uint_fast32_t y1 = math::min<uint_fast32_t>(y0 + 1u, srcH - 1u);
+
+        for (uint_fast32_t x = 0; x < dstW; ++x)
+        {
+            const uint_fast32_t x0 = x << 1u;
+            const uint_fast32_t x1 = math::min<uint_fast32_t>(x0 + 1u, srcW - 1u);
+
+            const uint_fast32_t sum = src[x0 + srcW * y0] + src[x1 + srcW * y0] + src[x0 + srcW * y1] + src[x1 + srcW * y1];
+            dst[x + dstW * y] = (uint16_t)((sum + 2u) >> 2u);
+        }
+    }
+
+    return dst;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Fill a texture with unique values, then verify nothing was overwritten
+-----------------------------------------------------------------------------*/
+template <SL_TexelOrder order>
+int fill_texture(SL_Texture& tex, std::vector<uint16_t>& outValues)
+{
+    outValues.resize(tex.width() * tex.height());
+
+    for (uint16_t y = 0; y < tex.height(); ++y)
+    {
+        for (uint16_t x = 0; x < tex.width(); ++x)
+        {
+            const uint16_t value = (uint16_t)((1u + x + tex.width() * y) * 97u);
+            outValues[x + tex.width() * y] = value;
+            tex.texel<TestColor, order>(x, y) = TestColor{value};
+        }
+    }
+
+    // Texels are written through SL_Texture::map_coordinate() and read
+    // through sl_texture_view_index(). Both must agree, without overlap.
+    const SL_TextureView& view = tex.view();
+    const TestColor* pTexels = reinterpret_cast<const TestColor*>(view.pTexels);
+
+    for (uint16_t y = 0; y < tex.height(); ++y)
+    {
+        for (uint16_t x = 0; x < tex.width(); ++x)
+        {
+            const uint16_t value = pTexels[sl_texture_view_index<order>(view, x, y)][0];
+            if (value != outValues[x + tex.width() * y])
+            {
+                std::cerr << "Invalid base texel at (" << x << ", " << y << "): " << value << " != " << outValues[x + tex.width() * y] << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare every generated mip level against the reference filter
+-----------------------------------------------------------------------------*/
+template <SL_TexelOrder order>
+int test_mipmaps(SL_Context& context, size_t texId)
+{
+    SL_Texture& tex = context.texture(texId);
+    if (tex.init(SL_ColorDataType::SL_COLOR_R_16U, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, 1) != 0)
+    {
+        std::cerr << "Unable to initialize the test texture." << std::endl;
+        return -1;
+    }
+
+    std::vector<uint16_t> reference;
+    if (fill_texture<order>(tex, reference) != 0)
+    {
+        return -2;
+    }
+
+    if (context.generate_mipmaps(texId, order) != 0)
+    {
+        std::cerr << "Unable to generate mipmaps." << std::endl;
+        return -3;
+    }
+
+    // 10x6, 5x3, 2x1, 1x1
+    if (tex.num_levels() != 4)
+    {
+        std::cerr << "Invalid number of mip levels: " << tex.num_levels() << std::endl;
+        return -4;
+    }
+
+    for (uint32_t level = 1; level < tex.num_levels(); ++level)
+    {
+        const SL_TextureView& srcView = tex.level_view(level-1u);
+        const SL_TextureView& view = tex.level_view(level);
+        const TestColor* pTexels = reinterpret_cast<const TestColor*>(view.pTexels);
+
+        reference = reference_level(reference, srcView.width, srcView.height, view.width, view.height);
+
+        for (uint16_t y = 0; y < view.height; ++y)
+        {
+            for (uint16_t x = 0; x < view.width; ++x)
+            {
+                const uint16_t value = pTexels[sl_texture_view_index<order>(view, x, y)][0];
+                const uint16_t expected = reference[x + view.width * y];
+
+                if (value != expected)
+                {
+                    std::cerr << "Invalid texel in level " << level << " at (" << x << ", " << y << "): " << value << " != " << expected << std::endl;
+                    return -5;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Generate mipmaps for odd-sized textures in both texel orders
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    const size_t texId = context.create_texture();
+
+    int retCode = test_mipmaps<SL_TexelOrder::ORDERED>(context, texId);
+    if (retCode != 0)
+    {
+        std::cerr << "Ordered mipmaps failed." << std::endl;
+        return retCode;
+    }
+
+    retCode = test_mipmaps<SL_TexelOrder::SWIZZLED>(context, texId);
+    if (retCode != 0)
+    {
+        std::cerr << "Swizzled mipmaps failed." << std::endl;
+        return retCode - 10;
+    }
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+
+#include <cmath> // std::abs, std::sin, std::cos
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lightsky/math/mat4.h"
+#include "lightsky/math/quat.h"
+#include "lightsky/math/vec3.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_SceneGraph.hpp"
+#include "softlight/SL_SceneNode.hpp"
+#include "softlight/SL_Transform.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Each root has 8 children, each of those has 16 children, and so on. Depths
+ * 2-4 contain 512 nodes each, which is enough to update them using multiple
+ * threads. A few nodes at depth 4 start long chains of single children.
+-----------------------------------------------------------------------------*/
+constexpr size_t NUM_TEST_ROOTS      = 4;
+constexpr size_t TEST_CHILD_COUNTS[] = {8, 16, 1, 1};
+constexpr size_t TEST_CHAIN_SPACING  = 37;
+constexpr size_t TEST_CHAIN_LENGTH   = 24;
+constexpr float  TEST_DIRTY_RATIO    = 0.04f;
+constexpr float  TEST_EPSILON        = 1.e-4f;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Build the hierarchy
+-----------------------------------------------------------------------------*/
+void randomize_transform(SL_Transform& t, uint32_t& seed)
+{
+    const math::vec3 axis = math::normalize(math::vec3{sl_test_random(seed), sl_test_random(seed), 1.f});
+    const float angle = sl_test_random(seed) * 0.5f;
+
+    t.position(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)});
+    t.orientation(math::quat{axis[0] * std::sin(angle), axis[1] * std::sin(angle), axis[2] * std::sin(angle), std::cos(angle)});
+    t.scaling(math::vec3{1.f + 0.01f * sl_test_random(seed)});
+}
+
+
+
+// Nodes are inserted depth-first, so every parent's children are already at
+// the end of the graph and no nodes get reordered.
+bool insert_subtree(SL_SceneGraph& graph, size_t parentId, size_t depth, std::vector<size_t>& chainIds, size_t& chainCounter, uint32_t& seed)
+{
+    SL_Transform t;
+    randomize_transform(t, seed);
+
+    const std::string&& nodeName = std::string{"node_"} + std::to_string(graph.mNodes.size());
+    const size_t nodeId = graph.insert_empty_node(parentId, nodeName.c_str(), t);
+
+    if (nodeId != graph.mNodes.size()-1 || graph.mNodeParentIds[nodeId] != parentId)
+    {
+        std::cerr << "Node " << nodeName << " was placed at an unexpected index." << std::endl;
+        return false;
+    }
+
+    constexpr size_t numCountedDepths = sizeof(TEST_CHILD_COUNTS) / sizeof(TEST_CHILD_COUNTS[0]);
+    size_t numChildren = 0;
+
+    if (depth < numCountedDepths)
+    {
+        numChildren = TEST_CHILD_COUNTS[depth];
+    }
+    else if (depth == numCountedDepths)
+    {
+        if ((chainCounter++ % TEST_CHAIN_SPACING) == 0)
+        {
+            chainIds.push_back(nodeId);
+            numChildren = 1;
+        }
+    }
+    else if (depth < numCountedDepths + TEST_CHAIN_LENGTH)
+    {
+        numChildren = 1;
+    }
+
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+        if (!insert_subtree(graph, nodeId, depth+1, chainIds, chainCounter, seed))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Serial, recursive reference for each node's world transform
+-----------------------------------------------------------------------------*/
+math::mat4 reference_transform(const SL_SceneGraph& graph, size_t nodeId)
+{
+    const size_t parentId = graph.mNodeParentIds[nodeId];
+    const math::mat4&& localTransform = graph.mCurrentTransforms[nodeId].get_rst_matrix();
+
+    if (parentId == SCENE_NODE_ROOT_ID)
+    {
+        return localTransform;
+    }
+
+    return reference_transform(graph, parentId) * localTransform;
+}
+
+
+
+bool compare_transforms(const SL_SceneGraph& graph, const char* pName)
+{
+    for (size_t nodeId = 0; nodeId < graph.mNodes.size(); ++nodeId)
+    {
+        if (graph.mCurrentTransforms[nodeId].is_dirty())
+        {
+            std::cerr << pName << ": node " << nodeId << " is still dirty after an update." << std::endl;
+            return false;
+        }
+
+        const math::mat4&& expected = reference_transform(graph, nodeId);
+        const math::mat4& world = graph.mCurrentTransforms[nodeId].transform();
+        const math::mat4& model = graph.mModelMatrices[nodeId];
+
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            for (unsigned r = 0; r < 4; ++r)
+            {
+                const float tolerance = TEST_EPSILON * (1.f + std::abs(expected[c][r]));
+
+                if (std::abs(world[c][r] - expected[c][r]) > tolerance || std::abs(model[c][r] - expected[c][r]) > tolerance)
+                {
+                    std::cerr << pName << ": node " << nodeId << " has an invalid transform at [" << c << "][" << r << "]: "
+                        << world[c][r] << ", expected " << expected[c][r] << '.' << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Modify some nodes, then update the graph
+-----------------------------------------------------------------------------*/
+size_t dirty_random_nodes(SL_SceneGraph& graph, uint32_t& seed)
+{
+    size_t numDirty = 0;
+
+    for (size_t nodeId = 0; nodeId < graph.mNodes.size(); ++nodeId)
+    {
+        if ((0.5f + 0.5f * sl_test_random(seed)) < TEST_DIRTY_RATIO)
+        {
+            randomize_transform(graph.mCurrentTransforms[nodeId], seed);
+            ++numDirty;
+        }
+    }
+
+    return numDirty;
+}
+
+
+
+bool update_and_compare(SL_SceneGraph& graph, unsigned numThreads, const char* pName)
+{
+    graph.mContext.num_threads(numThreads);
+    graph.update();
+
+    return compare_transforms(graph, pName);
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Depth-sorted updates should match a recursive update of every node
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_SceneGraph graph;
+    uint32_t seed = 0x5CE7E000u;
+    std::vector<size_t> rootIds;
+    std::vector<size_t> chainIds;
+    size_t chainCounter = 0;
+
+    for (size_t i = 0; i < NUM_TEST_ROOTS; ++i)
+    {
+        rootIds.push_back(graph.mNodes.size());
+
+        if (!insert_subtree(graph, SCENE_NODE_ROOT_ID, 0, chainIds, chainCounter, seed))
+        {
+            return -1;
+        }
+    }
+
+    std::cout << "Updating " << graph.mNodes.size() << " nodes." << std::endl;
+
+    // Every node is dirty after insertion
+    if (!update_and_compare(graph, 4, "Initial update"))
+    {
+        return -2;
+    }
+
+    // Two entire subtrees, giving 256 nodes at depths 2-4
+    randomize_transform(graph.mCurrentTransforms[rootIds[0]], seed);
+    randomize_transform(graph.mCurrentTransforms[rootIds[2]], seed);
+    dirty_random_nodes(graph, seed);
+
+    if (!update_and_compare(graph, 4, "Dirty subtrees"))
+    {
+        return -3;
+    }
+
+    // Threads receive uneven shares of each depth
+    randomize_transform(graph.mCurrentTransforms[rootIds[1]], seed);
+    randomize_transform(graph.mCurrentTransforms[rootIds[3]], seed);
+
+    if (!update_and_compare(graph, 3, "Uneven threads"))
+    {
+        return -4;
+    }
+
+    // Scattered nodes, most of which are too few per depth to use threads
+    if (!dirty_random_nodes(graph, seed) || !update_and_compare(graph, 4, "Scattered nodes"))
+    {
+        return -5;
+    }
+
+    if (!dirty_random_nodes(graph, seed) || !update_and_compare(graph, 1, "Single thread"))
+    {
+        return -6;
+    }
+
+    // Only the end of a chain
+    randomize_transform(graph.mCurrentTransforms[chainIds.back() + TEST_CHAIN_LENGTH / 2], seed);
+
+    if (!update_and_compare(graph, 4, "Chain"))
+    {
+        return -7;
+    }
+
+    // Nothing changed
+    if (!update_and_compare(graph, 4, "Clean graph"))
+    {
+        return -8;
+    }
+
+    return 0;
+}
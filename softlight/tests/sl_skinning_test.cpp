@@ -0,0 +1,301 @@
+
+#include <cstddef> // offsetof
+#include <cstdint>
+#include <iostream>
+
+#include "lightsky/math/half.h"
+#include "lightsky/math/mat_utils.h"
+#include "lightsky/math/vec_utils.h"
+
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_PackedVertex.hpp"
+#include "softlight/SL_Skinning.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+#include "sl_test_utils.hpp"
+
+namespace math = ls::math;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+-----------------------------------------------------------------------------*/
+constexpr size_t NUM_TEST_VERTS = 2400;
+constexpr size_t NUM_TEST_BONES = 4;
+constexpr size_t TEST_FIRST_VERT = 300; // vertices before this are unused
+constexpr float  TEST_POS_EPSILON = 1.0e-4f;
+constexpr float  TEST_NORM_EPSILON = 8.0e-3f; // 2_10_10_10 precision
+
+// Interleaved vertex layout, matching the scene loader
+struct TestVertex
+{
+    math::vec3 pos;
+    int32_t norm;
+    math::vec4_t<uint16_t> ids;
+    math::vec4_t<math::half> weights;
+    math::vec2 uv;
+};
+
+enum : unsigned
+{
+    TEST_BINDING_POS,
+    TEST_BINDING_NORM,
+    TEST_BINDING_IDS,
+    TEST_BINDING_WEIGHTS,
+    TEST_BINDING_UV
+};
+
+
+
+/*-----------------------------------------------------------------------------
+ * Rigid bones. Bones 1 & 2 share a rotation. Bones 0 & 3 have no
+ * translation.
+-----------------------------------------------------------------------------*/
+void create_bones(math::mat4* pBones)
+{
+    pBones[0] = math::mat4{1.f};
+    pBones[1] = math::rotate(math::translate(math::mat4{1.f}, math::vec3{1.f, 2.f, 3.f}), math::vec3{0.f, 0.f, 1.f}, math::radians(90.f));
+    pBones[2] = math::rotate(math::translate(math::mat4{1.f}, math::vec3{-4.f, 0.f, 1.f}), math::vec3{0.f, 0.f, 1.f}, math::radians(90.f));
+    pBones[3] = math::rotate(math::mat4{1.f}, math::vec3{1.f, 0.f, 0.f}, math::radians(60.f));
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Each vertex uses one of four weighting patterns:
+ * 0: bone 1 only
+ * 1: bone 3 only
+ * 2: bones 1 & 2, which only differ in translation
+ * 3: bones 0 & 3, which only differ in rotation
+-----------------------------------------------------------------------------*/
+int create_mesh(SL_Context& context, SL_Mesh& outMesh)
+{
+    const size_t vboId = context.create_vbo();
+    SL_VertexBuffer& vbo = context.vbo(vboId);
+
+    if (vbo.init(NUM_TEST_VERTS * sizeof(TestVertex)) != 0)
+    {
+        return -1;
+    }
+
+    uint32_t seed = 0x13579BDFu;
+    TestVertex* pVerts = vbo.element<TestVertex>(0);
+
+    for (size_t v = 0; v < NUM_TEST_VERTS; ++v)
+    {
+        TestVertex& vert = pVerts[v];
+        vert.pos = math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} * 5.f;
+        vert.norm = sl_pack_vertex_2_10_10_10(math::normalize(math::vec3{sl_test_random(seed), sl_test_random(seed), sl_test_random(seed)} + math::vec3{0.f, 0.f, 2.f}));
+        vert.uv = math::vec2{(float)v, -(float)v};
+
+        const math::half zero{0.f};
+
+        switch (v % 4u)
+        {
+            case 0:
+                vert.ids = math::vec4_t<uint16_t>{1, 0, 0, 0};
+                vert.weights = math::vec4_t<math::half>{math::half{1.f}, zero, zero, zero};
+                break;
+
+            case 1:
+                vert.ids = math::vec4_t<uint16_t>{3, 0, 0, 0};
+                vert.weights = math::vec4_t<math::half>{math::half{1.f}, zero, zero, zero};
+                break;
+
+            case 2:
+                vert.ids = math::vec4_t<uint16_t>{1, 2, 0, 0};
+                vert.weights = math::vec4_t<math::half>{math::half{0.25f}, math::half{0.75f}, zero, zero};
+                break;
+
+            default:
+                vert.ids = math::vec4_t<uint16_t>{0, 3, 0, 0};
+                vert.weights = math::vec4_t<math::half>{math::half{0.5f}, math::half{0.5f}, zero, zero};
+                break;
+        }
+    }
+
+    const size_t vaoId = context.create_vao();
+    SL_VertexArray& vao = context.vao(vaoId);
+    vao.set_vertex_buffer(vboId);
+
+    if (vao.set_num_bindings(5) != 5)
+    {
+        return -2;
+    }
+
+    vao.set_binding(TEST_BINDING_POS,     offsetof(TestVertex, pos),     sizeof(TestVertex), VERTEX_DIMENSION_3, VERTEX_DATA_FLOAT);
+    vao.set_binding(TEST_BINDING_NORM,    offsetof(TestVertex, norm),    sizeof(TestVertex), VERTEX_DIMENSION_1, VERTEX_DATA_INT);
+    vao.set_binding(TEST_BINDING_IDS,     offsetof(TestVertex, ids),     sizeof(TestVertex), VERTEX_DIMENSION_4, VERTEX_DATA_SHORT);
+    vao.set_binding(TEST_BINDING_WEIGHTS, offsetof(TestVertex, weights), sizeof(TestVertex), VERTEX_DIMENSION_4, VERTEX_DATA_SHORT);
+    vao.set_binding(TEST_BINDING_UV,      offsetof(TestVertex, uv),      sizeof(TestVertex), VERTEX_DIMENSION_2, VERTEX_DATA_FLOAT);
+
+    outMesh.vaoId = vaoId;
+    outMesh.elementBegin = TEST_FIRST_VERT;
+    outMesh.elementEnd = NUM_TEST_VERTS;
+    outMesh.mode = RENDER_MODE_TRIANGLES;
+    outMesh.materialId = 0;
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Same bone blending as the animation test's skinned vertex shader
+-----------------------------------------------------------------------------*/
+void reference_skin(const math::mat4* pBones, const TestVertex& vert, math::vec3& outPos, math::vec3& outNorm)
+{
+    const math::vec4&& weights = (math::vec4)vert.weights;
+
+    const math::mat4&& boneTrans =
+        (pBones[vert.ids[0]] * weights[0]) +
+        (pBones[vert.ids[1]] * weights[1]) +
+        (pBones[vert.ids[2]] * weights[2]) +
+        (pBones[vert.ids[3]] * weights[3]);
+
+    const math::vec3&& n = sl_unpack_vertex_vec3(vert.norm);
+    outPos = math::vec3_cast(boneTrans * math::vec4{vert.pos[0], vert.pos[1], vert.pos[2], 1.f});
+    outNorm = math::normalize(math::vec3_cast(boneTrans * math::vec4{n[0], n[1], n[2], 0.f}));
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Compare skinned vertices against the reference math
+-----------------------------------------------------------------------------*/
+int compare_skinned_mesh(const SL_Context& context, const SL_SkinnedMesh& skinned, const math::mat4* pBones, SL_SkinningMode mode)
+{
+    const SL_VertexArray& srcVao = context.vao(skinned.srcVaoId);
+    const SL_VertexArray& dstVao = context.vao(skinned.mesh.vaoId);
+    const SL_VertexBuffer& srcVbo = context.vbo(srcVao.get_vertex_buffer());
+    const SL_VertexBuffer& dstVbo = context.vbo(dstVao.get_vertex_buffer());
+
+    for (size_t v = TEST_FIRST_VERT; v < NUM_TEST_VERTS; ++v)
+    {
+        const TestVertex& vert = *srcVbo.element<const TestVertex>(srcVao.offset(TEST_BINDING_POS, v));
+        const math::vec3& pos = *dstVbo.element<const math::vec3>(dstVao.offset(TEST_BINDING_POS, v));
+        const math::vec3&& norm = sl_unpack_vertex_vec3(*dstVbo.element<const int32_t>(dstVao.offset(TEST_BINDING_NORM, v)));
+        const math::vec2& uv = *dstVbo.element<const math::vec2>(dstVao.offset(TEST_BINDING_UV, v));
+
+        if (uv[0] != vert.uv[0] || uv[1] != vert.uv[1])
+        {
+            std::cerr << "Unskinned attribute was not copied at vertex " << v << std::endl;
+            return -1;
+        }
+
+        math::vec3 refPos, refNorm;
+        reference_skin(pBones, vert, refPos, refNorm);
+
+        // Dual quaternions only match linear blending if the blended bones
+        // share a rotation. Rotations around the origin must keep the
+        // vertex's distance instead.
+        const bool rotationBlend = (v % 4u) == 3u;
+
+        if (mode == SL_SKINNING_DUAL_QUATERNION && rotationBlend)
+        {
+            if (math::abs(math::length(pos) - math::length(vert.pos)) > TEST_POS_EPSILON * 10.f)
+            {
+                std::cerr << "Dual-quaternion skinning did not preserve length at vertex " << v << std::endl;
+                return -2;
+            }
+
+            if (math::abs(math::length(norm) - 1.f) > TEST_NORM_EPSILON)
+            {
+                std::cerr << "Dual-quaternion skinning did not preserve normal length at vertex " << v << std::endl;
+                return -3;
+            }
+
+            continue;
+        }
+
+        if (math::length(pos - refPos) > TEST_POS_EPSILON * 10.f)
+        {
+            std::cerr << "Invalid skinned position at vertex " << v << ": "
+                << pos[0] << ", " << pos[1] << ", " << pos[2] << " != "
+                << refPos[0] << ", " << refPos[1] << ", " << refPos[2] << std::endl;
+            return -4;
+        }
+
+        if (math::length(norm - refNorm) > TEST_NORM_EPSILON)
+        {
+            std::cerr << "Invalid skinned normal at vertex " << v << ": "
+                << norm[0] << ", " << norm[1] << ", " << norm[2] << " != "
+                << refNorm[0] << ", " << refNorm[1] << ", " << refNorm[2] << std::endl;
+            return -5;
+        }
+    }
+
+    return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Skin a mesh with both methods, on multiple threads and a single thread
+-----------------------------------------------------------------------------*/
+int main()
+{
+    SL_Context context;
+    context.num_threads(4);
+
+    SL_Mesh mesh;
+    if (create_mesh(context, mesh) != 0)
+    {
+        std::cerr << "Unable to create the test mesh." << std::endl;
+        return -1;
+    }
+
+    const size_t numVaos = context.vaos().size();
+    const size_t numVbos = context.vbos().size();
+
+    SL_SkinnedMesh skinned;
+    int retCode = sl_init_skinned_mesh(context, mesh, TEST_BINDING_POS, TEST_BINDING_NORM, TEST_BINDING_IDS, TEST_BINDING_WEIGHTS, skinned);
+    if (retCode != 0)
+    {
+        std::cerr << "Unable to initialize a skinned mesh: " << retCode << std::endl;
+        return -2;
+    }
+
+    // Only the mesh's own vertices should be copied
+    if (context.vbo(skinned.vboId).num_bytes() != (NUM_TEST_VERTS - TEST_FIRST_VERT) * sizeof(TestVertex))
+    {
+        std::cerr << "Skinned vertex buffer contains unused vertices: " << context.vbo(skinned.vboId).num_bytes() << std::endl;
+        return -3;
+    }
+
+    math::mat4 bones[NUM_TEST_BONES];
+    create_bones(bones);
+
+    const SL_SkinningMode modes[] = {SL_SKINNING_LINEAR, SL_SKINNING_DUAL_QUATERNION};
+    const unsigned threadCounts[] = {4u, 1u};
+
+    for (unsigned t = 0; t < 2; ++t)
+    {
+        context.num_threads(threadCounts[t]);
+
+        for (unsigned m = 0; m < 2; ++m)
+        {
+            sl_skin_mesh(context, skinned, bones, NUM_TEST_BONES, modes[m]);
+
+            retCode = compare_skinned_mesh(context, skinned, bones, modes[m]);
+            if (retCode != 0)
+            {
+                std::cerr << "Skinning failed with " << threadCounts[t] << " thread(s), mode " << m << '.' << std::endl;
+                return retCode - 10;
+            }
+        }
+    }
+
+    sl_terminate_skinned_mesh(context, skinned);
+
+    if (context.vaos().size() != numVaos || context.vbos().size() != numVbos)
+    {
+        std::cerr << "Skinned mesh resources were not released." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+
+#ifndef SL_TEST_UTILS_HPP
+#define SL_TEST_UTILS_HPP
+
+#include <cstdint>
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Context.hpp"
+#include "softlight/SL_Framebuffer.hpp"
+#include "softlight/SL_Mesh.hpp"
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_VertexArray.hpp"
+#include "softlight/SL_VertexBuffer.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Deterministic test data
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Linear congruential generator, returning a value within (-1, 1). Tests
+ * use this instead of std::rand() so results match across platforms.
+-------------------------------------*/
+inline float sl_test_random(uint32_t& seed) noexcept
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (float)(seed >> 8u) * (1.f / 16777216.f) * 2.f - 1.f;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Small render targets & meshes
+-----------------------------------------------------------------------------*/
+/*-------------------------------------
+ * Create a framebuffer with one color attachment & a float depth buffer.
+ * Returns the framebuffer's index, or a negative value on error.
+-------------------------------------*/
+inline int sl_test_init_framebuffer(SL_Context& context, SL_ColorDataType colorType, uint16_t w, uint16_t h) noexcept
+{
+    const size_t fboId = context.create_framebuffer();
+    const size_t texId = context.create_texture();
+    const size_t depthId = context.create_texture();
+
+    SL_Texture& tex = context.texture(texId);
+    if (tex.init(colorType, w, h, 1) != 0)
+    {
+        return -1;
+    }
+
+    SL_Texture& depth = context.texture(depthId);
+    if (depth.init(SL_ColorDataType::SL_COLOR_R_FLOAT, w, h, 1) != 0)
+    {
+        return -2;
+    }
+
+    SL_Framebuffer& fbo = context.framebuffer(fboId);
+    if (fbo.reserve_color_buffers(1) != 0
+    || fbo.attach_color_buffer(0, tex.view()) != 0
+    || fbo.attach_depth_buffer(depth.view()) != 0)
+    {
+        return -3;
+    }
+
+    return (int)fboId;
+}
+
+
+
+/*-------------------------------------
+ * Create a triangle mesh from interleaved vertices, each starting with a
+ * vec4 position. Any further vertex data is read by the vertex shader using
+ * the same binding.
+-------------------------------------*/
+inline int sl_test_init_mesh(SL_Context& context, const void* pVerts, size_t vertStride, size_t numVerts, SL_Mesh& outMesh) noexcept
+{
+    const size_t vaoId = context.create_vao();
+    const size_t vboId = context.create_vbo();
+
+    SL_VertexBuffer& vbo = context.vbo(vboId);
+    if (vbo.init(vertStride * numVerts, pVerts) != 0)
+    {
+        return -1;
+    }
+
+    SL_VertexArray& vao = context.vao(vaoId);
+    vao.set_vertex_buffer(vboId);
+    if (vao.set_num_bindings(1) != 1)
+    {
+        return -2;
+    }
+
+    vao.set_binding(0, 0, vertStride, VERTEX_DIMENSION_4, VERTEX_DATA_FLOAT);
+
+    outMesh.vaoId = vaoId;
+    outMesh.elementBegin = 0;
+    outMesh.elementEnd = numVerts;
+    outMesh.mode = RENDER_MODE_TRIANGLES;
+    outMesh.materialId = 0;
+
+    return 0;
+}
+
+
+
+#endif /* SL_TEST_UTILS_HPP */
@@ -0,0 +1,190 @@
+
+#include <cstdint>
+#include <cstring> // std::memcmp
+#include <iostream>
+#include <vector>
+
+#include "softlight/SL_Color.hpp"
+#include "softlight/SL_Swizzle.hpp" // SL_TexelOrder
+#include "softlight/SL_Texture.hpp"
+#include "softlight/SL_TextureUploadProcessor.hpp"
+
+#include "sl_test_utils.hpp"
+
+
+
+/*-----------------------------------------------------------------------------
+ * Test data
+ *
+ * Widths leave partial vector runs at the end of each row for every texel
+ * size, and heights leave partial bands of SL_TEXELS_PER_CHUNK rows. Thread
+ * counts don't divide the number of bands evenly.
+-----------------------------------------------------------------------------*/
+struct TestDimens
+{
+    uint16_t w;
+    uint16_t h;
+    uint16_t d;
+};
+
+const TestDimens TEST_DIMENS[] = {
+    {1,  1,  1},
+    {3,  5,  1},
+    {13, 7,  1},
+    {37, 21, 1},
+    {67, 9,  1},
+    {5,  3,  2},
+    {19, 11, 3},
+};
+
+const uint16_t TEST_THREAD_COUNTS[] = {1, 2, 3, 5, 8};
+
+const SL_ColorDataType TEST_COLOR_TYPES[] = {
+    SL_COLOR_R_8U,    SL_COLOR_R_16U,    SL_COLOR_R_32U,    SL_COLOR_R_64U,    SL_COLOR_R_FLOAT,    SL_COLOR_R_DOUBLE,
+    SL_COLOR_RG_8U,   SL_COLOR_RG_16U,   SL_COLOR_RG_32U,   SL_COLOR_RG_64U,   SL_COLOR_RG_FLOAT,   SL_COLOR_RG_DOUBLE,
+    SL_COLOR_RGB_8U,  SL_COLOR_RGB_16U,  SL_COLOR_RGB_32U,  SL_COLOR_RGB_64U,  SL_COLOR_RGB_FLOAT,  SL_COLOR_RGB_DOUBLE,
+    SL_COLOR_RGBA_8U, SL_COLOR_RGBA_16U, SL_COLOR_RGBA_32U, SL_COLOR_RGBA_64U, SL_COLOR_RGBA_FLOAT, SL_COLOR_RGBA_DOUBLE,
+    SL_COLOR_RGB_332, SL_COLOR_RGB_565,  SL_COLOR_RGBA_5551, SL_COLOR_RGBA_4444, SL_COLOR_RGBA_1010102
+};
+
+constexpr char TEST_FILL_BYTE = (char)0xCD;
+
+
+
+/*-----------------------------------------------------------------------------
+ * Source texels are random bytes, so every texel differs from the fill value
+-----------------------------------------------------------------------------*/
+std::vector<char> create_texels(size_t numBytes, uint32_t& seed)
+{
+    std::vector<char> texels;
+    texels.resize(numBytes);
+
+    for (char& c : texels)
+    {
+        do
+        {
+            c = (char)(uint8_t)((0.5f + 0.5f * sl_test_random(seed)) * 255.f);
+        }
+        while (c == TEST_FILL_BYTE);
+    }
+
+    return texels;
+}
+
+
+
+template <SL_TexelOrder order>
+void fill_texture(SL_Texture& tex)
+{
+    const SL_TextureView& view = tex.view();
+    std::vector<char> fill;
+    fill.resize(view.bytesPerTexel, TEST_FILL_BYTE);
+
+    for (uint16_t z = 0; z < view.depth; ++z)
+    {
+        for (uint16_t y = 0; y < view.height; ++y)
+        {
+            for (uint16_t x = 0; x < view.width; ++x)
+            {
+                tex.set_texel<order>(x, y, z, fill.data());
+            }
+        }
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Upload texels with each thread's share of bands, then compare against
+ * texels copied one at a time.
+-----------------------------------------------------------------------------*/
+template <SL_TexelOrder order>
+bool check_upload(SL_ColorDataType type, const TestDimens& dimens, uint16_t numThreads, const std::vector<char>& texels)
+{
+    SL_Texture expected;
+    SL_Texture uploaded;
+
+    if (expected.init(type, dimens.w, dimens.h, dimens.d) != 0 || uploaded.init(type, dimens.w, dimens.h, dimens.d) != 0)
+    {
+        std::cerr << "Unable to initialize a texture of type " << (int)type << '.' << std::endl;
+        return false;
+    }
+
+    fill_texture<order>(uploaded);
+    expected.set_texels<order>(0, 0, 0, dimens.w, dimens.h, dimens.d, texels.data());
+
+    SL_TextureUploadProcessor uploader;
+    uploader.mNumThreads = numThreads;
+    uploader.mTexelOrder = order;
+    uploader.mSrcType    = type;
+    uploader.mSrcTexels  = texels.data();
+    uploader.mDstTex     = &uploaded.view();
+
+    for (uint16_t threadId = 0; threadId < numThreads; ++threadId)
+    {
+        uploader.mThreadId = threadId;
+        uploader.execute();
+    }
+
+    const SL_TextureView& a = expected.view();
+    const SL_TextureView& b = uploaded.view();
+
+    for (uint16_t z = 0; z < dimens.d; ++z)
+    {
+        for (uint16_t y = 0; y < dimens.h; ++y)
+        {
+            for (uint16_t x = 0; x < dimens.w; ++x)
+            {
+                const ptrdiff_t offset = sl_texture_view_index<order>(a, x, y, z) * (ptrdiff_t)a.bytesPerTexel;
+
+                if (std::memcmp(a.pTexels + offset, b.pTexels + offset, a.bytesPerTexel) != 0)
+                {
+                    std::cerr
+                        << "Texel mismatch at (" << x << ", " << y << ", " << z << ")"
+                        << "\n\tType:       " << (int)type
+                        << "\n\tDimensions: " << dimens.w << 'x' << dimens.h << 'x' << dimens.d
+                        << "\n\tThreads:    " << numThreads
+                        << "\n\tSwizzled:   " << (order == SL_TexelOrder::SWIZZLED)
+                        << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+/*-----------------------------------------------------------------------------
+ * Banded uploads should match per-texel copies for every texel size
+-----------------------------------------------------------------------------*/
+int main()
+{
+    uint32_t seed = 0x7E97E15Au;
+
+    for (SL_ColorDataType type : TEST_COLOR_TYPES)
+    {
+        for (const TestDimens& dimens : TEST_DIMENS)
+        {
+            const size_t numBytes = sl_bytes_per_color(type) * dimens.w * dimens.h * dimens.d;
+            const std::vector<char>&& texels = create_texels(numBytes, seed);
+
+            for (uint16_t numThreads : TEST_THREAD_COUNTS)
+            {
+                if (!check_upload<SL_TexelOrder::ORDERED>(type, dimens, numThreads, texels))
+                {
+                    return -1;
+                }
+
+                if (!check_upload<SL_TexelOrder::SWIZZLED>(type, dimens, numThreads, texels))
+                {
+                    return -2;
+                }
+            }
+        }
+    }
+
+    return 0;
+}